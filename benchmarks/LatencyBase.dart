@@ -0,0 +1,139 @@
+// Copyright (c) 2015, the Fletch project authors. Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE.md file.
+
+// Harness for open-loop latency benchmarks.
+//
+// Requests are issued at a given average rate, independent of when earlier
+// requests complete, and the latency of a request is measured from the time
+// it was scheduled to be issued. Requests delayed by a slow system therefore
+// count their full delay, which a closed loop (send, wait for the reply,
+// send again) hides.
+//
+// A benchmark is run for every combination of [processCounts] and [rates],
+// and each run prints one line per statistic in the format of
+// BenchmarkBase.report, for example:
+//
+//   PortLatency_8p_20000rps(P99): 31 us.
+//
+// The number of scheduler threads is set with the -Xmax_threads=<n> flag of
+// the VM, so sweeping over thread counts means running the benchmark once
+// per count. The request generator busy-waits for the time of the next
+// request, and so keeps one scheduler thread busy.
+
+library latency_base;
+
+import 'dart:fletch';
+import 'dart:math' show Random, log;
+
+const int WARMUP_MILLISECONDS = 200;
+const int RUN_MILLISECONDS = 1000;
+
+abstract class LatencyBenchmark {
+  final String name;
+  final List<int> processCounts;
+  final List<int> rates;
+
+  // Exponentially distributed arrival times (a Poisson process) model
+  // independent clients better than a fixed interval between requests.
+  final bool poisson;
+
+  final Random _random = new Random(42);
+  Channel _results;
+  Port _collector;
+
+  LatencyBenchmark(this.name, this.processCounts, this.rates,
+                   {this.poisson: true});
+
+  // Starts [processes] server processes. A request issued by [issue] must
+  // result in its scheduled time, unchanged, being sent to [collector].
+  void setup(int processes, Port collector);
+
+  // Stops the server processes started by [setup].
+  void teardown();
+
+  // Issues request number [request], scheduled at [scheduled] microseconds
+  // (see LatencyHistogram.now). Must not wait for the reply.
+  void issue(int request, int scheduled);
+
+  void report() {
+    for (int processes in processCounts) {
+      _results = new Channel();
+      Process.spawn(_collect, new Port(_results));
+      _collector = _results.receive();
+      setup(processes, _collector);
+      _run(rates.first, WARMUP_MILLISECONDS);
+      for (int rate in rates) {
+        List<int> statistics = _run(rate, RUN_MILLISECONDS);
+        String point = "${name}_${processes}p_${rate}rps";
+        print("$point(P50): ${statistics[1]} us.");
+        print("$point(P90): ${statistics[2]} us.");
+        print("$point(P99): ${statistics[3]} us.");
+        print("$point(P999): ${statistics[4]} us.");
+        print("$point(Max): ${statistics[5]} us.");
+        print("$point(Mean): ${statistics[6]} us.");
+      }
+      teardown();
+      _collector.send(null);
+    }
+  }
+
+  // Issues requests at [rate] per second for [milliseconds] and returns the
+  // statistics computed by [_collect].
+  List<int> _run(int rate, int milliseconds) {
+    double interval = 1000000 / rate;
+    int start = LatencyHistogram.now;
+    int end = start + milliseconds * 1000;
+    double next = start.toDouble();
+    int requests = 0;
+    while (next < end) {
+      int now = LatencyHistogram.now;
+      // Catch up on all requests that are due, keeping their scheduled
+      // times, if the generator was not running for a while.
+      while (next <= now && next < end) {
+        issue(requests++, next.toInt());
+        next += poisson
+            ? -log(1.0 - _random.nextDouble()) * interval
+            : interval;
+      }
+    }
+    // Ask for the statistics once all requests have completed.
+    _collector.send(-1 - requests);
+    List<int> statistics = new List<int>(7);
+    for (int i = 0; i < statistics.length; i++) {
+      statistics[i] = _results.receive();
+    }
+    return statistics;
+  }
+
+  // Records the latency of the scheduled times sent to it until it receives
+  // the number of requests of a run as -1 - count. When all of them have
+  // completed, the count, P50, P90, P99, P99.9, maximum and mean latency
+  // are sent to [results]. Stops when it receives null.
+  static void _collect(Port results) {
+    Channel input = new Channel();
+    results.send(new Port(input));
+    LatencyHistogram histogram = new LatencyHistogram();
+    int expected = -1;
+    while (true) {
+      var message = input.receive();
+      if (message == null) break;
+      if (message < 0) {
+        expected = -1 - message;
+      } else {
+        histogram.recordSince(message);
+      }
+      if (histogram.count == expected) {
+        results.send(histogram.count);
+        results.send(histogram.percentile(50));
+        results.send(histogram.percentile(90));
+        results.send(histogram.percentile(99));
+        results.send(histogram.percentile(99.9));
+        results.send(histogram.maximum);
+        results.send(histogram.mean);
+        histogram.reset();
+        expected = -1;
+      }
+    }
+  }
+}
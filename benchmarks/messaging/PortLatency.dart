@@ -0,0 +1,40 @@
+// Copyright (c) 2015, the Fletch project authors. Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE.md file.
+
+import 'dart:fletch';
+
+import '../LatencyBase.dart';
+import 'utils.dart';
+
+void main() {
+  new PortLatencyBenchmark().report();
+}
+
+// The latency of a message sent through a port to one of a number of
+// processes, which forward it to the collector.
+class PortLatencyBenchmark extends LatencyBenchmark {
+  List<Port> forwarders;
+
+  PortLatencyBenchmark()
+      : super("PortLatency", [1, 8, 64], [10000, 50000]);
+
+  void setup(int processes, Port collector) {
+    Channel channel = new Channel();
+    Port port = new Port(channel);
+    forwarders = new List<Port>(processes);
+    for (int i = 0; i < processes; i++) {
+      Process.spawn(portForwarder, port);
+      forwarders[i] = channel.receive();
+      forwarders[i].send(collector);
+    }
+  }
+
+  void teardown() {
+    for (Port forwarder in forwarders) forwarder.send(null);
+  }
+
+  void issue(int request, int scheduled) {
+    forwarders[request % forwarders.length].send(scheduled);
+  }
+}
@@ -0,0 +1,63 @@
+// Copyright (c) 2015, the Fletch project authors. Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE.md file.
+
+import 'dart:fletch';
+
+import '../BenchmarkBase.dart';
+import 'utils.dart';
+
+void main() {
+  new ProcessMonitorBenchmark().report();
+}
+
+// A supervisor monitors a tree of workers and restarts all of them at once:
+// it kills every worker and waits for their deaths before spawning a new
+// generation.
+class ProcessMonitorBenchmark extends BenchmarkBase {
+  Channel deaths;
+  Port deathsPort;
+  Channel ready;
+  Port readyPort;
+  List<Process> workers;
+
+  ProcessMonitorBenchmark() : super("ProcessMonitor");
+
+  void setup() {
+    deaths = new Channel();
+    deathsPort = new Port(deaths);
+    ready = new Channel();
+    readyPort = new Port(ready);
+    workers = spawnWorkers();
+  }
+
+  void exercise() => run();
+
+  void run() {
+    for (Process worker in workers) worker.kill();
+    for (int i = 0; i < DEFAULT_MESSAGES; i++) deaths.receive();
+    workers = spawnWorkers();
+  }
+
+  void teardown() {
+    for (Process worker in workers) worker.kill();
+    for (int i = 0; i < DEFAULT_MESSAGES; i++) deaths.receive();
+  }
+
+  List<Process> spawnWorkers() {
+    // The closures must be immutable, so they cannot refer to [this].
+    Port port = readyPort;
+    List<Process> result = new List<Process>(DEFAULT_MESSAGES);
+    for (int i = 0; i < DEFAULT_MESSAGES; i++) {
+      result[i] = Process.spawnDetached(() => worker(port),
+                                        monitor: deathsPort);
+    }
+    for (int i = 0; i < DEFAULT_MESSAGES; i++) ready.receive();
+    return result;
+  }
+
+  static void worker(Port ready) {
+    ready.send(null);
+    new Channel().receive();
+  }
+}
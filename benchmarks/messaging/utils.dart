@@ -27,3 +27,15 @@ void portResponder(Port output) {
     output.send(message - 1);
   } while (message > 0);
 }
+
+// Sends its input port to [output], and then forwards the messages it
+// receives to the port it receives first, until it receives null.
+void portForwarder(Port output) {
+  Channel input = new Channel();
+  output.send(new Port(input));
+  Port target = input.receive();
+  var message;
+  while ((message = input.receive()) != null) {
+    target.send(message);
+  }
+}
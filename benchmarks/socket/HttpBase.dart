@@ -0,0 +1,108 @@
+// Copyright (c) 2015, the Fletch project authors. Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE.md file.
+
+import 'dart:fletch';
+import 'dart:typed_data';
+
+import 'package:http/http.dart';
+import 'package:socket/socket.dart';
+
+import '../BenchmarkBase.dart';
+
+const int REQUEST_COUNT = 1000;
+const int PIPELINE_DEPTH = 8;
+const int SERVER_WORKERS = 4;
+
+const String REQUEST = "GET /plaintext HTTP/1.1\r\nHost: localhost\r\n\r\n";
+const String RESPONSE =
+    "HTTP/1.1 200 OK\r\nContent-Length: 13\r\n\r\nHello, World!";
+
+// Clients send keep-alive requests in batches of [PIPELINE_DEPTH] pipelined
+// requests and wait for all responses of a batch before sending the next.
+class HttpBenchmark extends BenchmarkBase {
+  final int clients;
+
+  final channel = new Channel();
+  var port;
+  var serverPort;
+  int serverSocketPort;
+
+  HttpBenchmark(int clients)
+    : super("HttpKeepAlive$clients"),
+      this.clients = clients;
+
+  static void handle(HttpServerRequest request, HttpServerResponse response) {
+    response.write("Hello, World!");
+  }
+
+  static void serverProcess(port) {
+    var channel = new Channel();
+    port.send(new Port(channel));
+    var server = new HttpServer("127.0.0.1", 0);
+    port.send(server.port);
+    Fiber.fork(() {
+      channel.receive();
+      server.close();
+    });
+    server.serve(handle, workers: SERVER_WORKERS);
+  }
+
+  void setup() {
+    port = new Port(channel);
+    Process.spawn(serverProcess, port);
+    serverPort = channel.receive();
+    serverSocketPort = channel.receive();
+  }
+
+  void teardown() {
+    serverPort.send(null);
+  }
+
+  void exercise() => run();
+
+  void run() {
+    for (int i = 0; i < clients; i++) {
+      var channel = new Channel();
+      Process.spawn(clientProcess, new Port(channel));
+      var clientPort = channel.receive();
+      clientPort.send(serverSocketPort);
+      clientPort.send(port);
+    }
+    for (int i = 0; i < clients; i++) {
+      channel.receive();
+    }
+  }
+
+  static ByteBuffer encode(String data) {
+    Uint8List list = new Uint8List(data.length);
+    for (int i = 0; i < data.length; i++) list[i] = data.codeUnitAt(i);
+    return list.buffer;
+  }
+
+  static void clientProcess(port) {
+    var channel = new Channel();
+    port.send(new Port(channel));
+
+    var socket = new Socket.connect("127.0.0.1", channel.receive());
+    port = channel.receive();
+    var requests = encode(REQUEST * PIPELINE_DEPTH);
+    int responsesLength = RESPONSE.length * PIPELINE_DEPTH;
+    bool checked = false;
+    for (int i = 0; i < REQUEST_COUNT; i += PIPELINE_DEPTH) {
+      socket.write(requests);
+      var responses = socket.read(responsesLength);
+      if (responses == null) throw "Bad server response";
+      if (!checked) {
+        var data = new Uint8List.view(responses, 0, RESPONSE.length);
+        if (new String.fromCharCodes(data) != RESPONSE) {
+          throw "Unexpected server response";
+        }
+        checked = true;
+      }
+    }
+    socket.close();
+
+    port.send(null);
+  }
+}
@@ -0,0 +1,67 @@
+// Copyright (c) 2015, the Fletch project authors. Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE.md file.
+
+import 'dart:fletch';
+import 'dart:typed_data';
+
+import 'package:socket/socket.dart';
+
+import '../LatencyBase.dart';
+import 'SocketBase.dart';
+
+void main() {
+  new SocketLatencyBenchmark().report();
+}
+
+// The latency of a ping-pong over one of a number of socket connections,
+// each served by a client process and an accept process.
+class SocketLatencyBenchmark extends LatencyBenchmark {
+  Port serverPort;
+  List<Port> clients;
+
+  SocketLatencyBenchmark()
+      : super("SocketLatency", [1, 32], [1000, 5000]);
+
+  void setup(int processes, Port collector) {
+    Channel channel = new Channel();
+    Port port = new Port(channel);
+    Process.spawn(SocketBenchmark.serverProcess, port);
+    serverPort = channel.receive();
+    int serverSocketPort = channel.receive();
+
+    serverPort.send(processes);
+    clients = new List<Port>(processes);
+    for (int i = 0; i < processes; i++) {
+      Process.spawn(clientProcess, port);
+      clients[i] = channel.receive();
+      clients[i].send(serverSocketPort);
+      clients[i].send(collector);
+    }
+  }
+
+  void teardown() {
+    for (Port client in clients) client.send(null);
+    serverPort.send(0);
+  }
+
+  void issue(int request, int scheduled) {
+    clients[request % clients.length].send(scheduled);
+  }
+
+  static void clientProcess(Port port) {
+    Channel channel = new Channel();
+    port.send(new Port(channel));
+
+    Socket socket = new Socket.connect("127.0.0.1", channel.receive());
+    Port collector = channel.receive();
+    var buffer = new Uint8List(MESSAGE_SIZE).buffer;
+    var scheduled;
+    while ((scheduled = channel.receive()) != null) {
+      socket.write(buffer);
+      if (socket.read(MESSAGE_SIZE) == null) throw "Bad socket response";
+      collector.send(scheduled);
+    }
+    socket.close();
+  }
+}
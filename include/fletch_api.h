@@ -56,6 +56,20 @@ FLETCH_EXPORT int FletchRunMain(FletchProgram program);
 // Start multiple processes at main, from the programs.
 FLETCH_EXPORT int FletchRunMultipleMain(int count, FletchProgram* programs);
 
+// Write the heaps, stacks and mailboxes of all processes of a running
+// program to a checkpoint file. The program is stopped while the checkpoint
+// is written. Returns 0 if the program is not running, a process is in the
+// middle of building a message, a process has not yet received an exit or
+// clone message sent to it, or the file could not be written.
+FLETCH_EXPORT int FletchWriteCheckpoint(FletchProgram program,
+                                        const char* path);
+
+// Restore the processes of a checkpoint file into a program loaded from the
+// snapshot the checkpoint was written against, and run them. Foreign memory
+// of the restored processes has to be initialized again.
+FLETCH_EXPORT int FletchRunFromCheckpoint(FletchProgram program,
+                                          const char* path);
+
 // Load the snapshot from the file, load the program from the
 // snapshot, start a process from that program, and run main in that
 // process.
@@ -35,9 +35,9 @@ Channel _ensureEventQueue() {
   }
 }
 
-int get _currentTimestamp {
-  return new DateTime.now().millisecondsSinceEpoch;
-}
+// Timers are based on the monotonic clock, so they are not affected by
+// changes to the system time.
+int get _currentTimestamp => _FletchTimer._now();
 
 // TODO(ajohnsen): We should create a heap-like structure in Dart, so we only
 // have one active port/channel per process.
@@ -97,6 +97,8 @@ class _FletchTimer implements Timer {
 
   bool get isActive => _isActive;
 
+  @fletch.native external static int _now();
+
   @fletch.native external static void _scheduleTimeout(int timeout, Port port);
 }
 
@@ -43,6 +43,13 @@ abstract class _StringBase implements String {
     if (end == null) end = charCodes.length;
     int length = end - start;
     if (start < 0 || length < 0) throw new RangeError.range(start, 0, length);
+    if (charCodes is List) {
+      var store = fletch.fixedListBackingStore(charCodes);
+      if (store != null) {
+        String result = _fromCharCodes(store, start, end);
+        if (result != null) return result;
+      }
+    }
     bool oneByteString = true;
     int stringLength = 0;
     // TODO(ajohnsen): Uint8List checks?
@@ -85,6 +92,13 @@ abstract class _StringBase implements String {
     return str;
   }
 
+  // Returns null if the VM cannot copy the code units from [store], the
+  // array behind a fixed-length list, in one go. The caller then builds the
+  // string itself.
+  @fletch.native static String _fromCharCodes(store, int start, int end) {
+    return null;
+  }
+
   factory _StringBase.fromCharCode(int charCode) {
     if (charCode >= 0 && charCode < 256) {
       return new _OneByteString(1)
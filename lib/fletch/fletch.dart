@@ -5,6 +5,7 @@
 library dart.fletch;
 
 import 'dart:fletch._system' as fletch;
+import 'dart:typed_data';
 
 /// Fibers are lightweight co-operative multitask units of execution. They
 /// are scheduled on top of OS-level threads, but they are cheap to create
@@ -321,22 +322,51 @@ class Process {
           'The optional argument passed to Process.spawn() must be immutable.');
     }
 
-    return _spawn(_entry, fn, argument, true, true, null);
+    return _spawn(_entry, fn, argument, true, true, null, null);
   }
 
-  static Process spawnDetached(Function fn, {Port monitor}) {
+  /**
+   * Spawn a process running [fn] that is not linked to the current process.
+   * If [monitor] is given, it receives a [ProcessDeath] when the process
+   * terminates.
+   *
+   * The [heapSize] in bytes is a hint for how much the process allocates. The
+   * process does not collect garbage before its heap reaches that size, so
+   * short-lived processes that allocate a known amount avoid collecting
+   * while they grow.
+   */
+  static Process spawnDetached(Function fn, {Port monitor, int heapSize}) {
     if (!isImmutable(fn)) {
       throw new ArgumentError(
           'The closure passed to Process.spawnDetached() must be immutable.');
     }
 
-    return _spawn(_entry, fn, null, true, false, monitor);
+    return _spawn(_entry, fn, null, true, false, monitor, heapSize);
   }
 
   /**
-   * Divide the elements in [arguments] into a matching number of processes
-   * with [fn] as entry. The current process blocks until all processes have
-   * terminated.
+   * Release the memory the current process holds for its peak usage the
+   * next time it waits for messages. The stack is shrunk to the frames in
+   * use and the heap is compacted. The process is resumed as usual when a
+   * message arrives, and grows again as needed.
+   *
+   * Idle processes can also be hibernated automatically with the
+   * `-Xhibernate_idle_ms` flag of the VM.
+   */
+  static void hibernate() {
+    _hibernate();
+  }
+
+  /**
+   * Apply [fn] to the elements in [arguments] in parallel and return the
+   * results in order. The current process blocks until all results are
+   * computed.
+   *
+   * The elements are split into chunks which are handed out to a pool of
+   * worker processes, one per scheduler thread. Idle workers pick up the
+   * remaining chunks, so uneven work is balanced between them. The results
+   * of a chunk come back in a single message. An element for which [fn]
+   * throws gets the result null.
    *
    * The elements in [arguments] can be any immutable (see [isImmutable])
    * object.
@@ -344,6 +374,55 @@ class Process {
    * The function [fn] must be a top-level or static function.
    */
   static List divide(fn(argument), List arguments) {
+    _checkDivideArguments(fn, null, arguments);
+    List results = new List(arguments.length);
+    _divide(fn, null, arguments, (int start, int count, _DivideLink link) {
+      // The results of a chunk come back in reverse order.
+      for (int i = start + count - 1; i >= start; i--) {
+        results[i] = link.value;
+        link = link.next;
+      }
+    });
+    return results;
+  }
+
+  /**
+   * Apply [fn] to the elements in [arguments] in parallel like [divide], and
+   * combine the results in order using [combine]. Returns null if
+   * [arguments] is empty. If [combine] throws, no more chunks are handed
+   * out and the error is rethrown once the workers have stopped. Errors
+   * that are not immutable are rethrown as their string representation.
+   *
+   * Both [fn] and [combine] must be top-level or static functions.
+   */
+  static divideReduce(fn(argument), combine(a, b), List arguments) {
+    _checkDivideArguments(fn, combine, arguments);
+    int length = arguments.length;
+    int chunkSize = _divideChunkSize(length);
+    List reduced = new List((length + chunkSize - 1) ~/ chunkSize);
+    _divide(fn, combine, arguments, (int start, int count, value) {
+      reduced[start ~/ chunkSize] = value;
+    });
+    if (reduced.isEmpty) return null;
+    var result = reduced[0];
+    for (int i = 1; i < reduced.length; i++) {
+      result = combine(result, reduced[i]);
+    }
+    return result;
+  }
+
+  /**
+   * Apply [fn] to the elements in [arguments] in parallel like [divide],
+   * discarding the results.
+   */
+  static void divideForEach(fn(argument), List arguments) {
+    _checkDivideArguments(fn, null, arguments);
+    _divide(fn, _discardResults, arguments, (int start, int count, value) {});
+  }
+
+  static _discardResults(a, b) => null;
+
+  static void _checkDivideArguments(fn, combine, List arguments) {
     if (fn == null) {
       throw new ArgumentError.notNull("fn");
     }
@@ -351,6 +430,11 @@ class Process {
       throw new ArgumentError.value(
           fn, "fn", "Closure passed to Process.divide must be immutable.");
     }
+    if (!isImmutable(combine)) {
+      throw new ArgumentError.value(
+          combine, "combine",
+          "Closure passed to Process.divideReduce must be immutable.");
+    }
     if (arguments == null) {
       throw new ArgumentError.notNull("arguments");
     }
@@ -363,27 +447,123 @@ class Process {
             "Cannot pass mutable arguments to subprocess via Process.divide.");
       }
     }
+  }
 
-    List channels = new List(length);
-    for (int i = 0; i < length; i++) {
-      channels[i] = new Channel();
-
-      final argument = arguments[i];
-      final port = new Port(channels[i]);
-      Process.spawnDetached(() {
-        try {
-          Process.exit(value: fn(argument), to: port);
-        } finally {
-          // TODO(kustermann): Handle error properly. Once we do this, we can
-          // remove the 'fn == null' check above.
-          Process.exit(to: port);
+  // Handing out a few chunks per worker lets idle workers take over work
+  // from slow ones, while keeping the number of messages low.
+  static const int _chunksPerWorker = 4;
+
+  static int _divideChunkSize(int length) {
+    int chunks = _numberOfThreads() * _chunksPerWorker;
+    int size = (length + chunks - 1) ~/ chunks;
+    return (size == 0) ? 1 : size;
+  }
+
+  // Run [fn] over [arguments] on a pool of worker processes. For each
+  // chunk, [done] is called with the chunk's position and either the
+  // results as a reversed [_DivideLink] list or, if [combine] is given,
+  // the results of the chunk combined into a single value.
+  static void _divide(fn, combine, List arguments, void done(start, count, r)) {
+    int length = arguments.length;
+    if (length == 0) return;
+    int chunkSize = _divideChunkSize(length);
+    int chunks = (length + chunkSize - 1) ~/ chunkSize;
+    int workers = _numberOfThreads();
+    if (workers > chunks) workers = chunks;
+
+    Channel channel = new Channel();
+    Port port = new Port(channel);
+    for (int i = 0; i < workers; i++) {
+      Process.spawnDetached(() => _divideWorker(fn, combine, port));
+    }
+
+    // Every message from a worker asks for the next chunk. Workers are
+    // told to stop with null once all chunks are handed out, or once one of
+    // them has failed.
+    int next = 0;
+    var failure;
+    while (workers > 0) {
+      _DivideResult message = channel.receive();
+      if (message.error != null) {
+        if (failure == null) failure = message.error;
+        next = chunks;
+      } else if (message.start >= 0) {
+        done(message.start, message.count, message.result);
+      }
+      if (message.exited) {
+        workers--;
+        if (next == chunks) continue;
+        Process.spawnDetached(() => _divideWorker(fn, combine, port));
+        workers++;
+      } else if (next == chunks) {
+        message.worker.send(null);
+        workers--;
+      } else {
+        int start = next * chunkSize;
+        int end = start + chunkSize;
+        if (end > length) end = length;
+        _DivideLink link = null;
+        for (int i = end - 1; i >= start; i--) {
+          link = new _DivideLink(arguments[i], link);
         }
-      });
+        message.worker.send(new _DivideWork(start, end - start, link));
+        next++;
+      }
     }
-    for (int i = 0; i < length; i++) {
-      channels[i] = channels[i].receive();
+    if (failure != null) throw failure;
+  }
+
+  static void _divideWorker(fn, combine, Port coordinator) {
+    Channel channel = new Channel();
+    Port self = new Port(channel);
+    coordinator.send(new _DivideResult(self, -1, 0, null, false));
+    while (true) {
+      _DivideWork work = channel.receive();
+      if (work == null) return;
+      var result;
+      try {
+        result = _divideChunk(fn, combine, work.arguments);
+      } catch (error) {
+        // Report the failure, since the caller waits for a message from
+        // every worker and would never hear from a dead one.
+        if (!isImmutable(error)) error = error.toString();
+        coordinator.send(new _DivideResult(self, -1, 0, null, false, error));
+        continue;
+      }
+
+      var message =
+          new _DivideResult(self, work.start, work.count, result, false);
+      if (!isImmutable(message)) {
+        // Mutable results cannot be sent as a message, but they can be
+        // passed on when exiting. The coordinator replaces this worker.
+        exit(value: new _DivideResult(self, work.start, work.count, result,
+                                      true),
+             to: coordinator);
+      }
+      coordinator.send(message);
+    }
+  }
+
+  // Apply [fn] to the elements of a chunk. An element for which [fn] throws
+  // gets the result null. Errors thrown by [combine] are passed on.
+  static _divideChunk(fn, combine, _DivideLink arguments) {
+    var result;
+    bool first = true;
+    for (_DivideLink link = arguments; link != null; link = link.next) {
+      var value;
+      try {
+        value = fn(link.value);
+      } catch (error) {
+        // TODO(kustermann): Handle error properly.
+      }
+      if (combine == null) {
+        result = new _DivideLink(value, result);
+      } else {
+        result = first ? value : combine(result, value);
+      }
+      first = false;
     }
-    return channels;
+    return result;
   }
 
   /**
@@ -414,7 +594,8 @@ class Process {
                                        argument,
                                        bool linkToChild,
                                        bool linkFromChild,
-                                       Port monitor) {
+                                       Port monitor,
+                                       int heapSize) {
     throw new ArgumentError();
   }
 
@@ -429,6 +610,8 @@ class Process {
   @fletch.native external static Process get current;
   @fletch.native external static _queueGetMessage();
   @fletch.native external static Channel _queueGetChannel();
+  @fletch.native external static int _numberOfThreads();
+  @fletch.native external static void _hibernate();
 }
 
 // Ports allow you to send messages to a channel. Ports are
@@ -441,6 +624,13 @@ class Port {
     return Port._create(channel);
   }
 
+  // Create a port that gathers [count] values. When a value has been
+  // contributed for every index from 0 to count - 1, they are delivered to
+  // [channel] as a single list in index order.
+  factory Port.gather(Channel channel, int count) {
+    return Port._createGather(channel, count);
+  }
+
   // TODO(kasperl): Temporary debugging aid.
   int get id => _port;
 
@@ -456,11 +646,124 @@ class Port {
     }
   }
 
+  // Send a copy of [message] to the channel. Unlike [send], the message may
+  // refer to mutable objects. They are copied along with everything they
+  // refer to, keeping cycles and sharing intact, and the receiver gets the
+  // copies. Immutable objects are shared instead of copied. Messages that
+  // refer to mutable foreign memory or to objects with a finalizer cannot
+  // be copied and throw an ArgumentError. Not blocking.
+  @fletch.native void sendClone(message) {
+    switch (fletch.nativeError) {
+      case fletch.wrongArgumentType:
+        throw new ArgumentError();
+      case fletch.illegalState:
+        throw new StateError("Port is closed.");
+      default:
+        throw fletch.nativeError;
+    }
+  }
+
   @fletch.native void _sendExit(value) {
     throw new StateError("Port is closed.");
   }
 
+  // Contribute [value] as the value at [index] of a gather port. Each index
+  // takes one contribution. Not blocking.
+  @fletch.native void contribute(int index, value) {
+    switch (fletch.nativeError) {
+      case fletch.wrongArgumentType:
+        throw new ArgumentError();
+      case fletch.indexOutOfBounds:
+        throw new RangeError.value(index);
+      case fletch.illegalState:
+        throw new StateError("Not a gather port or already contributed.");
+      default:
+        throw fletch.nativeError;
+    }
+  }
+
+  // Send the message returned by [builder]. The immutable objects allocated
+  // by [builder] are kept in a private arena instead of the shared heap. If
+  // nothing but the message refers to them afterwards, they are handed to the
+  // receiver in one step. They then live in the heap of the receiver, so
+  // unlike with [send] the receiver gets them as mutable objects (see
+  // [isImmutable]), and has to use [sendClone] to pass them on. Otherwise
+  // this works like [send]. Not blocking.
+  void sendBuilt(builder()) {
+    _openMessageArena();
+    try {
+      _sendMessageArena(builder());
+    } finally {
+      // Sending closes the arena, so this only matters if [builder] throws.
+      _closeMessageArena();
+    }
+  }
+
+  @fletch.native void _sendMessageArena(message) {
+    switch (fletch.nativeError) {
+      case fletch.wrongArgumentType:
+        throw new ArgumentError();
+      case fletch.illegalState:
+        throw new StateError("Port is closed.");
+      default:
+        throw fletch.nativeError;
+    }
+  }
+
+  @fletch.native static void _openMessageArena() {
+    throw new StateError("Already building a message.");
+  }
+
+  @fletch.native static void _closeMessageArena() {
+    throw fletch.nativeError;
+  }
+
   @fletch.native external static Port _create(Channel channel);
+
+  @fletch.native static Port _createGather(Channel channel, int count) {
+    switch (fletch.nativeError) {
+      case fletch.wrongArgumentType:
+        throw new ArgumentError(count);
+      case fletch.indexOutOfBounds:
+        throw new RangeError.value(count);
+      default:
+        throw fletch.nativeError;
+    }
+  }
+}
+
+// A fixed group of ports that can all be sent the same immutable message in
+// one step. Port groups are immutable, so they can be sent to other
+// processes.
+class PortGroup {
+  final List<Port> ports;
+
+  const PortGroup._(this.ports);
+
+  factory PortGroup(Iterable<Port> ports) {
+    List<Port> list = new List<Port>.from(ports, growable: false);
+    for (var port in list) {
+      if (port is! Port) throw new ArgumentError(port);
+    }
+    return new PortGroup._(immutableList(list));
+  }
+
+  int get length => ports.length;
+
+  // Send [message] to all ports of the group. The message must be immutable
+  // and is shared by all receivers. Not blocking.
+  void broadcast(message) {
+    _broadcast(ports, message);
+  }
+
+  @fletch.native static void _broadcast(List<Port> ports, message) {
+    switch (fletch.nativeError) {
+      case fletch.wrongArgumentType:
+        throw new ArgumentError();
+      default:
+        throw fletch.nativeError;
+    }
+  }
 }
 
 class Channel {
@@ -530,6 +833,33 @@ class Channel {
   }
 }
 
+// An immutable list used to move the arguments and results of a chunk of
+// [Process.divide] between processes in a single message.
+class _DivideLink {
+  final value;
+  final _DivideLink next;
+  const _DivideLink(this.value, this.next);
+}
+
+class _DivideWork {
+  final int start;
+  final int count;
+  final _DivideLink arguments;
+  const _DivideWork(this.start, this.count, this.arguments);
+}
+
+class _DivideResult {
+  final Port worker;
+  final int start;
+  final int count;
+  final result;
+  final bool exited;
+  final error;
+  const _DivideResult(
+      this.worker, this.start, this.count, this.result, this.exited,
+      [this.error]);
+}
+
 class _ChannelEntry {
   final message;
   final Fiber sender;
@@ -541,6 +871,270 @@ bool isImmutable(Object object) => _isImmutable(object);
 
 @fletch.native external bool _isImmutable(String string);
 
+/// Returns a fixed-length, unmodifiable copy of [elements]. If all the
+/// elements are immutable, so is the copy (see [isImmutable]), and it can be
+/// shared with other processes without copying.
+List immutableList(List elements) {
+  return _splice(elements, elements.length, 0, null, false);
+}
+
+/// Returns an unmodifiable copy of [list] where `list[index]` is [value].
+List immutableListReplace(List list, int index, value) {
+  return _splice(list, index, 1, value, true);
+}
+
+/// Returns an unmodifiable copy of [list] with [value] inserted at [index].
+List immutableListInsert(List list, int index, value) {
+  return _splice(list, index, 0, value, true);
+}
+
+/// Returns an unmodifiable copy of [list] without the element at [index].
+List immutableListRemove(List list, int index) {
+  return _splice(list, index, 1, null, false);
+}
+
+List _splice(List list, int index, int deleteCount, value, bool insert) {
+  int length = list.length;
+  if (index < 0 || index > length || index + deleteCount > length) {
+    throw new RangeError.range(index, 0, length);
+  }
+  var store = fletch.fixedListBackingStore(list);
+  if (store != null) {
+    try {
+      return _immutableListSplice(store, index, deleteCount, value, insert);
+    } on ArgumentError {
+      // Not a list of objects, e.g., a constant byte list.
+    }
+  }
+  List copy = new List.from(list, growable: false);
+  store = fletch.fixedListBackingStore(copy);
+  return _immutableListSplice(store, index, deleteCount, value, insert);
+}
+
+@fletch.native List _immutableListSplice(store,
+                                         int index,
+                                         int deleteCount,
+                                         value,
+                                         bool insert) {
+  switch (fletch.nativeError) {
+    case fletch.wrongArgumentType:
+      throw new ArgumentError();
+    case fletch.indexOutOfBounds:
+      throw new RangeError.value(index);
+    default:
+      throw fletch.nativeError;
+  }
+}
+
+/// Returns an unmodifiable copy of [bytes], a list of integers from 0 to 255.
+/// The copy is immutable (see [isImmutable]), so it can be shared with other
+/// processes without copying.
+List<int> immutableByteList(List<int> bytes) {
+  var store = fletch.fixedListBackingStore(bytes);
+  if (store == null) {
+    // Not a fixed-length list. Copy it into one first.
+    bytes = new List<int>.from(bytes, growable: false);
+    store = fletch.fixedListBackingStore(bytes);
+  }
+  return _immutableByteList(bytes, store);
+}
+
+@fletch.native List<int> _immutableByteList(List<int> bytes, store) {
+  throw new ArgumentError(bytes);
+}
+
+/// Returns the number of one bits in the 64-bit two's complement
+/// representation of [value].
+int bitCount(int value) => _bitCount(value);
+
+@fletch.native int _bitCount(int value) {
+  throw new ArgumentError(value);
+}
+
+/// A histogram of latencies, or other non-negative integers, for measuring
+/// tail percentiles. Like HdrHistogram, the buckets grow with the values so
+/// that percentiles are within 1/64th (1.6%) of the recorded values, and
+/// recording a value does not allocate.
+class LatencyHistogram {
+  final List _counts;
+  // The array holding the elements of [_counts], for the natives.
+  final _buckets;
+  int _count = 0;
+  int _sum = 0;
+  int _minimum = 0;
+  int _maximum = 0;
+
+  LatencyHistogram() : this._(new List.filled(_bucketCount(), 0));
+
+  LatencyHistogram._(List counts)
+      : _counts = counts,
+        _buckets = fletch.fixedListBackingStore(counts);
+
+  /// The current time in microseconds, on a monotonic clock shared by all
+  /// processes. Used as the start of a latency passed to [recordSince].
+  static int get now => _now();
+
+  int get count => _count;
+  int get sum => _sum;
+  int get minimum => _minimum;
+  int get maximum => _maximum;
+  int get mean => _count == 0 ? 0 : _sum ~/ _count;
+
+  void record(int value) {
+    _record(_buckets, value);
+    if (_count == 0 || value < _minimum) _minimum = value;
+    if (value > _maximum) _maximum = value;
+    _count++;
+    _sum += value;
+  }
+
+  /// Records the microseconds elapsed since [start], a time returned by
+  /// [now]. Negative latencies, from a [start] in the future, are recorded
+  /// as zero.
+  void recordSince(int start) {
+    int elapsed = now - start;
+    record(elapsed < 0 ? 0 : elapsed);
+  }
+
+  /// Returns an upper bound of the value at [percentile] (0-100), clamped
+  /// to the largest recorded value.
+  int percentile(num percentile) {
+    int limit = _percentile(_buckets, percentile);
+    return limit < _maximum ? limit : _maximum;
+  }
+
+  void reset() {
+    for (int i = 0; i < _counts.length; i++) _counts[i] = 0;
+    _count = 0;
+    _sum = 0;
+    _minimum = 0;
+    _maximum = 0;
+  }
+
+  @fletch.native static int _now() {
+    throw fletch.nativeError;
+  }
+
+  @fletch.native static int _bucketCount() {
+    throw fletch.nativeError;
+  }
+
+  @fletch.native static void _record(buckets, int value) {
+    switch (fletch.nativeError) {
+      case fletch.wrongArgumentType:
+        throw new ArgumentError(value);
+      case fletch.indexOutOfBounds:
+        throw new StateError("Too many values in one bucket");
+      default:
+        throw fletch.nativeError;
+    }
+  }
+
+  @fletch.native static int _percentile(buckets, num percentile) {
+    switch (fletch.nativeError) {
+      case fletch.wrongArgumentType:
+        throw new ArgumentError(percentile);
+      case fletch.indexOutOfBounds:
+        throw new RangeError.range(percentile, 0, 100);
+      default:
+        throw fletch.nativeError;
+    }
+  }
+}
+
+/// A pool of byte buffers for I/O, such as the connection buffers of a
+/// server. The memory behind the buffers is cached by the VM and shared by
+/// all processes. Releasing a buffer keeps its memory for the next buffer of
+/// the same size acquired by any process, instead of freeing it, and so does
+/// collecting a buffer of a pooled size that was not released.
+///
+/// Buffers of [bufferSize] bytes are pooled, and so are the larger buffers
+/// that [acquire] returns when asked for more than [bufferSize] bytes, which
+/// are [bufferSize] times a power of two up to 64. At most
+/// [maxPooledBuffers] buffers of [bufferSize] bytes are kept, and
+/// proportionally fewer of the larger sizes.
+class BufferPool {
+  static const int _maxGrowthShift = 6;
+
+  final int bufferSize;
+  final int maxPooledBuffers;
+
+  BufferPool(int bufferSize, {int maxPooledBuffers: 64})
+      : this.bufferSize = bufferSize,
+        this.maxPooledBuffers = maxPooledBuffers {
+    _register(bufferSize, maxPooledBuffers);
+  }
+
+  /// Get a zero-initialized buffer of [bufferSize] bytes, or of at least
+  /// [minimumLength] bytes if that is larger, reusing the memory of a
+  /// released buffer if possible.
+  ByteBuffer acquire([int minimumLength]) {
+    int length = bufferSize;
+    if (minimumLength != null && minimumLength > length) {
+      int shift = 0;
+      while (length < minimumLength && shift < _maxGrowthShift) {
+        length *= 2;
+        shift++;
+      }
+      if (length < minimumLength) return new Uint8List(minimumLength).buffer;
+      int maxBuffers = maxPooledBuffers >> shift;
+      _register(length, maxBuffers > 0 ? maxBuffers : 1);
+    }
+    return new Uint8List(length).buffer;
+  }
+
+  /// Return [buffer] to the pool. Neither [buffer] nor the lists viewing it
+  /// may be used afterwards. Buffers of sizes that this pool does not hand
+  /// out are left to the garbage collector.
+  void release(ByteBuffer buffer) {
+    if (!_isPooledLength(buffer.lengthInBytes)) return;
+    var memory = buffer;
+    memory.getForeign().free();
+  }
+
+  /// The number of buffers of [bufferSize] bytes ready for reuse.
+  int get pooledBuffers => _pooledBuffers(bufferSize);
+
+  bool _isPooledLength(int length) {
+    for (int shift = 0; shift <= _maxGrowthShift; shift++) {
+      if (length == bufferSize << shift) return true;
+    }
+    return false;
+  }
+
+  @fletch.native static bool _register(int length, int maxBuffers) {
+    throw new ArgumentError();
+  }
+
+  @fletch.native static int _pooledBuffers(int length) {
+    throw new ArgumentError();
+  }
+}
+
+/// Returns the index of the first [byte] in the bytes from [start] to [end]
+/// of [buffer], or -1 if there is none. The VM searches the bytes, which is
+/// much faster than reading them one at a time through a typed data list.
+int indexOfByte(ByteBuffer buffer, int byte, int start, int end) {
+  int length = buffer.lengthInBytes;
+  if (start < 0 || start > length) {
+    throw new RangeError.range(start, 0, length);
+  }
+  if (end < start || end > length) {
+    throw new RangeError.range(end, start, length);
+  }
+  var memory = buffer;
+  return _indexOfByte(memory.getForeign().address, byte, start, end);
+}
+
+@fletch.native int _indexOfByte(int address, int byte, int start, int end) {
+  switch (fletch.nativeError) {
+    case fletch.wrongArgumentType:
+      throw new ArgumentError(byte);
+    default:
+      throw fletch.nativeError;
+  }
+}
+
 void eventHandlerAdd(Object id, Port port) {
   if (port is! Port) throw new ArgumentError(port);
   _eventHandlerAdd(id, port);
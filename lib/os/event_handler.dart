@@ -14,8 +14,31 @@ abstract class EventHandler {
   int removeFromEventHandler(int fd);
   int setPortForNextEvent(int fd, Port port, int mask);
 
-  static int eventHandler = _getEventHandler();
-  @fletch.native static int _getEventHandler() {
+  static int eventHandler = _getEventHandler(0);
+
+  // The VM can run several event handler threads, see the -Xevent_handlers
+  // flag. A file descriptor is assigned to one of them by hashing.
+  static final List<int> _eventHandlers = _createEventHandlerList();
+
+  /// The event handler that [fd] is assigned to.
+  static int eventHandlerFor(int fd) {
+    List<int> eventHandlers = _eventHandlers;
+    int length = eventHandlers.length;
+    if (length == 1) return eventHandlers[0];
+    return eventHandlers[fd % length];
+  }
+
+  static List<int> _createEventHandlerList() {
+    int count = _eventHandlerCount();
+    List<int> eventHandlers = new List<int>(count);
+    for (int i = 0; i < count; i++) eventHandlers[i] = _getEventHandler(i);
+    return eventHandlers;
+  }
+
+  @fletch.native static int _eventHandlerCount() {
+    throw new UnsupportedError('_eventHandlerCount');
+  }
+  @fletch.native static int _getEventHandler(int index) {
     throw new UnsupportedError('_getEventHandler');
   }
   @fletch.native static int _incrementPortRef(Port port) {
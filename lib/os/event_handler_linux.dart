@@ -54,14 +54,14 @@ class LinuxEventHandler extends EventHandler {
   int addToEventHandler(int fd) {
     _epollEvent.events = 0;
     _epollEvent.data = 0;
-    int eh = EventHandler.eventHandler;
+    int eh = EventHandler.eventHandlerFor(fd);
     return  _epollCtl.icall$4Retry(eh, EPOLL_CTL_ADD, fd, _epollEvent);
   }
 
   int removeFromEventHandler(int fd) {
     // TODO(ajohnsen): If we increased the refcount of the port before adding it
     // to the epoll set and we remove it now, we can leak memory.
-    int eh = EventHandler.eventHandler;
+    int eh = EventHandler.eventHandlerFor(fd);
     return _epollCtl.icall$4Retry(eh, EPOLL_CTL_DEL, fd, ForeignPointer.NULL);
   }
 
@@ -71,7 +71,7 @@ class LinuxEventHandler extends EventHandler {
     if ((mask & WRITE_EVENT) != 0) events |= EPOLLOUT;
     _epollEvent.events = events;
     _epollEvent.data = EventHandler._incrementPortRef(port);
-    int eh = EventHandler.eventHandler;
+    int eh = EventHandler.eventHandlerFor(fd);
     return _epollCtl.icall$4Retry(eh, EPOLL_CTL_MOD, fd, _epollEvent);
   }
 }
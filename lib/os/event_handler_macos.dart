@@ -61,8 +61,8 @@ class MacOSEventHandler extends EventHandler {
   ForeignFunction get _lseek => _lseekMac;
   ForeignFunction get _open => _openMac;
 
-  int _setEvents(bool read, bool write) {
-    int eh = EventHandler.eventHandler;
+  int _setEvents(int fd, bool read, bool write) {
+    int eh = EventHandler.eventHandlerFor(fd);
     int status = 0;
     if (read) {
       _kEvent.filter = EVFILT_READ;
@@ -90,6 +90,6 @@ class MacOSEventHandler extends EventHandler {
     _kEvent.ident = fd;
     _kEvent.flags = EV_ADD | EV_ONESHOT;
     _kEvent.udata = EventHandler._incrementPortRef(port);
-    return _setEvents((mask & READ_EVENT) != 0, (mask & WRITE_EVENT) != 0);
+    return _setEvents(fd, (mask & READ_EVENT) != 0, (mask & WRITE_EVENT) != 0);
   }
 }
@@ -9,6 +9,13 @@ List newList(int length) {
   return (length == null) ? new _GrowableList() : new _FixedList(length);
 }
 
+// Returns the array or byte array holding the elements of [list] if it is a
+// fixed-length or constant list, and null otherwise. Natives that read all
+// the elements of such a list take this instead of the list.
+fixedListBackingStore(List list) {
+  return (list is _FixedListBase) ? list._list : null;
+}
+
 abstract class _FixedListBase<E>
     extends Object with ListMixin<E>
     implements List<E> {
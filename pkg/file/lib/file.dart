@@ -25,6 +25,7 @@ library file;
 import 'dart:typed_data';
 
 import 'package:os/os.dart';
+import 'package:socket/socket.dart';
 
 class File {
   static const int READ       = 0;
@@ -32,6 +33,8 @@ class File {
   static const int APPEND     = 2;
   static const int WRITE_ONLY = 3;
 
+  static const int _COPY_BUFFER_SIZE = 64 * 1024;
+
   final String path;
   int _fd;
 
@@ -101,6 +104,57 @@ class File {
     return buffer;
   }
 
+  /**
+   * Write [length] bytes starting at [offset] in the file to [socket]. The
+   * bytes are copied by the kernel, so they never pass through user space.
+   * The file position is not changed.
+   */
+  void sendTo(Socket socket, int offset, int length) {
+    _checkRange(offset, length);
+    socket.sendFile(_fd, offset, length);
+  }
+
+  /**
+   * Copy [length] bytes starting at [offset] in the file to [destination]
+   * at [destinationOffset]. The copy is done inside the kernel where
+   * supported. The file positions are not changed.
+   */
+  void copyTo(File destination, int offset, int length,
+              [int destinationOffset = 0]) {
+    _checkRange(offset, length);
+    int end = offset + length;
+    while (offset < end) {
+      int copied = sys.copyFileRange(_fd, offset, destination._fd,
+                                     destinationOffset, end - offset);
+      if (copied <= 0) break;
+      offset += copied;
+      destinationOffset += copied;
+    }
+    if (offset == end) return;
+
+    // Fall back to copying through a buffer.
+    int current = position;
+    int destinationCurrent = destination.position;
+    position = offset;
+    destination.position = destinationOffset;
+    while (offset < end) {
+      int chunk = end - offset;
+      if (chunk > _COPY_BUFFER_SIZE) chunk = _COPY_BUFFER_SIZE;
+      ByteBuffer buffer = read(chunk);
+      if (buffer.lengthInBytes == 0) _error("Failed to copy file");
+      destination.write(buffer);
+      offset += buffer.lengthInBytes;
+    }
+    position = current;
+    destination.position = destinationCurrent;
+  }
+
+  void _checkRange(int offset, int length) {
+    if (offset < 0 || length < 0) {
+      throw new RangeError("Invalid range: $offset, $length");
+    }
+  }
+
   /**
    * Get the current position within the file.
    */
@@ -1050,7 +1050,10 @@ class FletchBackend extends Backend
     int arity = codegen.assembler.functionArity;
     if (name == "Port.send" ||
         name == "Port._sendList" ||
-        name == "Port._sendExit") {
+        name == "Port._sendExit" ||
+        name == "Port.sendClone" ||
+        name == "Port.contribute" ||
+        name == "Port._sendMessageArena") {
       codegen.assembler.invokeNativeYield(arity, descriptor.index);
     } else {
       codegen.assembler.invokeNative(arity, descriptor.index);
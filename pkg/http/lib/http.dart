@@ -2,15 +2,22 @@
 // for details. All rights reserved. Use of this source code is governed by a
 // BSD-style license that can be found in the LICENSE.md file.
 
-/// HTTP client. Only supported when Fletch is running on a Posix platform.
+/// HTTP client and server. Only supported when Fletch is running on a Posix
+/// platform.
 library http;
 
 import 'dart:collection';
+import 'dart:convert' show UTF8;
+import 'dart:fletch';
+import 'dart:fletch.ffi';
 import 'dart:typed_data';
 
 import 'package:charcode/ascii.dart';
+import 'package:os/os.dart' show sys;
 import 'package:socket/socket.dart';
 
+part 'http_server.dart';
+
 ByteBuffer stringToByteBuffer(String str) {
   Uint8List list = new Uint8List(str.length);
   for (int i = 0; i < list.length; i++) {
@@ -0,0 +1,713 @@
+// Copyright (c) 2015, the Fletch project authors. Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE.md file.
+
+part of http;
+
+/// Handles a single request. The handler is run in the worker processes of
+/// an [HttpServer] and must therefore be immutable, e.g., a top-level or
+/// static function.
+typedef void HttpHandler(HttpServerRequest request,
+                         HttpServerResponse response);
+
+const int _kConnectionBufferSize = 16 * 1024;
+const int _kDefaultMaxBodySize = 1024 * 1024;
+// Content-Length values with more digits are rejected before they can
+// overflow, whatever the maximum body size is.
+const int _kMaxContentLengthDigits = 15;
+const int _kMaxHeaders = 64;
+const int _kMaxPooledBuffers = 64;
+
+final BufferPool _buffers = new BufferPool(
+    _kConnectionBufferSize, maxPooledBuffers: _kMaxPooledBuffers);
+
+final ForeignFunction _memmove = ForeignLibrary.main.lookup("memmove");
+
+// Delimiters are located with indexOfByte, which searches the buffer in the
+// VM, instead of indexing the buffer one byte at a time in Dart. Returns -1
+// if [byte] is not found in [from, to).
+int _indexOf(ByteBuffer buffer, int from, int to, int byte) {
+  if (from >= to) return -1;
+  return indexOfByte(buffer, byte, from, to);
+}
+
+// Returns the end of the head starting at [from], just past the empty line
+// that ends it, or -1 if the head is not complete in [from, to). Lines end
+// in CRLF or in a bare LF.
+int _indexOfEndOfHead(Uint8List bytes, int from, int to) {
+  ByteBuffer buffer = bytes.buffer;
+  int lineEnd = _indexOf(buffer, from, to, $lf);
+  while (lineEnd >= 0) {
+    int next = lineEnd + 1;
+    if (next < to && bytes[next] == $lf) return next + 1;
+    if (next + 1 < to && bytes[next] == $cr && bytes[next + 1] == $lf) {
+      return next + 2;
+    }
+    lineEnd = _indexOf(buffer, next, to, $lf);
+  }
+  return -1;
+}
+
+String _defaultReasonPhrase(int statusCode) {
+  switch (statusCode) {
+    case 200: return "OK";
+    case 201: return "Created";
+    case 204: return "No Content";
+    case 301: return "Moved Permanently";
+    case 302: return "Found";
+    case 304: return "Not Modified";
+    case 400: return "Bad Request";
+    case 403: return "Forbidden";
+    case 404: return "Not Found";
+    case 405: return "Method Not Allowed";
+    case 413: return "Payload Too Large";
+    case 431: return "Request Header Fields Too Large";
+    case 500: return "Internal Server Error";
+    case 501: return "Not Implemented";
+    case 503: return "Service Unavailable";
+  }
+  return "Unknown";
+}
+
+/**
+ * An HTTP/1.1 server. Connections are accepted by the process calling
+ * [serve] and handed over to a pool of worker processes, each serving its
+ * connections on separate fibers. Persistent connections and pipelined
+ * requests are supported; request bodies must have a Content-Length.
+ *
+ * A [shared] server additionally lets every worker accept connections on
+ * its own SO_REUSEPORT listener, so accepting is not limited by a single
+ * process.
+ *
+ * Requests whose head is larger than [maxHeadSize] bytes are answered with
+ * 431 and requests whose Content-Length is larger than [maxBodySize] with
+ * 413, before any buffer is grown for them.
+ */
+class HttpServer {
+  final String _host;
+  final bool _shared;
+  final ServerSocket _socket;
+  final int maxHeadSize;
+  final int maxBodySize;
+  bool _closed = false;
+
+  /**
+   * Create a new server listening on '[host]:[port]'. If [port] is 0, a
+   * free port is picked.
+   */
+  HttpServer(String host,
+             int port,
+             {bool shared: false,
+              this.maxHeadSize: _kConnectionBufferSize,
+              this.maxBodySize: _kDefaultMaxBodySize})
+      : _host = host,
+        _shared = shared,
+        _socket = new ServerSocket(host, port, shared: shared) {
+    if (maxHeadSize < 1) {
+      throw new ArgumentError("The maximum head size must be positive");
+    }
+    if (maxBodySize < 0) {
+      throw new ArgumentError("The maximum body size must not be negative");
+    }
+  }
+
+  int get port => _socket.port;
+
+  /**
+   * Serve requests with [handler] on [workers] worker processes until the
+   * server is closed. Blocks the calling fiber.
+   */
+  void serve(HttpHandler handler, {int workers: 4}) {
+    if (workers < 1) {
+      throw new ArgumentError("The number of workers must be positive");
+    }
+    Channel channel = new Channel();
+    Port port = new Port(channel);
+    String host = _shared ? _host : null;
+    int listenPort = this.port;
+    int maxHead = maxHeadSize;
+    int maxBody = maxBodySize;
+    List<Port> ports = new List<Port>(workers);
+    for (int i = 0; i < workers; i++) {
+      Process.spawnDetached(
+          () => _worker(handler, maxHead, maxBody, port, host, listenPort));
+      ports[i] = channel.receive();
+    }
+
+    try {
+      int next = 0;
+      while (true) {
+        int fd;
+        try {
+          fd = _socket.acceptFd();
+        } on SocketException catch (_) {
+          if (_closed) break;
+          rethrow;
+        }
+        ports[next].send(fd);
+        if (++next == workers) next = 0;
+      }
+    } finally {
+      for (int i = 0; i < workers; i++) ports[i].send(null);
+    }
+  }
+
+  /**
+   * Stop accepting connections. Connections already handed to a worker are
+   * served until they are closed.
+   */
+  void close() {
+    _closed = true;
+    _socket.close();
+  }
+
+  // Serves connections handed over through [port] and, if [host] is not
+  // null, connections accepted on a shared listener of its own.
+  static void _worker(HttpHandler handler,
+                      int maxHeadSize,
+                      int maxBodySize,
+                      Port port,
+                      String host,
+                      int listenPort) {
+    Channel channel = new Channel();
+    ServerSocket listener;
+    if (host != null) {
+      listener = new ServerSocket(host, listenPort, shared: true);
+      Fiber.fork(() => _acceptConnections(
+          listener, handler, maxHeadSize, maxBodySize));
+    }
+    port.send(new Port(channel));
+    while (true) {
+      int fd = channel.receive();
+      if (fd == null) break;
+      _serveConnection(fd, handler, maxHeadSize, maxBodySize);
+    }
+    if (listener != null) listener.close();
+  }
+
+  static void _acceptConnections(ServerSocket listener,
+                                 HttpHandler handler,
+                                 int maxHeadSize,
+                                 int maxBodySize) {
+    while (true) {
+      int fd;
+      try {
+        fd = listener.acceptFd();
+      } on SocketException catch (_) {
+        // The listener was closed.
+        return;
+      }
+      _serveConnection(fd, handler, maxHeadSize, maxBodySize);
+    }
+  }
+
+  static void _serveConnection(int fd,
+                               HttpHandler handler,
+                               int maxHeadSize,
+                               int maxBodySize) {
+    Fiber.fork(() {
+      Socket socket = new Socket.fromFd(fd);
+      new _HttpServerConnection(socket, handler, maxHeadSize, maxBodySize)
+          .run();
+    });
+  }
+}
+
+/**
+ * A request received by an [HttpServer]. The request refers directly to the
+ * connection buffer and is only valid while the handler is running.
+ */
+class HttpServerRequest {
+  final _HttpServerConnection _connection;
+  final _RequestHead _head;
+  String _method;
+  String _path;
+
+  HttpServerRequest._(this._connection, this._head);
+
+  String get method {
+    if (_method == null) {
+      _method = _connection._string(_head.methodStart, _head.methodEnd);
+    }
+    return _method;
+  }
+
+  /// The request target as sent by the client, e.g., '/index.html?a=b'.
+  String get path {
+    if (_path == null) {
+      _path = _connection._string(_head.targetStart, _head.targetEnd);
+    }
+    return _path;
+  }
+
+  String get protocolVersion => "1.${_head.minorVersion}";
+
+  /// Whether the connection is kept open after this request.
+  bool get persistentConnection => _head.keepAlive;
+
+  /// The value of the header [name], matched case-insensitively, or `null`.
+  String header(String name) {
+    String lowerCaseName = name.toLowerCase();
+    for (int i = 0; i < _head.headerCount; i++) {
+      if (_connection._nameEquals(_head, i, lowerCaseName)) {
+        return _connection._string(_head.valueStart(i), _head.valueEnd(i));
+      }
+    }
+    return null;
+  }
+
+  /// The body of the request. It is a view of the connection's buffer and
+  /// must not be used after the handler returns.
+  Uint8List get body {
+    int start = _head.headEnd;
+    int length = _head.contentLength;
+    return new Uint8List.view(_connection._in.buffer,
+                              _connection._start + start,
+                              length);
+  }
+}
+
+/**
+ * The response to an [HttpServerRequest]. The body is buffered and sent
+ * with a Content-Length when the handler returns.
+ */
+class HttpServerResponse {
+  int statusCode = 200;
+  String reasonPhrase;
+  final HttpHeaders headers = new HttpHeaders();
+  // Each chunk is either a List<int> to copy or a [_BufferChunk].
+  final List _chunks = [];
+  int _length = 0;
+  int _copiedLength = 0;
+
+  HttpServerResponse._();
+
+  void write(String data) {
+    writeBytes(UTF8.encode(data));
+  }
+
+  void writeBytes(List<int> data) {
+    _chunks.add(data);
+    _length += data.length;
+    _copiedLength += data.length;
+  }
+
+  /**
+   * Add the first [length] bytes of [buffer] to the body without copying
+   * them. The bytes are written straight from [buffer] to the socket, so it
+   * must not be modified afterwards.
+   */
+  void writeBuffer(ByteBuffer buffer, [int length]) {
+    if (length == null) length = buffer.lengthInBytes;
+    if (length < 0 || length > buffer.lengthInBytes) {
+      throw new RangeError.range(length, 0, buffer.lengthInBytes);
+    }
+    _chunks.add(new _BufferChunk(buffer, length));
+    _length += length;
+  }
+}
+
+class _BufferChunk {
+  final ByteBuffer buffer;
+  final int length;
+  _BufferChunk(this.buffer, this.length);
+}
+
+// The parsed head of a request. Instead of creating strings, the request
+// line and header fields are recorded as offsets relative to the start of
+// the request in the connection buffer.
+class _RequestHead {
+  int methodStart;
+  int methodEnd;
+  int targetStart;
+  int targetEnd;
+  int minorVersion;
+  int headEnd;
+  int headerCount;
+  int contentLength;
+  bool keepAlive;
+  bool chunked;
+  // Name start, name end, value start and value end for each header.
+  final List<int> headerOffsets = new List<int>(4 * _kMaxHeaders);
+
+  int nameStart(int index) => headerOffsets[4 * index];
+  int nameEnd(int index) => headerOffsets[4 * index + 1];
+  int valueStart(int index) => headerOffsets[4 * index + 2];
+  int valueEnd(int index) => headerOffsets[4 * index + 3];
+}
+
+class _HttpServerConnection {
+  final Socket _socket;
+  final HttpHandler _handler;
+  final int _maxHeadSize;
+  final int _maxBodySize;
+  final _RequestHead _head = new _RequestHead();
+
+  // Received bytes. Unprocessed data is in [_start, _end).
+  Uint8List _in;
+  int _inAddress;
+  int _start = 0;
+  int _end = 0;
+
+  // Responses not yet written to the socket are the [_segments] followed by
+  // [0, _outLength) of [_out]. Full output buffers among the segments are
+  // returned to the pool once written.
+  Uint8List _out;
+  int _outLength = 0;
+  final List<ByteBuffer> _segments = <ByteBuffer>[];
+  final List<int> _segmentLengths = <int>[];
+  final List<ByteBuffer> _sealed = <ByteBuffer>[];
+
+  _HttpServerConnection(this._socket,
+                        this._handler,
+                        this._maxHeadSize,
+                        this._maxBodySize);
+
+  void run() {
+    _setInput(new Uint8List.view(_buffers.acquire()));
+    _out = new Uint8List.view(_buffers.acquire());
+    try {
+      while (_serveRequest());
+      _flush();
+    } on SocketException catch (_) {
+      // The peer went away.
+    } finally {
+      _socket.close();
+      _buffers.release(_in.buffer);
+      _buffers.release(_out.buffer);
+    }
+  }
+
+  // Serves the next request. Returns false if the connection should be
+  // closed.
+  bool _serveRequest() {
+    int maxHeadSize = _maxHeadSize;
+    int endOfHead;
+    while (true) {
+      endOfHead = _indexOfEndOfHead(_in, _start, _end);
+      if (endOfHead >= 0) break;
+      int received = _end - _start;
+      if (received >= maxHeadSize) {
+        _sendError(431);
+        return false;
+      }
+      if (_start == 0 && _end == _in.length) {
+        // Make room for the rest of the head, but not more than it can take.
+        int capacity = 2 * _in.length;
+        _grow(capacity < maxHeadSize ? capacity : maxHeadSize);
+      }
+      if (!_receive()) return false;
+    }
+    if (endOfHead - _start > maxHeadSize) {
+      _sendError(431);
+      return false;
+    }
+
+    int status = _parseHead(endOfHead);
+    if (status != 0) {
+      _sendError(status);
+      return false;
+    }
+
+    // Both lengths are within the limits, so a client cannot make the buffer
+    // grow beyond them.
+    int requestLength = _head.headEnd + _head.contentLength;
+    if (requestLength > _in.length) _grow(requestLength);
+    while (_end - _start < requestLength) {
+      if (!_receive()) return false;
+    }
+
+    HttpServerRequest request = new HttpServerRequest._(this, _head);
+    HttpServerResponse response = new HttpServerResponse._();
+    try {
+      _handler(request, response);
+    } catch (e) {
+      response = new HttpServerResponse._();
+      response.statusCode = 500;
+    }
+    _start += requestLength;
+    _appendResponse(response, _head.keepAlive, _head.minorVersion);
+    return _head.keepAlive;
+  }
+
+  // Reads more data. Responses to earlier, pipelined requests are flushed
+  // before blocking. Returns false if the peer closed the connection.
+  bool _receive() {
+    _flush();
+    if (_end == _in.length) {
+      int length = _end - _start;
+      _memmove.icall$3(_inAddress, _inAddress + _start, length);
+      _start = 0;
+      _end = length;
+    }
+    int read = _socket.readInto(_in.buffer, _end, _in.length - _end);
+    if (read == 0) return false;
+    _end += read;
+    return true;
+  }
+
+  void _grow(int capacity) {
+    Uint8List buffer = new Uint8List.view(_buffers.acquire(capacity));
+    sys.memcpy(buffer.buffer, 0, _in.buffer, _start, _end - _start);
+    _buffers.release(_in.buffer);
+    _setInput(buffer);
+    _end -= _start;
+    _start = 0;
+  }
+
+  void _setInput(Uint8List buffer) {
+    _in = buffer;
+    _inAddress = sys.getForeign(buffer.buffer).address;
+  }
+
+  // Returns 0 if the head in [_start, _start + headEnd) was parsed, and
+  // otherwise the status code of the error response.
+  int _parseHead(int headEnd) {
+    _RequestHead head = _head;
+    Uint8List bytes = _in;
+    ByteBuffer buffer = bytes.buffer;
+    int base = _start;
+    head.headEnd = headEnd - base;
+    head.headerCount = 0;
+    head.contentLength = 0;
+    head.chunked = false;
+
+    // Request line: method SP target SP 'HTTP/1.' digit CRLF. Here and
+    // below, a bare LF is accepted as the end of a line as well.
+    int lineEnd = _indexOf(buffer, base, headEnd, $lf);
+    int contentEnd = _lineContentEnd(base, lineEnd);
+    int space = _indexOf(buffer, base, contentEnd, $space);
+    if (space <= base) return 400;
+    head.methodStart = 0;
+    head.methodEnd = space - base;
+    int targetStart = space + 1;
+    space = _indexOf(buffer, targetStart, contentEnd, $space);
+    if (space <= targetStart) return 400;
+    head.targetStart = targetStart - base;
+    head.targetEnd = space - base;
+    int version = space + 1;
+    if (contentEnd - version != 8 ||
+        bytes[version] != $H ||
+        bytes[version + 1] != $T ||
+        bytes[version + 2] != $T ||
+        bytes[version + 3] != $P ||
+        bytes[version + 4] != $slash ||
+        bytes[version + 5] != $1 ||
+        bytes[version + 6] != $dot) {
+      return 400;
+    }
+    int minor = bytes[version + 7] - $0;
+    if (minor != 0 && minor != 1) return 400;
+    head.minorVersion = minor;
+    bool keepAlive = minor == 1;
+
+    // Header fields: name ':' OWS value OWS CRLF, up to the empty line.
+    int lineStart = lineEnd + 1;
+    while (true) {
+      lineEnd = _indexOf(buffer, lineStart, headEnd, $lf);
+      contentEnd = _lineContentEnd(lineStart, lineEnd);
+      if (contentEnd == lineStart) break;
+      int colon = _indexOf(buffer, lineStart, contentEnd, $colon);
+      if (colon <= lineStart) return 400;
+      int index = head.headerCount;
+      if (index == _kMaxHeaders) return 431;
+      int valueStart = colon + 1;
+      int valueEnd = contentEnd;
+      while (valueStart < valueEnd && _isWhitespace(bytes[valueStart])) {
+        valueStart++;
+      }
+      while (valueEnd > valueStart && _isWhitespace(bytes[valueEnd - 1])) {
+        valueEnd--;
+      }
+      List<int> offsets = head.headerOffsets;
+      offsets[4 * index] = lineStart - base;
+      offsets[4 * index + 1] = colon - base;
+      offsets[4 * index + 2] = valueStart - base;
+      offsets[4 * index + 3] = valueEnd - base;
+      head.headerCount = index + 1;
+
+      if (_nameEquals(head, index, "content-length")) {
+        int length = _parseDecimal(valueStart, valueEnd);
+        if (length < 0) return 400;
+        if (length > _maxBodySize) return 413;
+        head.contentLength = length;
+      } else if (_nameEquals(head, index, "connection")) {
+        if (_valueEquals(head, index, "close")) {
+          keepAlive = false;
+        } else if (_valueEquals(head, index, "keep-alive")) {
+          keepAlive = true;
+        }
+      } else if (_nameEquals(head, index, "transfer-encoding")) {
+        // Any coding other than identity ends in chunked for a request, and
+        // chunked bodies are not supported.
+        if (!_valueEquals(head, index, "identity")) head.chunked = true;
+      }
+      lineStart = lineEnd + 1;
+    }
+    head.keepAlive = keepAlive;
+
+    if (head.chunked) return 501;
+    return 0;
+  }
+
+  // Returns the end of the line in [lineStart, lineEnd] without the CR
+  // before the LF at [lineEnd], if there is one.
+  int _lineContentEnd(int lineStart, int lineEnd) {
+    if (lineEnd > lineStart && _in[lineEnd - 1] == $cr) return lineEnd - 1;
+    return lineEnd;
+  }
+
+  static bool _isWhitespace(int char) => char == $space || char == $tab;
+
+  // Returns the non-negative integer in [start, end), or -1 if it is not
+  // one or has more than [_kMaxContentLengthDigits] digits.
+  int _parseDecimal(int start, int end) {
+    if (start == end || end - start > _kMaxContentLengthDigits) return -1;
+    int value = 0;
+    for (int i = start; i < end; i++) {
+      int digit = _in[i] - $0;
+      if (digit < 0 || digit > 9) return -1;
+      value = value * 10 + digit;
+    }
+    return value;
+  }
+
+  bool _nameEquals(_RequestHead head, int index, String lowerCaseName) {
+    return _equalsIgnoreCase(_start + head.nameStart(index),
+                             _start + head.nameEnd(index),
+                             lowerCaseName);
+  }
+
+  bool _valueEquals(_RequestHead head, int index, String lowerCaseValue) {
+    return _equalsIgnoreCase(_start + head.valueStart(index),
+                             _start + head.valueEnd(index),
+                             lowerCaseValue);
+  }
+
+  bool _equalsIgnoreCase(int start, int end, String lowerCase) {
+    int length = lowerCase.length;
+    if (end - start != length) return false;
+    Uint8List bytes = _in;
+    for (int i = 0; i < length; i++) {
+      int char = bytes[start + i];
+      if (char >= $A && char <= $Z) char += $a - $A;
+      if (char != lowerCase.codeUnitAt(i)) return false;
+    }
+    return true;
+  }
+
+  String _string(int start, int end) {
+    return new String.fromCharCodes(_in, _start + start, _start + end);
+  }
+
+  void _sendError(int statusCode) {
+    HttpServerResponse response = new HttpServerResponse._();
+    response.statusCode = statusCode;
+    _appendResponse(response, false, 1);
+    _flush();
+  }
+
+  void _appendResponse(HttpServerResponse response,
+                       bool keepAlive,
+                       int minorVersion) {
+    StringBuffer head = new StringBuffer();
+    head.write("HTTP/1.1 ");
+    head.write(response.statusCode);
+    head.write(" ");
+    String reasonPhrase = response.reasonPhrase;
+    if (reasonPhrase == null) {
+      reasonPhrase = _defaultReasonPhrase(response.statusCode);
+    }
+    head.write(reasonPhrase);
+    head.write("\r\n");
+    head.write(response.headers);
+    head.write("Content-Length: ");
+    head.write(response._length);
+    head.write("\r\n");
+    if (!keepAlive) {
+      head.write("Connection: close\r\n");
+    } else if (minorVersion == 0) {
+      head.write("Connection: keep-alive\r\n");
+    }
+    head.write("\r\n");
+
+    _appendHead(head.toString(), response._copiedLength);
+    List chunks = response._chunks;
+    for (int i = 0; i < chunks.length; i++) {
+      var chunk = chunks[i];
+      if (chunk is _BufferChunk) {
+        _appendSegment(chunk.buffer, chunk.length);
+      } else {
+        _out.setRange(_outLength, _outLength + chunk.length, chunk);
+        _outLength += chunk.length;
+      }
+    }
+  }
+
+  // Copies [head] to the output, reserving room for [bodyLength] more bytes.
+  // Heads are almost always ASCII, which is copied as is. Anything else in
+  // the reason phrase or the headers is encoded as UTF-8.
+  void _appendHead(String head, int bodyLength) {
+    int length = head.length;
+    for (int i = 0; i < length; i++) {
+      if (head.codeUnitAt(i) >= 0x80) {
+        List<int> bytes = UTF8.encode(head);
+        _reserveOutput(bytes.length + bodyLength);
+        _out.setRange(_outLength, _outLength + bytes.length, bytes);
+        _outLength += bytes.length;
+        return;
+      }
+    }
+    _reserveOutput(length + bodyLength);
+    for (int i = 0; i < length; i++) {
+      _out[_outLength++] = head.codeUnitAt(i);
+    }
+  }
+
+  // Queues [length] bytes of [buffer] for writing after the buffered output
+  // without copying them. The buffered output is sealed as a segment of its
+  // own and a fresh output buffer takes its place.
+  void _appendSegment(ByteBuffer buffer, int length) {
+    if (length == 0) return;
+    if (_outLength > 0) {
+      ByteBuffer sealed = _out.buffer;
+      _segments.add(sealed);
+      _segmentLengths.add(_outLength);
+      _sealed.add(sealed);
+      _out = new Uint8List.view(_buffers.acquire());
+      _outLength = 0;
+    }
+    _segments.add(buffer);
+    _segmentLengths.add(length);
+  }
+
+  void _reserveOutput(int length) {
+    if (_outLength + length <= _out.length) return;
+    _flush();
+    if (length > _out.length) {
+      _buffers.release(_out.buffer);
+      _out = new Uint8List.view(_buffers.acquire(length));
+    }
+  }
+
+  // Writes all pending output, gathering the segments and the buffered
+  // output in as few system calls as possible.
+  void _flush() {
+    if (_segments.isEmpty) {
+      if (_outLength == 0) return;
+      _socket.write(_out.buffer, 0, _outLength);
+      _outLength = 0;
+      return;
+    }
+    if (_outLength > 0) {
+      _segments.add(_out.buffer);
+      _segmentLengths.add(_outLength);
+    }
+    _socket.writeBuffers(_segments, _segmentLengths);
+    _segments.clear();
+    _segmentLengths.clear();
+    _outLength = 0;
+    for (int i = 0; i < _sealed.length; i++) _buffers.release(_sealed[i]);
+    _sealed.clear();
+  }
+}
@@ -0,0 +1,18 @@
+// Copyright (c) 2015, the Fletch project authors. Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE.md file.
+
+/// Persistent maps, sets and vectors based on hash array mapped tries.
+///
+/// Updating a collection returns a new collection sharing all unchanged
+/// nodes with the old one. The nodes are immutable (see `isImmutable` in
+/// `dart:fletch`) if the keys and values are, so the collections can be sent
+/// to other processes without copying. Builders apply a batch of updates
+/// without creating intermediate collections.
+library immutable.persistent;
+
+import 'dart:fletch';
+
+part 'src/persistent_map.dart';
+part 'src/persistent_set.dart';
+part 'src/persistent_vector.dart';
@@ -0,0 +1,397 @@
+// Copyright (c) 2015, the Fletch project authors. Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE.md file.
+
+part of immutable.persistent;
+
+// Each level of the trie consumes 5 bits of the hash code. Hash codes are
+// truncated to 30 bits, so there are at most 6 levels of bitmap nodes.
+// Entries with equal truncated hash codes share a collision node.
+const int _kBits = 5;
+const int _kWidth = 1 << _kBits;
+const int _kMask = _kWidth - 1;
+const int _kHashMask = 0x3fffffff;
+
+int _hash(key) => key.hashCode & _kHashMask;
+
+int _bitFor(int hash, int shift) => 1 << ((hash >> shift) & _kMask);
+
+// The slots of a node only exist for the bits set in its bitmap, so the
+// slot for a bit is found by counting the bits below it.
+int _slotFor(int bitmap, int bit) => bitCount(bitmap & (bit - 1));
+
+class PersistentMap<K, V> {
+  final _TrieNode _root;
+  final int length;
+
+  const PersistentMap._(this._root, this.length);
+
+  factory PersistentMap() => new PersistentMap<K, V>._(null, 0);
+
+  factory PersistentMap.fromMap(Map<K, V> map) {
+    PersistentMapBuilder<K, V> builder = new PersistentMapBuilder<K, V>();
+    map.forEach((K key, V value) {
+      builder[key] = value;
+    });
+    return builder.build();
+  }
+
+  bool get isEmpty => length == 0;
+
+  V operator [](K key) {
+    if (_root == null) return null;
+    _Entry entry = _root.lookup(_hash(key), key, 0);
+    return (entry == null) ? null : entry.value;
+  }
+
+  bool containsKey(K key) {
+    return _root != null && _root.lookup(_hash(key), key, 0) != null;
+  }
+
+  /// Returns a map where [key] is associated with [value].
+  PersistentMap<K, V> put(K key, V value) {
+    _Entry entry = new _Entry(_hash(key), key, value);
+    if (_root == null) {
+      return new PersistentMap<K, V>._(new _BitmapNode.single(entry), 1);
+    }
+    _Change change = new _Change();
+    _TrieNode root = _root.insert(entry, 0, change);
+    if (identical(root, _root)) return this;
+    return new PersistentMap<K, V>._(root, length + change.lengthDelta);
+  }
+
+  /// Returns a map without [key].
+  PersistentMap<K, V> remove(K key) {
+    if (_root == null) return this;
+    _Change change = new _Change();
+    _TrieNode root = _root.remove(_hash(key), key, 0, change);
+    if (identical(root, _root)) return this;
+    return new PersistentMap<K, V>._(root, length + change.lengthDelta);
+  }
+
+  void forEach(void f(K key, V value)) {
+    if (_root != null) _root.forEach(f);
+  }
+
+  Iterable<K> get keys {
+    List<K> result = new List<K>();
+    forEach((K key, V value) => result.add(key));
+    return result;
+  }
+
+  PersistentMapBuilder<K, V> toBuilder() {
+    return new PersistentMapBuilder<K, V>(this);
+  }
+}
+
+/**
+ * Applies a batch of updates to a [PersistentMap]. The nodes copied by the
+ * first update of a path are updated in place by the following ones, and
+ * only turned into immutable nodes by [build].
+ */
+class PersistentMapBuilder<K, V> {
+  _TrieNode _root;
+  int _length;
+
+  PersistentMapBuilder([PersistentMap<K, V> map]) {
+    _root = (map == null) ? null : map._root;
+    _length = (map == null) ? 0 : map.length;
+  }
+
+  int get length => _length;
+
+  V operator [](K key) {
+    if (_root == null) return null;
+    _Entry entry = _root.lookup(_hash(key), key, 0);
+    return (entry == null) ? null : entry.value;
+  }
+
+  void operator []=(K key, V value) {
+    _Entry entry = new _Entry(_hash(key), key, value);
+    _EditableNode root = (_root == null)
+        ? new _EditableNode(0, new List())
+        : _EditableNode.edit(_root);
+    _root = root;
+    _Change change = new _Change();
+    root.insertInPlace(entry, 0, change);
+    _length += change.lengthDelta;
+  }
+
+  void remove(K key) {
+    int hash = _hash(key);
+    if (_root == null || _root.lookup(hash, key, 0) == null) return;
+    _EditableNode root = _EditableNode.edit(_root);
+    _Change change = new _Change();
+    _root = root.removeInPlace(hash, key, 0, change) ? null : root;
+    _length += change.lengthDelta;
+  }
+
+  /// Returns a map with the updates so far. The builder can still be used.
+  PersistentMap<K, V> build() {
+    if (_root != null) _root = _root.freeze();
+    return new PersistentMap<K, V>._(_root, _length);
+  }
+}
+
+class _Change {
+  int lengthDelta = 0;
+}
+
+class _Entry {
+  final int hash;
+  final key;
+  final value;
+
+  const _Entry(this.hash, this.key, this.value);
+
+  bool matches(int hash, key) => this.hash == hash && this.key == key;
+}
+
+abstract class _TrieNode {
+  const _TrieNode();
+
+  _Entry lookup(int hash, key, int shift);
+
+  // Returns a node with [entry] added, or this node if nothing changed.
+  _TrieNode insert(_Entry entry, int shift, _Change change);
+
+  // Returns a node without the entry for [key], null if that leaves the node
+  // empty, or this node if there is no such entry.
+  _TrieNode remove(int hash, key, int shift, _Change change);
+
+  void forEach(void f(key, value));
+
+  _TrieNode freeze() => this;
+}
+
+// Returns the contents of a slot holding [existing] after adding [entry].
+_insertIntoEntry(_Entry existing, _Entry entry, int shift, _Change change) {
+  if (existing.matches(entry.hash, entry.key)) {
+    return identical(existing.value, entry.value) ? existing : entry;
+  }
+  change.lengthDelta++;
+  return _pair(existing, entry, shift + _kBits);
+}
+
+// Creates the subtrie holding the entries [a] and [b] at [shift].
+_TrieNode _pair(_Entry a, _Entry b, int shift) {
+  if (a.hash == b.hash) {
+    return new _CollisionNode(a.hash, immutableList([a, b]));
+  }
+  int bitA = _bitFor(a.hash, shift);
+  int bitB = _bitFor(b.hash, shift);
+  if (bitA == bitB) {
+    return new _BitmapNode(bitA, immutableList([_pair(a, b, shift + _kBits)]));
+  }
+  List slots = (bitA < bitB) ? [a, b] : [b, a];
+  return new _BitmapNode(bitA | bitB, immutableList(slots));
+}
+
+_Entry _lookupSlots(int bitmap, List slots, int hash, key, int shift) {
+  int bit = _bitFor(hash, shift);
+  if ((bitmap & bit) == 0) return null;
+  var slot = slots[_slotFor(bitmap, bit)];
+  if (slot is _Entry) return slot.matches(hash, key) ? slot : null;
+  return slot.lookup(hash, key, shift + _kBits);
+}
+
+void _forEachSlot(List slots, void f(key, value)) {
+  for (int i = 0; i < slots.length; i++) {
+    var slot = slots[i];
+    if (slot is _Entry) {
+      f(slot.key, slot.value);
+    } else {
+      slot.forEach(f);
+    }
+  }
+}
+
+// A node with a slot for each bit set in [bitmap]. A slot holds either an
+// [_Entry] or the node for the next 5 bits of the hash codes.
+class _BitmapNode extends _TrieNode {
+  final int bitmap;
+  final List slots;
+
+  const _BitmapNode(this.bitmap, this.slots);
+
+  factory _BitmapNode.single(_Entry entry) {
+    return new _BitmapNode(_bitFor(entry.hash, 0), immutableList([entry]));
+  }
+
+  _Entry lookup(int hash, key, int shift) {
+    return _lookupSlots(bitmap, slots, hash, key, shift);
+  }
+
+  _TrieNode insert(_Entry entry, int shift, _Change change) {
+    int bit = _bitFor(entry.hash, shift);
+    int index = _slotFor(bitmap, bit);
+    if ((bitmap & bit) == 0) {
+      change.lengthDelta++;
+      return new _BitmapNode(bitmap | bit,
+                             immutableListInsert(slots, index, entry));
+    }
+    var slot = slots[index];
+    var updated = (slot is _Entry)
+        ? _insertIntoEntry(slot, entry, shift, change)
+        : slot.insert(entry, shift + _kBits, change);
+    if (identical(updated, slot)) return this;
+    return new _BitmapNode(bitmap, immutableListReplace(slots, index, updated));
+  }
+
+  _TrieNode remove(int hash, key, int shift, _Change change) {
+    int bit = _bitFor(hash, shift);
+    if ((bitmap & bit) == 0) return this;
+    int index = _slotFor(bitmap, bit);
+    var slot = slots[index];
+    var updated;
+    if (slot is _Entry) {
+      if (!slot.matches(hash, key)) return this;
+      change.lengthDelta--;
+    } else {
+      updated = slot.remove(hash, key, shift + _kBits, change);
+      if (identical(updated, slot)) return this;
+    }
+    if (updated != null) {
+      return new _BitmapNode(bitmap,
+                             immutableListReplace(slots, index, updated));
+    }
+    if (bitmap == bit) return null;
+    return new _BitmapNode(bitmap ^ bit, immutableListRemove(slots, index));
+  }
+
+  void forEach(void f(key, value)) => _forEachSlot(slots, f);
+}
+
+// The entries whose truncated hash codes are all [hash].
+class _CollisionNode extends _TrieNode {
+  final int hash;
+  final List entries;
+
+  const _CollisionNode(this.hash, this.entries);
+
+  int _indexOf(key) {
+    for (int i = 0; i < entries.length; i++) {
+      if (entries[i].key == key) return i;
+    }
+    return -1;
+  }
+
+  _Entry lookup(int hash, key, int shift) {
+    if (hash != this.hash) return null;
+    int index = _indexOf(key);
+    return (index < 0) ? null : entries[index];
+  }
+
+  _TrieNode insert(_Entry entry, int shift, _Change change) {
+    if (entry.hash != hash) {
+      // Push this node one level down to tell the hash codes apart.
+      _BitmapNode parent =
+          new _BitmapNode(_bitFor(hash, shift), immutableList([this]));
+      return parent.insert(entry, shift, change);
+    }
+    int index = _indexOf(entry.key);
+    if (index < 0) {
+      change.lengthDelta++;
+      return new _CollisionNode(
+          hash, immutableListInsert(entries, entries.length, entry));
+    }
+    if (identical(entries[index].value, entry.value)) return this;
+    return new _CollisionNode(hash,
+                              immutableListReplace(entries, index, entry));
+  }
+
+  _TrieNode remove(int hash, key, int shift, _Change change) {
+    if (hash != this.hash) return this;
+    int index = _indexOf(key);
+    if (index < 0) return this;
+    change.lengthDelta--;
+    if (entries.length == 1) return null;
+    return new _CollisionNode(hash, immutableListRemove(entries, index));
+  }
+
+  void forEach(void f(key, value)) => _forEachSlot(entries, f);
+}
+
+// A mutable copy of a [_BitmapNode] owned by a [PersistentMapBuilder].
+class _EditableNode extends _TrieNode {
+  int bitmap;
+  final List slots;
+
+  _EditableNode(this.bitmap, this.slots);
+
+  static _EditableNode edit(_TrieNode node) {
+    if (node is _EditableNode) return node;
+    _BitmapNode original = node;
+    return new _EditableNode(original.bitmap, new List.from(original.slots));
+  }
+
+  _Entry lookup(int hash, key, int shift) {
+    return _lookupSlots(bitmap, slots, hash, key, shift);
+  }
+
+  _TrieNode insert(_Entry entry, int shift, _Change change) {
+    return freeze().insert(entry, shift, change);
+  }
+
+  _TrieNode remove(int hash, key, int shift, _Change change) {
+    return freeze().remove(hash, key, shift, change);
+  }
+
+  void insertInPlace(_Entry entry, int shift, _Change change) {
+    int bit = _bitFor(entry.hash, shift);
+    int index = _slotFor(bitmap, bit);
+    if ((bitmap & bit) == 0) {
+      change.lengthDelta++;
+      bitmap |= bit;
+      slots.insert(index, entry);
+      return;
+    }
+    var slot = slots[index];
+    if (slot is _Entry) {
+      slots[index] = _insertIntoEntry(slot, entry, shift, change);
+    } else if (slot is _CollisionNode) {
+      slots[index] = slot.insert(entry, shift + _kBits, change);
+    } else {
+      _EditableNode child = edit(slot);
+      slots[index] = child;
+      child.insertInPlace(entry, shift + _kBits, change);
+    }
+  }
+
+  // Returns true if the node is empty afterwards.
+  bool removeInPlace(int hash, key, int shift, _Change change) {
+    int bit = _bitFor(hash, shift);
+    if ((bitmap & bit) == 0) return false;
+    int index = _slotFor(bitmap, bit);
+    var slot = slots[index];
+    bool empty;
+    if (slot is _Entry) {
+      if (!slot.matches(hash, key)) return false;
+      change.lengthDelta--;
+      empty = true;
+    } else if (slot is _CollisionNode) {
+      var updated = slot.remove(hash, key, shift + _kBits, change);
+      slots[index] = updated;
+      empty = updated == null;
+    } else {
+      _EditableNode child = edit(slot);
+      slots[index] = child;
+      empty = child.removeInPlace(hash, key, shift + _kBits, change);
+    }
+    if (empty) {
+      bitmap ^= bit;
+      slots.removeAt(index);
+    }
+    return bitmap == 0;
+  }
+
+  void forEach(void f(key, value)) => _forEachSlot(slots, f);
+
+  _TrieNode freeze() {
+    for (int i = 0; i < slots.length; i++) {
+      var slot = slots[i];
+      if (slot is _EditableNode) slots[i] = slot.freeze();
+    }
+    return new _BitmapNode(bitmap, immutableList(slots));
+  }
+}
@@ -0,0 +1,60 @@
+// Copyright (c) 2015, the Fletch project authors. Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE.md file.
+
+part of immutable.persistent;
+
+class PersistentSet<E> {
+  final PersistentMap<E, bool> _map;
+
+  const PersistentSet._(this._map);
+
+  factory PersistentSet() => new PersistentSet<E>._(new PersistentMap());
+
+  factory PersistentSet.from(Iterable<E> elements) {
+    PersistentSetBuilder<E> builder = new PersistentSetBuilder<E>();
+    for (E element in elements) builder.add(element);
+    return builder.build();
+  }
+
+  int get length => _map.length;
+
+  bool get isEmpty => _map.isEmpty;
+
+  bool contains(E element) => _map.containsKey(element);
+
+  PersistentSet<E> add(E element) => _wrap(_map.put(element, true));
+
+  PersistentSet<E> remove(E element) => _wrap(_map.remove(element));
+
+  void forEach(void f(E element)) {
+    _map.forEach((E element, _) => f(element));
+  }
+
+  PersistentSetBuilder<E> toBuilder() => new PersistentSetBuilder<E>(this);
+
+  PersistentSet<E> _wrap(PersistentMap<E, bool> map) {
+    return identical(map, _map) ? this : new PersistentSet<E>._(map);
+  }
+}
+
+/// Applies a batch of updates to a [PersistentSet].
+class PersistentSetBuilder<E> {
+  final PersistentMapBuilder<E, bool> _builder;
+
+  PersistentSetBuilder([PersistentSet<E> set])
+      : _builder = new PersistentMapBuilder<E, bool>(
+            (set == null) ? null : set._map);
+
+  int get length => _builder.length;
+
+  bool contains(E element) => _builder[element] != null;
+
+  void add(E element) {
+    _builder[element] = true;
+  }
+
+  void remove(E element) => _builder.remove(element);
+
+  PersistentSet<E> build() => new PersistentSet<E>._(_builder.build());
+}
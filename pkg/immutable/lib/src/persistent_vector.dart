@@ -0,0 +1,218 @@
+// Copyright (c) 2015, the Fletch project authors. Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE.md file.
+
+part of immutable.persistent;
+
+final List _emptyNode = immutableList(const []);
+
+/**
+ * An indexed sequence stored in a trie with 32 elements per leaf. The last
+ * leaf, the tail, is kept outside of the trie so that adding elements only
+ * copies the tail until it is full.
+ */
+class PersistentVector<E> {
+  final int length;
+  final int _shift;
+  final List _root;
+  final List _tail;
+
+  const PersistentVector._(this.length, this._shift, this._root, this._tail);
+
+  factory PersistentVector() {
+    return new PersistentVector<E>._(0, _kBits, _emptyNode, _emptyNode);
+  }
+
+  factory PersistentVector.from(Iterable<E> elements) {
+    return new PersistentVector<E>().addAll(elements);
+  }
+
+  bool get isEmpty => length == 0;
+
+  int get _tailOffset => length - _tail.length;
+
+  E operator [](int index) {
+    if (index < 0 || index >= length) {
+      throw new RangeError.index(index, this);
+    }
+    return _leafFor(index)[index & _kMask];
+  }
+
+  /// Returns a vector with [value] added at the end.
+  PersistentVector<E> add(E value) {
+    if (_tail.length < _kWidth) {
+      List tail = immutableListInsert(_tail, _tail.length, value);
+      return new PersistentVector<E>._(length + 1, _shift, _root, tail);
+    }
+    return addAll([value]);
+  }
+
+  /// Returns a vector with [values] added at the end.
+  PersistentVector<E> addAll(Iterable<E> values) {
+    int count = length;
+    int shift = _shift;
+    List root = _root;
+    List tail = new List.from(_tail);
+    for (E value in values) {
+      if (tail.length == _kWidth) {
+        List leaf = immutableList(tail);
+        if ((count >> _kBits) > (1 << shift)) {
+          // The trie is full. Add a level on top.
+          root = immutableList([root, _newPath(shift, leaf)]);
+          shift += _kBits;
+        } else {
+          root = _pushLeaf(count, shift, root, leaf);
+        }
+        tail = new List();
+      }
+      tail.add(value);
+      count++;
+    }
+    if (count == length) return this;
+    return new PersistentVector<E>._(count, shift, root, immutableList(tail));
+  }
+
+  /// Returns a vector where the element at [index] is [value].
+  PersistentVector<E> set(int index, E value) {
+    if (index < 0 || index >= length) {
+      throw new RangeError.index(index, this);
+    }
+    if (index >= _tailOffset) {
+      List tail = immutableListReplace(_tail, index & _kMask, value);
+      return new PersistentVector<E>._(length, _shift, _root, tail);
+    }
+    List root = _setInNode(_shift, _root, index, value);
+    return new PersistentVector<E>._(length, _shift, root, _tail);
+  }
+
+  /// Returns a vector without the last element.
+  PersistentVector<E> removeLast() {
+    if (length == 0) throw new StateError("No elements");
+    if (length == 1) return new PersistentVector<E>();
+    if (_tail.length > 1) {
+      List tail = immutableListRemove(_tail, _tail.length - 1);
+      return new PersistentVector<E>._(length - 1, _shift, _root, tail);
+    }
+    // The last leaf of the trie becomes the tail.
+    List tail = _leafFor(length - 2);
+    List root = _popLeaf(_shift, _root);
+    int shift = _shift;
+    if (root == null) root = _emptyNode;
+    if (shift > _kBits && root.length == 1) {
+      root = root[0];
+      shift -= _kBits;
+    }
+    return new PersistentVector<E>._(length - 1, shift, root, tail);
+  }
+
+  void forEach(void f(E element)) {
+    for (int i = 0; i < length; i += _kWidth) {
+      List leaf = _leafFor(i);
+      for (int j = 0; j < leaf.length; j++) f(leaf[j]);
+    }
+  }
+
+  List<E> toList() {
+    List<E> result = new List<E>();
+    forEach(result.add);
+    return result;
+  }
+
+  PersistentVectorBuilder<E> toBuilder() {
+    return new PersistentVectorBuilder<E>(this);
+  }
+
+  List _leafFor(int index) {
+    if (index >= _tailOffset) return _tail;
+    List node = _root;
+    for (int level = _shift; level > 0; level -= _kBits) {
+      node = node[(index >> level) & _kMask];
+    }
+    return node;
+  }
+
+  // Adds the full [leaf] to the trie of a vector of [count] elements,
+  // including the elements of [leaf].
+  static List _pushLeaf(int count, int level, List parent, List leaf) {
+    int index = ((count - 1) >> level) & _kMask;
+    var child;
+    if (level == _kBits) {
+      child = leaf;
+    } else if (index < parent.length) {
+      child = _pushLeaf(count, level - _kBits, parent[index], leaf);
+    } else {
+      child = _newPath(level - _kBits, leaf);
+    }
+    return (index < parent.length)
+        ? immutableListReplace(parent, index, child)
+        : immutableListInsert(parent, index, child);
+  }
+
+  static List _newPath(int level, List leaf) {
+    if (level == 0) return leaf;
+    return immutableList([_newPath(level - _kBits, leaf)]);
+  }
+
+  static List _setInNode(int level, List node, int index, value) {
+    if (level == 0) return immutableListReplace(node, index & _kMask, value);
+    int child = (index >> level) & _kMask;
+    List updated = _setInNode(level - _kBits, node[child], index, value);
+    return immutableListReplace(node, child, updated);
+  }
+
+  // Removes the last leaf of the trie. Returns null if [node] becomes empty.
+  List _popLeaf(int level, List node) {
+    int index = ((length - 2) >> level) & _kMask;
+    if (level > _kBits) {
+      List child = _popLeaf(level - _kBits, node[index]);
+      if (child != null) return immutableListReplace(node, index, child);
+    }
+    if (index == 0) return null;
+    return immutableListRemove(node, index);
+  }
+}
+
+/**
+ * Applies a batch of updates to a [PersistentVector]. Added elements are
+ * collected in a mutable leaf and moved to the vector a full leaf at a time.
+ */
+class PersistentVectorBuilder<E> {
+  PersistentVector<E> _vector;
+  final List<E> _pending = new List<E>();
+
+  PersistentVectorBuilder([PersistentVector<E> vector]) {
+    _vector = (vector == null) ? new PersistentVector<E>() : vector;
+  }
+
+  int get length => _vector.length + _pending.length;
+
+  E operator [](int index) {
+    if (index < _vector.length) return _vector[index];
+    return _pending[index - _vector.length];
+  }
+
+  void operator []=(int index, E value) {
+    if (index < _vector.length) {
+      _vector = _vector.set(index, value);
+    } else {
+      _pending[index - _vector.length] = value;
+    }
+  }
+
+  void add(E value) {
+    _pending.add(value);
+    if (_pending.length == _kWidth) _flush();
+  }
+
+  /// Returns a vector with the updates so far. The builder can still be used.
+  PersistentVector<E> build() {
+    _flush();
+    return _vector;
+  }
+
+  void _flush() {
+    if (_pending.isEmpty) return;
+    _vector = _vector.addAll(_pending);
+    _pending.clear();
+  }
+}
@@ -26,6 +26,8 @@ class Errno {
   static int get EINPROGRESS_VALUE =>
       Foreign.platform == Foreign.MACOS ? 36 : 115;
   static Errno EINPROGRESS = new Errno(EINPROGRESS_VALUE, "EINPROGRESS");
+  static int get EAGAIN_VALUE => Foreign.platform == Foreign.MACOS ? 35 : 11;
+  static Errno EAGAIN = new Errno(EAGAIN_VALUE, "EAGAIN");
 
   final int value;
   final String name;
@@ -40,6 +42,8 @@ class Errno {
       return EADDRNOTAVAIL;
     } else if (value == EINPROGRESS_VALUE) {
       return EINPROGRESS;
+    } else if (value == EAGAIN_VALUE) {
+      return EAGAIN;
     }
     switch (value) {
       case EOK_VALUE: return EOK;
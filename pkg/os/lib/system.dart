@@ -68,6 +68,10 @@ abstract class System {
   int available(int fd);
   int read(int fd, ByteBuffer buffer, int offset, int length);
   int write(int fd, ByteBuffer buffer, int offset, int length);
+  int writev(int fd, List<ByteBuffer> buffers, List<int> lengths, int skip);
+  int sendfile(int outFd, int inFd, int offset, int length);
+  int copyFileRange(int inFd, int inOffset, int outFd, int outOffset,
+                    int length);
   int sendto(int fd, ByteBuffer buffer, InternetAddress target, int port);
   int recvfrom(int fd, ByteBuffer buffer, ForeignMemory sockaddr);
   int shutdown(int fd, int how);
@@ -93,6 +97,7 @@ abstract class System {
   int get O_NONBLOCK;
   int get SOL_SOCKET;
   int get SO_REUSEADDR;
+  int get SO_REUSEPORT;
   int get ADDR_INFO_SIZE;
   int get SOCKADDR_STORAGE_SIZE;
   SockAddrIn allocateSockAddrIn();
@@ -9,6 +9,18 @@ class LinuxSystem extends PosixSystem {
       ForeignLibrary.main.lookup("lseek64");
   static final ForeignFunction _openLinux =
       ForeignLibrary.main.lookup("open64");
+  static final ForeignFunction _sendfile =
+      ForeignLibrary.main.lookup("sendfile64");
+  // Null if the C library does not have copy_file_range (glibc before 2.27
+  // and many other libcs).
+  static final ForeignFunction _copyFileRange =
+      _lookupOptional("copy_file_range");
+
+  // Largest transfer done by sendfile and copy_file_range in one call.
+  static const int _MAX_TRANSFER = 0x7ffff000;
+
+  // In-out 'loff_t' offsets of sendfile and copy_file_range.
+  final ForeignMemory _offsets = new ForeignMemory.allocatedFinalized(16);
 
   int get AF_INET6 => 10;
 
@@ -24,11 +36,44 @@ class LinuxSystem extends PosixSystem {
 
   int get SO_REUSEADDR => 2;
 
+  int get SO_REUSEPORT => 15;
+
   // The size of fields and the struct used by uname.
   // From /usr/include/sys/utsname.h
   int get UTSNAME_LENGTH => 65;
   int get SIZEOF_UTSNAME => 6 * UTSNAME_LENGTH;
 
+  static ForeignFunction _lookupOptional(String name) {
+    try {
+      return ForeignLibrary.main.lookup(name);
+    } on ArgumentError catch (_) {
+      return null;
+    }
+  }
+
   ForeignFunction get _lseek => _lseekLinux;
   ForeignFunction get _open => _openLinux;
+
+  int sendfile(int outFd, int inFd, int offset, int length) {
+    if (length > _MAX_TRANSFER) length = _MAX_TRANSFER;
+    _offsets.setInt64(0, offset);
+    int result = _sendfile.icall$4Retry(outFd, inFd, _offsets, length);
+    if (result == -1) {
+      return (Foreign.errno == Errno.EAGAIN_VALUE) ? 0 : -1;
+    }
+    // Nothing was sent because the end of the file was reached.
+    if (result == 0 && length > 0) return -1;
+    return result;
+  }
+
+  int copyFileRange(int inFd, int inOffset, int outFd, int outOffset,
+                    int length) {
+    if (_copyFileRange == null) return -1;
+    if (length > _MAX_TRANSFER) length = _MAX_TRANSFER;
+    _offsets.setInt64(0, inOffset);
+    _offsets.setInt64(8, outOffset);
+    int outOffsetAddress = _offsets.address + 8;
+    return _copyFileRange.icall$6Retry(
+        inFd, _offsets, outFd, outOffsetAddress, length, 0);
+  }
 }
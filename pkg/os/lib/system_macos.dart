@@ -7,6 +7,12 @@ part of os;
 class MacOSSystem extends PosixSystem {
   static final ForeignFunction _lseekMac = ForeignLibrary.main.lookup("lseek");
   static final ForeignFunction _openMac = ForeignLibrary.main.lookup("open");
+  static final ForeignFunction _sendfile =
+      ForeignLibrary.main.lookup("sendfile");
+
+  // In-out 'off_t' length of sendfile.
+  final ForeignMemory _sendfileLength =
+      new ForeignMemory.allocatedFinalized(8);
 
   int get AF_INET6 => 30;
 
@@ -22,6 +28,8 @@ class MacOSSystem extends PosixSystem {
 
   int get SO_REUSEADDR => 0x4;
 
+  int get SO_REUSEPORT => 0x200;
+
   // The size of fields and the struct used by uname.
   // From /usr/include/sys/utsname.h
   int get UTSNAME_LENGTH => 256;
@@ -30,6 +38,23 @@ class MacOSSystem extends PosixSystem {
   ForeignFunction get _lseek => _lseekMac;
   ForeignFunction get _open => _openMac;
 
+  int sendfile(int outFd, int inFd, int offset, int length) {
+    _sendfileLength.setInt64(0, length);
+    int result = _sendfile.icall$6(inFd, outFd, offset, _sendfileLength, 0, 0);
+    int sent = _sendfileLength.getInt64(0);
+    if (result == -1) {
+      // Partial transfers are reported as failures with the sent length set.
+      int error = Foreign.errno;
+      if (error == Errno.EAGAIN_VALUE || error == Errno.EINTR_VALUE) {
+        return sent;
+      }
+      return -1;
+    }
+    // Nothing was sent because the end of the file was reached.
+    if (sent == 0 && length > 0) return -1;
+    return sent;
+  }
+
   int SOCKADDR_IN_SIZE = 16;
   int SOCKADDR_IN6_SIZE = 28;
 
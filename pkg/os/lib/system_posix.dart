@@ -11,6 +11,10 @@ const int F_SETFL = 4;
 
 const int FD_CLOEXEC = 0x1;
 
+// The maximum number of buffers passed to a single writev call. POSIX
+// guarantees at least 16 (_XOPEN_IOV_MAX).
+const int _MAX_IOVECS = 16;
+
 abstract class PosixSystem implements System {
   static final ForeignFunction _accept =
       ForeignLibrary.main.lookup("accept");
@@ -50,6 +54,8 @@ abstract class PosixSystem implements System {
       ForeignLibrary.main.lookup("unlink");
   static final ForeignFunction _write =
       ForeignLibrary.main.lookup("write");
+  static final ForeignFunction _writev =
+      ForeignLibrary.main.lookup("writev");
   static final ForeignFunction _sendto =
       ForeignLibrary.main.lookup("sendto");
   static final ForeignFunction _recvfrom =
@@ -57,6 +63,9 @@ abstract class PosixSystem implements System {
   static final ForeignFunction _uname =
       ForeignLibrary.main.lookup("uname");
 
+  // Array of 'struct iovec { void* iov_base; size_t iov_len; }' for writev.
+  final Struct _iovecs = new Struct.finalized(2 * _MAX_IOVECS);
+
   int get AF_INET => 2;
   int get AF_INET6;
 
@@ -78,6 +87,8 @@ abstract class PosixSystem implements System {
 
   int get SO_REUSEADDR;
 
+  int get SO_REUSEPORT;
+
   int get ADDR_INFO_SIZE => 8;
 
   int get SOCKADDR_STORAGE_SIZE => 128;
@@ -279,6 +290,60 @@ abstract class PosixSystem implements System {
     return _write.icall$3Retry(fd, address, length);
   }
 
+  /**
+   * Write [buffers] with a single writev call, skipping the first [skip]
+   * bytes. Only the first `lengths[i]` bytes of `buffers[i]` are written, or
+   * all of it if [lengths] is `null`. Returns the number of bytes written,
+   * which may be less than requested.
+   */
+  int writev(int fd, List<ByteBuffer> buffers, List<int> lengths, int skip) {
+    int index = 0;
+    int count = buffers.length;
+    while (index < count) {
+      int length =
+          (lengths == null) ? buffers[index].lengthInBytes : lengths[index];
+      if (skip < length) break;
+      skip -= length;
+      index++;
+    }
+    Struct iovecs = _iovecs;
+    int wordSize = iovecs.wordSize;
+    int iovecCount = 0;
+    while (index < count && iovecCount < _MAX_IOVECS) {
+      ByteBuffer buffer = buffers[index];
+      int length = (lengths == null) ? buffer.lengthInBytes : lengths[index];
+      _rangeCheck(buffer, 0, length);
+      if (length > skip) {
+        int offset = 2 * iovecCount * wordSize;
+        iovecs.setWord(offset, getForeign(buffer).address + skip);
+        iovecs.setWord(offset + wordSize, length - skip);
+        iovecCount++;
+      }
+      skip = 0;
+      index++;
+    }
+    if (iovecCount == 0) return 0;
+    return _writev.icall$3Retry(fd, iovecs, iovecCount);
+  }
+
+  /**
+   * Copy up to [length] bytes at [offset] in the file [inFd] to the socket
+   * [outFd] without passing them through user space. Returns the number of
+   * bytes sent, which is `0` if [outFd] is not ready for writing, or `-1` on
+   * errors, including [offset] being at the end of [inFd].
+   */
+  int sendfile(int outFd, int inFd, int offset, int length);
+
+  /**
+   * Copy up to [length] bytes between two files inside the kernel. Returns
+   * the number of bytes copied, or `-1` if the copy failed or is not
+   * supported, in which case the caller should fall back to read and write.
+   */
+  int copyFileRange(int inFd, int inOffset, int outFd, int outOffset,
+                    int length) {
+    return -1;
+  }
+
   int sendto(int fd, ByteBuffer buffer, InternetAddress target, int port) {
     ForeignMemory sockAddr = _createSocketAddress(target, port);
     ForeignMemory memory = getForeign(buffer);
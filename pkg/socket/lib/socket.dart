@@ -89,6 +89,13 @@ class Socket extends _SocketBase {
     }
   }
 
+  /**
+   * Take over the connected socket [fd], as returned by
+   * [ServerSocket.acceptFd]. This can be done by another process than the
+   * one accepting the socket.
+   */
+  Socket.fromFd(int fd) : this._fromFd(fd);
+
   Socket._fromFd(fd) {
     // Be sure it's not in the event handler.
     _fd = fd;
@@ -141,12 +148,34 @@ class Socket extends _SocketBase {
     return buffer;
   }
 
+  /**
+   * Read up to [length] bytes into [buffer] at [offset].
+   * Will block until some bytes are available.
+   * Returns the number of bytes read, which is `0` if the socket was closed
+   * for reading.
+   */
+  int readInto(ByteBuffer buffer, int offset, int length) {
+    int events = _waitFor(os.READ_EVENT);
+    int read = 0;
+    if ((events & os.READ_EVENT) != 0) {
+      read = sys.read(_fd, buffer, offset, length);
+    }
+    if (read < 0 || (events & os.ERROR_EVENT) != 0) {
+      _error("Failed to read from socket");
+    }
+    return read;
+  }
+
   /**
    * Write [buffer] on the socket. Will block until all of [buffer] is written.
+   *
+   * If [offset] and [length] are given, only that range of [buffer] is
+   * written.
    */
-  void write(ByteBuffer buffer) {
-    int offset = 0;
-    int bytes = buffer.lengthInBytes;
+  void write(ByteBuffer buffer, [int offset = 0, int length]) {
+    int bytes = (length == null) ? buffer.lengthInBytes - offset : length;
+    if (bytes == 0) return;
+    bytes += offset;
     while (true) {
       int wrote = sys.write(_fd, buffer, offset, bytes - offset);
       if (wrote == -1) {
@@ -161,6 +190,53 @@ class Socket extends _SocketBase {
     }
   }
 
+  /**
+   * Write all of [buffers] on the socket, gathering them in as few system
+   * calls as possible. If [lengths] is given, only the first `lengths[i]`
+   * bytes of `buffers[i]` are written. Will block until everything is
+   * written.
+   */
+  void writeBuffers(List<ByteBuffer> buffers, [List<int> lengths]) {
+    int bytes = 0;
+    for (int i = 0; i < buffers.length; i++) {
+      bytes += (lengths == null) ? buffers[i].lengthInBytes : lengths[i];
+    }
+    int offset = 0;
+    while (offset < bytes) {
+      int wrote = sys.writev(_fd, buffers, lengths, offset);
+      if (wrote == -1) {
+        _error("Failed to write to socket");
+      }
+      offset += wrote;
+      if (offset == bytes) return;
+      int events = _waitFor(os.WRITE_EVENT);
+      if ((events & os.ERROR_EVENT) != 0) {
+        _error("Failed to write to socket");
+      }
+    }
+  }
+
+  /**
+   * Write [length] bytes at [offset] in the file [fd] on the socket. The
+   * bytes are copied by the kernel without passing through user space. Will
+   * block until all bytes are written.
+   */
+  void sendFile(int fd, int offset, int length) {
+    int end = offset + length;
+    while (offset < end) {
+      int sent = sys.sendfile(_fd, fd, offset, end - offset);
+      if (sent == -1) {
+        _error("Failed to send file on socket");
+      }
+      offset += sent;
+      if (offset == end) return;
+      int events = _waitFor(os.WRITE_EVENT);
+      if ((events & os.ERROR_EVENT) != 0) {
+        _error("Failed to send file on socket");
+      }
+    }
+  }
+
   /**
    * Close the socket for writing. After the socket is closed for writing,
    * [write] to the socket will fail.
@@ -177,8 +253,13 @@ class ServerSocket extends _SocketBase {
    * Create a new server socket, listening on '[host]:[port]'.
    *
    * If [port] is '0', a random free port will be selected for the socket.
+   *
+   * If [shared] is true, the socket is created with SO_REUSEPORT and other
+   * shared server sockets can listen on the same port, e.g., one for each
+   * process accepting connections. The kernel balances incoming connections
+   * between them.
    */
-  ServerSocket(String host, int port) {
+  ServerSocket(String host, int port, {bool shared: false}) {
     var address = sys.lookup(host);
     if (address == null) _error("Failed to lookup address '$host'");
     _fd = sys.socket(sys.AF_INET, sys.SOCK_STREAM, 0);
@@ -186,6 +267,9 @@ class ServerSocket extends _SocketBase {
     if (_setReuseaddr(_fd) == -1) {
       _error("Failed to set socket option");
     }
+    if (shared && _setReuseport(_fd) == -1) {
+      _error("Failed to set socket option");
+    }
     sys.setBlocking(_fd, false);
     sys.setCloseOnExec(_fd, true);
     if (sys.bind(_fd, address, port) == -1) {
@@ -203,6 +287,10 @@ class ServerSocket extends _SocketBase {
     return result;
   }
 
+  int _setReuseport(int fd) {
+    return sys.setsockopt(fd, sys.SOL_SOCKET, sys.SO_REUSEPORT, FOREIGN_ONE);
+  }
+
   /**
    * Get the port of the server socket.
    */
@@ -238,6 +326,13 @@ class ServerSocket extends _SocketBase {
     return new Socket._fromFd(_accept());
   }
 
+  /**
+   * Accept the incoming socket and return its file descriptor. This
+   * function will block until a socket is accepted. The socket is handed
+   * over to a process by passing the descriptor to [Socket.fromFd].
+   */
+  int acceptFd() => _accept();
+
   int _accept() {
     int events = _waitFor(os.READ_EVENT);
     if (events != os.READ_EVENT) {
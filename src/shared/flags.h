@@ -26,6 +26,18 @@ namespace fletch {
 #define FLAG_CSTRING(macro, name, value, doc) \
   macro(const char*, String, name, value, doc)
 
+// The flags selecting the C++ interpreter are only accepted by builds that
+// bundle it in.
+#ifdef FLETCH_ENABLE_CPP_INTERPRETER
+#define APPLY_TO_INTERPRETER_FLAGS(debug, release)                        \
+  FLAG_BOOLEAN(release, native_interpreter, true,                         \
+               "Run bytecodes in the generated interpreter if available") \
+  FLAG_BOOLEAN(release, threaded_interpreter, false,                      \
+               "Run the C++ interpreter on pre-decoded threaded code")
+#else
+#define APPLY_TO_INTERPRETER_FLAGS(debug, release)
+#endif
+
 #define APPLY_TO_FLAGS(debug, release)                                    \
   FLAG_BOOLEAN(release, expose_gc, false,                                 \
                "Expose invoking GC to native call.")                      \
@@ -33,6 +45,7 @@ namespace fletch {
                "Validate stack at each interperter step")                 \
   FLAG_BOOLEAN(release, unfold_program, false,                            \
                "Unfold the program before running")                       \
+  APPLY_TO_INTERPRETER_FLAGS(debug, release)                              \
   FLAG_BOOLEAN(release, gc_on_delete, false,                              \
                "GC the heap at when terminating isolate")                 \
   FLAG_BOOLEAN(release, validate_heaps, false,                            \
@@ -42,11 +55,33 @@ namespace fletch {
                "Print statistics about the program")                      \
   FLAG_BOOLEAN(release, print_heap_statistics, false,                     \
                "Print heap statistics before GC")                         \
+  FLAG_BOOLEAN(release, print_safepoint_statistics, false,                \
+               "Print time-to-safepoint statistics at exit")              \
+  FLAG_BOOLEAN(release, print_exit_statistics, false,                     \
+               "Print statistics about process exit messages at exit")    \
   FLAG_BOOLEAN(release, verbose, false, "Verbose output")                 \
+  FLAG_BOOLEAN(release, tree_shake, true,                                 \
+               "Remove unreachable code when writing snapshots")          \
   FLAG_BOOLEAN(debug, print_flags, false, "Print flags")                  \
   FLAG_BOOLEAN(release, profile, false,                                   \
                "Profile the execution of the entire VM")                  \
   FLAG_INTEGER(release, profile_interval, 1000, "Profile interval in us") \
+  FLAG_INTEGER(release, event_handlers, 1,                                \
+               "Number of event handler threads, 0 for one per core")     \
+  FLAG_INTEGER(release, hibernate_idle_ms, 0,                             \
+               "Hibernate processes idle this long, 0 to disable")        \
+  FLAG_CSTRING(release, heap_policy, "fixed",                             \
+               "Process heap growth: fixed, frequency or time")           \
+  FLAG_INTEGER(release, heap_gc_interval_ms, 10,                          \
+               "Target ms between process GCs, frequency policy")         \
+  FLAG_INTEGER(release, heap_gc_time_percent, 5,                          \
+               "Target percentage of time spent in GC, time policy")      \
+  FLAG_INTEGER(release, max_threads, 0,                                   \
+               "Scheduler threads, 0 for one per hardware thread")        \
+  FLAG_BOOLEAN(release, numa, false,                                      \
+               "Pin worker threads and place heap chunks on NUMA nodes")  \
+  FLAG_BOOLEAN(release, use_cycle_counter, false,                         \
+               "Time Stopwatch with the CPU cycle counter if invariant")  \
   FLAG_CSTRING(release, filter, NULL, "Filter string for unit testing")   \
   /* Temporary compiler flags */                                          \
   FLAG_BOOLEAN(release, trace_compiler, false, "")                        \
@@ -157,6 +157,14 @@ inline D bit_cast(const S& source) {
   (__has_builtin(__builtin_smull_overflow))
 #endif
 
+// When live coding is disabled on a platform with a generated interpreter,
+// the C++ interpreter is not bundled in.
+#if defined(FLETCH_ENABLE_LIVE_CODING) ||                          \
+    !(defined(FLETCH_TARGET_IA32) || defined(FLETCH_TARGET_ARM) || \
+      (defined(FLETCH_TARGET_X64) && defined(FLETCH_TARGET_OS_POSIX)))
+#define FLETCH_ENABLE_CPP_INTERPRETER
+#endif
+
 #ifdef TEMP_FAILURE_RETRY
 #undef TEMP_FAILURE_RETRY
 #endif
@@ -129,6 +129,8 @@ namespace fletch {
   N(ProcessQueueGetMessage, "Process", "_queueGetMessage")                \
   N(ProcessQueueGetChannel, "Process", "_queueGetChannel")                \
   N(ProcessCurrent, "Process", "current")                                 \
+  N(ProcessNumberOfThreads, "Process", "_numberOfThreads")                \
+  N(ProcessHibernate, "Process", "_hibernate")                            \
                                                                           \
   N(CoroutineCurrent, "Coroutine", "_coroutineCurrent")                   \
   N(CoroutineNewStack, "Coroutine", "_coroutineNewStack")                 \
@@ -136,6 +138,16 @@ namespace fletch {
   N(StopwatchFrequency, "Stopwatch", "_frequency")                        \
   N(StopwatchNow, "Stopwatch", "_now")                                    \
                                                                           \
+  N(LatencyHistogramNow, "LatencyHistogram", "_now")                      \
+  N(LatencyHistogramBucketCount, "LatencyHistogram", "_bucketCount")      \
+  N(LatencyHistogramRecord, "LatencyHistogram", "_record")                \
+  N(LatencyHistogramPercentile, "LatencyHistogram", "_percentile")        \
+                                                                          \
+  N(BufferPoolRegister, "BufferPool", "_register")                        \
+  N(BufferPoolPooledBuffers, "BufferPool", "_pooledBuffers")              \
+  N(IndexOfByte, "<none>", "_indexOfByte")                                \
+                                                                          \
+  N(TimerNow, "_FletchTimer", "_now")                                     \
   N(TimerScheduleTimeout, "_FletchTimer", "_scheduleTimeout")             \
                                                                           \
   N(EventHandlerAdd, "<none>", "_eventHandlerAdd")                        \
@@ -211,6 +223,7 @@ namespace fletch {
   N(ForeignFree, "ForeignMemory", "_free")                                \
                                                                           \
   N(StringLength, "_StringBase", "length")                                \
+  N(StringFromCharCodes, "_StringBase", "_fromCharCodes")                 \
                                                                           \
   N(OneByteStringAdd, "_OneByteString", "+")                              \
   N(OneByteStringCodeUnitAt, "_OneByteString", "codeUnitAt")              \
@@ -239,13 +252,24 @@ namespace fletch {
   N(PortCreate, "Port", "_create")                                        \
   N(PortSend, "Port", "send")                                             \
   N(PortSendExit, "Port", "_sendExit")                                    \
-                                                                          \
+  N(PortSendClone, "Port", "sendClone")                                   \
+  N(PortOpenMessageArena, "Port", "_openMessageArena")                    \
+  N(PortCloseMessageArena, "Port", "_closeMessageArena")                  \
+  N(PortSendMessageArena, "Port", "_sendMessageArena")                    \
+  N(PortCreateGather, "Port", "_createGather")                            \
+  N(PortContribute, "Port", "contribute")                                 \
+  N(PortGroupBroadcast, "PortGroup", "_broadcast")                        \
+                                                                          \
+  N(SystemEventHandlerCount, "EventHandler", "_eventHandlerCount")        \
   N(SystemGetEventHandler, "EventHandler", "_getEventHandler")            \
   N(SystemIncrementPortRef, "EventHandler", "_incrementPortRef")          \
                                                                           \
   N(ServiceRegister, "<none>", "register")                                \
                                                                           \
   N(IsImmutable, "<none>", "_isImmutable")                                \
+  N(ImmutableListSplice, "<none>", "_immutableListSplice")                \
+  N(ImmutableByteList, "<none>", "_immutableByteList")                    \
+  N(BitCount, "<none>", "_bitCount")                                      \
   N(IdentityHashCode, "<none>", "_identityHashCode")                      \
                                                                           \
   N(NativeProcessSpawnDetached, "NativeProcess", "_spawnDetached")        \
@@ -66,10 +66,18 @@ Mutex* CreateMutex();
 // Use delete to reclaim the storage for the returned Monitor.
 Monitor* CreateMonitor();
 
-// Returns the number of microseconds since epoch.
+// Returns the number of microseconds since epoch. This is wall-clock time,
+// which jumps when the system clock is adjusted. Use
+// [GetMonotonicMicroseconds] for deadlines and durations.
 uint64 GetMicroseconds();
 
-// Returns the number of microseconds since this process got started.
+// Returns the number of microseconds since an unspecified point in the past.
+// The value never decreases and is not affected by changes to the system
+// clock.
+uint64 GetMonotonicMicroseconds();
+
+// Returns the number of microseconds since this process got started, based on
+// the monotonic clock.
 uint64 GetProcessMicroseconds();
 
 // Returns the number of available hardware threads.
@@ -203,8 +211,9 @@ class Monitor {
   int Unlock() { return impl_.Unlock(); }
   int Wait() { return impl_.Wait(); }
   bool Wait(uint64 microseconds) { return impl_.Wait(microseconds); }
-  bool WaitUntil(uint64 microseconds_since_epoch) {
-    return impl_.WaitUntil(microseconds_since_epoch);
+  // Wait until [deadline], in [Platform::GetMonotonicMicroseconds] time.
+  bool WaitUntil(uint64 deadline) {
+    return impl_.WaitUntil(deadline);
   }
   int Notify() { return impl_.Notify(); }
   int NotifyAll() { return impl_.NotifyAll(); }
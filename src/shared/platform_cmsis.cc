@@ -34,6 +34,12 @@ uint64 Platform::GetMicroseconds() {
   return result;
 }
 
+uint64 Platform::GetMonotonicMicroseconds() {
+  // There is no wall-clock time on these devices; gettimeofday counts from
+  // boot and is never adjusted.
+  return GetMicroseconds();
+}
+
 uint64 Platform::GetProcessMicroseconds() {
   // Assume now is past time_launch.
   return GetMicroseconds() - time_launch;
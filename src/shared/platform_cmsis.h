@@ -91,9 +91,9 @@ static const int kMutexSize = sizeof(int32_t) * 3;
 static const int kSemaphoreSize = sizeof(int32_t) * 2;
 static const int kMaxSemaphoreValue = 1024;
 
-// Forward declare [Platform::GetMicroseconds].
+// Forward declare [Platform::GetMonotonicMicroseconds].
 namespace Platform {
-uint64 GetMicroseconds();
+uint64 GetMonotonicMicroseconds();
 }  // namespace Platform
 
 class MutexImpl {
@@ -169,9 +169,9 @@ class MonitorImpl {
     return osOK;
   }
 
-  bool WaitUntil(uint64 microseconds_since_epoch) {
-    uint64 us = microseconds_since_epoch - Platform::GetMicroseconds();
-    return Wait(us);
+  bool WaitUntil(uint64 deadline) {
+    uint64 now = Platform::GetMonotonicMicroseconds();
+    return Wait(deadline > now ? deadline - now : 0);
   }
 
   int Notify() {
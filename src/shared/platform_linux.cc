@@ -25,6 +25,16 @@ void GetPathOfExecutable(char* path, size_t path_length) {
   path[length] = '\0';
 }
 
+uint64 Platform::GetMonotonicMicroseconds() {
+  struct timespec ts;
+  if (clock_gettime(CLOCK_MONOTONIC, &ts) != 0) {
+    FATAL1("clock_gettime failed: %s", strerror(errno));
+  }
+  uint64 result = ts.tv_sec * 1000000LL;
+  result += ts.tv_nsec / 1000;
+  return result;
+}
+
 int Platform::GetLocalTimeZoneOffset() {
   // TODO(ajohnsen): avoid excessive calls to tzset?
   tzset();
@@ -35,6 +35,11 @@ uint64 Platform::GetMicroseconds() {
   return time;
 }
 
+uint64 Platform::GetMonotonicMicroseconds() {
+  // The LK clock counts from boot and is never adjusted.
+  return current_time_hires();
+}
+
 uint64 Platform::GetProcessMicroseconds() {
   // Assume now is past time_launch.
   return GetMicroseconds() - time_launch;
@@ -19,9 +19,9 @@
 
 namespace fletch {
 
-// Forward declare [Platform::GetMicroseconds].
+// Forward declare [Platform::GetMonotonicMicroseconds].
 namespace Platform {
-uint64 GetMicroseconds();
+uint64 GetMonotonicMicroseconds();
 }  // namespace Platform
 
 class MutexImpl {
@@ -66,17 +66,17 @@ class MonitorImpl {
   }
 
   bool Wait(uint64 microseconds) {
-    uint64 us = Platform::GetMicroseconds() + microseconds;
+    uint64 us = Platform::GetMonotonicMicroseconds() + microseconds;
     return WaitUntil(us);
   }
 
-  bool WaitUntil(uint64 microseconds_since_epoch) {
+  bool WaitUntil(uint64 deadline) {
     mutex_acquire(&internal_);
     waiting_++;
     mutex_release(&internal_);
     mutex_release(&mutex_);
     // TODO(herhut): This is not really since epoch.
-    status_t status = sem_timedwait(&sem_, microseconds_since_epoch);
+    status_t status = sem_timedwait(&sem_, deadline);
     mutex_acquire(&mutex_);
     return status != ERR_TIMED_OUT;
   }
@@ -4,6 +4,7 @@
 
 #if defined(FLETCH_TARGET_OS_MACOS)
 
+#include <mach/mach_time.h>
 #include <mach-o/dyld.h>
 
 #include <CoreFoundation/CFTimeZone.h>
@@ -20,6 +21,19 @@ void GetPathOfExecutable(char* path, size_t path_length) {
   }
 }
 
+uint64 Platform::GetMonotonicMicroseconds() {
+  static mach_timebase_info_data_t timebase = {0, 0};
+  if (timebase.denom == 0) {
+    if (mach_timebase_info(&timebase) != KERN_SUCCESS) {
+      FATAL("mach_timebase_info failed");
+    }
+  }
+  // The timebase converts mach ticks to nanoseconds.
+  uint64 ticks = mach_absolute_time();
+  return (ticks / 1000) * timebase.numer / timebase.denom +
+         (ticks % 1000) * timebase.numer / timebase.denom / 1000;
+}
+
 int Platform::GetLocalTimeZoneOffset() {
   CFTimeZoneRef tz = CFTimeZoneCopySystem();
   // Even if the offset was 24 hours it would still easily fit into 32 bits.
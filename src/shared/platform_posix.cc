@@ -26,7 +26,7 @@ namespace fletch {
 static uint64 time_launch;
 
 void Platform::Setup() {
-  time_launch = GetMicroseconds();
+  time_launch = GetMonotonicMicroseconds();
 
   // Make functions return EPIPE instead of getting SIGPIPE signal.
   struct sigaction sa;
@@ -45,8 +45,7 @@ uint64 Platform::GetMicroseconds() {
 }
 
 uint64 Platform::GetProcessMicroseconds() {
-  // Assume now is past time_launch.
-  return GetMicroseconds() - time_launch;
+  return GetMonotonicMicroseconds() - time_launch;
 }
 
 int Platform::GetNumberOfHardwareThreads() {
@@ -13,14 +13,23 @@
 
 #include <errno.h>
 #include <pthread.h>
+#include <time.h>
 
 #include "src/shared/globals.h"
 
+// Older Android releases and Mac OS cannot time out condition variables on
+// the monotonic clock.
+#if !defined(FLETCH_TARGET_OS_MACOS) && !defined(__ANDROID__)
+#define FLETCH_MONOTONIC_CONDITION_VARIABLES
+#endif
+
 namespace fletch {
 
-// Forward declare [Platform::GetMicroseconds].
+// Forward declare [Platform::GetMicroseconds] and
+// [Platform::GetMonotonicMicroseconds].
 namespace Platform {
 uint64 GetMicroseconds();
+uint64 GetMonotonicMicroseconds();
 }  // namespace Platform
 
 class MutexImpl {
@@ -40,7 +49,17 @@ class MonitorImpl {
  public:
   MonitorImpl() {
     pthread_mutex_init(&mutex_, NULL);
+#if defined(FLETCH_MONOTONIC_CONDITION_VARIABLES)
+    // Time out based on the monotonic clock, so waits are not cut short or
+    // extended when the system clock is adjusted.
+    pthread_condattr_t attributes;
+    pthread_condattr_init(&attributes);
+    pthread_condattr_setclock(&attributes, CLOCK_MONOTONIC);
+    pthread_cond_init(&cond_, &attributes);
+    pthread_condattr_destroy(&attributes);
+#else
     pthread_cond_init(&cond_, NULL);
+#endif
   }
 
   ~MonitorImpl() {
@@ -54,14 +73,22 @@ class MonitorImpl {
   int Wait() { return pthread_cond_wait(&cond_, &mutex_); }
 
   bool Wait(uint64 microseconds) {
-    uint64 us = Platform::GetMicroseconds() + microseconds;
+    uint64 us = Platform::GetMonotonicMicroseconds() + microseconds;
     return WaitUntil(us);
   }
 
-  bool WaitUntil(uint64 microseconds_since_epoch) {
+  bool WaitUntil(uint64 deadline) {
+#if defined(FLETCH_MONOTONIC_CONDITION_VARIABLES)
+    uint64 time = deadline;
+#else
+    // Translate the deadline to wall-clock time.
+    uint64 now = Platform::GetMonotonicMicroseconds();
+    uint64 remaining = (deadline > now) ? deadline - now : 0;
+    uint64 time = Platform::GetMicroseconds() + remaining;
+#endif
     timespec ts;
-    ts.tv_sec = microseconds_since_epoch / 1000000;
-    ts.tv_nsec = (microseconds_since_epoch % 1000000) * 1000;
+    ts.tv_sec = time / 1000000;
+    ts.tv_nsec = (time % 1000000) * 1000;
     return pthread_cond_timedwait(&cond_, &mutex_, &ts) == ETIMEDOUT;
   }
 
@@ -28,7 +28,7 @@ void GetPathOfExecutable(char* path, size_t path_length) {
   }
 }
 
-void Platform::Setup() { time_launch = GetMicroseconds(); }
+void Platform::Setup() { time_launch = GetMonotonicMicroseconds(); }
 
 uint64 Platform::GetMicroseconds() {
   SYSTEMTIME sys_time;
@@ -44,9 +44,19 @@ uint64 Platform::GetMicroseconds() {
   return milliseconds.QuadPart / 10;
 }
 
+uint64 Platform::GetMonotonicMicroseconds() {
+  static LARGE_INTEGER frequency = {0};
+  if (frequency.QuadPart == 0) QueryPerformanceFrequency(&frequency);
+  LARGE_INTEGER counter;
+  QueryPerformanceCounter(&counter);
+  uint64 ticks = counter.QuadPart;
+  uint64 per_second = frequency.QuadPart;
+  return (ticks / per_second) * 1000000 +
+         (ticks % per_second) * 1000000 / per_second;
+}
+
 uint64 Platform::GetProcessMicroseconds() {
-  // Assume now is past time_launch.
-  return GetMicroseconds() - time_launch;
+  return GetMonotonicMicroseconds() - time_launch;
 }
 
 int Platform::GetNumberOfHardwareThreads() {
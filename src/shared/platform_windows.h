@@ -19,9 +19,9 @@
 
 namespace fletch {
 
-// Forward declare [Platform::GetMicroseconds].
+// Forward declare [Platform::GetMonotonicMicroseconds].
 namespace Platform {
-uint64 GetMicroseconds();
+uint64 GetMonotonicMicroseconds();
 }  // namespace Platform
 
 class MutexImpl {
@@ -69,9 +69,9 @@ class MonitorImpl {
     return 0;
   }
 
-  bool WaitUntil(uint64 microseconds_since_epoch) {
-    uint64 now = Platform::GetMicroseconds();
-    return Wait(microseconds_since_epoch - now);
+  bool WaitUntil(uint64 deadline) {
+    uint64 now = Platform::GetMonotonicMicroseconds();
+    return Wait(deadline > now ? deadline - now : 0);
   }
 
   int Notify() {
@@ -95,6 +95,15 @@ class Utils {
     return x + 1;
   }
 
+  // Implementation is from "Hacker's Delight" by Henry S. Warren, Jr.,
+  // figure 5-2, page 66, where the function is called pop.
+  static inline int BitCount(uint64 x) {
+    x = x - ((x >> 1) & 0x5555555555555555ULL);
+    x = (x & 0x3333333333333333ULL) + ((x >> 2) & 0x3333333333333333ULL);
+    x = (x + (x >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+    return static_cast<int>((x * 0x0101010101010101ULL) >> 56);
+  }
+
   // Computes a hash value for the given string.
   static uint32 StringHash(const uint8* data, int length, int char_width);
 
@@ -76,4 +76,13 @@ TEST_CASE(RoundUp) {
   EXPECT_EQ(64, Utils::RoundUp(63, 32));
 }
 
+TEST_CASE(BitCount) {
+  EXPECT_EQ(0, Utils::BitCount(0));
+  EXPECT_EQ(1, Utils::BitCount(1));
+  EXPECT_EQ(1, Utils::BitCount(0x80000000));
+  EXPECT_EQ(8, Utils::BitCount(0xFF00));
+  EXPECT_EQ(32, Utils::BitCount(0xFFFFFFFF));
+  EXPECT_EQ(64, Utils::BitCount(0xFFFFFFFFFFFFFFFFULL));
+}
+
 }  // namespace fletch
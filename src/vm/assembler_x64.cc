@@ -12,29 +12,23 @@ namespace fletch {
 enum RegisterSize { kLongRegister = 'l', kQuadRegister = 'q' };
 
 void Assembler::j(Condition condition, Label* label) {
-  static const char* kConditionMnemonics[] = {
-      "o",   // OVERFLOW
-      "no",  // NO_OVERFLOW
-      "b",   // BELOW
-      "ae",  // ABOVE_EQUAL
-      "e",   // EQUAL
-      "ne",  // NOT_EQUAL
-      "be",  // BELOW_EQUAL
-      "a",   // ABOVE
-      "s",   // SIGN
-      "ns",  // NOT_SIGN
-      "p",   // PARITY_EVEN
-      "np",  // PARITY_ODD
-      "l",   // LESS
-      "ge",  // GREATER_EQUAL
-      "le",  // LESS_EQUAL
-      "g"    // GREATER
-  };
-  ASSERT(static_cast<unsigned>(condition) < ARRAY_SIZE(kConditionMnemonics));
-  const char* mnemonic = kConditionMnemonics[condition];
+  const char* mnemonic = ConditionMnemonic(condition);
   printf("\tj%s L%d\n", mnemonic, ComputeLabelPosition(label));
 }
 
+void Assembler::SwitchToText() {
+  puts("\n\t.text");
+}
+
+void Assembler::SwitchToData() {
+  puts("\n\t.data");
+}
+
+void Assembler::BindWithPowerOfTwoAlignment(const char* name, int power) {
+  AlignToPowerOfTwo(power);
+  Bind("", name);
+}
+
 void Assembler::AlignToPowerOfTwo(int power) {
   printf("\t.p2align %d,0x90\n", power);
 }
@@ -106,6 +100,11 @@ void Assembler::Print(const char* format, ...) {
           break;
         }
 
+        case 's': {
+          printf("%s", va_arg(arguments, const char*));
+          break;
+        }
+
         default: {
           UNREACHABLE();
           break;
@@ -170,6 +169,29 @@ void Assembler::PrintAddress(const Address* address) {
   }
 }
 
+const char* Assembler::ConditionMnemonic(Condition condition) {
+  static const char* kConditionMnemonics[] = {
+      "o",   // OVERFLOW
+      "no",  // NO_OVERFLOW
+      "b",   // BELOW
+      "ae",  // ABOVE_EQUAL
+      "e",   // EQUAL
+      "ne",  // NOT_EQUAL
+      "be",  // BELOW_EQUAL
+      "a",   // ABOVE
+      "s",   // SIGN
+      "ns",  // NOT_SIGN
+      "p",   // PARITY_EVEN
+      "np",  // PARITY_ODD
+      "l",   // LESS
+      "ge",  // GREATER_EQUAL
+      "le",  // LESS_EQUAL
+      "g"    // GREATER
+  };
+  ASSERT(static_cast<unsigned>(condition) < ARRAY_SIZE(kConditionMnemonics));
+  return kConditionMnemonics[condition];
+}
+
 int Assembler::ComputeLabelPosition(Label* label) {
   if (!label->IsBound()) {
     static int labels = 0;
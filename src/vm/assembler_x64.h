@@ -238,57 +238,113 @@ class Assembler {
  public:
   INSTRUCTION_1(pushq, "pushq %rq", Register);
   INSTRUCTION_1(pushq, "pushq %a", const Address&);
+  INSTRUCTION_1(pushq, "pushq %i", const Immediate&);
 
   INSTRUCTION_1(popq, "popq %rq", Register);
   INSTRUCTION_1(popq, "popq %a", const Address&);
 
+  INSTRUCTION_1(notq, "notq %rq", Register);
   INSTRUCTION_1(incq, "incq %rq", Register);
   INSTRUCTION_1(negq, "negq %rq", Register);
+  INSTRUCTION_1(idivq, "idivq %rq", Register);
+
+  INSTRUCTION_1(call, "call *%rq", Register);
+
+  INSTRUCTION_1(jmp, "jmp *%rq", Register);
+  INSTRUCTION_1(jmp, "jmp *%a", const Address&);
 
   INSTRUCTION_2(movl, "movl %i, %rl", Register, const Immediate&);
   INSTRUCTION_2(movl, "movl %a, %rl", Register, const Address&);
   INSTRUCTION_2(movl, "movl %rl, %a", const Address&, Register);
 
   INSTRUCTION_2(movq, "movq %l, %rq", Register, const Immediate&);
+  INSTRUCTION_2(movq, "movq %i, %a", const Address&, const Immediate&);
   INSTRUCTION_2(movq, "movq %rq, %rq", Register, Register);
   INSTRUCTION_2(movq, "movq %a, %rq", Register, const Address&);
   INSTRUCTION_2(movq, "movq %rq, %a", const Address&, Register);
 
-  INSTRUCTION_2(movsxl, "movsxl %a, %rq", Register, const Address&);
+  INSTRUCTION_2(movsxl, "movslq %a, %rq", Register, const Address&);
+  INSTRUCTION_2(movzbl, "movzbl %a, %rl", Register, const Address&);
+
+  INSTRUCTION_2(leaq, "leaq %a, %rq", Register, const Address&);
 
   INSTRUCTION_2(cmpl, "cmpl %i, %rl", Register, const Immediate&);
   INSTRUCTION_2(cmpl, "cmpl %rl, %rl", Register, Register);
 
   INSTRUCTION_2(cmpq, "cmpq %i, %rq", Register, const Immediate&);
+  INSTRUCTION_2(cmpq, "cmpq %i, %a", const Address&, const Immediate&);
   INSTRUCTION_2(cmpq, "cmpq %rq, %rq", Register, Register);
+  INSTRUCTION_2(cmpq, "cmpq %a, %rq", Register, const Address&);
+
+  INSTRUCTION_2(testl, "testl %rl, %rl", Register, Register);
+  INSTRUCTION_2(testq, "testq %rq, %rq", Register, Register);
+  INSTRUCTION_2(testq, "testq %i, %rq", Register, const Immediate&);
 
   INSTRUCTION_2(addl, "addl %rl, %rl", Register, Register);
   INSTRUCTION_2(addl, "addl %i, %a", const Address&, const Immediate&);
 
+  INSTRUCTION_2(addq, "addq %rq, %rq", Register, Register);
   INSTRUCTION_2(addq, "addq %i, %rq", Register, const Immediate&);
   INSTRUCTION_2(addq, "addq %i, %a", const Address&, const Immediate&);
+  INSTRUCTION_2(addq, "addq %a, %rq", Register, const Address&);
 
   INSTRUCTION_2(andq, "andq %i, %rq", Register, const Immediate&);
   INSTRUCTION_2(andq, "andq %rq, %rq", Register, Register);
 
+  INSTRUCTION_2(subq, "subq %rq, %rq", Register, Register);
   INSTRUCTION_2(subq, "subq %i, %rq", Register, const Immediate&);
 
+  INSTRUCTION_2(imulq, "imulq %rq, %rq", Register, Register);
+
+  INSTRUCTION_2(sarq, "sarq %i, %rq", Register, const Immediate&);
+  INSTRUCTION_1(sarq_cl, "sarq %%cl, %rq", Register);
+
+  INSTRUCTION_2(shrl, "shrl %i, %rl", Register, const Immediate&);
+  INSTRUCTION_2(shrq, "shrq %i, %rq", Register, const Immediate&);
+  INSTRUCTION_2(shlq, "shlq %i, %rq", Register, const Immediate&);
+  INSTRUCTION_1(shlq_cl, "shlq %%cl, %rq", Register);
+
+  INSTRUCTION_2(orq, "orq %rq, %rq", Register, Register);
+  INSTRUCTION_2(xorq, "xorq %rq, %rq", Register, Register);
+
+  INSTRUCTION_0(cqo, "cqo");
   INSTRUCTION_0(ret, "ret");
   INSTRUCTION_0(nop, "nop");
   INSTRUCTION_0(int3, "int3");
 
+  void j(Condition condition, const char* name);
   void j(Condition condition, Label* label);
+
+  void call(const char* name);
+
+  void jmp(const char* name);
   void jmp(Label* label);
 
   void Bind(const char* prefix, const char* name);
+  void BindWithPowerOfTwoAlignment(const char* name, int power);
   void Bind(Label* label);
 
+  void DefineQuad(const char* name);
+
+  // Load the address of the global [name] into [reg]. Goes through the
+  // global offset table, so it works for position independent code.
+  void LoadAddress(Register reg, const char* name);
+
+  // Load the native function at [index] into [reg]. [reg] and [index]
+  // must be different registers.
+  void LoadNative(Register reg, Register index);
+
+  void SwitchToText();
+  void SwitchToData();
+
+  // Align what follows to a 2^power address.
+  void AlignToPowerOfTwo(int power);
+
  private:
   void Print(const char* format, ...);
   void PrintAddress(const Address* address);
 
-  // Align what follows to a 2^power address.
-  void AlignToPowerOfTwo(int power);
+  static const char* ConditionMnemonic(Condition condition);
 
   static int ComputeLabelPosition(Label* label);
 
@@ -9,13 +9,32 @@
 
 namespace fletch {
 
+void Assembler::call(const char* name) { printf("\tcall %s\n", name); }
+
+void Assembler::j(Condition condition, const char* name) {
+  const char* mnemonic = ConditionMnemonic(condition);
+  printf("\tj%s %s\n", mnemonic, name);
+}
+
+void Assembler::jmp(const char* name) { printf("\tjmp %s\n", name); }
+
 void Assembler::Bind(const char* prefix, const char* name) {
-  putchar('\n');
-  printf("\t.text\n");
   printf("\t.global %s%s\n", prefix, name);
   printf("%s%s:\n", prefix, name);
 }
 
+void Assembler::DefineQuad(const char* name) { printf("\t.quad %s\n", name); }
+
+void Assembler::LoadAddress(Register reg, const char* name) {
+  Print("movq %s@GOTPCREL(%%rip), %rq", name, reg);
+}
+
+void Assembler::LoadNative(Register reg, Register index) {
+  ASSERT(reg != index);
+  LoadAddress(reg, "kNativeTable");
+  movq(reg, Address(reg, index, TIMES_8));
+}
+
 }  // namespace fletch
 
 #endif  // defined(FLETCH_TARGET_X64) && defined(FLETCH_TARGET_OS_LINUX)
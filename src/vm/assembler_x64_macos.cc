@@ -9,11 +9,37 @@
 
 namespace fletch {
 
+static const char* kPrefix = "_";
+
+void Assembler::call(const char* name) {
+  printf("\tcall %s%s\n", kPrefix, name);
+}
+
+void Assembler::j(Condition condition, const char* name) {
+  const char* mnemonic = ConditionMnemonic(condition);
+  printf("\tj%s %s%s\n", mnemonic, kPrefix, name);
+}
+
+void Assembler::jmp(const char* name) { printf("\tjmp %s%s\n", kPrefix, name); }
+
 void Assembler::Bind(const char* prefix, const char* name) {
   putchar('\n');
-  printf("\t.text\n");
-  printf("\t.globl _%s%s\n", prefix, name);
-  printf("_%s%s:\n", prefix, name);
+  printf("\t.globl %s%s%s\n", kPrefix, prefix, name);
+  printf("%s%s%s:\n", kPrefix, prefix, name);
+}
+
+void Assembler::DefineQuad(const char* name) {
+  printf("\t.quad %s%s\n", kPrefix, name);
+}
+
+void Assembler::LoadAddress(Register reg, const char* name) {
+  Print("movq %s%s@GOTPCREL(%%rip), %rq", kPrefix, name, reg);
+}
+
+void Assembler::LoadNative(Register reg, Register index) {
+  ASSERT(reg != index);
+  LoadAddress(reg, "kNativeTable");
+  movq(reg, Address(reg, index, TIMES_8));
 }
 
 }  // namespace fletch
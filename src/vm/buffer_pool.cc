@@ -0,0 +1,106 @@
+// Copyright (c) 2015, the Fletch project authors. Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE.md file.
+
+#include "src/vm/buffer_pool.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "src/shared/platform.h"
+
+namespace fletch {
+
+Mutex* BufferPool::mutex_ = NULL;
+Atomic<int> BufferPool::size_count_(0);
+BufferPool::SizeClass BufferPool::sizes_[kMaxSizes];
+
+void BufferPool::Setup() { mutex_ = Platform::CreateMutex(); }
+
+void BufferPool::TearDown() {
+  int count = size_count_;
+  for (int i = 0; i < count; i++) {
+    void* slab = sizes_[i].free_list;
+    while (slab != NULL) {
+      void* next = *reinterpret_cast<void**>(slab);
+      free(slab);
+      slab = next;
+    }
+  }
+  size_count_ = 0;
+  delete mutex_;
+  mutex_ = NULL;
+}
+
+bool BufferPool::Register(word size, word max_buffers) {
+  if (size < static_cast<word>(sizeof(void*)) || max_buffers <= 0) {
+    return false;
+  }
+  ScopedLock lock(mutex_);
+  SizeClass* size_class = Find(size);
+  if (size_class == NULL) {
+    int count = size_count_;
+    if (count == kMaxSizes) return false;
+    size_class = &sizes_[count];
+    size_class->size = size;
+    size_class->max_buffers = 0;
+    size_class->count = 0;
+    size_class->free_list = NULL;
+    size_count_ = count + 1;
+  }
+  if (max_buffers > size_class->max_buffers) {
+    size_class->max_buffers = max_buffers;
+  }
+  return true;
+}
+
+void* BufferPool::Allocate(word size) {
+  if (size_count_ > 0) {
+    void* slab = NULL;
+    {
+      ScopedLock lock(mutex_);
+      SizeClass* size_class = Find(size);
+      if (size_class != NULL && size_class->free_list != NULL) {
+        slab = size_class->free_list;
+        size_class->free_list = *reinterpret_cast<void**>(slab);
+        size_class->count--;
+      }
+    }
+    if (slab != NULL) {
+      memset(slab, 0, size);
+      return slab;
+    }
+  }
+  return calloc(1, size);
+}
+
+void BufferPool::Free(void* memory, word size) {
+  if (memory == NULL) return;
+  if (size_count_ > 0) {
+    ScopedLock lock(mutex_);
+    SizeClass* size_class = Find(size);
+    if (size_class != NULL && size_class->count < size_class->max_buffers) {
+      *reinterpret_cast<void**>(memory) = size_class->free_list;
+      size_class->free_list = memory;
+      size_class->count++;
+      return;
+    }
+  }
+  free(memory);
+}
+
+word BufferPool::PooledBuffers(word size) {
+  ScopedLock lock(mutex_);
+  SizeClass* size_class = Find(size);
+  return (size_class == NULL) ? 0 : size_class->count;
+}
+
+BufferPool::SizeClass* BufferPool::Find(word size) {
+  int count = size_count_;
+  for (int i = 0; i < count; i++) {
+    if (sizes_[i].size == size) return &sizes_[i];
+  }
+  return NULL;
+}
+
+}  // namespace fletch
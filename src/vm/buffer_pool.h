@@ -0,0 +1,69 @@
+// Copyright (c) 2015, the Fletch project authors. Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE.md file.
+
+#ifndef SRC_VM_BUFFER_POOL_H_
+#define SRC_VM_BUFFER_POOL_H_
+
+#include "src/shared/atomic.h"
+#include "src/shared/globals.h"
+
+namespace fletch {
+
+class Mutex;
+
+// A VM-wide cache of the zero-initialized memory behind foreign memory
+// objects, such as the buffers of typed data. Memory of a registered size
+// that is freed, explicitly or by a finalizer, is kept as a slab for the next
+// allocation of that size instead of being returned to the C heap. The slabs
+// are shared by all processes, so a connection buffer released by one
+// process can back the next buffer acquired by another.
+//
+// The slabs are ordinary malloc'ed memory, so memory of a registered size
+// may still be released with free() by code that does not know about the
+// pool.
+class BufferPool {
+ public:
+  static const int kMaxSizes = 16;
+
+  static void Setup();
+  static void TearDown();
+
+  // Keep up to [max_buffers] slabs of [size] bytes. Registering a size again
+  // raises its limit to [max_buffers] if that is larger. Returns false if the
+  // size cannot be pooled.
+  static bool Register(word size, word max_buffers);
+
+  // Returns [size] bytes of zero-initialized memory, reusing a slab if one is
+  // available, or NULL if the allocation failed.
+  static void* Allocate(word size);
+
+  // Keeps [memory] of [size] bytes as a slab if its size is registered and
+  // the pool for that size is not full, and frees it otherwise.
+  static void Free(void* memory, word size);
+
+  // The number of slabs of [size] bytes ready for reuse.
+  static word PooledBuffers(word size);
+
+ private:
+  struct SizeClass {
+    word size;
+    word max_buffers;
+    word count;
+    // Slabs are linked through their first word.
+    void* free_list;
+  };
+
+  static SizeClass* Find(word size);
+
+  static Mutex* mutex_;
+  // Only sizes in [0, size_count_) of [sizes_] are registered. The count is
+  // read without the lock so that allocations skip the pool when no size has
+  // been registered.
+  static Atomic<int> size_count_;
+  static SizeClass sizes_[kMaxSizes];
+};
+
+}  // namespace fletch
+
+#endif  // SRC_VM_BUFFER_POOL_H_
@@ -0,0 +1,51 @@
+// Copyright (c) 2015, the Fletch project authors. Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE.md file.
+
+#include <string.h>
+
+#include "src/shared/assert.h"
+#include "src/shared/test_case.h"
+
+#include "src/vm/buffer_pool.h"
+
+namespace fletch {
+
+// Sizes no other test allocates, so the counts below are exact.
+static const word kSlabSize = 3 * 1024 + 8;
+static const word kOtherSize = 5 * 1024 + 8;
+
+TEST_CASE(BufferPool_Recycle) {
+  EXPECT(!BufferPool::Register(1, 4));
+  EXPECT(!BufferPool::Register(kSlabSize, 0));
+  EXPECT(BufferPool::Register(kSlabSize, 1));
+  EXPECT_EQ(0, BufferPool::PooledBuffers(kSlabSize));
+
+  uint8* first = reinterpret_cast<uint8*>(BufferPool::Allocate(kSlabSize));
+  uint8* second = reinterpret_cast<uint8*>(BufferPool::Allocate(kSlabSize));
+  memset(first, 0xff, kSlabSize);
+
+  // Only one slab is kept; the second is freed.
+  BufferPool::Free(first, kSlabSize);
+  BufferPool::Free(second, kSlabSize);
+  EXPECT_EQ(1, BufferPool::PooledBuffers(kSlabSize));
+
+  // The slab is reused and cleared.
+  uint8* reused = reinterpret_cast<uint8*>(BufferPool::Allocate(kSlabSize));
+  EXPECT_EQ(first, reused);
+  EXPECT_EQ(0, BufferPool::PooledBuffers(kSlabSize));
+  for (word i = 0; i < kSlabSize; i++) EXPECT_EQ(0, reused[i]);
+
+  // Registering again raises the limit.
+  EXPECT(BufferPool::Register(kSlabSize, 2));
+  void* third = BufferPool::Allocate(kSlabSize);
+  BufferPool::Free(reused, kSlabSize);
+  BufferPool::Free(third, kSlabSize);
+  EXPECT_EQ(2, BufferPool::PooledBuffers(kSlabSize));
+
+  // Memory of unregistered sizes is not pooled.
+  BufferPool::Free(BufferPool::Allocate(kOtherSize), kOtherSize);
+  EXPECT_EQ(0, BufferPool::PooledBuffers(kOtherSize));
+}
+
+}  // namespace fletch
@@ -0,0 +1,606 @@
+// Copyright (c) 2015, the Fletch project authors. Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE.md file.
+
+#include "src/vm/checkpoint.h"
+
+#include <string.h>
+
+#include "src/shared/assert.h"
+#include "src/shared/platform.h"
+#include "src/shared/version.h"
+
+#include "src/vm/object.h"
+#include "src/vm/port.h"
+#include "src/vm/process.h"
+#include "src/vm/program.h"
+#include "src/vm/storebuffer.h"
+
+namespace fletch {
+
+static const uint8 kCheckpointMagic[] = {0xbe, 0xec};
+
+class ProgramObjectTableBuilder : public PointerVisitor {
+ public:
+  ProgramObjectTableBuilder(ProgramObjectTable* table, Space* program_space)
+      : table_(table), program_space_(program_space) {}
+
+  void VisitBlock(Object** start, Object** end) {
+    for (Object** p = start; p < end; p++) {
+      Object* object = *p;
+      if (!object->IsHeapObject()) continue;
+      HeapObject* heap_object = HeapObject::cast(object);
+      // Dispatch table intrinsics are code addresses that can look like heap
+      // objects.
+      if (!program_space_->Includes(heap_object->address())) continue;
+      table_->Add(heap_object);
+    }
+  }
+
+ private:
+  ProgramObjectTable* table_;
+  Space* program_space_;
+};
+
+ProgramObjectTable::ProgramObjectTable(Program* program) {
+  ASSERT(program->is_compact());
+  ProgramObjectTableBuilder builder(this, program->heap()->space());
+  Object* roots[] = {program->entry(),          program->classes(),
+                     program->constants(),      program->static_methods(),
+                     program->static_fields(),  program->dispatch_table()};
+  int count = sizeof(roots) / sizeof(roots[0]);
+  builder.VisitBlock(&roots[0], &roots[count]);
+  program->IterateRootsIgnoringSession(&builder);
+
+  // Number the objects breadth first.
+  for (int i = 0; i < length(); i++) {
+    at(i)->IteratePointers(&builder);
+  }
+}
+
+int ProgramObjectTable::IndexOf(HeapObject* object) {
+  HashMap<HeapObject*, int>::Iterator it = indices_.Find(object);
+  if (it == indices_.End()) return -1;
+  return it->second;
+}
+
+void ProgramObjectTable::Add(HeapObject* object) {
+  if (indices_.Find(object) != indices_.End()) return;
+  indices_[object] = objects_.size();
+  objects_.PushBack(object);
+}
+
+// Tells the slots of a stack apart, from the top down. Each frame pointer
+// slot holds the address of the frame pointer slot of the calling frame, or
+// NULL for the bottom frame. The slot below a frame pointer slot holds the
+// bytecode pointer of its frame. All other slots hold objects.
+class StackSlotIterator {
+ public:
+  enum Kind { kObject, kFramePointer, kBytecodePointer };
+
+  explicit StackSlotIterator(word top) : index_(top), frame_pointer_(top) {}
+
+  word index() const { return index_; }
+
+  // The slots must be visited in increasing order.
+  Kind Next() {
+    ASSERT(frame_pointer_ < 0 || index_ <= frame_pointer_);
+    word index = index_++;
+    if (index == frame_pointer_) return kFramePointer;
+    if (index == frame_pointer_ - 1) return kBytecodePointer;
+    return kObject;
+  }
+
+  // Continue the frame chain at the frame pointer slot at [index], or end it
+  // if [index] is -1. Must be called after visiting a frame pointer slot.
+  void SetFramePointer(word index) {
+    ASSERT(index == -1 || index - 1 >= index_);
+    frame_pointer_ = index;
+  }
+
+ private:
+  word index_;
+  word frame_pointer_;
+};
+
+static word FramePointerIndex(Stack* stack, Object* value) {
+  if (value == NULL) return -1;
+  return reinterpret_cast<Object**>(value) - stack->Pointer(0);
+}
+
+void Stack::StackWriteTo(SnapshotWriter* writer, Class* klass) {
+  // Header.
+  writer->WriteHeader(InstanceFormat::STACK_TYPE, length());
+  writer->Forward(this);
+  // Body. Frame pointers are written as indices and bytecode pointers as
+  // a function and an offset, so they can be relocated.
+  writer->WriteInt64(top());
+  StackSlotIterator slots(top());
+  while (slots.index() < length()) {
+    Object* value = get(slots.index());
+    switch (slots.Next()) {
+      case StackSlotIterator::kFramePointer: {
+        word index = FramePointerIndex(this, value);
+        writer->WriteInt64(index);
+        slots.SetFramePointer(index);
+        break;
+      }
+      case StackSlotIterator::kBytecodePointer: {
+        uint8* bcp = reinterpret_cast<uint8*>(value);
+        if (bcp == NULL) {
+          writer->WriteObject(Smi::zero());
+          break;
+        }
+        Function* function = Function::FromBytecodePointer(bcp);
+        writer->WriteObject(function);
+        writer->WriteInt64(bcp - function->bytecode_address_for(0));
+        break;
+      }
+      case StackSlotIterator::kObject:
+        writer->WriteObject(value);
+        break;
+    }
+  }
+}
+
+void Stack::StackReadFrom(SnapshotReader* reader, int length) {
+  set_length(length);
+  set_next(Smi::zero());
+  word top = reader->ReadInt64();
+  set_top(top);
+  for (word i = 0; i < top; i++) set(i, NULL);
+  StackSlotIterator slots(top);
+  while (slots.index() < length) {
+    word index = slots.index();
+    switch (slots.Next()) {
+      case StackSlotIterator::kFramePointer: {
+        word frame_pointer = reader->ReadInt64();
+        Object** address = (frame_pointer < 0) ? NULL : Pointer(frame_pointer);
+        set(index, reinterpret_cast<Object*>(address));
+        slots.SetFramePointer(frame_pointer);
+        break;
+      }
+      case StackSlotIterator::kBytecodePointer: {
+        Object* function = reader->ReadObject();
+        uint8* bcp = NULL;
+        if (function != Smi::zero()) {
+          int offset = reader->ReadInt64();
+          bcp = Function::cast(function)->bytecode_address_for(offset);
+        }
+        set(index, reinterpret_cast<Object*>(bcp));
+        break;
+      }
+      case StackSlotIterator::kObject:
+        set(index, reader->ReadObject());
+        break;
+    }
+  }
+}
+
+class CheckpointCollector : public PointerVisitor {
+ public:
+  explicit CheckpointCollector(CheckpointWriter* writer) : writer_(writer) {}
+
+  void VisitBlock(Object** start, Object** end) {
+    for (Object** p = start; p < end; p++) writer_->Collect(*p);
+  }
+
+  // Visits the objects on [stack], skipping frame pointers and bytecode
+  // pointers.
+  void VisitStack(Stack* stack) {
+    StackSlotIterator slots(stack->top());
+    while (slots.index() < stack->length()) {
+      Object* value = stack->get(slots.index());
+      StackSlotIterator::Kind kind = slots.Next();
+      if (kind == StackSlotIterator::kFramePointer) {
+        slots.SetFramePointer(FramePointerIndex(stack, value));
+      } else if (kind == StackSlotIterator::kObject) {
+        writer_->Collect(value);
+      }
+    }
+  }
+
+ private:
+  CheckpointWriter* writer_;
+};
+
+CheckpointWriter::CheckpointWriter(Program* program)
+    : SnapshotWriter(&function_offsets_, &class_offsets_),
+      program_(program),
+      table_(program) {}
+
+int CheckpointWriter::ReferenceIndexFor(HeapObject* object) {
+  if (!program_->heap()->space()->Includes(object->address())) return -1;
+  int index = table_.IndexOf(object);
+  if (index < 0) FATAL("Checkpoint refers to an unknown program object.");
+  return index;
+}
+
+void CheckpointWriter::Collect(Object* object) {
+  if (!object->IsHeapObject()) return;
+  HeapObject* heap_object = HeapObject::cast(object);
+  if (program_->heap()->space()->Includes(heap_object->address())) return;
+  if (collected_.Insert(heap_object).second) objects_.PushBack(heap_object);
+}
+
+void CheckpointWriter::CollectProcess(Process* process) {
+  size_t first = objects_.size();
+  CheckpointCollector collector(this);
+  Collect(process->statics());
+  Collect(process->coroutine());
+  Collect(process->exception());
+  for (Port* port = process->ports(); port != NULL; port = port->next()) {
+    Collect(port->channel());
+  }
+  for (Message* message = process->mailbox()->AllMessages(); message != NULL;
+       message = message->next()) {
+    message->VisitPointers(&collector);
+  }
+
+  for (size_t i = first; i < objects_.size(); i++) {
+    HeapObject* object = objects_[i];
+    if (object->IsStack()) {
+      collector.VisitStack(Stack::cast(object));
+    } else {
+      object->IteratePointers(&collector);
+    }
+  }
+}
+
+// Exit and clone messages carry a heap of their own, which is not part of
+// the checkpoint.
+static bool HasMessageHeap(Process* process) {
+  for (Message* message = process->mailbox()->AllMessages(); message != NULL;
+       message = message->next()) {
+    if (message->HasExitReference()) return true;
+  }
+  return false;
+}
+
+List<uint8> CheckpointWriter::WriteProcesses(Process** processes, int count) {
+  for (int i = 0; i < count; i++) {
+    if (processes[i]->message_arena() != NULL) return List<uint8>();
+    if (HasMessageHeap(processes[i])) return List<uint8>();
+  }
+
+  // Objects outside the heap of a process are immutable. They are written
+  // ahead of all processes, since more than one process may refer to them.
+  for (int i = 0; i < count; i++) {
+    Process* process = processes[i];
+    ASSERT(process->state() == Process::kReady ||
+           process->state() == Process::kSleeping);
+    size_t first = objects_.size();
+    CollectProcess(process);
+    Space* space = process->heap()->space();
+    for (size_t j = first; j < objects_.size(); j++) {
+      HeapObject* object = objects_[j];
+      if (!space->Includes(object->address())) shared_.PushBack(object);
+    }
+  }
+
+  WriteBytes(sizeof(kCheckpointMagic), kCheckpointMagic);
+
+  const char* version = GetVersion();
+  int version_length = strlen(version);
+  WriteInt64(version_length);
+  WriteBytes(version_length, reinterpret_cast<const uint8*>(version));
+
+  WriteInt64(table_.length());
+  int reference_count_position = ReserveReferenceCount();
+
+  // Write the shared section.
+  int heap_size_position = ReserveHeapSizes();
+  PortableOffset start(heap_size_);
+  WriteInt64(shared_.size());
+  for (size_t i = 0; i < shared_.size(); i++) WriteObject(shared_[i]);
+  WriteHeapSizes(heap_size_position, start);
+
+  // Write a section for each process. Parents are restored before their
+  // children, if they are part of the checkpoint.
+  WriteInt64(count);
+  for (int i = 0; i < count; i++) {
+    int parent = -1;
+    for (int j = 0; j < i; j++) {
+      if (processes[j] == processes[i]->parent()) parent = j;
+    }
+    WriteProcess(processes[i], parent);
+  }
+
+  WriteReferenceCount(reference_count_position);
+  for (size_t i = 0; i < objects_.size(); i++) Unforward(objects_[i]);
+  return snapshot_.Sublist(0, position_);
+}
+
+// Gathers and death signals refer to state that is not part of the
+// checkpoint. They are dropped. Exit and clone messages never get here, see
+// [HasMessageHeap].
+static bool IsCheckpointed(Message* message) {
+  switch (message->kind()) {
+    case Message::IMMEDIATE:
+    case Message::IMMUTABLE_OBJECT:
+    case Message::LARGE_INTEGER:
+    case Message::FOREIGN:
+    case Message::FOREIGN_FINALIZED:
+      return true;
+    default:
+      return false;
+  }
+}
+
+List<uint8> CheckpointWriter::WriteAllProcesses() {
+  Vector<Process*> processes;
+  for (Process* process = program_->FirstProcess(); process != NULL;
+       process = program_->NextProcess(process)) {
+    Process::State state = process->state();
+    if (state == Process::kReady || state == Process::kSleeping) {
+      processes.PushBack(process);
+    }
+  }
+  return WriteProcesses(processes.Data(), processes.size());
+}
+
+void CheckpointWriter::WriteProcess(Process* process, int parent) {
+  int heap_size_position = ReserveHeapSizes();
+  PortableOffset start(heap_size_);
+  WriteInt64(parent);
+  WriteInt64(process->state() == Process::kReady ? 1 : 0);
+  WriteInt64(reinterpret_cast<uword>(process->process_handle()));
+  WriteObject(process->statics());
+  WriteObject(process->coroutine());
+  WriteObject(process->exception());
+
+  HashMap<Port*, int> port_indices;
+  int port_count = 0;
+  for (Port* port = process->ports(); port != NULL; port = port->next()) {
+    port_indices[port] = port_count++;
+  }
+  WriteInt64(port_count);
+  for (Port* port = process->ports(); port != NULL; port = port->next()) {
+    WriteInt64(reinterpret_cast<uword>(port));
+    WriteObject(port->channel());
+    WriteInt64(port->gather_count());
+  }
+
+  int message_count = 0;
+  Message* messages = process->mailbox()->AllMessages();
+  for (Message* message = messages; message != NULL;
+       message = message->next()) {
+    if (IsCheckpointed(message)) message_count++;
+  }
+  WriteInt64(message_count);
+  for (Message* message = messages; message != NULL;
+       message = message->next()) {
+    if (!IsCheckpointed(message)) continue;
+    Message::Kind kind = message->kind();
+    WriteInt64(port_indices[message->port()]);
+    WriteInt64(kind);
+    switch (kind) {
+      case Message::IMMEDIATE:
+      case Message::IMMUTABLE_OBJECT:
+        WriteObject(reinterpret_cast<Object*>(message->value()));
+        break;
+      case Message::LARGE_INTEGER:
+        WriteInt64(message->value());
+        break;
+      default:
+        // The foreign memory is not part of the checkpoint.
+        break;
+    }
+  }
+  WriteHeapSizes(heap_size_position, start);
+}
+
+CheckpointReader::CheckpointReader(Program* program, List<uint8> checkpoint)
+    : SnapshotReader(checkpoint),
+      program_(program),
+      table_(program),
+      section_size_(0) {}
+
+bool CheckpointReader::IsCheckpoint(List<uint8> bytes) {
+  return bytes.length() > 2 && bytes[0] == kCheckpointMagic[0] &&
+         bytes[1] == kCheckpointMagic[1];
+}
+
+HeapObject* CheckpointReader::ReferenceAt(int index) {
+  ASSERT(index < table_.length());
+  return table_.at(index);
+}
+
+void CheckpointReader::ReadProcesses() {
+  if (!IsCheckpoint(snapshot_)) {
+    Print::Error("Error: Checkpoint has wrong magic header!\n");
+    Platform::Exit(-1);
+  }
+  position_ += sizeof(kCheckpointMagic);
+
+  const char* version = GetVersion();
+  int version_length = strlen(version);
+  int checkpoint_version_length = ReadInt64();
+  uint8* checkpoint_version = new uint8[checkpoint_version_length];
+  ReadBytes(checkpoint_version_length, checkpoint_version);
+  bool same_version =
+      (version_length == checkpoint_version_length) &&
+      (strncmp(version, reinterpret_cast<char*>(checkpoint_version),
+               checkpoint_version_length) == 0);
+  delete[] checkpoint_version;
+  if (!same_version || ReadInt64() != table_.length()) {
+    Print::Error("Error: Checkpoint and program do not agree.\n");
+    Platform::Exit(-1);
+  }
+
+  ReadReferenceCount();
+  large_integer_class_ = program_->large_integer_class();
+
+  Space* shared_space = program_->shared_heap()->heap()->space();
+  BeginSection(shared_space, ReadHeapSize());
+  int shared_count = ReadInt64();
+  for (int i = 0; i < shared_count; i++) ReadObject();
+  EndSection(shared_space);
+
+  int process_count = ReadInt64();
+  for (int i = 0; i < process_count; i++) ReadProcess();
+
+  FixupExternalReferences();
+  backward_references_.Delete();
+}
+
+void CheckpointReader::ReadProcess() {
+  int heap_size = ReadHeapSize();
+  int parent = ReadInt64();
+  bool ready = ReadInt64() != 0;
+  uword handle = ReadInt64();
+  Process* process =
+      program_->SpawnProcess((parent < 0) ? NULL : processes_[parent]);
+  processes_.PushBack(process);
+  handles_[handle] = process;
+
+  Space* space = process->heap()->space();
+  BeginSection(space, heap_size);
+  process->statics_ = Array::cast(ReadObject());
+  Coroutine* coroutine = Coroutine::cast(ReadObject());
+  process->set_exception(ReadObject());
+
+  // Creating ports requires the process to be attached to this thread.
+  ThreadState thread_state;
+  thread_state.AttachToCurrentThread();
+  process->set_thread_state(&thread_state);
+  Vector<Port*> ports;
+  int port_count = ReadInt64();
+  for (int i = 0; i < port_count; i++) {
+    uword address = ReadInt64();
+    Instance* channel = reinterpret_cast<Instance*>(ReadObject());
+    int gather_count = ReadInt64();
+    Port* port = (gather_count == 0)
+                     ? new Port(process, channel)
+                     : new Port(process, channel, gather_count);
+    ports_[address] = port;
+    ports.PushBack(port);
+  }
+  process->set_thread_state(NULL);
+
+  MessageMailbox* mailbox = process->mailbox();
+  int message_count = ReadInt64();
+  for (int i = 0; i < message_count; i++) {
+    Port* port = ports[ReadInt64()];
+    switch (static_cast<Message::Kind>(ReadInt64())) {
+      case Message::IMMEDIATE:
+      case Message::IMMUTABLE_OBJECT:
+        mailbox->Enqueue(port, ReadObject());
+        break;
+      case Message::LARGE_INTEGER:
+        mailbox->EnqueueLargeInteger(port, ReadInt64());
+        break;
+      case Message::FOREIGN:
+      case Message::FOREIGN_FINALIZED:
+        mailbox->EnqueueForeign(port, NULL, 0, false);
+        break;
+      default:
+        UNREACHABLE();
+    }
+  }
+  EndSection(space);
+
+  process->UpdateCoroutine(coroutine);
+  RecordImmutablePointers(process);
+  if (ready && !process->ChangeState(Process::kSleeping, Process::kReady)) {
+    UNREACHABLE();
+  }
+}
+
+void CheckpointReader::BeginSection(Space* space, int size) {
+  section_size_ = size;
+  memory_ = NULL;
+  top_ = 0;
+  if (size == 0) return;
+  // Leave room for the chunk end sentinel.
+  memory_ = ObjectMemory::AllocateChunk(space, size + kPointerSize);
+  if (memory_ == NULL) FATAL1("Failed to allocate %d bytes.\n", size);
+  top_ = memory_->base();
+}
+
+void CheckpointReader::EndSection(Space* space) {
+  if (memory_ == NULL) return;
+  int consumed_memory = top_ - memory_->base();
+  if (consumed_memory != section_size_) {
+    FATAL("The heap size in the checkpoint was incorrect.");
+  }
+  space->Flush();
+  space->AppendProgramChunk(memory_, top_);
+}
+
+void CheckpointReader::RecordImmutablePointers(Process* process) {
+  if (memory_ == NULL) return;
+  FindImmutablePointerVisitor finder(process->heap()->space(),
+                                     program_->heap()->space());
+  for (uword address = memory_->base(); address < top_;) {
+    HeapObject* object = HeapObject::FromAddress(address);
+    if (finder.ContainsImmutablePointer(object)) {
+      process->store_buffer()->Insert(object);
+    }
+    address += object->Size();
+  }
+}
+
+void CheckpointReader::FixupExternalReferences() {
+  Class* port_class = program_->port_class();
+  Class* process_class = program_->process_class();
+  Class* foreign_memory_class = program_->foreign_memory_class();
+  HashSet<Port*> referenced_ports;
+
+  for (int i = 0; i < index_; i++) {
+    HeapObject* object = backward_references_[i];
+    Class* klass = object->get_class();
+    if (klass == port_class) {
+      Instance* instance = Instance::cast(object);
+      uword address = Smi::cast(instance->GetInstanceField(0))->value() << 2;
+      HashMap<uword, Port*>::Iterator it = ports_.Find(address);
+      if (it == ports_.End()) {
+        // The process owning the port was not restored.
+        instance->SetInstanceField(0, Smi::zero());
+        continue;
+      }
+      Port* port = it->second;
+      if (!referenced_ports.Insert(port).second) port->IncrementRef();
+      uword port_address = reinterpret_cast<uword>(port);
+      instance->SetInstanceField(0, Smi::FromWord(port_address >> 2));
+      HeapFor(object)->AddWeakPointer(object, Port::WeakCallback);
+    } else if (klass == process_class) {
+      Instance* instance = Instance::cast(object);
+      uword address = Smi::cast(instance->GetInstanceField(0))->value() << 2;
+      HashMap<uword, Process*>::Iterator it = handles_.Find(address);
+      ProcessHandle* handle;
+      if (it == handles_.End()) {
+        handle = new ProcessHandle(NULL);
+      } else {
+        handle = it->second->process_handle();
+        handle->IncrementRef();
+      }
+      handle->InitializeDartObject(instance);
+      HeapFor(object)->AddWeakPointer(object, Process::FinalizeProcess);
+    } else if (klass == foreign_memory_class) {
+      Instance* instance = Instance::cast(object);
+      instance->SetConsecutiveSmis(0, 0);
+      instance->SetInstanceField(2, Smi::zero());
+    }
+  }
+
+  // The ports that are not referenced by any object are only kept alive by
+  // the process until it cleans up its ports.
+  for (HashMap<uword, Port*>::Iterator it = ports_.Begin(); it != ports_.End();
+       ++it) {
+    Port* port = it->second;
+    if (referenced_ports.Find(port) == referenced_ports.End()) {
+      port->DecrementRef();
+    }
+  }
+}
+
+Heap* CheckpointReader::HeapFor(HeapObject* object) {
+  for (size_t i = 0; i < processes_.size(); i++) {
+    Heap* heap = processes_[i]->heap();
+    if (heap->space()->Includes(object->address())) return heap;
+  }
+  return program_->shared_heap()->heap();
+}
+
+}  // namespace fletch
@@ -0,0 +1,137 @@
+// Copyright (c) 2015, the Fletch project authors. Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE.md file.
+
+#ifndef SRC_VM_CHECKPOINT_H_
+#define SRC_VM_CHECKPOINT_H_
+
+#include "src/shared/globals.h"
+#include "src/shared/list.h"
+
+#include "src/vm/hash_map.h"
+#include "src/vm/hash_set.h"
+#include "src/vm/snapshot.h"
+#include "src/vm/vector.h"
+
+namespace fletch {
+
+class Heap;
+class Port;
+class Process;
+class Program;
+
+// Numbers the objects of a compact program in an order that only depends on
+// the contents of the program. A checkpoint refers to program objects by
+// their number, so it can be restored into another VM that loaded the same
+// program snapshot.
+class ProgramObjectTable {
+ public:
+  explicit ProgramObjectTable(Program* program);
+
+  int length() const { return objects_.size(); }
+  HeapObject* at(int index) { return objects_[index]; }
+
+  // Returns the number of [object], or -1 if it is not in the table.
+  int IndexOf(HeapObject* object);
+
+ private:
+  friend class ProgramObjectTableBuilder;
+
+  void Add(HeapObject* object);
+
+  Vector<HeapObject*> objects_;
+  HashMap<HeapObject*, int> indices_;
+};
+
+// Writes the heaps, stacks and mailboxes of processes to a checkpoint. The
+// objects are encoded like in a program snapshot, except that objects of the
+// program are referred to through the [ProgramObjectTable]. The immutable
+// objects reachable from the processes are written to a section of their
+// own, which is restored into the shared heap.
+//
+// The program must be stopped (see [Scheduler::StopProgram]) and the
+// processes must be ready or sleeping while the checkpoint is written.
+class CheckpointWriter : public SnapshotWriter {
+ public:
+  explicit CheckpointWriter(Program* program);
+
+  // Returns an empty list if one of the processes is building a message in
+  // its message arena, since the arena objects are neither immutable nor in
+  // the heap of the process until the message is sent. The same goes for a
+  // process with an exit or clone message in its mailbox, whose objects are
+  // in a heap of the message until it is received.
+  List<uint8> WriteProcesses(Process** processes, int count);
+
+  // Writes all processes of the program that are ready or sleeping.
+  List<uint8> WriteAllProcesses();
+
+ protected:
+  virtual int ReferenceIndexFor(HeapObject* object);
+
+ private:
+  friend class CheckpointCollector;
+
+  void Collect(Object* object);
+  void CollectProcess(Process* process);
+  void WriteProcess(Process* process, int parent);
+
+  Program* const program_;
+  ProgramObjectTable table_;
+  FunctionOffsetsType function_offsets_;
+  ClassOffsetsType class_offsets_;
+
+  // All objects written to the checkpoint, and the ones among them that are
+  // not in the heap of a process.
+  HashSet<HeapObject*> collected_;
+  Vector<HeapObject*> objects_;
+  Vector<HeapObject*> shared_;
+};
+
+// Restores the processes of a checkpoint into a program loaded from the
+// snapshot the checkpoint was written against. Resources outside the heap
+// do not survive the restart:
+//
+//   * foreign memory has its address and length cleared and must be
+//     initialized again,
+//   * ports and process handles of processes that were not restored are
+//     dead,
+//   * links, monitors and the contributions of gather ports are dropped.
+class CheckpointReader : public SnapshotReader {
+ public:
+  CheckpointReader(Program* program, List<uint8> checkpoint);
+
+  static bool IsCheckpoint(List<uint8> bytes);
+
+  // Restores all processes. The ones that were ready to run when the
+  // checkpoint was written are in state kReady, the others are sleeping.
+  void ReadProcesses();
+
+  int process_count() const { return processes_.size(); }
+  Process** processes() { return processes_.Data(); }
+
+ protected:
+  virtual HeapObject* ReferenceAt(int index);
+
+ private:
+  void ReadProcess();
+  void BeginSection(Space* space, int size);
+  void EndSection(Space* space);
+  void RecordImmutablePointers(Process* process);
+  void FixupExternalReferences();
+  Heap* HeapFor(HeapObject* object);
+
+  Program* const program_;
+  ProgramObjectTable table_;
+  int section_size_;
+
+  Vector<Process*> processes_;
+
+  // The ports and process handles of the checkpoint by their address in the
+  // VM that wrote it.
+  HashMap<uword, Port*> ports_;
+  HashMap<uword, Process*> handles_;
+};
+
+}  // namespace fletch
+
+#endif  // SRC_VM_CHECKPOINT_H_
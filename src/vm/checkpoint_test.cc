@@ -0,0 +1,138 @@
+// Copyright (c) 2015, the Fletch project authors. Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE.md file.
+
+#ifdef FLETCH_ENABLE_LIVE_CODING
+
+#include "src/shared/bytecodes.h"
+#include "src/shared/test_case.h"
+
+#include "src/vm/checkpoint.h"
+#include "src/vm/frame.h"
+#include "src/vm/message_mailbox.h"
+#include "src/vm/object.h"
+#include "src/vm/port.h"
+#include "src/vm/process.h"
+#include "src/vm/program.h"
+#include "src/vm/program_folder.h"
+#include "src/vm/test_program.h"
+
+namespace fletch {
+
+static uint8 kEntryBytecodes[] = {
+  kLoadLiteral0,                            // 0
+  kReturn, 1,                               // 1
+};
+
+TEST_CASE(Checkpoint_RoundTrip) {
+  TestProgram test(1);
+  Program* program = test.program();
+  program->set_entry(
+      test.CreateFunction(kEntryBytecodes, sizeof(kEntryBytecodes)));
+  ProgramFolder folder(program);
+  folder.Fold();
+
+  Process* process = program->ProcessSpawnForMain();
+  Array* array = Array::cast(process->NewArray(3));
+  array->set(0, array);
+  array->set(1, program->entry());
+  array->set(2, process->NewBoxed(array));
+  process->statics()->set(0, array);
+
+  CheckpointWriter writer(program);
+  List<uint8> checkpoint = writer.WriteProcesses(&process, 1);
+  EXPECT(CheckpointReader::IsCheckpoint(checkpoint));
+  EXPECT(process->statics()->get(0) == array);
+  EXPECT(array->get_class() == program->array_class());
+
+  CheckpointReader reader(program, checkpoint);
+  reader.ReadProcesses();
+  checkpoint.Delete();
+  EXPECT_EQ(1, reader.process_count());
+  Process* restored = reader.processes()[0];
+  EXPECT_EQ(Process::kSleeping, restored->state());
+
+  // Objects of the process are copied, program objects are shared.
+  Array* restored_array = Array::cast(restored->statics()->get(0));
+  EXPECT(restored_array != array);
+  EXPECT(restored_array->get(0) == restored_array);
+  EXPECT(restored_array->get(1) == program->entry());
+  Boxed* restored_boxed = Boxed::cast(restored_array->get(2));
+  EXPECT(restored_boxed != array->get(2));
+  EXPECT(restored_boxed->value() == restored_array);
+
+  // The frames are relocated to the new stack.
+  Stack* stack = restored->stack();
+  EXPECT(stack != process->stack());
+  EXPECT_EQ(process->stack()->top(), stack->top());
+  Frame frame(stack);
+  EXPECT(frame.MovePrevious());
+  EXPECT(frame.ByteCodePointer() == program->entry()->bytecode_address_for(0));
+  EXPECT(!frame.MovePrevious());
+
+  test.DeleteProcess(restored);
+  test.DeleteProcess(process);
+}
+
+TEST_CASE(Checkpoint_OpenMessageArena) {
+  TestProgram test(1);
+  Program* program = test.program();
+  program->set_entry(
+      test.CreateFunction(kEntryBytecodes, sizeof(kEntryBytecodes)));
+  ProgramFolder folder(program);
+  folder.Fold();
+
+  // A process stopped while building a message is not checkpointed.
+  Process* process = program->ProcessSpawnForMain();
+  process->OpenMessageArena();
+  CheckpointWriter refused(program);
+  EXPECT(refused.WriteProcesses(&process, 1).is_empty());
+
+  process->CloseMessageArena(program->shared_heap()->heap());
+  CheckpointWriter writer(program);
+  List<uint8> checkpoint = writer.WriteProcesses(&process, 1);
+  EXPECT(CheckpointReader::IsCheckpoint(checkpoint));
+  checkpoint.Delete();
+
+  test.DeleteProcess(process);
+}
+
+#ifdef FLETCH_ENABLE_MULTIPLE_PROCESS_HEAPS
+
+TEST_CASE(Checkpoint_CloneMessage) {
+  TestProgram test(1);
+  Program* program = test.program();
+  program->set_entry(
+      test.CreateFunction(kEntryBytecodes, sizeof(kEntryBytecodes)));
+  ProgramFolder folder(program);
+  folder.Fold();
+
+  Process* process = program->ProcessSpawnForMain();
+  ThreadState thread_state;
+  thread_state.AttachToCurrentThread();
+  process->set_thread_state(&thread_state);
+  Port* port = new Port(process, NULL);
+  MessageMailbox* mailbox = process->mailbox();
+
+  // The copy in a clone message would be lost, so a process that has one
+  // is not checkpointed.
+  ExitReference* reference =
+      ExitReference::CloneMessage(process, process->NewArray(1));
+  EXPECT(reference != NULL);
+  uint64 address = reinterpret_cast<uint64>(reference);
+  mailbox->EnqueueEntry(new Message(port, address, 0, Message::CLONE));
+  CheckpointWriter writer(program);
+  EXPECT(writer.WriteProcesses(&process, 1).is_empty());
+
+  EXPECT_EQ(Message::CLONE, mailbox->CurrentMessage()->kind());
+  mailbox->AdvanceCurrentMessage();
+  port->DecrementRef();
+  process->set_thread_state(NULL);
+  test.DeleteProcess(process);
+}
+
+#endif  // FLETCH_ENABLE_MULTIPLE_PROCESS_HEAPS
+
+}  // namespace fletch
+
+#endif  // FLETCH_ENABLE_LIVE_CODING
@@ -0,0 +1,95 @@
+// Copyright (c) 2015, the Fletch project authors. Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE.md file.
+
+#include "src/vm/clock.h"
+
+#include "src/shared/flags.h"
+#include "src/shared/platform.h"
+
+#if (defined(FLETCH_TARGET_IA32) || defined(FLETCH_TARGET_X64)) && \
+    defined(__GNUC__)
+#define FLETCH_HAS_CYCLE_COUNTER
+#include <cpuid.h>
+#endif
+
+namespace fletch {
+
+static const uint64 kMicrosecondsPerSecond = 1000000;
+
+// The cycle counter is calibrated by comparing it to the monotonic clock over
+// this interval.
+static const uint64 kCalibrationMicroseconds = 5000;
+
+bool Clock::use_cycle_counter_ = false;
+uint64 Clock::ticks_per_second_ = kMicrosecondsPerSecond;
+uint64 Clock::ticks_at_setup_ = 0;
+Atomic<uint64> Clock::coarse_microseconds_(0);
+
+#if defined(FLETCH_HAS_CYCLE_COUNTER)
+
+static inline uint64 ReadCycleCounter() {
+  uint32 low;
+  uint32 high;
+  asm volatile("rdtsc" : "=a"(low), "=d"(high));
+  return (static_cast<uint64>(high) << 32) | low;
+}
+
+// The counter can only be used as a clock if it ticks at a constant rate
+// independent of frequency scaling and sleep states.
+static bool HasInvariantCycleCounter() {
+  unsigned int eax, ebx, ecx, edx;
+  if (__get_cpuid(0x80000000, &eax, &ebx, &ecx, &edx) == 0) return false;
+  if (eax < 0x80000007) return false;
+  __get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx);
+  return (edx & (1 << 8)) != 0;
+}
+
+static uint64 CalibrateCycleCounter() {
+  uint64 start = Platform::GetMonotonicMicroseconds();
+  uint64 start_cycles = ReadCycleCounter();
+  uint64 end;
+  do {
+    end = Platform::GetMonotonicMicroseconds();
+  } while (end - start < kCalibrationMicroseconds);
+  uint64 cycles = ReadCycleCounter() - start_cycles;
+  return cycles * kMicrosecondsPerSecond / (end - start);
+}
+
+#endif  // defined(FLETCH_HAS_CYCLE_COUNTER)
+
+void Clock::Setup() {
+#if defined(FLETCH_HAS_CYCLE_COUNTER)
+  if (Flags::use_cycle_counter && HasInvariantCycleCounter()) {
+    uint64 frequency = CalibrateCycleCounter();
+    if (frequency > kMicrosecondsPerSecond) {
+      use_cycle_counter_ = true;
+      ticks_per_second_ = frequency;
+    }
+  }
+#endif
+  ticks_at_setup_ = Ticks();
+  UpdateCoarseMicroseconds();
+}
+
+uint64 Clock::Ticks() {
+#if defined(FLETCH_HAS_CYCLE_COUNTER)
+  if (use_cycle_counter_) return ReadCycleCounter();
+#endif
+  return Platform::GetMonotonicMicroseconds();
+}
+
+uint64 Clock::TicksToMicroseconds(uint64 ticks) {
+  uint64 seconds = ticks / ticks_per_second_;
+  uint64 rest = ticks % ticks_per_second_;
+  return seconds * kMicrosecondsPerSecond +
+         rest * kMicrosecondsPerSecond / ticks_per_second_;
+}
+
+uint64 Clock::UpdateCoarseMicroseconds() {
+  uint64 now = Platform::GetMonotonicMicroseconds();
+  coarse_microseconds_ = now;
+  return now;
+}
+
+}  // namespace fletch
@@ -0,0 +1,51 @@
+// Copyright (c) 2015, the Fletch project authors. Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE.md file.
+
+#ifndef SRC_VM_CLOCK_H_
+#define SRC_VM_CLOCK_H_
+
+#include "src/shared/atomic.h"
+#include "src/shared/globals.h"
+
+namespace fletch {
+
+// Time sources of the VM. All of them are monotonic; wall-clock time is only
+// used for DateTime.
+//
+//  - [Platform::GetMonotonicMicroseconds] is used for deadlines, e.g., timers
+//    and preemption.
+//  - [Ticks] is a high-resolution counter for measuring durations, used by
+//    Stopwatch. With --use_cycle_counter it reads the CPU's invariant
+//    time-stamp counter, calibrated against the monotonic clock at startup,
+//    which avoids a call into the C library (and possibly the kernel).
+//  - [CoarseMicroseconds] is a cached monotonic time updated by the scheduler
+//    tick. It is very cheap to read, but lags by up to a tick.
+class Clock {
+ public:
+  static void Setup();
+
+  static uint64 Ticks();
+  static uint64 TicksPerSecond() { return ticks_per_second_; }
+  static uint64 TicksToMicroseconds(uint64 ticks);
+
+  // Ticks since [Setup].
+  static uint64 ElapsedTicks() { return Ticks() - ticks_at_setup_; }
+
+  static bool UsesCycleCounter() { return use_cycle_counter_; }
+
+  static uint64 CoarseMicroseconds() { return coarse_microseconds_; }
+
+  // Read the monotonic clock, publish it as the coarse time and return it.
+  static uint64 UpdateCoarseMicroseconds();
+
+ private:
+  static bool use_cycle_counter_;
+  static uint64 ticks_per_second_;
+  static uint64 ticks_at_setup_;
+  static Atomic<uint64> coarse_microseconds_;
+};
+
+}  // namespace fletch
+
+#endif  // SRC_VM_CLOCK_H_
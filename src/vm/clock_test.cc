@@ -0,0 +1,46 @@
+// Copyright (c) 2015, the Fletch project authors. Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE.md file.
+
+#include "src/shared/assert.h"
+#include "src/shared/platform.h"
+#include "src/shared/test_case.h"
+
+#include "src/vm/clock.h"
+
+namespace fletch {
+
+TEST_CASE(Clock_Monotonic) {
+  uint64 last = Platform::GetMonotonicMicroseconds();
+  for (int i = 0; i < 1000; i++) {
+    uint64 now = Platform::GetMonotonicMicroseconds();
+    EXPECT(now >= last);
+    last = now;
+  }
+  EXPECT(Platform::GetProcessMicroseconds() <= last);
+}
+
+TEST_CASE(Clock_Ticks) {
+  Clock::Setup();
+  EXPECT(Clock::TicksPerSecond() >= 1000000U);
+
+  uint64 start = Clock::Ticks();
+  uint64 start_us = Platform::GetMonotonicMicroseconds();
+  while (Platform::GetMonotonicMicroseconds() - start_us < 2000) {
+  }
+  uint64 elapsed = Clock::TicksToMicroseconds(Clock::Ticks() - start);
+  EXPECT(elapsed >= 1000U);
+  EXPECT(elapsed < 1000000U);
+
+  EXPECT_EQ(3000000U, Clock::TicksToMicroseconds(3 * Clock::TicksPerSecond()));
+}
+
+TEST_CASE(Clock_Coarse) {
+  uint64 before = Platform::GetMonotonicMicroseconds();
+  uint64 updated = Clock::UpdateCoarseMicroseconds();
+  EXPECT(updated >= before);
+  EXPECT_EQ(updated, Clock::CoarseMicroseconds());
+  EXPECT(Clock::CoarseMicroseconds() <= Platform::GetMonotonicMicroseconds());
+}
+
+}  // namespace fletch
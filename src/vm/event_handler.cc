@@ -13,10 +13,11 @@
 
 namespace fletch {
 
-EventHandler::EventHandler()
+EventHandler::EventHandler(int preferred_thread)
     : monitor_(Platform::CreateMonitor()),
       data_(NULL),
       id_(-1),
+      preferred_thread_(preferred_thread),
       running_(true),
       next_timeout_(INT64_MAX) {}
 
@@ -102,9 +103,10 @@ void EventHandler::ScheduleTimeout(int64 timeout, Port* port) {
 
 void EventHandler::HandleTimeouts() {
   // Check timeouts.
-  int64 current_time = Platform::GetMicroseconds() / 1000;
-
   ScopedMonitorLock scoped_lock(monitor_);
+  if (next_timeout_ == INT64_MAX) return;
+
+  int64 current_time = Platform::GetMonotonicMicroseconds() / 1000;
   if (next_timeout_ > current_time) return;
 
   int64 next_timeout = INT64_MAX;
@@ -126,7 +128,12 @@ void EventHandler::Send(Port* port, int64 value) {
   Process* port_process = port->process();
   if (port_process != NULL) {
     port_process->mailbox()->EnqueueLargeInteger(port, value);
-    port_process->program()->scheduler()->ResumeProcess(port_process);
+    Scheduler* scheduler = port_process->program()->scheduler();
+    if (preferred_thread_ < 0) {
+      scheduler->ResumeProcess(port_process);
+    } else {
+      scheduler->ResumeProcessOn(port_process, preferred_thread_);
+    }
   }
   port->Unlock();
   port->DecrementRef();
@@ -25,7 +25,10 @@ class EventHandler {
     ERROR_EVENT = 1 << 3,
   };
 
-  EventHandler();
+  // An event handler with a [preferred_thread] resumes the processes it sends
+  // events to on that scheduler worker thread if possible. A negative value
+  // resumes them on any thread.
+  explicit EventHandler(int preferred_thread = -1);
   ~EventHandler();
 
   int GetEventHandler();
@@ -42,6 +45,7 @@ class EventHandler {
   Monitor* monitor_;
   void* data_;
   int id_;
+  int preferred_thread_;
   bool running_;
   ThreadIdentifier thread_;
 
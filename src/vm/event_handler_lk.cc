@@ -128,7 +128,7 @@ void EventHandler::Run() {
     if (next_timeout == INT64_MAX) {
       next_timeout = -1;
     } else {
-      next_timeout -= Platform::GetMicroseconds() / 1000;
+      next_timeout -= Platform::GetMonotonicMicroseconds() / 1000;
       if (next_timeout < 0) next_timeout = 0;
     }
 
@@ -50,7 +50,7 @@ void EventHandler::Run() {
     timespec* interval = NULL;
 
     if (next_timeout != INT64_MAX) {
-      next_timeout -= Platform::GetMicroseconds() / 1000;
+      next_timeout -= Platform::GetMonotonicMicroseconds() / 1000;
       if (next_timeout < 0) next_timeout = 0;
       ts.tv_sec = next_timeout / 1000;
       ts.tv_nsec = (next_timeout % 1000) * 1000000;
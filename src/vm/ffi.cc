@@ -5,6 +5,7 @@
 #include "src/vm/ffi.h"
 
 #include "src/shared/asan_helper.h"
+#include "src/vm/buffer_pool.h"
 #include "src/vm/natives.h"
 #include "src/vm/object.h"
 #include "src/vm/port.h"
@@ -16,8 +17,8 @@ NATIVE(ForeignAllocate) {
   word size = AsForeignWord(arguments[0]);
   Object* result = process->NewInteger(0);
   if (result == Failure::retry_after_gc()) return result;
-  void* calloc_value = calloc(1, size);
-  uint64 value = reinterpret_cast<uint64>(calloc_value);
+  void* memory = BufferPool::Allocate(size);
+  uint64 value = reinterpret_cast<uint64>(memory);
 
 // If we might be using a leak sanitizer, we'll always use a LargeInteger to
 // hold the memory pointer in order for the leak sanitizer to find pointers to
@@ -33,8 +34,10 @@ NATIVE(ForeignAllocate) {
 }
 
 NATIVE(ForeignFree) {
-  uword address = Instance::cast(arguments[0])->GetConsecutiveSmis(0);
-  free(reinterpret_cast<void*>(address));
+  Instance* instance = Instance::cast(arguments[0]);
+  uword address = instance->GetConsecutiveSmis(0);
+  word length = Smi::cast(instance->GetInstanceField(2))->value();
+  BufferPool::Free(reinterpret_cast<void*>(address), length);
   return process->program()->null_object();
 }
 
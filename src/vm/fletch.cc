@@ -6,6 +6,8 @@
 
 #include "src/shared/platform.h"
 
+#include "src/vm/buffer_pool.h"
+#include "src/vm/clock.h"
 #include "src/vm/ffi.h"
 #include "src/vm/object_memory.h"
 #include "src/vm/object.h"
@@ -15,12 +17,15 @@ namespace fletch {
 
 void Fletch::Setup() {
   Platform::Setup();
+  Clock::Setup();
   ObjectMemory::Setup();
   StaticClassStructures::Setup();
   ForeignFunctionInterface::Setup();
+  BufferPool::Setup();
 }
 
 void Fletch::TearDown() {
+  BufferPool::TearDown();
   ForeignFunctionInterface::TearDown();
   StaticClassStructures::TearDown();
   ObjectMemory::TearDown();
@@ -13,6 +13,7 @@
 #include "src/shared/fletch.h"
 #include "src/shared/list.h"
 
+#include "src/vm/checkpoint.h"
 #include "src/vm/ffi.h"
 #include "src/vm/program.h"
 #include "src/vm/program_folder.h"
@@ -79,6 +80,33 @@ static void RunSnapshotFromFile(const char* path) {
   if (result != 0) FATAL1("Failed to run snapshot: %s\n", path);
 }
 
+static bool WriteCheckpoint(Program* program, const char* path) {
+  Scheduler* scheduler = program->scheduler();
+  if (scheduler == NULL) return false;
+  scheduler->StopProgram(program);
+  CheckpointWriter writer(program);
+  List<uint8> checkpoint = writer.WriteAllProcesses();
+  scheduler->ResumeProgram(program);
+  if (checkpoint.is_empty()) return false;
+  bool success = Platform::StoreFile(path, checkpoint);
+  checkpoint.Delete();
+  return success;
+}
+
+static int RunFromCheckpoint(Program* program, const char* path) {
+  List<uint8> bytes = Platform::LoadFile(path);
+  if (!CheckpointReader::IsCheckpoint(bytes)) {
+    FATAL1("Not a checkpoint: %s\n", path);
+  }
+  CheckpointReader reader(program, bytes);
+  reader.ReadProcesses();
+  bytes.Delete();
+  Scheduler scheduler;
+  scheduler.ScheduleRestoredProgram(program, reader.processes(),
+                                    reader.process_count());
+  return RunScheduler(&scheduler);
+}
+
 static void WaitForDebuggerConnection(int port) {
 #ifdef FLETCH_ENABLE_LIVE_CODING
   ConnectionListener listener("127.0.0.1", port);
@@ -129,6 +157,16 @@ int FletchRunMultipleMain(int count, FletchProgram* programs) {
   return fletch::RunScheduler(&scheduler);
 }
 
+int FletchWriteCheckpoint(FletchProgram raw_program, const char* path) {
+  fletch::Program* program = reinterpret_cast<fletch::Program*>(raw_program);
+  return fletch::WriteCheckpoint(program, path) ? 1 : 0;
+}
+
+int FletchRunFromCheckpoint(FletchProgram raw_program, const char* path) {
+  fletch::Program* program = reinterpret_cast<fletch::Program*>(raw_program);
+  return fletch::RunFromCheckpoint(program, path);
+}
+
 FletchProgram FletchLoadProgramFromFlash(void* heap, size_t size) {
   fletch::Program* program =
       new fletch::Program(fletch::Program::kLoadedFromSnapshot);
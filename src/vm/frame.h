@@ -6,6 +6,7 @@
 #define SRC_VM_FRAME_H_
 
 #include "src/shared/globals.h"
+#include "src/vm/natives.h"
 #include "src/vm/object.h"
 #include "src/vm/process.h"
 
@@ -95,6 +96,43 @@ class Frame {
   word size_;
 };
 
+// The frame of a method that calls a native, while the native is running.
+// Natives are the first bytecode of their method, so the frame holds nothing
+// but the frame descriptor pushed below the arguments by the call:
+//
+//   +----------------+
+//   |   Arguments    |  <-- arguments[0]
+//   |       .        |
+//   +----------------+
+//   |     Empty      |
+//   |  Frame pointer |  <-- FramePointer()
+//   |      BCP       |  <-- stack pointer
+//   +----------------+
+//
+// All interpreters locate the arguments they pass to a native with
+// [kArgumentsOffset], so natives can rely on this layout.
+class NativeFrame {
+ public:
+  // The first argument is this many slots plus the arity above the stack
+  // pointer at the native call.
+  static const int kArgumentsOffset = 2;
+
+  NativeFrame(Arguments arguments, int arity)
+      : frame_pointer_(arguments.address(arity) + 1 - kArgumentsOffset) {}
+
+  Object** FramePointer() const { return frame_pointer_; }
+
+  // The lowest slot of the frame, holding its bytecode pointer.
+  Object** FirstSlot() const { return frame_pointer_ - 1; }
+
+  Object** PreviousFramePointer() const {
+    return reinterpret_cast<Object**>(*frame_pointer_);
+  }
+
+ private:
+  Object** frame_pointer_;
+};
+
 }  // namespace fletch
 
 #endif  // SRC_VM_FRAME_H_
@@ -0,0 +1,112 @@
+// Copyright (c) 2015, the Fletch project authors. Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE.md file.
+
+#include "src/vm/function_profile.h"
+
+#include "src/vm/object.h"
+#include "src/vm/vector.h"
+
+namespace fletch {
+
+FunctionProfile::FunctionProfile() : mutex_(Platform::CreateMutex()) {}
+
+FunctionProfile::~FunctionProfile() { delete mutex_; }
+
+void FunctionProfile::Record(Function* function, int count) {
+  ScopedLock locker(mutex_);
+  counts_[function] += count;
+}
+
+int FunctionProfile::CountFor(Function* function) {
+  ScopedLock locker(mutex_);
+  auto it = counts_.Find(function);
+  return it == counts_.End() ? 0 : it->second;
+}
+
+int FunctionProfile::length() {
+  ScopedLock locker(mutex_);
+  return counts_.size();
+}
+
+bool FunctionProfile::CompareEntries(const Entry& a, const Entry& b) {
+  return a.count > b.count;
+}
+
+void FunctionProfile::IteratePointers(PointerVisitor* visitor) {
+  ScopedLock locker(mutex_);
+  if (counts_.size() == 0) return;
+
+  Vector<Entry> entries;
+  for (auto it = counts_.Begin(); it != counts_.End(); ++it) {
+    Entry entry = {it->first, it->second};
+    entries.PushBack(entry);
+  }
+  entries.Sort(CompareEntries);
+
+  // The visitor may move the functions, so the map is rebuilt with the
+  // visited pointers.
+  counts_.Clear();
+  for (size_t i = 0; i < entries.size(); i++) {
+    Entry& entry = entries[i];
+    visitor->Visit(reinterpret_cast<Object**>(&entry.function));
+    counts_[entry.function] = entry.count;
+  }
+}
+
+void FunctionProfile::ComputeLayout(int page_size, int* span, int* pages) {
+  ScopedLock locker(mutex_);
+  uword first = ~static_cast<uword>(0);
+  uword last = 0;
+  HashMap<uword, bool> touched;
+  for (auto it = counts_.Begin(); it != counts_.End(); ++it) {
+    Function* function = it->first;
+    uword start = function->address();
+    uword end = start + function->Size();
+    first = Utils::Minimum(first, start);
+    last = Utils::Maximum(last, end);
+    for (uword page = start / page_size; page <= (end - 1) / page_size;
+         page++) {
+      touched[page] = true;
+    }
+  }
+  *span = (last > first) ? static_cast<int>(last - first) : 0;
+  *pages = touched.size();
+}
+
+void FunctionProfile::Retain(HashSet<Function*>* functions) {
+  ScopedLock locker(mutex_);
+  Vector<Function*> removed;
+  for (auto it = counts_.Begin(); it != counts_.End(); ++it) {
+    if (functions->Find(it->first) == functions->End()) {
+      removed.PushBack(it->first);
+    }
+  }
+  for (size_t i = 0; i < removed.size(); i++) {
+    counts_.Erase(counts_.Find(removed[i]));
+  }
+}
+
+void FunctionProfile::RemoveReplaced(Array* old_methods, Array* new_methods) {
+  HashSet<Function*> retained;
+  for (int i = 1; i < new_methods->length(); i += 2) {
+    retained.Insert(Function::cast(new_methods->get(i)));
+  }
+  for (int i = 1; i < old_methods->length(); i += 2) {
+    Function* function = Function::cast(old_methods->get(i));
+    if (retained.Find(function) == retained.End()) Remove(function);
+  }
+}
+
+void FunctionProfile::Remove(Function* function) {
+  ScopedLock locker(mutex_);
+  auto it = counts_.Find(function);
+  if (it != counts_.End()) counts_.Erase(it);
+}
+
+void FunctionProfile::Clear() {
+  ScopedLock locker(mutex_);
+  counts_.Clear();
+}
+
+}  // namespace fletch
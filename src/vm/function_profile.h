@@ -0,0 +1,74 @@
+// Copyright (c) 2015, the Fletch project authors. Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE.md file.
+
+#ifndef SRC_VM_FUNCTION_PROFILE_H_
+#define SRC_VM_FUNCTION_PROFILE_H_
+
+#include "src/shared/globals.h"
+#include "src/shared/platform.h"
+
+#include "src/vm/hash_map.h"
+#include "src/vm/hash_set.h"
+
+namespace fletch {
+
+class Array;
+class Function;
+class PointerVisitor;
+
+// Sample counts for the functions of a program. The samples are taken by
+// the profiler (see [Process::HandleStackOverflow]) and the profile is used
+// to lay out the program heap: program GCs, folding and snapshots place the
+// profiled functions first, hottest first, together with their literals.
+class FunctionProfile {
+ public:
+  FunctionProfile();
+  ~FunctionProfile();
+
+  // Adds [count] samples for [function]. Can be called by all threads
+  // running processes of the program.
+  void Record(Function* function, int count);
+
+  int CountFor(Function* function);
+
+  int length();
+  bool is_empty() { return length() == 0; }
+
+  // Visits the profiled functions, hottest first, and updates the profile
+  // with the visited pointers. Must only be called when the program is
+  // stopped.
+  void IteratePointers(PointerVisitor* visitor);
+
+  // Computes the number of bytes between the first and the end of the last
+  // profiled function, and the number of pages of [page_size] bytes holding
+  // profiled functions.
+  void ComputeLayout(int page_size, int* span, int* pages);
+
+  // Drops the profiled functions that are not in [functions].
+  void Retain(HashSet<Function*>* functions);
+
+  // Drops the methods of the method table [old_methods] that are not in
+  // [new_methods], when a session replaces the former with the latter.
+  // Otherwise the profile would keep the replaced functions alive.
+  void RemoveReplaced(Array* old_methods, Array* new_methods);
+
+  void Remove(Function* function);
+
+  void Clear();
+
+ private:
+  struct Entry {
+    Function* function;
+    int count;
+  };
+
+  static bool CompareEntries(const Entry& a, const Entry& b);
+
+  Mutex* const mutex_;
+  HashMap<Function*, int> counts_;
+};
+
+}  // namespace fletch
+
+#endif  // SRC_VM_FUNCTION_PROFILE_H_
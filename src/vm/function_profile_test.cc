@@ -0,0 +1,136 @@
+// Copyright (c) 2015, the Fletch project authors. Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE.md file.
+
+#include "src/shared/test_case.h"
+
+#include "src/shared/bytecodes.h"
+
+#include "src/vm/function_profile.h"
+#include "src/vm/object.h"
+#include "src/vm/program.h"
+#include "src/vm/test_program.h"
+
+namespace fletch {
+
+// Records the visited functions and moves each of them by [delta].
+class MovingVisitor : public PointerVisitor {
+ public:
+  explicit MovingVisitor(word delta) : delta_(delta), count_(0) {}
+
+  void VisitBlock(Object** start, Object** end) {
+    for (Object** p = start; p < end; p++) {
+      visited_[count_++] = *p;
+      *p = reinterpret_cast<Object*>(reinterpret_cast<word>(*p) + delta_);
+    }
+  }
+
+  Object* visited(int index) const { return visited_[index]; }
+  int count() const { return count_; }
+
+ private:
+  word delta_;
+  int count_;
+  Object* visited_[8];
+};
+
+static Function* FakeFunction(int index) {
+  return reinterpret_cast<Function*>((index + 1) * 64 + HeapObject::kTag);
+}
+
+TEST_CASE(FunctionProfile_HottestFirst) {
+  FunctionProfile profile;
+  EXPECT(profile.is_empty());
+
+  profile.Record(FakeFunction(0), 1);
+  profile.Record(FakeFunction(1), 5);
+  profile.Record(FakeFunction(2), 2);
+  profile.Record(FakeFunction(0), 2);
+  EXPECT_EQ(3, profile.length());
+  EXPECT_EQ(3, profile.CountFor(FakeFunction(0)));
+
+  MovingVisitor visitor(1024);
+  profile.IteratePointers(&visitor);
+  EXPECT_EQ(3, visitor.count());
+  EXPECT(visitor.visited(0) == FakeFunction(1));
+  EXPECT(visitor.visited(1) == FakeFunction(0));
+  EXPECT(visitor.visited(2) == FakeFunction(2));
+
+  // The profile follows the moved functions.
+  EXPECT_EQ(0, profile.CountFor(FakeFunction(1)));
+  EXPECT_EQ(5, profile.CountFor(FakeFunction(1 + 16)));
+
+  profile.Clear();
+  EXPECT(profile.is_empty());
+}
+
+// Counts the functions in a heap and remembers the last one.
+class FunctionCounter : public HeapObjectVisitor {
+ public:
+  FunctionCounter() : count_(0), last_(NULL) {}
+
+  int Visit(HeapObject* object) {
+    if (object->IsFunction()) {
+      count_++;
+      last_ = Function::cast(object);
+    }
+    return object->Size();
+  }
+
+  int count() const { return count_; }
+  Function* last() const { return last_; }
+
+ private:
+  int count_;
+  Function* last_;
+};
+
+static uint8 kReturnNullBytecodes[] = {
+  kLoadLiteralNull,
+  kReturn, 0,
+};
+
+TEST_CASE(FunctionProfile_ReplacedMethodsAreCollected) {
+  TestProgram test(1);
+  Program* program = test.program();
+  Function* function = test.CreateFunction(kReturnNullBytecodes,
+                                           sizeof(kReturnNullBytecodes));
+  program->profile()->Record(function, 1);
+
+  // The profile keeps the function alive, at its new address.
+  program->CollectGarbage();
+  FunctionCounter before;
+  program->heap()->IterateObjects(&before);
+  EXPECT_EQ(1, before.count());
+  function = before.last();
+  EXPECT_EQ(1, program->profile()->CountFor(function));
+
+  Function* replacement = test.CreateFunction(kReturnNullBytecodes,
+                                              sizeof(kReturnNullBytecodes));
+  Array* old_methods;
+  Array* new_methods;
+  {
+    NoAllocationFailureScope scope(program->heap()->space());
+    Class* clazz = Class::cast(program->CreateClass(0));
+    old_methods = Array::cast(program->CreateArray(2));
+    old_methods->set(0, Smi::FromWord(0));
+    old_methods->set(1, function);
+    new_methods = Array::cast(program->CreateArray(2));
+    new_methods->set(0, Smi::FromWord(0));
+    new_methods->set(1, replacement);
+    clazz->set_methods(new_methods);
+    program->static_fields()->set(0, clazz);
+  }
+  program->profile()->RemoveReplaced(old_methods, new_methods);
+  EXPECT(program->profile()->is_empty());
+
+  // Only the method of the class is left.
+  program->CollectGarbage();
+  FunctionCounter after;
+  program->heap()->IterateObjects(&after);
+  EXPECT_EQ(1, after.count());
+  Class* clazz = Class::cast(program->static_fields()->get(0));
+  EXPECT(after.last() == clazz->methods()->get(1));
+}
+
+}  // namespace fletch
@@ -21,6 +21,7 @@ GCThread::GCThread()
       shutting_down_(false),
       requesting_shared_gc_(false),
       requesting_gc_(false),
+      requesting_chunk_freeing_(false),
       pause_count_(0),
       client_monitor_(Platform::CreateMonitor()),
       did_pause_(false),
@@ -53,6 +54,12 @@ void GCThread::TriggerGC(Program* program) {
   gc_thread_monitor_->Notify();
 }
 
+void GCThread::TriggerChunkFreeing() {
+  if (requesting_chunk_freeing_.exchange(true)) return;
+  ScopedMonitorLock lock(gc_thread_monitor_);
+  gc_thread_monitor_->Notify();
+}
+
 void GCThread::Pause() {
   // Tell thread it should pause.
   {
@@ -114,7 +121,7 @@ void GCThread::MainLoop() {
       {
         ScopedMonitorLock lock(gc_thread_monitor_);
         while (!requesting_gc_ && !requesting_shared_gc_ && pause_count_ == 0 &&
-               !shutting_down_) {
+               !shutting_down_ && !requesting_chunk_freeing_) {
           gc_thread_monitor_->Wait();
         }
 
@@ -148,6 +155,10 @@ void GCThread::MainLoop() {
       }
     }
 
+    if (requesting_chunk_freeing_.exchange(false)) {
+      ObjectMemory::FreeQueuedChunks();
+    }
+
     if (do_shared_gc) {
       program_->CollectSharedGarbage();
     }
@@ -157,6 +168,7 @@ void GCThread::MainLoop() {
     }
 
     if (do_shutdown) {
+      ObjectMemory::FreeQueuedChunks();
       break;
     }
   }
@@ -5,6 +5,8 @@
 #ifndef SRC_VM_GC_THREAD_H_
 #define SRC_VM_GC_THREAD_H_
 
+#include "src/shared/atomic.h"
+
 #include "src/vm/thread.h"
 #include "src/vm/program.h"
 
@@ -18,6 +20,9 @@ class GCThread {
   void StartThread();
   void TriggerImmutableGC(Program* program);
   void TriggerGC(Program* program);
+  // Free the chunks queued by [Space::QueueChunksForFreeing] in the
+  // background.
+  void TriggerChunkFreeing();
   void Pause();
   void Resume();
   void StopThread();
@@ -34,6 +39,8 @@ class GCThread {
   bool shutting_down_;
   bool requesting_shared_gc_;
   bool requesting_gc_;
+  // Set without holding the monitor, so repeated triggers are cheap.
+  Atomic<bool> requesting_chunk_freeing_;
   int pause_count_;
 
   Monitor* client_monitor_;
@@ -0,0 +1,111 @@
+// Copyright (c) 2015, the Fletch project authors. Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE.md file.
+
+#include "src/vm/heap_policy.h"
+
+#include <string.h>
+
+#include "src/shared/flags.h"
+#include "src/shared/utils.h"
+
+#include "src/vm/object_memory.h"
+
+namespace fletch {
+
+static int FixedBudget(int used) {
+  return Utils::Maximum(Space::DefaultChunkSize(used), used);
+}
+
+HeapSizingPolicy::HeapSizingPolicy(Mode mode, uint64 target)
+    : mode_(mode),
+      target_(target),
+      size_hint_(0),
+      budget_(0),
+      survival_percent_(-1),
+      used_after_last_collection_(0),
+      collections_(0) {}
+
+HeapSizingPolicy HeapSizingPolicy::FromFlags() {
+  const char* name = Flags::heap_policy;
+  if (name != NULL && strcmp(name, "frequency") == 0) {
+    uint64 interval = static_cast<uint64>(Flags::heap_gc_interval_ms) * 1000;
+    return HeapSizingPolicy(kGcFrequency, interval);
+  }
+  if (name != NULL && strcmp(name, "time") == 0) {
+    return HeapSizingPolicy(kTimeRatio, Flags::heap_gc_time_percent);
+  }
+  return HeapSizingPolicy(kFixed, 0);
+}
+
+int HeapSizingPolicy::InitialBudget(int used) const {
+  return ClampBudget(FixedBudget(used), used);
+}
+
+int HeapSizingPolicy::RecordCollection(int used_before, int used,
+                                       uint64 gc_time, uint64 mutator_time) {
+  collections_++;
+  survival_percent_ =
+      (used_before > 0) ? static_cast<int>(int64(used) * 100 / used_before)
+                        : 100;
+  int64 allocated = used_before - used_after_last_collection_;
+  if (allocated < 0) allocated = used_before;
+  used_after_last_collection_ = used;
+
+  int64 budget = budget_;
+  if (budget == 0) budget = FixedBudget(used);
+  switch (mode_) {
+    case kFixed:
+      budget = FixedBudget(used);
+      break;
+    case kGcFrequency:
+      // Allocate at the same rate for another interval.
+      if (mutator_time > 0) {
+        budget = allocated * static_cast<int64>(target_) / mutator_time;
+      } else {
+        budget *= 2;
+      }
+      break;
+    case kTimeRatio: {
+      uint64 total = gc_time + mutator_time;
+      uint64 percent = (total > 0) ? gc_time * 100 / total : 0;
+      if (percent > target_) {
+        budget *= 2;
+      } else if (percent * 2 < target_) {
+        budget /= 2;
+      }
+      break;
+    }
+  }
+  if (budget > kMaximumBudget) budget = kMaximumBudget;
+  budget_ = ClampBudget(static_cast<int>(budget), used);
+  return budget_;
+}
+
+int HeapSizingPolicy::ToSpaceSize(int used) const {
+  if (survival_percent_ < 0) return used / 10;
+  // Leave a little room for survival rates that vary between collections.
+  int64 size = int64(used) * (survival_percent_ + 5) / 100;
+  return static_cast<int>(Utils::Minimum<int64>(size, used));
+}
+
+int HeapSizingPolicy::ClampBudget(int budget, int used) const {
+  int minimum = Utils::Maximum(FixedBudget(used), size_hint_ - used);
+  int maximum = Utils::Maximum(minimum, kMaximumBudget);
+  return Utils::Minimum(Utils::Maximum(budget, minimum), maximum);
+}
+
+const char* HeapSizingPolicy::ModeName() const {
+  switch (mode_) {
+    case kFixed:
+      return "fixed";
+    case kGcFrequency:
+      return "frequency";
+    case kTimeRatio:
+      return "time";
+  }
+  UNREACHABLE();
+  return NULL;
+}
+
+}  // namespace fletch
@@ -0,0 +1,83 @@
+// Copyright (c) 2015, the Fletch project authors. Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE.md file.
+
+#ifndef SRC_VM_HEAP_POLICY_H_
+#define SRC_VM_HEAP_POLICY_H_
+
+#include "src/shared/globals.h"
+
+namespace fletch {
+
+// Decides how much a process heap may grow before its next garbage
+// collection and how large the to-space of a collection starts out. Each
+// process heap has its own policy, so it is only used by the thread
+// interpreting the process.
+class HeapSizingPolicy {
+ public:
+  enum Mode {
+    // Allow the heap to grow by its live size, but at least by the default
+    // chunk size (see [Space::DefaultChunkSize]).
+    kFixed,
+    // Size the budget from the allocation rate, so the process collects
+    // about once per target interval of running time.
+    kGcFrequency,
+    // Double or halve the budget to keep the time spent collecting near a
+    // target percentage of the running time.
+    kTimeRatio,
+  };
+
+  static const int kMaximumBudget = 64 * MB;
+
+  // [target] is the collection interval in microseconds for
+  // [kGcFrequency] and the percentage of time spent collecting for
+  // [kTimeRatio]. It is unused for [kFixed].
+  HeapSizingPolicy(Mode mode, uint64 target);
+
+  // A policy as selected by the -Xheap_policy flags.
+  static HeapSizingPolicy FromFlags();
+
+  Mode mode() const { return mode_; }
+
+  // Let the heap reach [size] bytes before it collects, as if the process
+  // had started with a heap of that size.
+  void set_size_hint(int size) { size_hint_ = size; }
+  int size_hint() const { return size_hint_; }
+
+  // The budget for a heap with [used] bytes that has not been collected.
+  int InitialBudget(int used) const;
+
+  // Record a collection that took [gc_time] microseconds and left [used]
+  // of [used_before] bytes, [mutator_time] microseconds after the end of
+  // the previous one. Returns the budget until the next collection.
+  int RecordCollection(int used_before, int used, uint64 gc_time,
+                       uint64 mutator_time);
+
+  // The initial size of the to-space when collecting a heap that uses
+  // [used] bytes. Based on the survival rate of the previous collection.
+  int ToSpaceSize(int used) const;
+
+  int collections() const { return collections_; }
+  int budget() const { return budget_; }
+
+  // The percentage of the heap that survived the last collection, or -1
+  // before the first collection.
+  int survival_percent() const { return survival_percent_; }
+
+  const char* ModeName() const;
+
+ private:
+  int ClampBudget(int budget, int used) const;
+
+  Mode mode_;
+  uint64 target_;
+  int size_hint_;
+  int budget_;
+  int survival_percent_;
+  int used_after_last_collection_;
+  int collections_;
+};
+
+}  // namespace fletch
+
+#endif  // SRC_VM_HEAP_POLICY_H_
@@ -0,0 +1,63 @@
+// Copyright (c) 2015, the Fletch project authors. Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE.md file.
+
+#include "src/shared/assert.h"
+#include "src/shared/test_case.h"
+
+#include "src/vm/heap_policy.h"
+#include "src/vm/object_memory.h"
+
+namespace fletch {
+
+static const int kMinimum = Space::kDefaultMinimumChunkSize;
+
+TEST_CASE(HEAP_POLICY_FIXED) {
+  HeapSizingPolicy policy(HeapSizingPolicy::kFixed, 0);
+  EXPECT_EQ(kMinimum, policy.InitialBudget(0));
+  EXPECT_EQ(-1, policy.survival_percent());
+  EXPECT_EQ(100 * KB, policy.ToSpaceSize(1000 * KB));
+
+  EXPECT_EQ(1 * MB, policy.RecordCollection(4 * MB, 1 * MB, 10, 1000));
+  EXPECT_EQ(25, policy.survival_percent());
+  EXPECT_EQ(1, policy.collections());
+  EXPECT_EQ(300 * KB, policy.ToSpaceSize(1000 * KB));
+}
+
+TEST_CASE(HEAP_POLICY_SIZE_HINT) {
+  HeapSizingPolicy policy(HeapSizingPolicy::kFixed, 0);
+  policy.set_size_hint(2 * MB);
+  EXPECT_EQ(2 * MB, policy.InitialBudget(0));
+  EXPECT_EQ(1 * MB, policy.InitialBudget(1 * MB));
+  // Above the hint the heap grows as usual.
+  EXPECT_EQ(3 * MB, policy.RecordCollection(4 * MB, 3 * MB, 10, 1000));
+}
+
+TEST_CASE(HEAP_POLICY_FREQUENCY) {
+  // Collect about once every 10 ms.
+  HeapSizingPolicy policy(HeapSizingPolicy::kGcFrequency, 10000);
+  // 1 MB allocated in 1 ms, so 10 MB until the next collection.
+  EXPECT_EQ(10 * MB, policy.RecordCollection(1 * MB, 0, 10, 1000));
+  // 11 MB allocated in 110 ms, so 1 MB for the next 10 ms.
+  EXPECT_EQ(1 * MB, policy.RecordCollection(11 * MB, 0, 10, 110000));
+  // Never above the maximum budget.
+  int maximum = HeapSizingPolicy::kMaximumBudget;
+  EXPECT_EQ(maximum, policy.RecordCollection(64 * MB, 0, 10, 1));
+}
+
+TEST_CASE(HEAP_POLICY_TIME_RATIO) {
+  // Spend about 10% of the time collecting.
+  HeapSizingPolicy policy(HeapSizingPolicy::kTimeRatio, 10);
+  int budget = policy.RecordCollection(1 * MB, 0, 50, 50);
+  EXPECT_EQ(2 * kMinimum, budget);
+  // Still collecting half of the time.
+  EXPECT_EQ(2 * budget, policy.RecordCollection(1 * MB, 0, 50, 50));
+  // Between 5% and 10% the budget stays.
+  EXPECT_EQ(2 * budget, policy.RecordCollection(1 * MB, 0, 8, 92));
+  // Below 5% the budget shrinks, but never below the fixed budget.
+  EXPECT_EQ(budget, policy.RecordCollection(1 * MB, 0, 1, 99));
+  EXPECT_EQ(kMinimum, policy.RecordCollection(1 * MB, 0, 1, 99));
+  EXPECT_EQ(kMinimum, policy.RecordCollection(1 * MB, 0, 1, 99));
+}
+
+}  // namespace fletch
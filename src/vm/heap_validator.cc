@@ -28,13 +28,19 @@ void HeapPointerValidator::ValidatePointer(Object* object) {
     is_mutable_heap_obj = mutable_heap_->space()->Includes(address);
   }
 
+  bool is_message_arena_obj = false;
+  if (message_arena_ != NULL) {
+    is_message_arena_obj = message_arena_->space()->Includes(address);
+  }
+
   bool is_program_heap = program_heap_->space()->Includes(address);
 
-  if (!is_shared_heap_obj && !is_mutable_heap_obj && !is_program_heap &&
+  if (!is_shared_heap_obj && !is_mutable_heap_obj && !is_message_arena_obj &&
+      !is_program_heap &&
       !StaticClassStructures::IsStaticClass(heap_object)) {
     fprintf(stderr,
             "Found pointer %p which lies in neither of "
-            "immutable_heap/mutable_heap/program_heap.\n",
+            "immutable_heap/mutable_heap/message_arena/program_heap.\n",
             heap_object);
 
     FATAL("Heap validation failed.");
@@ -55,7 +61,8 @@ void ProcessHeapValidatorVisitor::VisitProcess(Process* process) {
 
   // Validate pointers in roots, queues, weak pointers and mutable heap.
   {
-    HeapPointerValidator validator(program_heap_, shared_heap_, process_heap);
+    HeapPointerValidator validator(program_heap_, shared_heap_, process_heap,
+                                   process->message_arena());
 
     SafeObjectPointerVisitor pointer_visitor(process, &validator);
     process->IterateRoots(&validator);
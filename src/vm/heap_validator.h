@@ -13,14 +13,16 @@ namespace fletch {
 class SharedHeap;
 
 // Validates that all pointers it gets called with lie inside certain spaces -
-// depending on [shared_heap], [mutable_heap], [program_heap].
+// depending on [shared_heap], [mutable_heap], [program_heap] and
+// [message_arena].
 class HeapPointerValidator : public PointerVisitor {
  public:
   HeapPointerValidator(Heap* program_heap, SharedHeap* shared_heap,
-                       Heap* mutable_heap)
+                       Heap* mutable_heap, Heap* message_arena = NULL)
       : program_heap_(program_heap),
         shared_heap_(shared_heap),
-        mutable_heap_(mutable_heap) {}
+        mutable_heap_(mutable_heap),
+        message_arena_(message_arena) {}
   virtual ~HeapPointerValidator() {}
 
   virtual void VisitBlock(Object** start, Object** end);
@@ -31,6 +33,7 @@ class HeapPointerValidator : public PointerVisitor {
   Heap* program_heap_;
   SharedHeap* shared_heap_;
   Heap* mutable_heap_;
+  Heap* message_arena_;
 };
 
 // Validates that all pointers it gets called with lie inside program/immutable
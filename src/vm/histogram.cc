@@ -0,0 +1,97 @@
+// Copyright (c) 2015, the Fletch project authors. Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE.md file.
+
+#include "src/vm/histogram.h"
+
+#include "src/shared/assert.h"
+#include "src/shared/utils.h"
+
+namespace fletch {
+
+void Histogram::Reset() {
+  count_ = 0;
+  sum_ = 0;
+  minimum_ = UINT64_MAX;
+  maximum_ = 0;
+  for (int i = 0; i < kNumberOfBuckets; i++) buckets_[i] = 0;
+}
+
+int Histogram::BucketFor(uint64 value) {
+  if (value == 0) return 0;
+  if ((value >> 63) != 0) return kNumberOfBuckets - 1;
+  return Utils::HighestBit(static_cast<int64>(value)) + 1;
+}
+
+uint64 Histogram::BucketLimit(int index) {
+  ASSERT(index >= 0 && index < kNumberOfBuckets);
+  if (index == 0) return 0;
+  if (index == kNumberOfBuckets - 1) return UINT64_MAX;
+  return (static_cast<uint64>(1) << index) - 1;
+}
+
+void Histogram::Record(uint64 value) {
+  count_++;
+  sum_ += value;
+  if (value < minimum_) minimum_ = value;
+  if (value > maximum_) maximum_ = value;
+  buckets_[BucketFor(value)]++;
+}
+
+void Histogram::Merge(const Histogram* other) {
+  if (other->count_ == 0) return;
+  count_ += other->count_;
+  sum_ += other->sum_;
+  if (other->minimum_ < minimum_) minimum_ = other->minimum_;
+  if (other->maximum_ > maximum_) maximum_ = other->maximum_;
+  for (int i = 0; i < kNumberOfBuckets; i++) buckets_[i] += other->buckets_[i];
+}
+
+uint64 Histogram::Percentile(double percentile) const {
+  if (count_ == 0) return 0;
+  uint64 target = static_cast<uint64>((count_ * percentile) / 100.0 + 0.5);
+  if (target == 0) target = 1;
+  uint64 seen = 0;
+  for (int i = 0; i < kNumberOfBuckets; i++) {
+    seen += buckets_[i];
+    if (seen >= target) return Utils::Minimum(BucketLimit(i), maximum_);
+  }
+  return maximum_;
+}
+
+int LatencyBuckets::BucketFor(uint64 value) {
+  if (value < 2 * kSubBuckets) return static_cast<int>(value);
+  int exponent = ((value >> 63) != 0)
+      ? 63 : Utils::HighestBit(static_cast<int64>(value));
+  int shift = exponent - kSubBucketBits;
+  return shift * kSubBuckets + static_cast<int>(value >> shift);
+}
+
+uint64 LatencyBuckets::BucketLimit(int index) {
+  ASSERT(index >= 0 && index < kNumberOfBuckets);
+  if (index < 2 * kSubBuckets) return index;
+  int shift = index / kSubBuckets - 1;
+  uint64 top = index % kSubBuckets + kSubBuckets;
+  // Wraps around to UINT64_MAX for the last bucket.
+  return ((top + 1) << shift) - 1;
+}
+
+void Histogram::PrintStatistics(const char* name, const char* unit) const {
+  Print::Error("%s: count %llu, mean %llu %s, min %llu, p50 %llu, p99 %llu, "
+               "max %llu\n",
+               name, static_cast<unsigned long long>(count_),  // NOLINT
+               static_cast<unsigned long long>(Mean()), unit,  // NOLINT
+               static_cast<unsigned long long>(minimum()),     // NOLINT
+               static_cast<unsigned long long>(Percentile(50)),  // NOLINT
+               static_cast<unsigned long long>(Percentile(99)),  // NOLINT
+               static_cast<unsigned long long>(maximum_));       // NOLINT
+  for (int i = 0; i < kNumberOfBuckets; i++) {
+    if (buckets_[i] == 0) continue;
+    Print::Error("  <= %llu %s: %llu\n",
+                 static_cast<unsigned long long>(BucketLimit(i)),  // NOLINT
+                 unit,
+                 static_cast<unsigned long long>(buckets_[i]));  // NOLINT
+  }
+}
+
+}  // namespace fletch
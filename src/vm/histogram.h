@@ -0,0 +1,76 @@
+// Copyright (c) 2015, the Fletch project authors. Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE.md file.
+
+#ifndef SRC_VM_HISTOGRAM_H_
+#define SRC_VM_HISTOGRAM_H_
+
+#include "src/shared/globals.h"
+
+namespace fletch {
+
+// A histogram of unsigned values using power-of-two buckets. Bucket 0 holds
+// the value 0 and bucket i > 0 holds the values in [2^(i-1), 2^i). Recording
+// is constant time and does not allocate, which makes it usable on paths
+// where the VM is stopping threads. The histogram is not thread safe; callers
+// must serialize access to it.
+class Histogram {
+ public:
+  static const int kNumberOfBuckets = 65;
+
+  Histogram() { Reset(); }
+
+  void Reset();
+
+  void Record(uint64 value);
+
+  // Add all the values recorded in [other] to this histogram.
+  void Merge(const Histogram* other);
+
+  uint64 count() const { return count_; }
+  uint64 sum() const { return sum_; }
+  uint64 minimum() const { return count_ == 0 ? 0 : minimum_; }
+  uint64 maximum() const { return maximum_; }
+  uint64 bucket(int index) const { return buckets_[index]; }
+
+  uint64 Mean() const { return count_ == 0 ? 0 : sum_ / count_; }
+
+  // Returns an upper bound of the value at the given [percentile] (0-100),
+  // which is the upper limit of the bucket containing it, clamped to the
+  // largest recorded value.
+  uint64 Percentile(double percentile) const;
+
+  static int BucketFor(uint64 value);
+  static uint64 BucketLimit(int index);
+
+  // Print a one-line summary followed by the non-empty buckets.
+  void PrintStatistics(const char* name, const char* unit) const;
+
+ private:
+  uint64 count_;
+  uint64 sum_;
+  uint64 minimum_;
+  uint64 maximum_;
+  uint64 buckets_[kNumberOfBuckets];
+};
+
+// Log-linear buckets in the style of HdrHistogram, for latencies where the
+// power-of-two buckets of [Histogram] are too coarse to compare tail
+// percentiles. Values below 2 * kSubBuckets have a bucket each. Above that,
+// every range [2^k, 2^(k+1)) is split into kSubBuckets buckets of equal
+// width, so the limit of a bucket is within 1/kSubBuckets of its values.
+class LatencyBuckets {
+ public:
+  static const int kSubBucketBits = 6;
+  static const int kSubBuckets = 1 << kSubBucketBits;
+  static const int kNumberOfBuckets = (65 - kSubBucketBits) * kSubBuckets;
+
+  static int BucketFor(uint64 value);
+
+  // The largest value in the bucket [index].
+  static uint64 BucketLimit(int index);
+};
+
+}  // namespace fletch
+
+#endif  // SRC_VM_HISTOGRAM_H_
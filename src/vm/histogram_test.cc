@@ -0,0 +1,89 @@
+// Copyright (c) 2015, the Fletch project authors. Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE.md file.
+
+#include "src/shared/assert.h"
+#include "src/shared/test_case.h"
+
+#include "src/vm/histogram.h"
+
+namespace fletch {
+
+TEST_CASE(HISTOGRAM_BUCKETS) {
+  EXPECT_EQ(0, Histogram::BucketFor(0));
+  EXPECT_EQ(1, Histogram::BucketFor(1));
+  EXPECT_EQ(2, Histogram::BucketFor(2));
+  EXPECT_EQ(2, Histogram::BucketFor(3));
+  EXPECT_EQ(3, Histogram::BucketFor(4));
+  EXPECT_EQ(11, Histogram::BucketFor(1024));
+  EXPECT_EQ(Histogram::kNumberOfBuckets - 1, Histogram::BucketFor(UINT64_MAX));
+
+  for (int i = 1; i < Histogram::kNumberOfBuckets - 1; i++) {
+    uint64 limit = Histogram::BucketLimit(i);
+    EXPECT_EQ(i, Histogram::BucketFor(limit));
+    EXPECT_EQ(i + 1, Histogram::BucketFor(limit + 1));
+  }
+}
+
+TEST_CASE(HISTOGRAM_RECORD) {
+  Histogram histogram;
+  EXPECT_EQ(0U, histogram.count());
+  EXPECT_EQ(0U, histogram.minimum());
+  EXPECT_EQ(0U, histogram.Percentile(99));
+
+  for (int i = 1; i <= 100; i++) histogram.Record(i);
+  EXPECT_EQ(100U, histogram.count());
+  EXPECT_EQ(5050U, histogram.sum());
+  EXPECT_EQ(1U, histogram.minimum());
+  EXPECT_EQ(100U, histogram.maximum());
+  EXPECT_EQ(50U, histogram.Mean());
+
+  // The 50th value (50) lives in the [32, 63] bucket.
+  EXPECT_EQ(63U, histogram.Percentile(50));
+  // The top bucket is clamped to the maximum.
+  EXPECT_EQ(100U, histogram.Percentile(99));
+  EXPECT_EQ(1U, histogram.Percentile(0));
+}
+
+TEST_CASE(HISTOGRAM_MERGE) {
+  Histogram a;
+  Histogram b;
+  a.Record(3);
+  b.Record(1000);
+  b.Record(0);
+  a.Merge(&b);
+  EXPECT_EQ(3U, a.count());
+  EXPECT_EQ(0U, a.minimum());
+  EXPECT_EQ(1000U, a.maximum());
+  EXPECT_EQ(1U, a.bucket(Histogram::BucketFor(1000)));
+
+  a.Reset();
+  EXPECT_EQ(0U, a.count());
+  EXPECT_EQ(0U, a.maximum());
+}
+
+TEST_CASE(LATENCY_BUCKETS) {
+  EXPECT_EQ(0, LatencyBuckets::BucketFor(0));
+  EXPECT_EQ(127, LatencyBuckets::BucketFor(127));
+  EXPECT_EQ(128, LatencyBuckets::BucketFor(128));
+  EXPECT_EQ(128, LatencyBuckets::BucketFor(129));
+  EXPECT_EQ(129, LatencyBuckets::BucketFor(130));
+  EXPECT_EQ(LatencyBuckets::kNumberOfBuckets - 1,
+            LatencyBuckets::BucketFor(UINT64_MAX));
+  EXPECT_EQ(UINT64_MAX,
+            LatencyBuckets::BucketLimit(LatencyBuckets::kNumberOfBuckets - 1));
+
+  for (int i = 0; i < LatencyBuckets::kNumberOfBuckets - 1; i++) {
+    uint64 limit = LatencyBuckets::BucketLimit(i);
+    EXPECT_EQ(i, LatencyBuckets::BucketFor(limit));
+    EXPECT_EQ(i + 1, LatencyBuckets::BucketFor(limit + 1));
+  }
+
+  // Buckets are at most 1/64th of their values wide.
+  int index = LatencyBuckets::BucketFor(1000000);
+  uint64 width = LatencyBuckets::BucketLimit(index) -
+      LatencyBuckets::BucketLimit(index - 1);
+  EXPECT(width * LatencyBuckets::kSubBuckets <= 1000000U);
+}
+
+}  // namespace fletch
@@ -17,6 +17,7 @@
 #include "src/vm/natives.h"
 #include "src/vm/port.h"
 #include "src/vm/process.h"
+#include "src/vm/threaded_code.h"
 
 #define GC_AND_RETRY_ON_ALLOCATION_FAILURE_OR_SIGNAL_SCHEDULER(var, exp) \
   Object* var = (exp);                                                   \
@@ -159,13 +160,94 @@ class State {
 };
 
 // TODO(kasperl): Should we call this interpreter?
+//
+// When [kThreaded] is true, the engine dispatches on the instructions decoded
+// by a [ThreadedCodeCache] instead of on the bytecodes. The bytecode pointer
+// is only kept up to date when the state is saved or a frame is pushed, so
+// the stack looks the same in both modes.
+template <bool kThreaded>
 class Engine : public State {
  public:
-  explicit Engine(Process* process) : State(process) {}
+  explicit Engine(Process* process)
+      : State(process), ip_(NULL), threaded_cache_(NULL), handlers_(NULL) {}
 
   Interpreter::InterruptKind Interpret(TargetYieldResult* target_yield_result);
 
  private:
+  // The bytecode pointer related operations of [State], reading the decoded
+  // instruction in threaded mode. The second operand of a bytecode is always
+  // read with an offset different from 1.
+  uint8 ReadByte(int offset) {
+    if (!kThreaded) return State::ReadByte(offset);
+    return ip_->operands[offset == 1 ? 0 : 1];
+  }
+
+  int ReadInt32(int offset) {
+    if (!kThreaded) return State::ReadInt32(offset);
+    return ip_->operands[offset == 1 ? 0 : 1];
+  }
+
+  Object* ReadConstant() const {
+    if (!kThreaded) return State::ReadConstant();
+    return ip_->constant;
+  }
+
+  void* ReadHandler(void** dispatch_table) const {
+    if (!kThreaded) return dispatch_table[ReadOpcode()];
+    return ip_->handler;
+  }
+
+  void Goto(uint8* bcp) {
+    State::Goto(bcp);
+    SyncInstructionPointer();
+  }
+
+  void Advance(int delta) {
+    if (!kThreaded) return State::Advance(delta);
+    ASSERT((ip_ + 1)->bcp == ip_->bcp + delta);
+    ip_++;
+  }
+
+  // Advances by [delta], which is the branch delta of the current bytecode
+  // if the branch is taken.
+  void Jump(int delta) {
+    if (!kThreaded) return State::Advance(delta);
+    ip_ = (delta == ip_->branch_delta) ? ip_->target : ip_ + 1;
+  }
+
+  uint8* ComputeByteCodePointer(int offset) {
+    if (!kThreaded) return State::ComputeByteCodePointer(offset);
+    return ip_->bcp + offset;
+  }
+
+  void SaveState() {
+    SyncByteCodePointer();
+    State::SaveState();
+  }
+
+  void RestoreState() {
+    State::RestoreState();
+    SyncInstructionPointer();
+  }
+
+  void PushFrameDescriptor(int offset) {
+    SyncByteCodePointer();
+    State::PushFrameDescriptor(offset);
+  }
+
+  void PopFrameDescriptor() {
+    State::PopFrameDescriptor();
+    SyncInstructionPointer();
+  }
+
+  void SyncByteCodePointer() {
+    if (kThreaded) State::Goto(ip_->bcp);
+  }
+
+  void SyncInstructionPointer() {
+    if (kThreaded) ip_ = threaded_cache_->Lookup(bcp(), handlers_);
+  }
+
   void Branch(int true_offset, int false_offset);
 
   void PushDelta(int delta);
@@ -195,6 +277,10 @@ class Engine : public State {
   Object* ToBool(bool value) const {
     return value ? program()->true_object() : program()->false_object();
   }
+
+  ThreadedInstruction* ip_;
+  ThreadedCodeCache* threaded_cache_;
+  void** handlers_;
 };
 
 #define STACK_OVERFLOW_CHECK(size)                                       \
@@ -223,9 +309,9 @@ class Engine : public State {
 #else
 #define DISPATCH()                                        \
   if (ShouldBreak()) return Interpreter::kBreakPoint;     \
-  goto *kDispatchTable[ReadOpcode()]
+  goto *ReadHandler(kDispatchTable)
 #define DISPATCH_NO_BREAK()                               \
-  goto *kDispatchTable[ReadOpcode()]
+  goto *ReadHandler(kDispatchTable)
 #define DISPATCH_TO(opcode)                               \
   goto opcode##Label
 #endif
@@ -238,7 +324,8 @@ class Engine : public State {
   }                  \
   DISPATCH()
 
-Interpreter::InterruptKind Engine::Interpret(
+template <bool kThreaded>
+Interpreter::InterruptKind Engine<kThreaded>::Interpret(
     TargetYieldResult* target_yield_result) {
 #ifdef FLETCH_TARGET_OS_WIN
 // TODO(herhut): This compiles but obviously does not work...
@@ -251,6 +338,14 @@ Interpreter::InterruptKind Engine::Interpret(
   };
 #undef LABEL
 
+  if (kThreaded) {
+    ThreadState* thread_state = process()->thread_state();
+    threaded_cache_ = thread_state->EnsureThreadedCodeCache();
+    if (threaded_cache_->IsFull()) threaded_cache_->Clear();
+    handlers_ = kDispatchTable;
+    SyncInstructionPointer();
+  }
+
   // Dispatch to the first bytecode.
   if (IsAtBreakPoint()) {
     DISPATCH_NO_BREAK();
@@ -530,7 +625,7 @@ Interpreter::InterruptKind Engine::Interpret(
   OPCODE_BEGIN(InvokeNative);
   int arity = ReadByte(1);
   Native native = static_cast<Native>(ReadByte(2));
-  Object** arguments = LocalPointer(arity + 2);
+  Object** arguments = LocalPointer(arity + NativeFrame::kArgumentsOffset);
   GC_AND_RETRY_ON_ALLOCATION_FAILURE_OR_SIGNAL_SCHEDULER(
       result, kNativeTable[native](process(), Arguments(arguments)));
   if (result->IsFailure()) {
@@ -575,7 +670,7 @@ Interpreter::InterruptKind Engine::Interpret(
   OPCODE_BEGIN(InvokeNativeYield);
   int arity = ReadByte(1);
   Native native = static_cast<Native>(ReadByte(2));
-  Object** arguments = LocalPointer(arity + 2);
+  Object** arguments = LocalPointer(arity + NativeFrame::kArgumentsOffset);
   GC_AND_RETRY_ON_ALLOCATION_FAILURE_OR_SIGNAL_SCHEDULER(
       result, kNativeTable[native](process(), Arguments(arguments)));
   if (result->IsFailure()) {
@@ -645,7 +740,7 @@ Interpreter::InterruptKind Engine::Interpret(
 
   OPCODE_BEGIN(BranchWide);
   int delta = ReadInt32(1);
-  Advance(delta);
+  Jump(delta);
   OPCODE_END();
 
   OPCODE_BEGIN(BranchIfTrueWide);
@@ -660,7 +755,7 @@ Interpreter::InterruptKind Engine::Interpret(
 
   OPCODE_BEGIN(BranchBack);
   STACK_OVERFLOW_CHECK(0);
-  Advance(-ReadByte(1));
+  Jump(-ReadByte(1));
   OPCODE_END();
 
   OPCODE_BEGIN(BranchBackIfTrue);
@@ -678,7 +773,7 @@ Interpreter::InterruptKind Engine::Interpret(
   OPCODE_BEGIN(BranchBackWide);
   STACK_OVERFLOW_CHECK(0);
   int delta = ReadInt32(1);
-  Advance(-delta);
+  Jump(-delta);
   OPCODE_END();
 
   OPCODE_BEGIN(BranchBackIfTrueWide);
@@ -697,7 +792,7 @@ Interpreter::InterruptKind Engine::Interpret(
   int pop_count = ReadByte(1);
   int delta = ReadInt32(2);
   Drop(pop_count);
-  Advance(delta);
+  Jump(delta);
   OPCODE_END();
 
   OPCODE_BEGIN(PopAndBranchBackWide);
@@ -705,7 +800,7 @@ Interpreter::InterruptKind Engine::Interpret(
   int pop_count = ReadByte(1);
   int delta = -ReadInt32(2);
   Drop(pop_count);
-  Advance(delta);
+  Jump(delta);
   OPCODE_END();
 
   OPCODE_BEGIN(Allocate);
@@ -908,11 +1003,11 @@ Interpreter::InterruptKind Engine::Interpret(
   int delta = ReadInt32(1);
   int return_delta = ReadInt32(5);
   PushDelta(return_delta);
-  Advance(delta);
+  Jump(delta);
   OPCODE_END();
 
   OPCODE_BEGIN(SubroutineReturn);
-  Advance(-PopDelta());
+  Goto(ComputeByteCodePointer(-PopDelta()));
   OPCODE_END();
 
   OPCODE_BEGIN(MethodEnd);
@@ -920,16 +1015,20 @@ Interpreter::InterruptKind Engine::Interpret(
   OPCODE_END();
 }  // NOLINT
 
-void Engine::Branch(int true_offset, int false_offset) {
+template <bool kThreaded>
+void Engine<kThreaded>::Branch(int true_offset, int false_offset) {
   int offset = (Pop() == program()->true_object()) ? true_offset : false_offset;
-  Advance(offset);
+  Jump(offset);
 }
 
-void Engine::PushDelta(int delta) { Push(Smi::FromWord(delta)); }
+template <bool kThreaded>
+void Engine<kThreaded>::PushDelta(int delta) { Push(Smi::FromWord(delta)); }
 
-int Engine::PopDelta() { return Smi::cast(Pop())->value(); }
+template <bool kThreaded>
+int Engine<kThreaded>::PopDelta() { return Smi::cast(Pop())->value(); }
 
-Process::StackCheckResult Engine::StackOverflowCheck(int size) {
+template <bool kThreaded>
+Process::StackCheckResult Engine<kThreaded>::StackOverflowCheck(int size) {
   if (HasStackSpaceFor(size)) return Process::kStackCheckContinue;
   SaveState();
   Process::StackCheckResult result = process()->HandleStackOverflow(size);
@@ -937,7 +1036,8 @@ Process::StackCheckResult Engine::StackOverflowCheck(int size) {
   return result;
 }
 
-bool Engine::DoThrow(Object* exception) {
+template <bool kThreaded>
+bool Engine<kThreaded>::DoThrow(Object* exception) {
   // Find the catch block address.
   int stack_delta = 0;
   Object** frame_pointer = NULL;
@@ -945,8 +1045,8 @@ bool Engine::DoThrow(Object* exception) {
       HandleThrow(process(), exception, &stack_delta, &frame_pointer);
   if (catch_bcp == NULL) return false;
   ASSERT(frame_pointer != NULL);
-  // Restore stack pointer and bcp.
-  RestoreState();
+  // Restore stack pointer and bcp. The catch block is looked up below.
+  State::RestoreState();
   SetFramePointer(frame_pointer);
   StoreByteCodePointer(NULL);
   Goto(catch_bcp);
@@ -957,14 +1057,16 @@ bool Engine::DoThrow(Object* exception) {
   return true;
 }
 
-bool Engine::CollectGarbageIfNecessary() {
+template <bool kThreaded>
+bool Engine<kThreaded>::CollectGarbageIfNecessary() {
   if (process()->heap()->needs_garbage_collection()) {
     CollectMutableGarbage();
   }
   return process()->immutable_heap()->needs_garbage_collection();
 }
 
-void Engine::CollectMutableGarbage() {
+template <bool kThreaded>
+void Engine<kThreaded>::CollectMutableGarbage() {
   SaveState();
   process()->CollectMutableGarbage();
   RestoreState();
@@ -978,7 +1080,8 @@ void Engine::CollectMutableGarbage() {
   process()->store_buffer()->Insert(process()->stack());
 }
 
-void Engine::ValidateStack() {
+template <bool kThreaded>
+void Engine<kThreaded>::ValidateStack() {
   SaveState();
   Frame frame(process()->stack());
   while (frame.MovePrevious()) {
@@ -990,7 +1093,10 @@ void Engine::ValidateStack() {
   RestoreState();
 }
 
-bool Engine::ShouldBreak() {
+template <bool kThreaded>
+bool Engine<kThreaded>::ShouldBreak() {
+  // The threaded engine is only used when no debugger is attached.
+  if (kThreaded) return false;
   DebugInfo* debug_info = process()->debug_info();
   if (debug_info != NULL) {
     bool should_break = debug_info->ShouldBreak(bcp(), sp());
@@ -1000,7 +1106,8 @@ bool Engine::ShouldBreak() {
   return false;
 }
 
-bool Engine::IsAtBreakPoint() {
+template <bool kThreaded>
+bool Engine<kThreaded>::IsAtBreakPoint() {
   DebugInfo* debug_info = process()->debug_info();
   if (process()->debug_info() != NULL) {
     bool result = debug_info->is_at_breakpoint();
@@ -1032,7 +1139,13 @@ void Interpreter::Run() {
   // This is conservative.
   process_->store_buffer()->Insert(process_->stack());
 
+#ifdef FLETCH_ENABLE_CPP_INTERPRETER
+  int result = Flags::native_interpreter
+                   ? InterpretFast(process_, &target_yield_result_)
+                   : -1;
+#else
   int result = InterpretFast(process_, &target_yield_result_);
+#endif
   if (result < 0) {
     interruption_ = HandleBailout();
   } else {
@@ -1045,14 +1158,17 @@ void Interpreter::Run() {
 }
 
 Interpreter::InterruptKind Interpreter::HandleBailout() {
-#if !defined(FLETCH_ENABLE_LIVE_CODING) && \
-    (defined(FLETCH_TARGET_IA32) || defined(FLETCH_TARGET_ARM))
+#ifndef FLETCH_ENABLE_CPP_INTERPRETER
   // When live coding is disabled on a fully supported platform, we don't
   // need to bundle in the slow interpreter.
   FATAL("Unsupported bailout from native interpreter");
   return kTerminate;
 #else
-  Engine engine(process_);
+  if (Flags::threaded_interpreter && process_->debug_info() == NULL) {
+    Engine<true> engine(process_);
+    return engine.Interpret(&target_yield_result_);
+  }
+  Engine<false> engine(process_);
   return engine.Interpret(&target_yield_result_);
 #endif
 }
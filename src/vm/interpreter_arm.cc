@@ -9,6 +9,7 @@
 #include "src/shared/selectors.h"
 
 #include "src/vm/assembler.h"
+#include "src/vm/frame.h"
 #include "src/vm/generator.h"
 #include "src/vm/interpreter.h"
 #include "src/vm/intrinsics.h"
@@ -1681,7 +1682,7 @@ void InterpreterGeneratorARM::InvokeMethod(bool test) {
 void InterpreterGeneratorARM::InvokeNative(bool yield) {
   __ ldrb(R1, Address(R5, 1));
   // Also skip two empty slots.
-  __ add(R1, R1, Immediate(2));
+  __ add(R1, R1, Immediate(NativeFrame::kArgumentsOffset));
   __ ldrb(R0, Address(R5, 2));
 
   // Load native from native table.
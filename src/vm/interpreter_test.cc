@@ -0,0 +1,124 @@
+// Copyright (c) 2015, the Fletch project authors. Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE.md file.
+
+// The generated x64 interpreter handles the arithmetic on small integers
+// used below without bailing out, so the program runs without any classes
+// or methods besides the static functions.
+#if defined(FLETCH_TARGET_X64) && defined(FLETCH_TARGET_OS_POSIX)
+
+#include "src/shared/bytecodes.h"
+#include "src/shared/test_case.h"
+
+#include "src/vm/interpreter.h"
+#include "src/vm/object.h"
+#include "src/vm/process.h"
+#include "src/vm/program.h"
+#include "src/vm/test_program.h"
+
+namespace fletch {
+
+enum { kMainIndex, kFibIndex, kSumIndex };
+
+// fib(n) => n < 2 ? n : fib(n - 1) + fib(n - 2)
+static uint8 kFibBytecodes[] = {
+  kLoadLocal3,                              // 0
+  kLoadLiteral, 2,                          // 1
+  kInvokeLt, 0, 0, 0, 0,                    // 3
+  kBranchIfFalseWide, 8, 0, 0, 0,           // 8: branch +8
+  kLoadLocal3,                              // 13
+  kReturn, 1,                               // 14
+  kLoadLocal3,                              // 16
+  kLoadLiteral1,                            // 17
+  kInvokeSub, 0, 0, 0, 0,                   // 18
+  kInvokeStatic, kFibIndex, 0, 0, 0,        // 23
+  kLoadLocal4,                              // 28
+  kLoadLiteral, 2,                          // 29
+  kInvokeSub, 0, 0, 0, 0,                   // 31
+  kInvokeStatic, kFibIndex, 0, 0, 0,        // 36
+  kInvokeAdd, 0, 0, 0, 0,                   // 41
+  kReturn, 1,                               // 46
+};
+
+// sum(n) => n == 0 ? 0 : n + sum(n - 1)
+static uint8 kSumBytecodes[] = {
+  kLoadLocal3,                              // 0
+  kLoadLiteral0,                            // 1
+  kInvokeEq, 0, 0, 0, 0,                    // 2
+  kBranchIfFalseWide, 8, 0, 0, 0,           // 7: branch +8
+  kLoadLiteral0,                            // 12
+  kReturn, 1,                               // 13
+  kLoadLocal3,                              // 15
+  kLoadLocal4,                              // 16
+  kLoadLiteral1,                            // 17
+  kInvokeSub, 0, 0, 0, 0,                   // 18
+  kInvokeStatic, kSumIndex, 0, 0, 0,        // 23
+  kInvokeAdd, 0, 0, 0, 0,                   // 28
+  kReturn, 1,                               // 33
+};
+
+// Leaves fib(27), ((fib(27) * 3) ~/ 2) % -1000 - ((fib(27) >> 3) << 2) and
+// sum(20000) on the stack, and terminates.
+static uint8 kMainBytecodes[] = {
+  kLoadLiteralWide, 27, 0, 0, 0,            // 0
+  kInvokeStatic, kFibIndex, 0, 0, 0,        // 5
+  kLoadLocal0,                              // 10
+  kLoadLiteral, 3,                          // 11
+  kInvokeMul, 0, 0, 0, 0,                   // 13
+  kLoadLiteral, 2,                          // 18
+  kInvokeTruncDiv, 0, 0, 0, 0,              // 20
+  kLoadLiteralWide, 0x18, 0xfc, 0xff, 0xff, // 25: -1000
+  kInvokeMod, 0, 0, 0, 0,                   // 30
+  kLoadLocal1,                              // 35
+  kLoadLiteral, 3,                          // 36
+  kInvokeBitShr, 0, 0, 0, 0,                // 38
+  kLoadLiteral, 2,                          // 43
+  kInvokeBitShl, 0, 0, 0, 0,                // 45
+  kInvokeSub, 0, 0, 0, 0,                   // 50
+  kLoadLiteralWide, 0x20, 0x4e, 0, 0,       // 55: 20000
+  kInvokeStatic, kSumIndex, 0, 0, 0,        // 60
+  kLoadLiteral, Interpreter::kTerminate,    // 65
+  kProcessYield,                            // 67
+};
+
+TEST_CASE(Interpreter_GeneratedFastPaths) {
+  TestProgram test;
+  Program* program = test.program();
+  Function* main =
+      test.CreateFunction(kMainBytecodes, sizeof(kMainBytecodes));
+  Function* fib =
+      test.CreateFunction(kFibBytecodes, sizeof(kFibBytecodes), 1);
+  Function* sum =
+      test.CreateFunction(kSumBytecodes, sizeof(kSumBytecodes), 1);
+  {
+    NoAllocationFailureScope scope(program->heap()->space());
+    Array* statics = Array::cast(program->CreateArray(3));
+    statics->set(kMainIndex, main);
+    statics->set(kFibIndex, fib);
+    statics->set(kSumIndex, sum);
+    program->set_static_methods(statics);
+  }
+  program->set_entry(main);
+
+  // The recursion in sum grows the stack several times.
+  Process* process = program->ProcessSpawnForMain();
+  ThreadState thread_state;
+  thread_state.AttachToCurrentThread();
+  process->set_thread_state(&thread_state);
+  Interpreter interpreter(process);
+  interpreter.Run();
+  process->set_thread_state(NULL);
+  EXPECT(interpreter.IsTerminated());
+
+  Stack* stack = process->stack();
+  word top = stack->top();
+  EXPECT_EQ(196418, Smi::cast(stack->get(top + 5))->value());
+  EXPECT_EQ(-97581, Smi::cast(stack->get(top + 4))->value());
+  EXPECT_EQ(200010000, Smi::cast(stack->get(top + 3))->value());
+
+  test.DeleteProcess(process);
+}
+
+}  // namespace fletch
+
+#endif  // defined(FLETCH_TARGET_X64) && defined(FLETCH_TARGET_OS_POSIX)
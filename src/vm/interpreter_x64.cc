@@ -0,0 +1,2130 @@
+// Copyright (c) 2015, the Fletch project authors. Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE.md file.
+
+#if defined(FLETCH_TARGET_X64) && defined(FLETCH_TARGET_OS_POSIX)
+
+#include "src/shared/bytecodes.h"
+#include "src/shared/names.h"
+#include "src/shared/selectors.h"
+
+#include "src/vm/assembler.h"
+#include "src/vm/frame.h"
+#include "src/vm/generator.h"
+#include "src/vm/interpreter.h"
+#include "src/vm/intrinsics.h"
+#include "src/vm/object.h"
+#include "src/vm/process.h"
+#include "src/vm/program.h"
+
+#define __ assembler()->
+
+namespace fletch {
+
+class InterpreterGenerator {
+ public:
+  explicit InterpreterGenerator(Assembler* assembler) : assembler_(assembler) {}
+
+  void Generate();
+
+  virtual void GeneratePrologue() = 0;
+  virtual void GenerateEpilogue() = 0;
+
+  virtual void GenerateBytecodePrologue(const char* name) = 0;
+  virtual void GenerateDebugAtBytecode() = 0;
+
+#define V(name, branching, format, size, stack_diff, print) \
+  virtual void Do##name() = 0;
+  BYTECODES_DO(V)
+#undef V
+
+#define V(name) virtual void DoIntrinsic##name() = 0;
+  INTRINSICS_DO(V)
+#undef V
+
+ protected:
+  Assembler* assembler() const { return assembler_; }
+
+ private:
+  Assembler* const assembler_;
+};
+
+void InterpreterGenerator::Generate() {
+  GeneratePrologue();
+  GenerateEpilogue();
+
+  GenerateDebugAtBytecode();
+
+#define V(name, branching, format, size, stack_diff, print) \
+  GenerateBytecodePrologue("BC_" #name);                    \
+  Do##name();
+  BYTECODES_DO(V)
+#undef V
+
+  // The intrinsics are stored as smis in the dispatch table, so they
+  // must be aligned.
+#define V(name)                    \
+  __ AlignToPowerOfTwo(3);         \
+  __ Bind("", "Intrinsic_" #name); \
+  DoIntrinsic##name();
+  INTRINSICS_DO(V)
+#undef V
+
+  __ SwitchToData();
+  __ BindWithPowerOfTwoAlignment("InterpretFast_DispatchTable", 4);
+#define V(name, branching, format, size, stack_diff, print) \
+  __ DefineQuad("BC_" #name);
+  BYTECODES_DO(V)
+#undef V
+
+  puts("\n");
+}
+
+class InterpreterGeneratorX64 : public InterpreterGenerator {
+ public:
+  explicit InterpreterGeneratorX64(Assembler* assembler)
+      : InterpreterGenerator(assembler), spill_size_(-1) {}
+
+  // Registers
+  // ---------
+  //   rsp: stack pointer (top)
+  //   rbp: frame pointer
+  //   r12: dispatch table
+  //   r13: bytecode pointer
+  //   r14: C stack pointer
+  //   r15: process
+  //
+  // All of them are callee-saved in the System V calling convention, so
+  // they survive calls into the runtime.
+
+  virtual void GeneratePrologue();
+  virtual void GenerateEpilogue();
+
+  virtual void GenerateBytecodePrologue(const char* name);
+  virtual void GenerateDebugAtBytecode();
+
+  virtual void DoLoadLocal0();
+  virtual void DoLoadLocal1();
+  virtual void DoLoadLocal2();
+  virtual void DoLoadLocal3();
+  virtual void DoLoadLocal4();
+  virtual void DoLoadLocal5();
+  virtual void DoLoadLocal();
+  virtual void DoLoadLocalWide();
+
+  virtual void DoLoadBoxed();
+  virtual void DoLoadStatic();
+  virtual void DoLoadStaticInit();
+  virtual void DoLoadField();
+  virtual void DoLoadFieldWide();
+
+  virtual void DoLoadConst();
+  virtual void DoLoadConstUnfold();
+
+  virtual void DoStoreLocal();
+  virtual void DoStoreBoxed();
+  virtual void DoStoreStatic();
+  virtual void DoStoreField();
+  virtual void DoStoreFieldWide();
+
+  virtual void DoLoadLiteralNull();
+  virtual void DoLoadLiteralTrue();
+  virtual void DoLoadLiteralFalse();
+  virtual void DoLoadLiteral0();
+  virtual void DoLoadLiteral1();
+  virtual void DoLoadLiteral();
+  virtual void DoLoadLiteralWide();
+
+  virtual void DoInvokeMethodUnfold();
+  virtual void DoInvokeMethod();
+
+  virtual void DoInvokeNoSuchMethod();
+  virtual void DoInvokeTestNoSuchMethod();
+
+  virtual void DoInvokeStatic();
+  virtual void DoInvokeStaticUnfold();
+  virtual void DoInvokeFactory();
+  virtual void DoInvokeFactoryUnfold();
+
+  virtual void DoInvokeNative();
+  virtual void DoInvokeNativeYield();
+
+  virtual void DoInvokeSelector();
+
+  virtual void DoInvokeTestUnfold();
+  virtual void DoInvokeTest();
+
+#define INVOKE_BUILTIN(kind)               \
+  virtual void DoInvoke##kind##Unfold() {  \
+    Invoke##kind("BC_InvokeMethodUnfold"); \
+  }                                        \
+  virtual void DoInvoke##kind() { Invoke##kind("BC_InvokeMethod"); }
+
+  INVOKE_BUILTIN(Eq);
+  INVOKE_BUILTIN(Lt);
+  INVOKE_BUILTIN(Le);
+  INVOKE_BUILTIN(Gt);
+  INVOKE_BUILTIN(Ge);
+
+  INVOKE_BUILTIN(Add);
+  INVOKE_BUILTIN(Sub);
+  INVOKE_BUILTIN(Mod);
+  INVOKE_BUILTIN(Mul);
+  INVOKE_BUILTIN(TruncDiv);
+
+  INVOKE_BUILTIN(BitNot);
+  INVOKE_BUILTIN(BitAnd);
+  INVOKE_BUILTIN(BitOr);
+  INVOKE_BUILTIN(BitXor);
+  INVOKE_BUILTIN(BitShr);
+  INVOKE_BUILTIN(BitShl);
+
+#undef INVOKE_BUILTIN
+
+  virtual void DoPop();
+  virtual void DoDrop();
+  virtual void DoReturn();
+  virtual void DoReturnNull();
+
+  virtual void DoBranchWide();
+  virtual void DoBranchIfTrueWide();
+  virtual void DoBranchIfFalseWide();
+
+  virtual void DoBranchBack();
+  virtual void DoBranchBackIfTrue();
+  virtual void DoBranchBackIfFalse();
+
+  virtual void DoBranchBackWide();
+  virtual void DoBranchBackIfTrueWide();
+  virtual void DoBranchBackIfFalseWide();
+
+  virtual void DoPopAndBranchWide();
+  virtual void DoPopAndBranchBackWide();
+
+  virtual void DoAllocate();
+  virtual void DoAllocateUnfold();
+  virtual void DoAllocateImmutable();
+  virtual void DoAllocateImmutableUnfold();
+  virtual void DoAllocateBoxed();
+
+  virtual void DoNegate();
+
+  virtual void DoStackOverflowCheck();
+
+  virtual void DoThrow();
+  // Expects to be called after SaveState with the exception object in RBX.
+  virtual void DoThrowAfterSaveState();
+  virtual void DoSubroutineCall();
+  virtual void DoSubroutineReturn();
+
+  virtual void DoProcessYield();
+  virtual void DoCoroutineChange();
+
+  virtual void DoIdentical();
+  virtual void DoIdenticalNonNumeric();
+
+  virtual void DoEnterNoSuchMethod();
+  virtual void DoExitNoSuchMethod();
+
+  virtual void DoMethodEnd();
+
+  virtual void DoIntrinsicObjectEquals();
+  virtual void DoIntrinsicGetField();
+  virtual void DoIntrinsicSetField();
+  virtual void DoIntrinsicListIndexGet();
+  virtual void DoIntrinsicListIndexSet();
+  virtual void DoIntrinsicListLength();
+
+ private:
+  Label done_;
+  Label gc_;
+  Label check_stack_overflow_;
+  Label check_stack_overflow_0_;
+  Label intrinsic_failure_;
+  int spill_size_;
+
+  void LoadLocal(Register reg, int index);
+  void StoreLocal(Register reg, int index);
+
+  void Push(Register reg);
+  void Push(const Immediate& value);
+  void Pop(Register reg);
+  void Drop(int n);
+  void Drop(Register reg);
+
+  void LoadProcess(Register reg);
+  void LoadProgram(Register reg);
+  void LoadStaticsArray(Register reg);
+  void LoadLiteralNull(Register reg);
+  void LoadLiteralTrue(Register reg);
+  void LoadLiteralFalse(Register reg);
+
+  void SwitchToDartStack();
+  void SwitchToCStack();
+
+  void PushFrameDescriptor(Register bcp);
+  void ReadFrameDescriptor();
+
+  void Return(bool is_return_null);
+
+  void Allocate(bool unfolded, bool immutable);
+
+  // This function
+  //   * changes caller-saved registers
+  void AddToStoreBufferSlow(Register object, Register value);
+
+  void InvokeMethodUnfold(bool test);
+  void InvokeMethod(bool test);
+
+  void InvokeStatic(bool unfolded);
+
+  void InvokeEq(const char* fallback);
+  void InvokeLt(const char* fallback);
+  void InvokeLe(const char* fallback);
+  void InvokeGt(const char* fallback);
+  void InvokeGe(const char* fallback);
+  void InvokeCompare(const char* fallback, Condition condition);
+
+  void InvokeAdd(const char* fallback);
+  void InvokeSub(const char* fallback);
+  void InvokeMod(const char* fallback);
+  void InvokeMul(const char* fallback);
+  void InvokeTruncDiv(const char* fallback);
+
+  void InvokeBitNot(const char* fallback);
+  void InvokeBitAnd(const char* fallback);
+  void InvokeBitOr(const char* fallback);
+  void InvokeBitXor(const char* fallback);
+  void InvokeBitShr(const char* fallback);
+  void InvokeBitShl(const char* fallback);
+
+  // Load the two topmost stack slots into [left] and [right] and jump to
+  // [fallback] unless both are smis.
+  void LoadSmiOperands(Register left, Register right, const char* fallback);
+
+  void InvokeNative(bool yield);
+
+  void CheckStackOverflow(int size);
+
+  void Dispatch(int size);
+
+  void SaveState();
+  void RestoreState();
+
+  static int ComputeStackPadding(int reserved, int extra) {
+    const int kAlignment = 16;
+    int rounded = (reserved + extra + kAlignment - 1) & ~(kAlignment - 1);
+    return rounded - reserved;
+  }
+};
+
+GENERATE(, InterpretFast) {
+  InterpreterGeneratorX64 generator(assembler);
+  generator.Generate();
+}
+
+void InterpreterGeneratorX64::GeneratePrologue() {
+  __ pushq(RBP);
+  __ pushq(RBX);
+  __ pushq(R12);
+  __ pushq(R13);
+  __ pushq(R14);
+  __ pushq(R15);
+
+  // Keep the current process in a register.
+  __ movq(R15, RDI);
+
+  // Push the target yield result.
+  __ pushq(RSI);
+
+  // Create room for Dart stack, when doing native calls.
+  __ pushq(Immediate(0));
+
+  // Pad the stack to guarantee the right alignment for calls. Reserved is
+  // 6 registers, 1 return address, 1 target yield result and 1 Dart stack
+  // slot. The padding has room for the two results of HandleThrow.
+  spill_size_ = ComputeStackPadding(9 * kWordSize, 2 * kWordSize);
+  __ subq(RSP, Immediate(spill_size_));
+
+  __ LoadAddress(R12, "InterpretFast_DispatchTable");
+
+  // Restore the register state and dispatch to the first bytecode.
+  RestoreState();
+  Dispatch(0);
+}
+
+void InterpreterGeneratorX64::GenerateEpilogue() {
+  // Done. Start by saving the register state.
+  __ Bind(&done_);
+  SaveState();
+
+  // Undo stack padding.
+  Label undo_padding;
+  __ Bind(&undo_padding);
+  __ addq(RSP, Immediate(spill_size_));
+
+  // Skip Dart stack slot and target yield result.
+  __ addq(RSP, Immediate(2 * kWordSize));
+
+  // Restore callee-saved registers.
+  __ popq(R15);
+  __ popq(R14);
+  __ popq(R13);
+  __ popq(R12);
+  __ popq(RBX);
+  __ popq(RBP);
+  __ ret();
+
+#ifdef FLETCH_ENABLE_MULTIPLE_PROCESS_HEAPS
+  // Handle immutable heap allocation failures.
+  Label immutable_alloc_failure;
+  __ Bind(&immutable_alloc_failure);
+  __ movl(RAX, Immediate(Interpreter::kImmutableAllocationFailure));
+  __ jmp(&undo_padding);
+#endif  // #ifdef FLETCH_ENABLE_MULTIPLE_PROCESS_HEAPS
+
+  // Handle GC and re-interpret current bytecode.
+  __ Bind(&gc_);
+  SaveState();
+  __ movq(RDI, R15);
+  __ call("HandleGC");
+#ifdef FLETCH_ENABLE_MULTIPLE_PROCESS_HEAPS
+  __ testl(RAX, RAX);
+  __ j(NOT_ZERO, &immutable_alloc_failure);
+#endif  // #ifdef FLETCH_ENABLE_MULTIPLE_PROCESS_HEAPS
+  RestoreState();
+  Dispatch(0);
+
+  // Stack overflow handling (slow case).
+  Label stay_fast, overflow, check_debug_interrupt;
+  __ Bind(&check_stack_overflow_0_);
+  __ movl(RAX, Immediate(0));
+  __ Bind(&check_stack_overflow_);
+  SaveState();
+
+  __ movq(RDI, R15);
+  __ movq(RSI, RAX);
+  __ call("HandleStackOverflow");
+  __ testl(RAX, RAX);
+  ASSERT(Process::kStackCheckContinue == 0);
+  __ j(ZERO, &stay_fast);
+  __ cmpl(RAX, Immediate(Process::kStackCheckInterrupt));
+  __ j(NOT_EQUAL, &check_debug_interrupt);
+  __ movl(RAX, Immediate(Interpreter::kInterrupt));
+  __ jmp(&undo_padding);
+  __ Bind(&check_debug_interrupt);
+  __ cmpl(RAX, Immediate(Process::kStackCheckDebugInterrupt));
+  __ j(NOT_EQUAL, &overflow);
+  __ movl(RAX, Immediate(Interpreter::kBreakPoint));
+  __ jmp(&undo_padding);
+
+  __ Bind(&stay_fast);
+  RestoreState();
+  Dispatch(0);
+
+  __ Bind(&overflow);
+  LoadProgram(RBX);
+  __ movq(RBX, Address(RBX, Program::kStackOverflowErrorOffset));
+  DoThrowAfterSaveState();
+
+  // Intrinsic failure: Just invoke the method.
+  __ Bind(&intrinsic_failure_);
+  __ addq(R13, Immediate(kInvokeMethodLength));
+  PushFrameDescriptor(R13);
+  __ leaq(R13, Address(RAX, Function::kSize - HeapObject::kTag));
+  Dispatch(0);
+}
+
+void InterpreterGeneratorX64::GenerateBytecodePrologue(const char* name) {
+  __ SwitchToText();
+  __ AlignToPowerOfTwo(3);
+  __ nop();
+  __ nop();
+  __ nop();
+  __ nop();
+  __ Bind("Debug_", name);
+  __ call("DebugAtBytecode");
+  __ AlignToPowerOfTwo(3);
+  __ Bind("", name);
+}
+
+void InterpreterGeneratorX64::GenerateDebugAtBytecode() {
+  __ SwitchToText();
+  __ AlignToPowerOfTwo(4);
+  __ Bind("", "DebugAtBytecode");
+  // TODO(ajohnsen): Check if the process has debug_info set.
+  __ popq(RBX);
+  __ movq(RDX, RSP);
+  SwitchToCStack();
+  __ movq(RDI, R15);
+  __ movq(RSI, R13);
+  __ call("HandleAtBytecode");
+  SwitchToDartStack();
+  __ testl(RAX, RAX);
+  __ j(NOT_ZERO, &done_);
+  __ pushq(RBX);
+  __ ret();
+}
+
+void InterpreterGeneratorX64::DoLoadLocal0() {
+  LoadLocal(RAX, 0);
+  Push(RAX);
+  Dispatch(1);
+}
+
+void InterpreterGeneratorX64::DoLoadLocal1() {
+  LoadLocal(RAX, 1);
+  Push(RAX);
+  Dispatch(1);
+}
+
+void InterpreterGeneratorX64::DoLoadLocal2() {
+  LoadLocal(RAX, 2);
+  Push(RAX);
+  Dispatch(1);
+}
+
+void InterpreterGeneratorX64::DoLoadLocal3() {
+  LoadLocal(RAX, 3);
+  Push(RAX);
+  Dispatch(1);
+}
+
+void InterpreterGeneratorX64::DoLoadLocal4() {
+  LoadLocal(RAX, 4);
+  Push(RAX);
+  Dispatch(1);
+}
+
+void InterpreterGeneratorX64::DoLoadLocal5() {
+  LoadLocal(RAX, 5);
+  Push(RAX);
+  Dispatch(1);
+}
+
+void InterpreterGeneratorX64::DoLoadLocal() {
+  __ movzbl(RAX, Address(R13, 1));
+  __ movq(RAX, Address(RSP, RAX, TIMES_8));
+  Push(RAX);
+  Dispatch(kLoadLocalLength);
+}
+
+void InterpreterGeneratorX64::DoLoadLocalWide() {
+  __ movl(RAX, Address(R13, 1));
+  __ movq(RAX, Address(RSP, RAX, TIMES_8));
+  Push(RAX);
+  Dispatch(kLoadLocalWideLength);
+}
+
+void InterpreterGeneratorX64::DoLoadBoxed() {
+  __ movzbl(RAX, Address(R13, 1));
+  __ movq(RBX, Address(RSP, RAX, TIMES_8));
+  __ movq(RAX, Address(RBX, Boxed::kValueOffset - HeapObject::kTag));
+  Push(RAX);
+  Dispatch(kLoadBoxedLength);
+}
+
+void InterpreterGeneratorX64::DoLoadStatic() {
+  __ movl(RAX, Address(R13, 1));
+  LoadStaticsArray(RBX);
+  __ movq(RAX, Address(RBX, RAX, TIMES_8, Array::kSize - HeapObject::kTag));
+  Push(RAX);
+  Dispatch(kLoadStaticLength);
+}
+
+void InterpreterGeneratorX64::DoLoadStaticInit() {
+  __ movl(RAX, Address(R13, 1));
+  LoadStaticsArray(RBX);
+  __ movq(RAX, Address(RBX, RAX, TIMES_8, Array::kSize - HeapObject::kTag));
+
+  Label done;
+  ASSERT(Smi::kTag == 0);
+  __ testq(RAX, Immediate(Smi::kTagMask));
+  __ j(ZERO, &done);
+  __ movq(RBX, Address(RAX, HeapObject::kClassOffset - HeapObject::kTag));
+  __ movq(RBX, Address(RBX, Class::kInstanceFormatOffset - HeapObject::kTag));
+
+  int type = InstanceFormat::INITIALIZER_TYPE;
+  __ andq(RBX, Immediate(InstanceFormat::TypeField::mask()));
+  __ cmpq(RBX, Immediate(type << InstanceFormat::TypeField::shift()));
+  __ j(NOT_EQUAL, &done);
+
+  // Invoke the initializer function.
+  __ movq(RAX, Address(RAX, Initializer::kFunctionOffset - HeapObject::kTag));
+  __ addq(R13, Immediate(kLoadStaticInitLength));
+  PushFrameDescriptor(R13);
+
+  // Jump to the first bytecode in the initializer function.
+  __ leaq(R13, Address(RAX, Function::kSize - HeapObject::kTag));
+  CheckStackOverflow(0);
+  Dispatch(0);
+
+  __ Bind(&done);
+  Push(RAX);
+  Dispatch(kLoadStaticInitLength);
+}
+
+void InterpreterGeneratorX64::DoLoadField() {
+  __ movzbl(RBX, Address(R13, 1));
+  LoadLocal(RAX, 0);
+  __ movq(RAX,
+          Address(RAX, RBX, TIMES_8, Instance::kSize - HeapObject::kTag));
+  StoreLocal(RAX, 0);
+  Dispatch(kLoadFieldLength);
+}
+
+void InterpreterGeneratorX64::DoLoadFieldWide() {
+  __ movl(RBX, Address(R13, 1));
+  LoadLocal(RAX, 0);
+  __ movq(RAX,
+          Address(RAX, RBX, TIMES_8, Instance::kSize - HeapObject::kTag));
+  StoreLocal(RAX, 0);
+  Dispatch(kLoadFieldWideLength);
+}
+
+void InterpreterGeneratorX64::DoLoadConst() {
+  __ movl(RAX, Address(R13, 1));
+  LoadProgram(RBX);
+  __ movq(RBX, Address(RBX, Program::kConstantsOffset));
+  __ movq(RAX, Address(RBX, RAX, TIMES_8, Array::kSize - HeapObject::kTag));
+  Push(RAX);
+  Dispatch(kLoadConstLength);
+}
+
+void InterpreterGeneratorX64::DoLoadConstUnfold() {
+  __ movsxl(RAX, Address(R13, 1));
+  __ movq(RAX, Address(R13, RAX, TIMES_1));
+  Push(RAX);
+  Dispatch(kLoadConstUnfoldLength);
+}
+
+void InterpreterGeneratorX64::DoStoreLocal() {
+  LoadLocal(RBX, 0);
+  __ movzbl(RAX, Address(R13, 1));
+  __ movq(Address(RSP, RAX, TIMES_8), RBX);
+  Dispatch(kStoreLocalLength);
+}
+
+void InterpreterGeneratorX64::DoStoreBoxed() {
+  LoadLocal(RCX, 0);
+  __ movzbl(RAX, Address(R13, 1));
+  __ movq(RBX, Address(RSP, RAX, TIMES_8));
+  __ movq(Address(RBX, Boxed::kValueOffset - HeapObject::kTag), RCX);
+
+  AddToStoreBufferSlow(RBX, RCX);
+
+  Dispatch(kStoreBoxedLength);
+}
+
+void InterpreterGeneratorX64::DoStoreStatic() {
+  LoadLocal(RCX, 0);
+  __ movl(RAX, Address(R13, 1));
+  LoadStaticsArray(RBX);
+  __ movq(Address(RBX, RAX, TIMES_8, Array::kSize - HeapObject::kTag), RCX);
+
+  AddToStoreBufferSlow(RBX, RCX);
+
+  Dispatch(kStoreStaticLength);
+}
+
+void InterpreterGeneratorX64::DoStoreField() {
+  __ movzbl(RBX, Address(R13, 1));
+  LoadLocal(RCX, 0);
+  LoadLocal(RAX, 1);
+  __ movq(Address(RAX, RBX, TIMES_8, Instance::kSize - HeapObject::kTag),
+          RCX);
+  StoreLocal(RCX, 1);
+  Drop(1);
+
+  AddToStoreBufferSlow(RAX, RCX);
+
+  Dispatch(kStoreFieldLength);
+}
+
+void InterpreterGeneratorX64::DoStoreFieldWide() {
+  __ movl(RBX, Address(R13, 1));
+  LoadLocal(RCX, 0);
+  LoadLocal(RAX, 1);
+  __ movq(Address(RAX, RBX, TIMES_8, Instance::kSize - HeapObject::kTag),
+          RCX);
+  StoreLocal(RCX, 1);
+  Drop(1);
+
+  AddToStoreBufferSlow(RAX, RCX);
+
+  Dispatch(kStoreFieldWideLength);
+}
+
+void InterpreterGeneratorX64::DoLoadLiteralNull() {
+  LoadLiteralNull(RAX);
+  Push(RAX);
+  Dispatch(kLoadLiteralNullLength);
+}
+
+void InterpreterGeneratorX64::DoLoadLiteralTrue() {
+  LoadLiteralTrue(RAX);
+  Push(RAX);
+  Dispatch(kLoadLiteralTrueLength);
+}
+
+void InterpreterGeneratorX64::DoLoadLiteralFalse() {
+  LoadLiteralFalse(RAX);
+  Push(RAX);
+  Dispatch(kLoadLiteralFalseLength);
+}
+
+void InterpreterGeneratorX64::DoLoadLiteral0() {
+  Push(Immediate(reinterpret_cast<word>(Smi::FromWord(0))));
+  Dispatch(kLoadLiteral0Length);
+}
+
+void InterpreterGeneratorX64::DoLoadLiteral1() {
+  Push(Immediate(reinterpret_cast<word>(Smi::FromWord(1))));
+  Dispatch(kLoadLiteral1Length);
+}
+
+void InterpreterGeneratorX64::DoLoadLiteral() {
+  __ movzbl(RAX, Address(R13, 1));
+  ASSERT(Smi::kTag == 0);
+  __ shlq(RAX, Immediate(Smi::kTagSize));
+  Push(RAX);
+  Dispatch(kLoadLiteralLength);
+}
+
+void InterpreterGeneratorX64::DoLoadLiteralWide() {
+  ASSERT(Smi::kTag == 0);
+  __ movsxl(RAX, Address(R13, 1));
+  __ shlq(RAX, Immediate(Smi::kTagSize));
+  Push(RAX);
+  Dispatch(kLoadLiteralWideLength);
+}
+
+void InterpreterGeneratorX64::DoInvokeMethodUnfold() {
+  InvokeMethodUnfold(false);
+}
+
+void InterpreterGeneratorX64::DoInvokeMethod() { InvokeMethod(false); }
+
+void InterpreterGeneratorX64::DoInvokeNoSuchMethod() {
+  // Use the noSuchMethod entry from entry zero of the virtual table.
+  LoadProgram(RCX);
+  __ movq(RCX, Address(RCX, Program::kDispatchTableOffset));
+  __ movq(RCX, Address(RCX, Array::kSize - HeapObject::kTag));
+
+  // Load the function at index 2.
+  __ movq(RAX,
+          Address(RCX, 2 * kWordSize + Array::kSize - HeapObject::kTag));
+
+  // Compute and push the return bcp on the stack.
+  __ addq(R13, Immediate(kInvokeNoSuchMethodLength));
+  PushFrameDescriptor(R13);
+
+  // Jump to the first bytecode in the target method.
+  __ leaq(R13, Address(RAX, Function::kSize - HeapObject::kTag));
+  CheckStackOverflow(0);
+  Dispatch(0);
+}
+
+void InterpreterGeneratorX64::DoInvokeTestNoSuchMethod() {
+  LoadLiteralFalse(RAX);
+  StoreLocal(RAX, 0);
+  Dispatch(kInvokeTestNoSuchMethodLength);
+}
+
+void InterpreterGeneratorX64::DoInvokeTestUnfold() { InvokeMethodUnfold(true); }
+
+void InterpreterGeneratorX64::DoInvokeTest() { InvokeMethod(true); }
+
+void InterpreterGeneratorX64::DoInvokeStatic() { InvokeStatic(false); }
+
+void InterpreterGeneratorX64::DoInvokeStaticUnfold() { InvokeStatic(true); }
+
+void InterpreterGeneratorX64::DoInvokeFactory() { InvokeStatic(false); }
+
+void InterpreterGeneratorX64::DoInvokeFactoryUnfold() { InvokeStatic(true); }
+
+void InterpreterGeneratorX64::DoInvokeNative() { InvokeNative(false); }
+
+void InterpreterGeneratorX64::DoInvokeNativeYield() { InvokeNative(true); }
+
+void InterpreterGeneratorX64::DoInvokeSelector() {
+  SaveState();
+  __ movq(RDI, R15);
+  __ call("HandleInvokeSelector");
+  RestoreState();
+  CheckStackOverflow(0);
+  Dispatch(0);
+}
+
+void InterpreterGeneratorX64::InvokeEq(const char* fallback) {
+  InvokeCompare(fallback, EQUAL);
+}
+
+void InterpreterGeneratorX64::InvokeLt(const char* fallback) {
+  InvokeCompare(fallback, LESS);
+}
+
+void InterpreterGeneratorX64::InvokeLe(const char* fallback) {
+  InvokeCompare(fallback, LESS_EQUAL);
+}
+
+void InterpreterGeneratorX64::InvokeGt(const char* fallback) {
+  InvokeCompare(fallback, GREATER);
+}
+
+void InterpreterGeneratorX64::InvokeGe(const char* fallback) {
+  InvokeCompare(fallback, GREATER_EQUAL);
+}
+
+void InterpreterGeneratorX64::InvokeAdd(const char* fallback) {
+  LoadSmiOperands(RAX, RBX, fallback);
+  __ addq(RAX, RBX);
+  __ j(OVERFLOW, fallback);
+  StoreLocal(RAX, 1);
+  Drop(1);
+  Dispatch(kInvokeAddLength);
+}
+
+void InterpreterGeneratorX64::InvokeSub(const char* fallback) {
+  LoadSmiOperands(RAX, RBX, fallback);
+  __ subq(RAX, RBX);
+  __ j(OVERFLOW, fallback);
+  StoreLocal(RAX, 1);
+  Drop(1);
+  Dispatch(kInvokeSubLength);
+}
+
+void InterpreterGeneratorX64::InvokeMod(const char* fallback) {
+  LoadSmiOperands(RAX, RBX, fallback);
+
+  // Check for division by zero.
+  __ testq(RBX, RBX);
+  __ j(ZERO, fallback);
+
+  // Untag and sign extend rax into rdx:rax. Smis have at most 63 bits,
+  // so the division cannot overflow.
+  __ sarq(RAX, Immediate(1));
+  __ sarq(RBX, Immediate(1));
+  __ cqo();
+  __ idivq(RBX);
+
+  // The remainder in rdx has the sign of the dividend. Make it
+  // non-negative by adding the absolute value of the divisor.
+  Label done, subtract;
+  __ testq(RDX, RDX);
+  __ j(NOT_SIGN, &done);
+  __ testq(RBX, RBX);
+  __ j(SIGN, &subtract);
+  __ addq(RDX, RBX);
+  __ jmp(&done);
+  __ Bind(&subtract);
+  __ subq(RDX, RBX);
+  __ Bind(&done);
+
+  // Re-tag. The remainder is smaller than the divisor, so this cannot
+  // overflow.
+  ASSERT(Smi::kTagSize == 1 && Smi::kTag == 0);
+  __ addq(RDX, RDX);
+  StoreLocal(RDX, 1);
+  Drop(1);
+  Dispatch(kInvokeModLength);
+}
+
+void InterpreterGeneratorX64::InvokeMul(const char* fallback) {
+  LoadSmiOperands(RAX, RBX, fallback);
+
+  // Untag one of the operands and multiply. The product of a tagged and
+  // an untagged smi is tagged, so overflow of the multiplication is
+  // overflow of the smi.
+  __ sarq(RAX, Immediate(1));
+  __ imulq(RAX, RBX);
+  __ j(OVERFLOW, fallback);
+
+  StoreLocal(RAX, 1);
+  Drop(1);
+  Dispatch(kInvokeMulLength);
+}
+
+void InterpreterGeneratorX64::InvokeTruncDiv(const char* fallback) {
+  LoadSmiOperands(RAX, RBX, fallback);
+
+  // Check for division by zero.
+  __ testq(RBX, RBX);
+  __ j(ZERO, fallback);
+
+  // Untag and sign extend rax into rdx:rax.
+  __ sarq(RAX, Immediate(1));
+  __ sarq(RBX, Immediate(1));
+  __ cqo();
+
+  // Divide rdx:rax by rbx. The resulting quotient is in rax.
+  __ idivq(RBX);
+
+  // Re-tag. We need to check for overflow to handle the case
+  // where the top two bits are 01 after the division. This only
+  // happens when you divide the smallest smi by -1.
+  ASSERT(Smi::kTagSize == 1 && Smi::kTag == 0);
+  __ addq(RAX, RAX);
+  __ j(OVERFLOW, fallback);
+
+  StoreLocal(RAX, 1);
+  Drop(1);
+  Dispatch(kInvokeTruncDivLength);
+}
+
+void InterpreterGeneratorX64::InvokeBitNot(const char* fallback) {
+  LoadLocal(RAX, 0);
+  __ testq(RAX, Immediate(Smi::kTagMask));
+  __ j(NOT_ZERO, fallback);
+
+  __ notq(RAX);
+  __ andq(RAX, Immediate(~Smi::kTagMask));
+  StoreLocal(RAX, 0);
+  Dispatch(kInvokeBitNotLength);
+}
+
+void InterpreterGeneratorX64::InvokeBitAnd(const char* fallback) {
+  LoadSmiOperands(RAX, RBX, fallback);
+  __ andq(RAX, RBX);
+  StoreLocal(RAX, 1);
+  Drop(1);
+  Dispatch(kInvokeBitAndLength);
+}
+
+void InterpreterGeneratorX64::InvokeBitOr(const char* fallback) {
+  LoadSmiOperands(RAX, RBX, fallback);
+  __ orq(RAX, RBX);
+  StoreLocal(RAX, 1);
+  Drop(1);
+  Dispatch(kInvokeBitOrLength);
+}
+
+void InterpreterGeneratorX64::InvokeBitXor(const char* fallback) {
+  LoadSmiOperands(RAX, RBX, fallback);
+  __ xorq(RAX, RBX);
+  StoreLocal(RAX, 1);
+  Drop(1);
+  Dispatch(kInvokeBitXorLength);
+}
+
+void InterpreterGeneratorX64::InvokeBitShr(const char* fallback) {
+  LoadSmiOperands(RAX, RCX, fallback);
+
+  // Untag the smis and do the shift. Negative shift counts are left to
+  // the method.
+  __ sarq(RAX, Immediate(1));
+  __ sarq(RCX, Immediate(1));
+  __ j(SIGN, fallback);
+  __ cmpq(RCX, Immediate(kBitsPerWord));
+  Label shift;
+  __ j(LESS, &shift);
+  __ movq(RCX, Immediate(kBitsPerWord - 1));
+  __ Bind(&shift);
+  __ sarq_cl(RAX);
+
+  // Re-tag the resulting smi. No need to check for overflow
+  // here, because the top two bits of rax are either 00 or 11
+  // because we've shifted rax arithmetically at least one
+  // position to the right.
+  ASSERT(Smi::kTagSize == 1 && Smi::kTag == 0);
+  __ addq(RAX, RAX);
+
+  StoreLocal(RAX, 1);
+  Drop(1);
+  Dispatch(kInvokeBitShrLength);
+}
+
+void InterpreterGeneratorX64::InvokeBitShl(const char* fallback) {
+  LoadSmiOperands(RAX, RCX, fallback);
+
+  // Untag the shift count, but not the value. If the shift
+  // count is greater than 63 (or negative), the shift is going
+  // to misbehave so we have to guard against that.
+  __ sarq(RCX, Immediate(1));
+  __ cmpq(RCX, Immediate(kBitsPerWord));
+  __ j(ABOVE_EQUAL, fallback);
+
+  // Only allow to shift out "sign bits". If we shift
+  // out any other bit, it's an overflow.
+  __ movq(RBX, RAX);
+  __ shlq_cl(RAX);
+  __ movq(RDX, RAX);
+  __ sarq_cl(RDX);
+  __ cmpq(RBX, RDX);
+  __ j(NOT_EQUAL, fallback);
+
+  StoreLocal(RAX, 1);
+  Drop(1);
+  Dispatch(kInvokeBitShlLength);
+}
+
+void InterpreterGeneratorX64::DoPop() {
+  Drop(1);
+  Dispatch(kPopLength);
+}
+
+void InterpreterGeneratorX64::DoDrop() {
+  __ movzbl(RAX, Address(R13, 1));
+  Drop(RAX);
+  Dispatch(kDropLength);
+}
+
+void InterpreterGeneratorX64::DoReturn() { Return(false); }
+
+void InterpreterGeneratorX64::DoReturnNull() { Return(true); }
+
+void InterpreterGeneratorX64::DoBranchWide() {
+  __ movsxl(RAX, Address(R13, 1));
+  __ addq(R13, RAX);
+  Dispatch(0);
+}
+
+void InterpreterGeneratorX64::DoBranchIfTrueWide() {
+  Label branch;
+  Pop(RBX);
+  LoadLiteralTrue(RAX);
+  __ cmpq(RBX, RAX);
+  __ j(EQUAL, &branch);
+  Dispatch(kBranchIfTrueWideLength);
+
+  __ Bind(&branch);
+  __ movsxl(RAX, Address(R13, 1));
+  __ addq(R13, RAX);
+  Dispatch(0);
+}
+
+void InterpreterGeneratorX64::DoBranchIfFalseWide() {
+  Label branch;
+  Pop(RBX);
+  LoadLiteralTrue(RAX);
+  __ cmpq(RBX, RAX);
+  __ j(NOT_EQUAL, &branch);
+  Dispatch(kBranchIfFalseWideLength);
+
+  __ Bind(&branch);
+  __ movsxl(RAX, Address(R13, 1));
+  __ addq(R13, RAX);
+  Dispatch(0);
+}
+
+void InterpreterGeneratorX64::DoBranchBack() {
+  CheckStackOverflow(0);
+  __ movzbl(RAX, Address(R13, 1));
+  __ subq(R13, RAX);
+  Dispatch(0);
+}
+
+void InterpreterGeneratorX64::DoBranchBackIfTrue() {
+  CheckStackOverflow(0);
+
+  Label branch;
+  Pop(RBX);
+  LoadLiteralTrue(RAX);
+  __ cmpq(RBX, RAX);
+  __ j(EQUAL, &branch);
+  Dispatch(kBranchBackIfTrueLength);
+
+  __ Bind(&branch);
+  __ movzbl(RAX, Address(R13, 1));
+  __ subq(R13, RAX);
+  Dispatch(0);
+}
+
+void InterpreterGeneratorX64::DoBranchBackIfFalse() {
+  CheckStackOverflow(0);
+
+  Label branch;
+  Pop(RBX);
+  LoadLiteralTrue(RAX);
+  __ cmpq(RBX, RAX);
+  __ j(NOT_EQUAL, &branch);
+  Dispatch(kBranchBackIfFalseLength);
+
+  __ Bind(&branch);
+  __ movzbl(RAX, Address(R13, 1));
+  __ subq(R13, RAX);
+  Dispatch(0);
+}
+
+void InterpreterGeneratorX64::DoBranchBackWide() {
+  CheckStackOverflow(0);
+  __ movsxl(RAX, Address(R13, 1));
+  __ subq(R13, RAX);
+  Dispatch(0);
+}
+
+void InterpreterGeneratorX64::DoBranchBackIfTrueWide() {
+  CheckStackOverflow(0);
+
+  Label branch;
+  Pop(RBX);
+  LoadLiteralTrue(RAX);
+  __ cmpq(RBX, RAX);
+  __ j(EQUAL, &branch);
+  Dispatch(kBranchBackIfTrueWideLength);
+
+  __ Bind(&branch);
+  __ movsxl(RAX, Address(R13, 1));
+  __ subq(R13, RAX);
+  Dispatch(0);
+}
+
+void InterpreterGeneratorX64::DoBranchBackIfFalseWide() {
+  CheckStackOverflow(0);
+
+  Label branch;
+  Pop(RBX);
+  LoadLiteralTrue(RAX);
+  __ cmpq(RBX, RAX);
+  __ j(NOT_EQUAL, &branch);
+  Dispatch(kBranchBackIfFalseWideLength);
+
+  __ Bind(&branch);
+  __ movsxl(RAX, Address(R13, 1));
+  __ subq(R13, RAX);
+  Dispatch(0);
+}
+
+void InterpreterGeneratorX64::DoPopAndBranchWide() {
+  __ movzbl(RAX, Address(R13, 1));
+  __ leaq(RSP, Address(RSP, RAX, TIMES_8));
+
+  __ movsxl(RAX, Address(R13, 2));
+  __ addq(R13, RAX);
+  Dispatch(0);
+}
+
+void InterpreterGeneratorX64::DoPopAndBranchBackWide() {
+  CheckStackOverflow(0);
+
+  __ movzbl(RAX, Address(R13, 1));
+  __ leaq(RSP, Address(RSP, RAX, TIMES_8));
+
+  __ movsxl(RAX, Address(R13, 2));
+  __ subq(R13, RAX);
+  Dispatch(0);
+}
+
+void InterpreterGeneratorX64::DoAllocate() { Allocate(false, false); }
+
+void InterpreterGeneratorX64::DoAllocateUnfold() { Allocate(true, false); }
+
+void InterpreterGeneratorX64::DoAllocateImmutable() { Allocate(false, true); }
+
+void InterpreterGeneratorX64::DoAllocateImmutableUnfold() {
+  Allocate(true, true);
+}
+
+void InterpreterGeneratorX64::DoAllocateBoxed() {
+  LoadLocal(RBX, 0);
+  SwitchToCStack();
+  __ movq(RDI, R15);
+  __ movq(RSI, RBX);
+  __ call("HandleAllocateBoxed");
+  SwitchToDartStack();
+  __ cmpq(RAX, Immediate(reinterpret_cast<word>(Failure::retry_after_gc())));
+  __ j(EQUAL, &gc_);
+  StoreLocal(RAX, 0);
+  Dispatch(kAllocateBoxedLength);
+}
+
+void InterpreterGeneratorX64::DoNegate() {
+  Label store;
+  LoadLocal(RBX, 0);
+  LoadProgram(RCX);
+  __ movq(RAX, Address(RCX, Program::kTrueObjectOffset));
+  __ cmpq(RBX, RAX);
+  __ j(NOT_EQUAL, &store);
+  __ movq(RAX, Address(RCX, Program::kFalseObjectOffset));
+  __ Bind(&store);
+  StoreLocal(RAX, 0);
+  Dispatch(kNegateLength);
+}
+
+void InterpreterGeneratorX64::DoStackOverflowCheck() {
+  __ movl(RAX, Address(R13, 1));
+  __ movq(RBX, Address(R15, Process::kStackLimitOffset));
+  __ movq(RDX, RAX);
+  __ negq(RDX);
+  __ leaq(RCX, Address(RSP, RDX, TIMES_8));
+  __ cmpq(RCX, RBX);
+  __ j(BELOW_EQUAL, &check_stack_overflow_);
+  Dispatch(kStackOverflowCheckLength);
+}
+
+void InterpreterGeneratorX64::DoThrow() {
+  LoadLocal(RBX, 0);
+  SaveState();
+  DoThrowAfterSaveState();
+}
+
+void InterpreterGeneratorX64::DoThrowAfterSaveState() {
+  // Use the stack to store the stack delta initialized to zero, and the
+  // frame pointer of the target frame.
+  __ movq(Address(RSP, 0), Immediate(0));
+  __ leaq(RDX, Address(RSP, 0));
+  __ leaq(RCX, Address(RSP, 1 * kWordSize));
+
+  __ movq(RDI, R15);
+  __ movq(RSI, RBX);
+  __ call("HandleThrow");
+
+  RestoreState();
+
+  Label unwind;
+  __ testq(RAX, RAX);
+  __ j(NOT_ZERO, &unwind);
+  __ movl(RAX, Immediate(Interpreter::kUncaughtException));
+  __ jmp(&done_);
+
+  __ Bind(&unwind);
+  __ movq(RBP, Address(R14, 1 * kWordSize));
+  __ movsxl(RCX, Address(R14, 0));
+  __ movq(R13, RAX);
+  __ leaq(RSP, Address(RSP, RCX, TIMES_8));
+  StoreLocal(RBX, 0);
+  Dispatch(0);
+}
+
+void InterpreterGeneratorX64::DoSubroutineCall() {
+  __ movsxl(RAX, Address(R13, 1));
+  __ movsxl(RBX, Address(R13, 5));
+
+  // Push the return delta as a tagged smi.
+  ASSERT(Smi::kTag == 0);
+  __ shlq(RBX, Immediate(Smi::kTagSize));
+  Push(RBX);
+
+  __ addq(R13, RAX);
+  Dispatch(0);
+}
+
+void InterpreterGeneratorX64::DoSubroutineReturn() {
+  Pop(RAX);
+  __ sarq(RAX, Immediate(Smi::kTagSize));
+  __ subq(R13, RAX);
+  Dispatch(0);
+}
+
+void InterpreterGeneratorX64::DoProcessYield() {
+  LoadLiteralNull(RBX);
+  LoadLocal(RAX, 0);
+  __ sarq(RAX, Immediate(1));
+  __ addq(R13, Immediate(kProcessYieldLength));
+  StoreLocal(RBX, 0);
+  __ jmp(&done_);
+}
+
+void InterpreterGeneratorX64::DoCoroutineChange() {
+  LoadLiteralNull(RAX);
+
+  LoadLocal(RBX, 0);  // Load argument.
+  LoadLocal(RDX, 1);  // Load coroutine.
+
+  StoreLocal(RAX, 0);
+  StoreLocal(RAX, 1);
+
+  SaveState();
+  __ movq(RDI, R15);
+  __ movq(RSI, RDX);
+  __ call("HandleCoroutineChange");
+  RestoreState();
+
+  StoreLocal(RBX, 1);
+  Drop(1);
+
+  Dispatch(kCoroutineChangeLength);
+}
+
+void InterpreterGeneratorX64::DoIdentical() {
+  LoadLocal(RAX, 0);
+  LoadLocal(RBX, 1);
+
+  // TODO(ager): For now we bail out if we have two doubles or two
+  // large integers and let the slow interpreter deal with it. These
+  // cases could be dealt with directly here instead.
+  Label fast_case;
+  Label bail_out;
+
+  // If either is a smi they are not both doubles or large integers.
+  __ testq(RAX, Immediate(Smi::kTagMask));
+  __ j(ZERO, &fast_case);
+  __ testq(RBX, Immediate(Smi::kTagMask));
+  __ j(ZERO, &fast_case);
+
+  // If they do not have the same type they are not both double or
+  // large integers.
+  __ movq(RCX, Address(RAX, HeapObject::kClassOffset - HeapObject::kTag));
+  __ movq(RCX, Address(RCX, Class::kInstanceFormatOffset - HeapObject::kTag));
+  __ movq(RDX, Address(RBX, HeapObject::kClassOffset - HeapObject::kTag));
+  __ cmpq(RCX, Address(RDX, Class::kInstanceFormatOffset - HeapObject::kTag));
+  __ j(NOT_EQUAL, &fast_case);
+
+  int double_type = InstanceFormat::DOUBLE_TYPE;
+  int large_integer_type = InstanceFormat::LARGE_INTEGER_TYPE;
+  int type_field_shift = InstanceFormat::TypeField::shift();
+
+  __ andq(RCX, Immediate(InstanceFormat::TypeField::mask()));
+  __ cmpq(RCX, Immediate(double_type << type_field_shift));
+  __ j(EQUAL, &bail_out);
+  __ cmpq(RCX, Immediate(large_integer_type << type_field_shift));
+  __ j(EQUAL, &bail_out);
+
+  __ Bind(&fast_case);
+  LoadProgram(RCX);
+
+  Label true_case;
+  __ cmpq(RBX, RAX);
+  __ j(EQUAL, &true_case);
+
+  __ movq(RAX, Address(RCX, Program::kFalseObjectOffset));
+  StoreLocal(RAX, 1);
+  Drop(1);
+  Dispatch(kIdenticalLength);
+
+  __ Bind(&true_case);
+  __ movq(RAX, Address(RCX, Program::kTrueObjectOffset));
+
+  Label done;
+  __ Bind(&done);
+  StoreLocal(RAX, 1);
+  Drop(1);
+  Dispatch(kIdenticalLength);
+
+  __ Bind(&bail_out);
+  SwitchToCStack();
+  __ movq(RDI, R15);
+  __ movq(RSI, RBX);
+  __ movq(RDX, RAX);
+  __ call("HandleIdentical");
+  SwitchToDartStack();
+  __ jmp(&done);
+}
+
+void InterpreterGeneratorX64::DoIdenticalNonNumeric() {
+  LoadLocal(RAX, 0);
+  LoadLocal(RBX, 1);
+  LoadProgram(RCX);
+
+  Label true_case;
+  __ cmpq(RAX, RBX);
+  __ j(EQUAL, &true_case);
+
+  __ movq(RAX, Address(RCX, Program::kFalseObjectOffset));
+  StoreLocal(RAX, 1);
+  Drop(1);
+  Dispatch(kIdenticalNonNumericLength);
+
+  __ Bind(&true_case);
+  __ movq(RAX, Address(RCX, Program::kTrueObjectOffset));
+  StoreLocal(RAX, 1);
+  Drop(1);
+  Dispatch(kIdenticalNonNumericLength);
+}
+
+void InterpreterGeneratorX64::DoEnterNoSuchMethod() {
+  SaveState();
+  __ movq(RDI, R15);
+  __ call("HandleEnterNoSuchMethod");
+  RestoreState();
+  Dispatch(0);
+}
+
+void InterpreterGeneratorX64::DoExitNoSuchMethod() {
+  Pop(RAX);  // Result.
+  Pop(RBX);  // Selector.
+  __ shrq(RBX, Immediate(Smi::kTagSize));
+
+  ReadFrameDescriptor();
+  // Drop FP and BCP.
+  Drop(2);
+
+  Label done;
+  __ movq(RCX, RBX);
+  __ andq(RCX, Immediate(Selector::KindField::mask()));
+  __ cmpq(RCX, Immediate(Selector::SETTER << Selector::KindField::shift()));
+  __ j(NOT_EQUAL, &done);
+  LoadLocal(RAX, 0);
+
+  __ Bind(&done);
+  ASSERT(Selector::ArityField::shift() == 0);
+  __ andq(RBX, Immediate(Selector::ArityField::mask()));
+
+  // Drop the arguments from the stack, but leave the receiver.
+  __ leaq(RSP, Address(RSP, RBX, TIMES_8));
+
+  StoreLocal(RAX, 0);
+  Dispatch(0);
+}
+
+void InterpreterGeneratorX64::DoMethodEnd() { __ int3(); }
+
+void InterpreterGeneratorX64::DoIntrinsicObjectEquals() {
+  Label true_case;
+  LoadLocal(RAX, 0);
+  LoadLocal(RBX, 1);
+  LoadProgram(RCX);
+
+  __ cmpq(RAX, RBX);
+  __ j(EQUAL, &true_case);
+
+  __ movq(RAX, Address(RCX, Program::kFalseObjectOffset));
+  StoreLocal(RAX, 1);
+  Drop(1);
+  Dispatch(kInvokeMethodLength);
+
+  __ Bind(&true_case);
+  __ movq(RAX, Address(RCX, Program::kTrueObjectOffset));
+  StoreLocal(RAX, 1);
+  Drop(1);
+  Dispatch(kInvokeMethodLength);
+}
+
+void InterpreterGeneratorX64::DoIntrinsicGetField() {
+  __ movzbl(RBX, Address(RAX, 2 + Function::kSize - HeapObject::kTag));
+  LoadLocal(RAX, 0);
+  __ movq(RAX,
+          Address(RAX, RBX, TIMES_8, Instance::kSize - HeapObject::kTag));
+  StoreLocal(RAX, 0);
+  Dispatch(kInvokeMethodLength);
+}
+
+void InterpreterGeneratorX64::DoIntrinsicSetField() {
+  __ movzbl(RBX, Address(RAX, 3 + Function::kSize - HeapObject::kTag));
+  LoadLocal(RAX, 0);
+  LoadLocal(RCX, 1);
+  __ movq(Address(RCX, RBX, TIMES_8, Instance::kSize - HeapObject::kTag),
+          RAX);
+  StoreLocal(RAX, 1);
+  Drop(1);
+
+  AddToStoreBufferSlow(RCX, RAX);
+
+  Dispatch(kInvokeMethodLength);
+}
+
+void InterpreterGeneratorX64::DoIntrinsicListIndexGet() {
+  LoadLocal(RBX, 0);  // Index.
+  LoadLocal(RCX, 1);  // List.
+
+  ASSERT(Smi::kTag == 0);
+  __ testq(RBX, Immediate(Smi::kTagMask));
+  __ j(NOT_ZERO, &intrinsic_failure_);
+  __ cmpq(RBX, Immediate(0));
+  __ j(LESS, &intrinsic_failure_);
+
+  // Load the backing store (array) from the first instance field of the list.
+  __ movq(RCX, Address(RCX, Instance::kSize - HeapObject::kTag));
+  __ movq(RDX, Address(RCX, Array::kLengthOffset - HeapObject::kTag));
+
+  // Check the index against the length.
+  __ cmpq(RBX, RDX);
+  __ j(GREATER_EQUAL, &intrinsic_failure_);
+
+  // Load from the array and continue. The index is a smi, so we only
+  // multiply by four -- not eight -- when indexing.
+  ASSERT(Smi::kTagSize == 1);
+  __ movq(RAX, Address(RCX, RBX, TIMES_4, Array::kSize - HeapObject::kTag));
+  StoreLocal(RAX, 1);
+  Drop(1);
+  Dispatch(kInvokeMethodLength);
+}
+
+void InterpreterGeneratorX64::DoIntrinsicListIndexSet() {
+  LoadLocal(RBX, 1);  // Index.
+  LoadLocal(RCX, 2);  // List.
+
+  ASSERT(Smi::kTag == 0);
+  __ testq(RBX, Immediate(Smi::kTagMask));
+  __ j(NOT_ZERO, &intrinsic_failure_);
+  __ cmpq(RBX, Immediate(0));
+  __ j(LESS, &intrinsic_failure_);
+
+  // Load the backing store (array) from the first instance field of the list.
+  __ movq(RCX, Address(RCX, Instance::kSize - HeapObject::kTag));
+  __ movq(RDX, Address(RCX, Array::kLengthOffset - HeapObject::kTag));
+
+  // Check the index against the length.
+  __ cmpq(RBX, RDX);
+  __ j(GREATER_EQUAL, &intrinsic_failure_);
+
+  // Store to the array and continue.
+  ASSERT(Smi::kTagSize == 1);
+  LoadLocal(RAX, 0);
+  __ movq(Address(RCX, RBX, TIMES_4, Array::kSize - HeapObject::kTag), RAX);
+  StoreLocal(RAX, 2);
+  Drop(2);
+
+  AddToStoreBufferSlow(RCX, RAX);
+
+  Dispatch(kInvokeMethodLength);
+}
+
+void InterpreterGeneratorX64::DoIntrinsicListLength() {
+  // Load the backing store (array) from the first instance field of the list.
+  LoadLocal(RCX, 0);  // List.
+  __ movq(RCX, Address(RCX, Instance::kSize - HeapObject::kTag));
+  __ movq(RDX, Address(RCX, Array::kLengthOffset - HeapObject::kTag));
+  StoreLocal(RDX, 0);
+  Dispatch(kInvokeMethodLength);
+}
+
+void InterpreterGeneratorX64::Push(Register reg) { __ pushq(reg); }
+
+void InterpreterGeneratorX64::Push(const Immediate& value) { __ pushq(value); }
+
+void InterpreterGeneratorX64::Pop(Register reg) { __ popq(reg); }
+
+void InterpreterGeneratorX64::Drop(int n) {
+  __ addq(RSP, Immediate(n * kWordSize));
+}
+
+void InterpreterGeneratorX64::Drop(Register reg) {
+  __ leaq(RSP, Address(RSP, reg, TIMES_8));
+}
+
+void InterpreterGeneratorX64::LoadProcess(Register reg) {
+  __ movq(reg, R15);
+}
+
+void InterpreterGeneratorX64::LoadProgram(Register reg) {
+  __ movq(reg, Address(R15, Process::kProgramOffset));
+}
+
+void InterpreterGeneratorX64::LoadStaticsArray(Register reg) {
+  __ movq(reg, Address(R15, Process::kStaticsOffset));
+}
+
+void InterpreterGeneratorX64::LoadLiteralNull(Register reg) {
+  LoadProgram(reg);
+  __ movq(reg, Address(reg, Program::kNullObjectOffset));
+}
+
+void InterpreterGeneratorX64::LoadLiteralTrue(Register reg) {
+  LoadProgram(reg);
+  __ movq(reg, Address(reg, Program::kTrueObjectOffset));
+}
+
+void InterpreterGeneratorX64::LoadLiteralFalse(Register reg) {
+  LoadProgram(reg);
+  __ movq(reg, Address(reg, Program::kFalseObjectOffset));
+}
+
+void InterpreterGeneratorX64::SwitchToDartStack() {
+  __ movq(R14, RSP);
+  __ movq(RSP, Address(R14, spill_size_));
+}
+
+void InterpreterGeneratorX64::SwitchToCStack() {
+  __ movq(Address(R14, spill_size_), RSP);
+  __ movq(RSP, R14);
+}
+
+void InterpreterGeneratorX64::PushFrameDescriptor(Register bcp) {
+  __ movq(Address(RBP, -kWordSize), bcp);
+
+  Push(Immediate(0));
+
+  Push(RBP);
+  __ movq(RBP, RSP);
+
+  Push(Immediate(0));
+}
+
+void InterpreterGeneratorX64::ReadFrameDescriptor() {
+  // Read frame pointer and apply as stack pointer. This pops all values on
+  // the stack.
+  __ movq(RSP, RBP);
+
+  // Store old frame pointer from stack.
+  LoadLocal(RBP, 0);
+
+  // Load bcp.
+  __ movq(R13, Address(RBP, -kWordSize));
+}
+
+void InterpreterGeneratorX64::LoadLocal(Register reg, int index) {
+  __ movq(reg, Address(RSP, index * kWordSize));
+}
+
+void InterpreterGeneratorX64::StoreLocal(Register reg, int index) {
+  __ movq(Address(RSP, index * kWordSize), reg);
+}
+
+void InterpreterGeneratorX64::Return(bool is_return_null) {
+  // Materialize the result in register RAX.
+  if (is_return_null) {
+    LoadLiteralNull(RAX);
+  } else {
+    LoadLocal(RAX, 0);
+  }
+
+  // Fetch the number of arguments from the bytecodes.
+  __ movzbl(RBX, Address(R13, 1));
+
+  ReadFrameDescriptor();
+
+  // Drop arguments except one which we will overwrite with the result
+  // (we've left the return address on the stack).
+  __ leaq(RSP, Address(RSP, RBX, TIMES_8, kWordSize));
+
+  // Overwrite the first argument (or the return address) with the result
+  // and dispatch to the next bytecode.
+  StoreLocal(RAX, 0);
+  Dispatch(0);
+}
+
+void InterpreterGeneratorX64::Allocate(bool unfolded, bool immutable) {
+  // Load the class into register rbx.
+  if (unfolded) {
+    __ movsxl(RAX, Address(R13, 1));
+    __ movq(RBX, Address(R13, RAX, TIMES_1));
+  } else {
+    __ movl(RAX, Address(R13, 1));
+    LoadProgram(RBX);
+    __ movq(RBX, Address(RBX, Program::kClassesOffset));
+    __ movq(RBX, Address(RBX, RAX, TIMES_8, Array::kSize - HeapObject::kTag));
+  }
+
+  // The third and fourth argument to "HandleAllocate" are computed in
+  // registers r9 and r8. We initialize r9 to 0, meaning the object we're
+  // allocating will not be initialized with pointers to immutable space.
+  const Register kAllocateImmutable = R8;
+  const Register kImmutableMembers = R9;
+  __ movq(kImmutableMembers, Immediate(0));
+
+  // Loop over all arguments and find out if
+  //   * all of them are immutable
+  //   * there is at least one immutable member
+  Label allocate;
+  {
+    // Initialization of [kAllocateImmutable] depended on [immutable]
+    __ movq(kAllocateImmutable, Immediate(immutable ? 1 : 0));
+
+    __ movq(RCX, Address(RBX, Class::kInstanceFormatOffset - HeapObject::kTag));
+    __ andq(RCX, Immediate(InstanceFormat::FixedSizeField::mask()));
+    int size_shift = InstanceFormat::FixedSizeField::shift() - kPointerSizeLog2;
+    __ shrq(RCX, Immediate(size_shift));
+
+    // RCX = SizeOfEntireObject - Instance::kSize
+    __ subq(RCX, Immediate(Instance::kSize));
+
+    // RDX = StackPointer(RSP) + NumberOfFields*kPointerSize
+    __ movq(RDX, RSP);
+    __ addq(RDX, RCX);
+
+    Label loop;
+    Label loop_with_immutable_field;
+    Label loop_with_mutable_field;
+
+    // Decrement pointer to point to next field.
+    __ Bind(&loop);
+    __ subq(RDX, Immediate(kPointerSize));
+
+    // Test whether RDX < RSP. If so we're done and it's immutable.
+    __ cmpq(RDX, RSP);
+    __ j(BELOW, &allocate);
+
+    // If Smi, continue the loop.
+    __ movq(RCX, Address(RDX));
+    __ testq(RCX, Immediate(Smi::kTagMask));
+    __ j(ZERO, &loop);
+
+    // Load class of object we want to test immutability of.
+    __ movq(RAX, Address(RCX, HeapObject::kClassOffset - HeapObject::kTag));
+
+    // Load instance format & handle the three cases:
+    //  - never immutable (based on instance format) => not immutable
+    //  - always immutable (based on instance format) => immutable
+    //  - else (only instances) => check runtime-tracked bit
+    uword mask = InstanceFormat::ImmutableField::mask();
+    uword always_immutable_mask = InstanceFormat::ImmutableField::encode(
+        InstanceFormat::ALWAYS_IMMUTABLE);
+    uword never_immutable_mask =
+        InstanceFormat::ImmutableField::encode(InstanceFormat::NEVER_IMMUTABLE);
+
+    __ movq(RAX, Address(RAX, Class::kInstanceFormatOffset - HeapObject::kTag));
+    __ andq(RAX, Immediate(mask));
+
+    // If this is type never immutable we continue the loop.
+    __ cmpq(RAX, Immediate(never_immutable_mask));
+    __ j(EQUAL, &loop_with_mutable_field);
+
+    // If this is type is always immutable we continue the loop.
+    __ cmpq(RAX, Immediate(always_immutable_mask));
+    __ j(EQUAL, &loop_with_immutable_field);
+
+    // Else, we must have a Instance and check the runtime-tracked
+    // immutable bit.
+    uword im_mask = Instance::FlagsImmutabilityField::encode(true);
+    __ movq(RCX, Address(RCX, Instance::kFlagsOffset - HeapObject::kTag));
+    __ testq(RCX, Immediate(im_mask));
+    __ j(NOT_ZERO, &loop_with_immutable_field);
+
+    __ jmp(&loop_with_mutable_field);
+
+    __ Bind(&loop_with_immutable_field);
+    __ movq(kImmutableMembers, Immediate(1));
+    __ jmp(&loop);
+
+    __ Bind(&loop_with_mutable_field);
+    __ movq(kAllocateImmutable, Immediate(0));
+    __ jmp(&loop);
+  }
+
+  // TODO(kasperl): Consider inlining this in the interpreter.
+  __ Bind(&allocate);
+  SwitchToCStack();
+  __ movq(RDI, R15);
+  __ movq(RSI, RBX);
+  __ movq(RDX, kAllocateImmutable);
+  __ movq(RCX, kImmutableMembers);
+  __ call("HandleAllocate");
+  SwitchToDartStack();
+  __ cmpq(RAX, Immediate(reinterpret_cast<word>(Failure::retry_after_gc())));
+  __ j(EQUAL, &gc_);
+
+  __ movq(RCX, Address(RBX, Class::kInstanceFormatOffset - HeapObject::kTag));
+  __ andq(RCX, Immediate(InstanceFormat::FixedSizeField::mask()));
+  // The fixed size is recorded as the number of pointers. Therefore, the
+  // size in bytes is the recorded size multiplied by kPointerSize. Instead
+  // of doing the multiplication we shift by kPointerSizeLog2 less.
+  ASSERT(InstanceFormat::FixedSizeField::shift() >= kPointerSizeLog2);
+  int size_shift = InstanceFormat::FixedSizeField::shift() - kPointerSizeLog2;
+  __ shrq(RCX, Immediate(size_shift));
+
+  // Compute the address of the first and last instance field.
+  __ leaq(RDX, Address(RAX, RCX, TIMES_1, -1 * kWordSize - HeapObject::kTag));
+  __ leaq(RCX, Address(RAX, Instance::kSize - HeapObject::kTag));
+
+  Label loop, done;
+  __ Bind(&loop);
+  __ cmpq(RDX, RCX);
+  __ j(BELOW, &done);
+  Pop(RBX);
+  __ movq(Address(RDX, 0), RBX);
+  __ subq(RDX, Immediate(1 * kWordSize));
+  __ jmp(&loop);
+
+  __ Bind(&done);
+  Push(RAX);
+  Dispatch(kAllocateLength);
+}
+
+void InterpreterGeneratorX64::AddToStoreBufferSlow(Register object,
+                                                   Register value) {
+#ifdef FLETCH_ENABLE_MULTIPLE_PROCESS_HEAPS
+  // Only heap objects can be immutable, so storing a smi never needs an
+  // entry in the store buffer.
+  Label done;
+  __ testq(value, Immediate(Smi::kTagMask));
+  __ j(ZERO, &done);
+  ASSERT(value != RSI);
+  SwitchToCStack();
+  __ movq(RDI, R15);
+  __ movq(RSI, object);
+  __ movq(RDX, value);
+  __ call("AddToStoreBufferSlow");
+  SwitchToDartStack();
+  __ Bind(&done);
+#endif  // #ifdef FLETCH_ENABLE_MULTIPLE_PROCESS_HEAPS
+}
+
+void InterpreterGeneratorX64::InvokeMethodUnfold(bool test) {
+  // Get the selector from the bytecodes.
+  __ movsxl(RDX, Address(R13, 1));
+
+  if (test) {
+    // Get the receiver from the stack.
+    LoadLocal(RBX, 0);
+  } else {
+    // Compute the arity from the selector.
+    ASSERT(Selector::ArityField::shift() == 0);
+    __ movq(RBX, RDX);
+    __ andq(RBX, Immediate(Selector::ArityField::mask()));
+
+    // Get the receiver from the stack.
+    __ movq(RBX, Address(RSP, RBX, TIMES_8));
+  }
+
+  // Compute the receiver class.
+  Label smi, probe;
+  ASSERT(Smi::kTag == 0);
+  __ testq(RBX, Immediate(Smi::kTagMask));
+  __ j(ZERO, &smi);
+  __ movq(RBX, Address(RBX, HeapObject::kClassOffset - HeapObject::kTag));
+
+  // Find the entry in the primary lookup cache.
+  Label miss, finish;
+  ASSERT(Utils::IsPowerOfTwo(LookupCache::kPrimarySize));
+  ASSERT(sizeof(LookupCache::Entry) == 1 << 5);
+  __ Bind(&probe);
+  __ movq(RAX, RBX);
+  __ xorq(RAX, RDX);
+  __ andq(RAX, Immediate(LookupCache::kPrimarySize - 1));
+  __ shlq(RAX, Immediate(5));
+  __ addq(RAX, Address(R15, Process::kPrimaryLookupCacheOffset));
+
+  // Validate the primary entry.
+  __ cmpq(RBX, Address(RAX, LookupCache::kClassOffset));
+  __ j(NOT_EQUAL, &miss);
+  __ cmpq(RDX, Address(RAX, LookupCache::kSelectorOffset));
+  __ j(NOT_EQUAL, &miss);
+
+  // At this point, we've got our hands on a valid lookup cache entry.
+  Label intrinsified;
+  __ Bind(&finish);
+  if (test) {
+    __ movq(RAX, Address(RAX, LookupCache::kTagOffset));
+  } else {
+    __ movq(RBX, Address(RAX, LookupCache::kTagOffset));
+    __ movq(RAX, Address(RAX, LookupCache::kTargetOffset));
+    __ cmpq(RBX, Immediate(1));
+    __ j(ABOVE, &intrinsified);
+  }
+
+  if (test) {
+    // Materialize either true or false depending on whether or not
+    // we've found a target method.
+    Label found;
+    LoadProgram(RBX);
+    __ testq(RAX, RAX);
+    __ j(NOT_ZERO, &found);
+
+    __ movq(RAX, Address(RBX, Program::kFalseObjectOffset));
+    StoreLocal(RAX, 0);
+    Dispatch(kInvokeTestUnfoldLength);
+
+    __ Bind(&found);
+    __ movq(RAX, Address(RBX, Program::kTrueObjectOffset));
+    StoreLocal(RAX, 0);
+    Dispatch(kInvokeTestUnfoldLength);
+  } else {
+    // Compute and push the return bcp on the stack.
+    __ addq(R13, Immediate(kInvokeMethodUnfoldLength));
+    PushFrameDescriptor(R13);
+
+    // Jump to the first bytecode in the target method.
+    __ leaq(R13, Address(RAX, Function::kSize - HeapObject::kTag));
+    CheckStackOverflow(0);
+    Dispatch(0);
+  }
+
+  __ Bind(&smi);
+  LoadProgram(RBX);
+  __ movq(RBX, Address(RBX, Program::kSmiClassOffset));
+  __ jmp(&probe);
+
+  if (!test) {
+    __ Bind(&intrinsified);
+    __ jmp(RBX);
+  }
+
+  // We didn't find a valid entry in primary lookup cache.
+  __ Bind(&miss);
+  SwitchToCStack();
+  __ movq(RCX, RDX);
+  __ movq(RDX, RBX);
+  __ movq(RSI, RAX);
+  __ movq(RDI, R15);
+  __ call("HandleLookupEntry");
+  SwitchToDartStack();
+  __ jmp(&finish);
+}
+
+void InterpreterGeneratorX64::InvokeMethod(bool test) {
+  // Get the selector from the bytecodes.
+  __ movl(RDX, Address(R13, 1));
+
+  // Fetch the dispatch table from the program.
+  LoadProgram(RCX);
+  __ movq(RCX, Address(RCX, Program::kDispatchTableOffset));
+
+  if (!test) {
+    // Compute the arity from the selector.
+    ASSERT(Selector::ArityField::shift() == 0);
+    __ movq(RBX, RDX);
+    __ andq(RBX, Immediate(Selector::ArityField::mask()));
+  }
+
+  // Compute the selector offset (smi tagged) from the selector. The id
+  // field is the topmost field of the 32-bit selector, so shifting it
+  // down is enough to extract it.
+  ASSERT(Selector::IdField::shift() + 22 == 32);
+  __ shrl(RDX, Immediate(Selector::IdField::shift()));
+  ASSERT(Smi::kTagSize == 1 && Smi::kTag == 0);
+  __ addq(RDX, RDX);
+
+  // Get the receiver from the stack.
+  if (test) {
+    LoadLocal(RBX, 0);
+  } else {
+    __ movq(RBX, Address(RSP, RBX, TIMES_8));
+  }
+
+  // Compute the receiver class.
+  Label smi, dispatch;
+  ASSERT(Smi::kTag == 0);
+  __ testq(RBX, Immediate(Smi::kTagMask));
+  __ j(ZERO, &smi);
+  __ movq(RBX, Address(RBX, HeapObject::kClassOffset - HeapObject::kTag));
+
+  // Compute entry index: class id + selector offset.
+  int id_offset = Class::kIdOrTransformationTargetOffset - HeapObject::kTag;
+  __ Bind(&dispatch);
+  __ movq(RBX, Address(RBX, id_offset));
+  __ addq(RBX, RDX);
+
+  // Fetch the entry from the table. Because the index is smi tagged
+  // we only multiply by four -- not eight -- when indexing.
+  ASSERT(Smi::kTagSize == 1);
+  __ movq(RCX, Address(RCX, RBX, TIMES_4, Array::kSize - HeapObject::kTag));
+
+  // Validate that the offset stored in the entry matches the offset
+  // we used to find it.
+  Label invalid;
+  __ cmpq(RDX, Address(RCX, Array::kSize - HeapObject::kTag));
+  __ j(NOT_EQUAL, &invalid);
+
+  Label validated, intrinsified;
+  if (test) {
+    // Valid entry: The answer is true.
+    LoadLiteralTrue(RAX);
+    StoreLocal(RAX, 0);
+    Dispatch(kInvokeTestLength);
+  } else {
+    // Load the target and the intrinsic from the entry.
+    __ Bind(&validated);
+    __ movq(RAX,
+            Address(RCX, 2 * kWordSize + Array::kSize - HeapObject::kTag));
+    __ movq(RBX,
+            Address(RCX, 3 * kWordSize + Array::kSize - HeapObject::kTag));
+
+    // Check if we have an associated intrinsic.
+    __ testq(RBX, RBX);
+    __ j(NOT_ZERO, &intrinsified);
+
+    // Compute and push the return bcp on the stack.
+    __ addq(R13, Immediate(kInvokeMethodLength));
+    PushFrameDescriptor(R13);
+
+    // Jump to the first bytecode in the target method.
+    __ leaq(R13, Address(RAX, Function::kSize - HeapObject::kTag));
+    CheckStackOverflow(0);
+    Dispatch(0);
+  }
+
+  __ Bind(&smi);
+  LoadProgram(RBX);
+  __ movq(RBX, Address(RBX, Program::kSmiClassOffset));
+  __ jmp(&dispatch);
+
+  if (test) {
+    // Invalid entry: The answer is false.
+    __ Bind(&invalid);
+    LoadLiteralFalse(RAX);
+    StoreLocal(RAX, 0);
+    Dispatch(kInvokeTestLength);
+  } else {
+    __ Bind(&intrinsified);
+    __ jmp(RBX);
+
+    // Invalid entry: Use the noSuchMethod entry from entry zero of
+    // the virtual table.
+    __ Bind(&invalid);
+    LoadProgram(RCX);
+    __ movq(RCX, Address(RCX, Program::kDispatchTableOffset));
+    __ movq(RCX, Address(RCX, Array::kSize - HeapObject::kTag));
+    __ jmp(&validated);
+  }
+}
+
+void InterpreterGeneratorX64::InvokeStatic(bool unfolded) {
+  if (unfolded) {
+    __ movsxl(RAX, Address(R13, 1));
+    __ movq(RAX, Address(R13, RAX, TIMES_1));
+  } else {
+    __ movl(RAX, Address(R13, 1));
+    LoadProgram(RBX);
+    __ movq(RBX, Address(RBX, Program::kStaticMethodsOffset));
+    __ movq(RAX, Address(RBX, RAX, TIMES_8, Array::kSize - HeapObject::kTag));
+  }
+
+  // Compute and push the return bcp on the stack.
+  __ addq(R13, Immediate(kInvokeStaticLength));
+  PushFrameDescriptor(R13);
+
+  // Jump to the first bytecode in the target method.
+  __ leaq(R13, Address(RAX, Function::kSize - HeapObject::kTag));
+  CheckStackOverflow(0);
+  Dispatch(0);
+}
+
+void InterpreterGeneratorX64::InvokeCompare(const char* fallback,
+                                            Condition condition) {
+  LoadSmiOperands(RBX, RAX, fallback);
+
+  Label true_case;
+  __ cmpq(RBX, RAX);
+  __ j(condition, &true_case);
+
+  LoadLiteralFalse(RAX);
+  StoreLocal(RAX, 1);
+  Drop(1);
+  Dispatch(kInvokeMethodLength);
+
+  __ Bind(&true_case);
+  LoadLiteralTrue(RAX);
+  StoreLocal(RAX, 1);
+  Drop(1);
+  Dispatch(kInvokeMethodLength);
+}
+
+void InterpreterGeneratorX64::LoadSmiOperands(Register left, Register right,
+                                              const char* fallback) {
+  LoadLocal(left, 1);
+  __ testq(left, Immediate(Smi::kTagMask));
+  __ j(NOT_ZERO, fallback);
+  LoadLocal(right, 0);
+  __ testq(right, Immediate(Smi::kTagMask));
+  __ j(NOT_ZERO, fallback);
+}
+
+void InterpreterGeneratorX64::InvokeNative(bool yield) {
+  __ movzbl(RBX, Address(R13, 1));
+  __ movzbl(RCX, Address(R13, 2));
+
+  __ LoadNative(RAX, RCX);
+
+  // Extract address for first argument (note we skip two empty slots).
+  __ leaq(RBX, Address(RSP, RBX, TIMES_8,
+                       NativeFrame::kArgumentsOffset * kWordSize));
+
+  SwitchToCStack();
+  __ movq(RDI, R15);
+  __ movq(RSI, RBX);
+
+  Label failure;
+  __ call(RAX);
+  SwitchToDartStack();
+  __ movq(RCX, RAX);
+  __ andq(RCX, Immediate(Failure::kTagMask));
+  __ cmpq(RCX, Immediate(Failure::kTag));
+  __ j(EQUAL, &failure);
+
+  // Result is now in rax. Pointer to first argument is in rbx.
+  ReadFrameDescriptor();
+
+  if (yield) {
+    // Set the result to null and drop the arguments.
+    LoadLiteralNull(RCX);
+    __ movq(Address(RBX, 0), RCX);
+    __ movq(RSP, RBX);
+
+    // If the result of calling the native is null, we don't yield.
+    Label dont_yield;
+    __ cmpq(RAX, RCX);
+    __ j(EQUAL, &dont_yield);
+
+    // Yield to the target port.
+    __ movq(RCX, Address(R14, spill_size_ + kWordSize));
+    __ movq(Address(RCX, 0), RAX);
+    __ movl(RAX, Immediate(Interpreter::kTargetYield));
+    __ jmp(&done_);
+    __ Bind(&dont_yield);
+  } else {
+    // Store the result in the stack and drop the arguments.
+    __ movq(Address(RBX, 0), RAX);
+    __ movq(RSP, RBX);
+  }
+
+  // Dispatch to bcp.
+  Dispatch(0);
+
+  // Failure: Check if it's a request to garbage collect. If not,
+  // just continue running the failure block by dispatching to the
+  // next bytecode.
+  __ Bind(&failure);
+  __ cmpq(RAX, Immediate(reinterpret_cast<word>(Failure::retry_after_gc())));
+  __ j(EQUAL, &gc_);
+
+  // TODO(kasperl): This should be reworked. We shouldn't be calling
+  // through the runtime system for something as simple as converting
+  // a failure object to the corresponding heap object.
+  SwitchToCStack();
+  __ movq(RDI, R15);
+  __ movq(RSI, RAX);
+  __ call("HandleObjectFromFailure");
+  SwitchToDartStack();
+
+  Push(RAX);
+  Dispatch(kInvokeNativeLength);
+}
+
+void InterpreterGeneratorX64::CheckStackOverflow(int size) {
+  __ cmpq(RSP, Address(R15, Process::kStackLimitOffset));
+  if (size == 0) {
+    __ j(BELOW_EQUAL, &check_stack_overflow_0_);
+  } else {
+    Label done;
+    __ j(ABOVE, &done);
+    __ movl(RAX, Immediate(size));
+    __ jmp(&check_stack_overflow_);
+    __ Bind(&done);
+  }
+}
+
+void InterpreterGeneratorX64::Dispatch(int size) {
+  // Load the next bytecode through r13 and dispatch to it.
+  __ movzbl(RBX, Address(R13, size));
+  if (size > 0) {
+    __ addq(R13, Immediate(size));
+  }
+  __ jmp(Address(R12, RBX, TIMES_8));
+}
+
+void InterpreterGeneratorX64::SaveState() {
+  // Save the bytecode pointer at the bcp slot.
+  __ movq(Address(RBP, -kWordSize), R13);
+
+  // Push null.
+  Push(Immediate(0));
+
+  // Push frame pointer.
+  Push(RBP);
+
+  // Update top in the stack. Ugh. Complicated.
+  __ movq(RCX, Address(R15, Process::kCoroutineOffset));
+  __ movq(RCX, Address(RCX, Coroutine::kStackOffset - HeapObject::kTag));
+  __ subq(RSP, RCX);
+  __ subq(RSP, Immediate(Stack::kSize - HeapObject::kTag));
+  // The top is the smi tagged word index: the byte offset divided by 4.
+  __ shrq(RSP, Immediate(kPointerSizeLog2 - Smi::kTagSize));
+  __ movq(Address(RCX, Stack::kTopOffset - HeapObject::kTag), RSP);
+
+  // Restore the C stack in RSP.
+  __ movq(RSP, R14);
+}
+
+void InterpreterGeneratorX64::RestoreState() {
+  // Store the C stack in R14.
+  __ movq(R14, RSP);
+
+  // Load the Dart stack pointer into RSP.
+  __ movq(RSP, Address(R15, Process::kCoroutineOffset));
+  __ movq(RSP, Address(RSP, Coroutine::kStackOffset - HeapObject::kTag));
+  __ movq(RCX, Address(RSP, Stack::kTopOffset - HeapObject::kTag));
+  __ leaq(RSP, Address(RSP, RCX, TIMES_4, Stack::kSize - HeapObject::kTag));
+
+  // Read frame pointer.
+  LoadLocal(RBP, 0);
+
+  // Set the bcp from the stack.
+  __ movq(R13, Address(RBP, -kWordSize));
+
+  Drop(2);
+}
+
+}  // namespace fletch
+
+#endif  // defined(FLETCH_TARGET_X64) && defined(FLETCH_TARGET_OS_POSIX)
@@ -9,6 +9,7 @@
 #include "src/shared/selectors.h"
 
 #include "src/vm/assembler.h"
+#include "src/vm/frame.h"
 #include "src/vm/generator.h"
 #include "src/vm/interpreter.h"
 #include "src/vm/intrinsics.h"
@@ -2025,7 +2026,8 @@ void InterpreterGeneratorX86::InvokeNative(bool yield) {
   __ LoadNative(EAX, EAX);
 
   // Extract address for first argument (note we skip two empty slots).
-  __ leal(EBX, Address(ESP, EBX, TIMES_WORD_SIZE, 2 * kWordSize));
+  __ leal(EBX, Address(ESP, EBX, TIMES_WORD_SIZE,
+                       NativeFrame::kArgumentsOffset * kWordSize));
   LoadProcess(ECX);
 
   SwitchToCStack();
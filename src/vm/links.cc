@@ -34,40 +34,52 @@ void Links::RemoveHandle(ProcessHandle* handle) {
 
 void Links::NotifyLinkedProcesses(ProcessHandle* dying_handle,
                                   Signal::Kind kind) {
-  ScopedSpinlock locker(&lock_);
-  ASSERT(!half_dead_);
+  // Take the links out of the set while holding the lock, and signal the
+  // linked processes after releasing it. That way registering links and
+  // monitors never waits for the signals to be sent.
+  MultiHashSet<ProcessHandle*> handles;
+  {
+    ScopedSpinlock locker(&lock_);
+    ASSERT(!half_dead_);
+    handles.Swap(handles_);
+    half_dead_ = true;
+    exit_kind_ = kind;
+  }
 
   Signal* signal = NULL;
 
-  for (auto it = handles_.Begin(); it != handles_.End(); ++it) {
+  for (auto it = handles.Begin(); it != handles.End(); ++it) {
     ProcessHandle* handle = it->first;
     // NOTE: Even though a link might have been setup several times, there is no
     // reason to send several signals, since the first one is deadly already.
     signal = SendSignal(handle, dying_handle, kind, signal);
     ProcessHandle::DecrementRef(handle);
   }
-  handles_.Clear();
-  half_dead_ = true;
-  exit_kind_ = kind;
 
   if (signal != NULL) Signal::DecrementRef(signal);
 }
 
 void Links::NotifyMonitors(ProcessHandle* dying_handle) {
-  ScopedSpinlock locker(&lock_);
+  MultiHashSet<Port*> ports;
+  Signal::Kind kind;
+  {
+    ScopedSpinlock locker(&lock_);
+    ASSERT(half_dead_);
+    ports.Swap(ports_);
+    kind = exit_kind_;
+  }
+
   Signal* signal = NULL;
-  ASSERT(half_dead_);
-  for (auto it = ports_.Begin(); it != ports_.End(); ++it) {
+  for (auto it = ports.Begin(); it != ports.End(); ++it) {
     Port* port = it->first;
     int count = it->second;
     // NOTE: Since one can monitor another process X number of times, we need to
     // send the exit signal also X times.
     for (int i = 0; i < count; i++) {
-      signal = EnqueueSignal(port, dying_handle, exit_kind_, signal);
+      signal = EnqueueSignal(port, dying_handle, kind, signal);
     }
     port->DecrementRef();
   }
-  ports_.Clear();
 
   if (signal != NULL) Signal::DecrementRef(signal);
 }
@@ -80,21 +92,20 @@ Signal* Links::EnqueueSignal(Port* port, ProcessHandle* dying_handle,
   if (port->process() != NULL) {
     if (signal == NULL) signal = new Signal(dying_handle, kind);
     signal->IncrementRef();
-    uword address = reinterpret_cast<uword>(signal);
-    Message* message =
-        new Message(port, address, 0, Message::PROCESS_DEATH_SIGNAL);
 
-    {
-      ScopedSpinlock locker(port->spinlock());
-      Process* process = port->process();
-      if (process != NULL) {
+    // The signals pending in a port are delivered in batches, so only the
+    // first one of a batch enqueues a message and wakes up the owner.
+    ScopedSpinlock locker(port->spinlock());
+    Process* process = port->process();
+    if (process == NULL) {
+      Signal::DecrementRef(signal);
+    } else {
+      Message* message = port->AddDeathSignal(signal);
+      if (message != NULL) {
         process->mailbox()->EnqueueEntry(message);
         process->program()->scheduler()->ResumeProcess(process);
-        message = NULL;
       }
     }
-
-    if (message != NULL) delete message;
   }
 
   return signal;
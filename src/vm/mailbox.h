@@ -42,6 +42,12 @@ class Mailbox {
   // Thread-safe way of asking if the mailbox is empty.
   bool IsEmpty() const { return last_message_.load() == NULL; }
 
+  // Thread-safe way of asking if [entry] is the last message enqueued, and
+  // the queue has not been taken since.
+  bool IsLast(MessageType* entry) const {
+    return last_message_.load() == entry;
+  }
+
   void TakeQueue() {
     ASSERT(current_message_ == NULL);
     MessageType* last = last_message_;
@@ -55,6 +61,22 @@ class Mailbox {
     return current_message_;
   }
 
+  // Returns the first of all messages in the mailbox, in the order they will
+  // be received. Messages enqueued since the queue was last taken are moved
+  // behind the current ones. Only safe while no other thread enqueues
+  // messages, e.g. when the program is stopped.
+  MessageType* AllMessages() {
+    MessageType* queue = Reverse(last_message_.exchange(NULL));
+    if (current_message_ == NULL) {
+      current_message_ = queue;
+    } else {
+      MessageType* last = current_message_;
+      while (last->next() != NULL) last = last->next();
+      last->set_next(queue);
+    }
+    return current_message_;
+  }
+
   void AdvanceCurrentMessage() {
     ASSERT(current_message_ != NULL);
     MessageType* temp = current_message_;
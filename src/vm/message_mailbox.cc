@@ -3,26 +3,226 @@
 // BSD-style license that can be found in the LICENSE.md file.
 
 #include "src/vm/message_mailbox.h"
+
+#include "src/shared/flags.h"
+#include "src/shared/platform.h"
+
+#include "src/vm/hash_map.h"
+#include "src/vm/hash_set.h"
 #include "src/vm/process.h"
+#include "src/vm/scheduler.h"
+#include "src/vm/vector.h"
 
 namespace fletch {
 
+#ifdef FLETCH_ENABLE_MULTIPLE_PROCESS_HEAPS
+
 ExitReference::ExitReference(Process* exiting_process, Object* message)
     : mutable_heap_(NULL, reinterpret_cast<WeakPointer*>(NULL)),
-      store_buffer_(true),
+      store_buffer_(false),
+      message_(message) {
+  // Copy the objects reachable from the message out of the heap of the
+  // exiting process instead of taking over the whole heap. That keeps
+  // the heap of the receiver from growing by the garbage of every process
+  // it joins.
+  Heap* heap = exiting_process->heap();
+  Space* from = heap->space();
+  Space* to = new Space();
+  {
+    NoAllocationFailureScope scope(to);
+    ScavengeVisitor visitor(from, to);
+    visitor.Visit(&message_);
+    Space* program_space = exiting_process->program()->heap()->space();
+    to->CompleteScavengeMutable(&visitor, program_space, &store_buffer_);
+  }
+
+  // Finalizers of objects that were copied move along with them. The
+  // rest of the objects are dead, so we run their finalizers right away.
+  // After that, all remaining foreign memory belongs to the copies.
+  WeakPointer::MoveForwarded(from, &heap->weak_pointers_,
+                             &mutable_heap_.weak_pointers_);
+  heap->ProcessWeakPointers();
+  mutable_heap_.foreign_memory_ = heap->foreign_memory_;
+  heap->foreign_memory_ = 0;
+  mutable_heap_.ReplaceSpace(to);
+
+  // The process is terminating. Its store buffer refers to objects that
+  // may have been copied, so we drop it along with the heap.
+  StoreBuffer empty;
+  exiting_process->store_buffer()->ReplaceAfterMutableGC(&empty);
+  Space* dead = heap->TakeSpace();
+  dead->QueueChunksForFreeing();
+  delete dead;
+}
+
+// Turns the objects of a message arena into mutable objects and records the
+// ones pointing into the shared heap in a store buffer.
+class DetachArenaObjectVisitor : public HeapObjectVisitor {
+ public:
+  DetachArenaObjectVisitor(Space* space, Program* program,
+                           StoreBuffer* store_buffer)
+      : finder_(space, program->heap()->space()),
+        store_buffer_(store_buffer),
+        array_class_(program->array_class()),
+        immutable_array_class_(program->immutable_array_class()) {}
+
+  virtual int Visit(HeapObject* object) {
+    if (object->IsInstance()) {
+      Instance::cast(object)->ClearImmutable();
+    } else if (object->get_class() == immutable_array_class_) {
+      object->set_class(array_class_);
+    }
+    if (finder_.ContainsImmutablePointer(object)) {
+      store_buffer_->Insert(object);
+    }
+    return object->Size();
+  }
+
+ private:
+  FindImmutablePointerVisitor finder_;
+  StoreBuffer* store_buffer_;
+  Class* array_class_;
+  Class* immutable_array_class_;
+};
+
+ExitReference::ExitReference(Heap* message_arena, Program* program,
+                             Object* message)
+    : mutable_heap_(NULL, reinterpret_cast<WeakPointer*>(NULL)),
+      store_buffer_(false),
       message_(message) {
-  mutable_heap_.MergeInOtherHeap(exiting_process->heap());
-  store_buffer_.Prepend(exiting_process->store_buffer());
+  mutable_heap_.MergeInOtherHeap(message_arena);
+  DetachArenaObjectVisitor visitor(mutable_heap_.space(), program,
+                                   &store_buffer_);
+  mutable_heap_.IterateObjects(&visitor);
+}
+
+ExitReference::ExitReference(Object* message)
+    : mutable_heap_(NULL, reinterpret_cast<WeakPointer*>(NULL)),
+      store_buffer_(false),
+      message_(message) {}
+
+// Collects the objects that have a finalizer registered.
+class FinalizedObjectsVisitor : public PointerVisitor {
+ public:
+  explicit FinalizedObjectsVisitor(HashSet<HeapObject*>* objects)
+      : objects_(objects) {}
+
+  virtual void VisitBlock(Object** start, Object** end) {
+    for (Object** p = start; p < end; p++) {
+      objects_->Insert(HeapObject::cast(*p));
+    }
+  }
+
+ private:
+  HashSet<HeapObject*>* objects_;
+};
+
+// Copies the objects of a process heap reachable from the visited pointers
+// into another space. Unlike a scavenge, the originals are not forwarded,
+// so the sending process keeps using them. The copies are processed from a
+// worklist and the forwarding table maps each original to its copy, which
+// preserves cycles and sharing.
+//
+// Stacks cannot be copied. Neither can foreign memory objects and objects
+// with a finalizer: the copy would refer to the same external resource as
+// the original without owning it, and would dangle once the original is
+// finalized or freed.
+class CloneVisitor : public PointerVisitor {
+ public:
+  CloneVisitor(Heap* from, Space* to, Program* program,
+               StoreBuffer* store_buffer)
+      : from_(from->space()),
+        to_(to),
+        foreign_memory_class_(program->foreign_memory_class()),
+        finder_(to, program->heap()->space()),
+        store_buffer_(store_buffer),
+        failed_(false) {
+    FinalizedObjectsVisitor visitor(&finalized_);
+    from->VisitWeakObjectPointers(&visitor);
+  }
+
+  bool failed() const { return failed_; }
+
+  virtual void VisitBlock(Object** start, Object** end) {
+    for (Object** p = start; p < end; p++) {
+      Object* object = *p;
+      if (!object->IsHeapObject()) continue;
+      HeapObject* original = HeapObject::cast(object);
+      if (!from_->Includes(original->address())) continue;
+      HeapObject*& copy = forwarding_[original];
+      if (copy == NULL) {
+        if (!CanClone(original)) {
+          failed_ = true;
+          return;
+        }
+        int size = original->Size();
+        copy = HeapObject::FromAddress(to_->AllocateLinearly(size));
+        memcpy(reinterpret_cast<void*>(copy->address()),
+               reinterpret_cast<void*>(original->address()), size);
+        worklist_.PushBack(copy);
+      }
+      *p = copy;
+    }
+  }
+
+  // Copies the objects reachable from the copies made so far. Copies
+  // pointing into the shared heap are recorded in the store buffer.
+  void Complete() {
+    while (worklist_.size() > 0) {
+      HeapObject* copy = worklist_.PopBack();
+      copy->IteratePointers(this);
+      if (failed_) return;
+      if (finder_.ContainsImmutablePointer(copy)) {
+        store_buffer_->Insert(copy);
+      }
+    }
+  }
+
+ private:
+  bool CanClone(HeapObject* object) {
+    if (object->IsStack()) return false;
+    if (object->get_class() == foreign_memory_class_) return false;
+    return finalized_.Find(object) == finalized_.End();
+  }
+
+  Space* from_;
+  Space* to_;
+  Class* foreign_memory_class_;
+  FindImmutablePointerVisitor finder_;
+  StoreBuffer* store_buffer_;
+  HashSet<HeapObject*> finalized_;
+  HashMap<HeapObject*, HeapObject*> forwarding_;
+  Vector<HeapObject*> worklist_;
+  bool failed_;
+};
+
+ExitReference* ExitReference::CloneMessage(Process* sender, Object* message) {
+  ExitReference* reference = new ExitReference(message);
+  Space* to = new Space();
+  bool failed;
+  {
+    NoAllocationFailureScope scope(to);
+    CloneVisitor visitor(sender->heap(), to, sender->program(),
+                         &reference->store_buffer_);
+    visitor.Visit(&reference->message_);
+    visitor.Complete();
+    failed = visitor.failed();
+  }
+  reference->mutable_heap_.ReplaceSpace(to);
+  if (failed) {
+    delete reference;
+    return NULL;
+  }
+  return reference;
 }
 
+#endif  // #ifdef FLETCH_ENABLE_MULTIPLE_PROCESS_HEAPS
+
 Message::~Message() {
   port_->DecrementRef();
-  if (kind() == EXIT) {
+  if (HasExitReference()) {
     ExitReference* ref = reinterpret_cast<ExitReference*>(value());
     delete ref;
-  } else if (kind() == PROCESS_DEATH_SIGNAL) {
-    Signal* signal = reinterpret_cast<Signal*>(value());
-    Signal::DecrementRef(signal);
   }
 }
 
@@ -39,8 +239,10 @@ Message* Message::NewImmutableMessage(Port* port, Object* message) {
 }
 
 void Message::MergeChildHeaps(Process* destination_process) {
-  ASSERT(kind() == Message::EXIT);
+  ASSERT(HasExitReference());
   ExitReference* ref = reinterpret_cast<ExitReference*>(value());
+  // The heap is gone if [Process::TakeChildHeaps] already merged it.
+  if (ref->mutable_heap()->space() == NULL) return;
   destination_process->heap()->MergeInOtherHeap(ref->mutable_heap());
   destination_process->store_buffer()->Prepend(ref->store_buffer());
 }
@@ -65,8 +267,18 @@ void MessageMailbox::EnqueueForeign(Port* port, void* foreign, int size,
 #ifdef FLETCH_ENABLE_MULTIPLE_PROCESS_HEAPS
 
 void MessageMailbox::EnqueueExit(Process* sender, Port* port, Object* message) {
-  // TODO(kasperl): Optimize this to avoid merging heaps if copying is cheaper.
-  uint64 address = reinterpret_cast<uint64>(new ExitReference(sender, message));
+  uint64 start =
+      Flags::print_exit_statistics ? Platform::GetMonotonicMicroseconds() : 0;
+  int heap_size = sender->heap()->space()->Used();
+  ExitReference* reference = new ExitReference(sender, message);
+  if (Flags::print_exit_statistics) {
+    Scheduler* scheduler = sender->program()->scheduler();
+    if (scheduler != NULL) {
+      scheduler->RecordExit(heap_size, reference->mutable_heap()->Used(),
+                            Platform::GetMonotonicMicroseconds() - start);
+    }
+  }
+  uint64 address = reinterpret_cast<uint64>(reference);
   Message* entry = new Message(port, address, 0, Message::EXIT);
   EnqueueEntry(entry);
 }
@@ -89,7 +301,7 @@ void MessageMailbox::MergeAllChildHeaps(Process* destination_process) {
 void MessageMailbox::MergeAllChildHeapsFromQueue(Message* queue,
                                                  Process* destination_process) {
   for (Message* current = queue; current != NULL; current = current->next()) {
-    if (current->kind() == Message::EXIT) {
+    if (current->HasExitReference()) {
       current->MergeChildHeaps(destination_process);
     }
   }
@@ -16,12 +16,25 @@
 namespace fletch {
 
 class Process;
-class Signal;
+class Program;
 
+// The objects of a heap detached from its process, on the way to the
+// process receiving [message]. Exit messages, sealed message arenas and
+// cloned messages travel this way.
 class ExitReference {
  public:
   ExitReference(Process* exiting_process, Object* message);
 
+  // Takes the objects of a sealed message arena. They become mutable, since
+  // they will live in the heap of the receiving process.
+  ExitReference(Heap* message_arena, Program* program, Object* message);
+
+  // Copies the objects of the heap of [sender] reachable from [message],
+  // leaving the originals untouched. Objects outside the heap of [sender]
+  // are shared with the copy. Returns NULL if the objects include a stack,
+  // which cannot be copied.
+  static ExitReference* CloneMessage(Process* sender, Object* message);
+
   Object* message() const { return message_; }
 
   void VisitPointers(PointerVisitor* visitor) { visitor->Visit(&message_); }
@@ -31,6 +44,8 @@ class ExitReference {
   StoreBuffer* store_buffer() { return &store_buffer_; }
 
  private:
+  explicit ExitReference(Object* message);
+
   Heap mutable_heap_;
   StoreBuffer store_buffer_;
   Object* message_;
@@ -44,8 +59,17 @@ class Message : public MailboxMessage<Message> {
     LARGE_INTEGER,
     FOREIGN,
     FOREIGN_FINALIZED,
+    // Death signals of monitored processes have arrived. They are kept in
+    // the port, and the message stays in the mailbox until all of its batch
+    // has been received. The value is the end of the batch, see
+    // [Port::AddDeathSignal].
     PROCESS_DEATH_SIGNAL,
     EXIT,
+    // A copy of a mutable message, see [ExitReference::CloneMessage].
+    CLONE,
+    // All contributions to a gather port have arrived. They are kept in the
+    // port until the message is received.
+    GATHER,
   };
 
   Message(Port* port, uint64 value, int size, Kind kind)
@@ -61,17 +85,18 @@ class Message : public MailboxMessage<Message> {
 
   Port* port() const { return port_; }
   uint64 value() const { return value_; }
+  void set_value(uint64 value) { value_ = value; }
   int size() const { return SizeField::decode(kind_and_size_); }
   Kind kind() const { return KindField::decode(kind_and_size_); }
 
-  Object* ExitReferenceObject() {
-    ASSERT(kind() == Message::EXIT);
-    return reinterpret_cast<ExitReference*>(value())->message();
+  // Exit and clone messages carry their objects in an [ExitReference].
+  bool HasExitReference() const {
+    return kind() == Message::EXIT || kind() == Message::CLONE;
   }
 
-  Signal* ProcessDeathSignal() {
-    ASSERT(kind() == Message::PROCESS_DEATH_SIGNAL);
-    return reinterpret_cast<Signal*>(value());
+  Object* ExitReferenceObject() {
+    ASSERT(HasExitReference());
+    return reinterpret_cast<ExitReference*>(value())->message();
   }
 
   void VisitPointers(PointerVisitor* visitor) {
@@ -79,7 +104,8 @@ class Message : public MailboxMessage<Message> {
       case IMMUTABLE_OBJECT:
         visitor->Visit(reinterpret_cast<Object**>(&value_));
         break;
-      case EXIT: {
+      case EXIT:
+      case CLONE: {
         ExitReference* ref = reinterpret_cast<ExitReference*>(value());
         ref->VisitPointers(visitor);
         break;
@@ -94,8 +120,8 @@ class Message : public MailboxMessage<Message> {
  private:
   Port* port_;
   uint64 value_;
-  class KindField : public BitField<Kind, 0, 3> {};
-  class SizeField : public BitField<int, 3, 32 - 3> {};
+  class KindField : public BitField<Kind, 0, 4> {};
+  class SizeField : public BitField<int, 4, 32 - 4> {};
   const int32 kind_and_size_;
 };
 
@@ -0,0 +1,192 @@
+// Copyright (c) 2015, the Fletch project authors. Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE.md file.
+
+#ifdef FLETCH_ENABLE_MULTIPLE_PROCESS_HEAPS
+
+#include "src/shared/test_case.h"
+
+#include "src/vm/message_mailbox.h"
+#include "src/vm/object.h"
+#include "src/vm/port.h"
+#include "src/vm/process.h"
+#include "src/vm/program.h"
+#include "src/vm/signal.h"
+#include "src/vm/test_program.h"
+
+namespace fletch {
+
+TEST_CASE(MessageMailbox_CloneMessage) {
+  TestProgram test;
+  Program* program = test.program();
+  Process* process = test.SpawnProcess();
+
+  Array* outer = Array::cast(process->NewArray(3));
+  Array* inner = Array::cast(process->NewArray(1));
+  outer->set(0, outer);
+  outer->set(1, inner);
+  outer->set(2, inner);
+  inner->set(0, program->null_object());
+
+  ExitReference* reference = ExitReference::CloneMessage(process, outer);
+  EXPECT(reference != NULL);
+  Array* copy = Array::cast(reference->message());
+  EXPECT(copy != outer);
+  EXPECT(reference->mutable_heap()->space()->Includes(copy->address()));
+
+  // Cycles and sharing are preserved, the originals are untouched.
+  EXPECT(copy->get(0) == copy);
+  EXPECT(copy->get(1) == copy->get(2));
+  EXPECT(copy->get(1) != inner);
+  EXPECT(Array::cast(copy->get(1))->get(0) == program->null_object());
+  EXPECT(outer->get(0) == outer);
+  EXPECT(outer->get(1) == inner);
+  delete reference;
+
+  // Stacks cannot be copied.
+  inner->set(0, process->stack());
+  EXPECT(ExitReference::CloneMessage(process, outer) == NULL);
+
+  // Neither can objects with a finalizer, whose copies would not own the
+  // resources the finalizer releases.
+  inner->set(0, program->null_object());
+  process->RegisterFinalizer(inner, Process::FinalizeForeign);
+  EXPECT(ExitReference::CloneMessage(process, outer) == NULL);
+  process->UnregisterFinalizer(inner);
+  reference = ExitReference::CloneMessage(process, outer);
+  EXPECT(reference != NULL);
+  delete reference;
+
+  // Nor foreign memory, finalized or not.
+  Instance* foreign =
+      Instance::cast(process->NewInstance(program->foreign_memory_class()));
+  foreign->SetConsecutiveSmis(0, 0);
+  foreign->SetInstanceField(2, Smi::zero());
+  inner->set(0, foreign);
+  EXPECT(ExitReference::CloneMessage(process, outer) == NULL);
+
+  test.DeleteProcess(process);
+}
+
+TEST_CASE(MessageMailbox_SealMessageArena) {
+  TestProgram test;
+  Program* program = test.program();
+  Process* process = test.SpawnProcess();
+  process->set_immutable_heap(program->shared_heap()->heap());
+  Object* null = program->null_object();
+
+  // Use free slots below the top of the stack as the sending frames.
+  Stack* stack = process->stack();
+  stack->set_top(stack->length() - 1);
+  stack->set(stack->top(), NULL);
+  Object** frames_start = stack->Pointer(stack->top() - 3);
+  Object** frames_end = stack->Pointer(stack->top() - 1);
+
+  process->OpenMessageArena();
+  Array* message = Array::cast(process->NewImmutableArray(1));
+  Object* inner = process->NewImmutableArray(0);
+  message->set(0, inner);
+  frames_start[0] = message;
+  frames_start[1] = inner;
+  ExitReference* reference =
+      process->SealMessageArena(message, frames_start, frames_end);
+  EXPECT(reference != NULL);
+  EXPECT(process->message_arena() == NULL);
+  EXPECT(frames_start[0] == null);
+  EXPECT(frames_start[1] == null);
+
+  // The receiver gets the objects as mutable objects in its own heap, so
+  // they cannot be sent on like immutable ones.
+  EXPECT(reference->message() == message);
+  EXPECT(reference->mutable_heap()->space()->Includes(message->address()));
+  EXPECT(message->get_class() == program->array_class());
+  EXPECT(!message->IsImmutable());
+  delete reference;
+
+  // A reference from outside the sending frames keeps the objects in the
+  // shared heap, where they stay immutable.
+  process->OpenMessageArena();
+  message = Array::cast(process->NewImmutableArray(1));
+  frames_end[0] = message;
+  EXPECT(process->SealMessageArena(message, frames_start, frames_end - 1) ==
+         NULL);
+  EXPECT(process->message_arena() == NULL);
+  EXPECT(frames_end[0] == message);
+  EXPECT(message->IsImmutable());
+  frames_end[0] = null;
+
+  process->set_immutable_heap(NULL);
+  test.DeleteProcess(process);
+}
+
+// Adds a death signal to [port] like [Links::EnqueueSignal], without waking
+// up the owner.
+static void EnqueueDeath(Port* port, Process* dying) {
+  Signal* signal = new Signal(dying->process_handle(), Signal::kTerminated);
+  port->Lock();
+  Message* message = port->AddDeathSignal(signal);
+  if (message != NULL) port->process()->mailbox()->EnqueueEntry(message);
+  port->Unlock();
+}
+
+static int TakeDeathBatch(Port* port, Message* message) {
+  EXPECT_EQ(Message::PROCESS_DEATH_SIGNAL, message->kind());
+  int count = 0;
+  bool more = true;
+  port->Lock();
+  while (more) {
+    Signal::DecrementRef(port->TakeDeathSignal(message, &more));
+    count++;
+  }
+  port->Unlock();
+  return count;
+}
+
+TEST_CASE(MessageMailbox_DeathSignalOrder) {
+  TestProgram test;
+  Process* process = test.SpawnProcess();
+  Process* dying = test.SpawnProcess();
+  ThreadState thread_state;
+  thread_state.AttachToCurrentThread();
+  process->set_thread_state(&thread_state);
+  Port* port = new Port(process, NULL);
+  MessageMailbox* mailbox = process->mailbox();
+
+  // Deaths only join the batch of the last message in the mailbox, so they
+  // are never received ahead of data messages enqueued before them.
+  EnqueueDeath(port, dying);
+  EnqueueDeath(port, dying);
+  mailbox->EnqueueLargeInteger(port, 1);
+  EnqueueDeath(port, dying);
+  mailbox->EnqueueLargeInteger(port, 2);
+  EnqueueDeath(port, dying);
+  EnqueueDeath(port, dying);
+  EnqueueDeath(port, dying);
+
+  EXPECT_EQ(2, TakeDeathBatch(port, mailbox->CurrentMessage()));
+  mailbox->AdvanceCurrentMessage();
+  EXPECT_EQ(1, static_cast<int>(mailbox->CurrentMessage()->value()));
+  mailbox->AdvanceCurrentMessage();
+
+  // A death arriving once the queue has been taken starts a new batch,
+  // behind the ones already taken.
+  EnqueueDeath(port, dying);
+  EXPECT_EQ(1, TakeDeathBatch(port, mailbox->CurrentMessage()));
+  mailbox->AdvanceCurrentMessage();
+  EXPECT_EQ(2, static_cast<int>(mailbox->CurrentMessage()->value()));
+  mailbox->AdvanceCurrentMessage();
+  EXPECT_EQ(3, TakeDeathBatch(port, mailbox->CurrentMessage()));
+  mailbox->AdvanceCurrentMessage();
+  EXPECT_EQ(1, TakeDeathBatch(port, mailbox->CurrentMessage()));
+  mailbox->AdvanceCurrentMessage();
+  EXPECT(mailbox->CurrentMessage() == NULL);
+
+  port->DecrementRef();
+  process->set_thread_state(NULL);
+  test.DeleteProcess(dying);
+  test.DeleteProcess(process);
+}
+
+}  // namespace fletch
+
+#endif  // FLETCH_ENABLE_MULTIPLE_PROCESS_HEAPS
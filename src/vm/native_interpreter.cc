@@ -2,7 +2,8 @@
 // for details. All rights reserved. Use of this source code is governed by a
 // BSD-style license that can be found in the LICENSE.md file.
 
-#if defined(FLETCH_TARGET_IA32) || defined(FLETCH_TARGET_ARM)
+#if defined(FLETCH_TARGET_IA32) || defined(FLETCH_TARGET_ARM) || \
+    (defined(FLETCH_TARGET_X64) && defined(FLETCH_TARGET_OS_POSIX))
 
 #include "src/shared/assert.h"
 
@@ -41,4 +42,4 @@ void ClearBytecodeBreak(Opcode opcode) {
 
 }  // namespace fletch
 
-#endif  // defined(FLETCH_TARGET_IA32) || defined(FLETCH_TARGET_ARM)
+#endif  // defined(FLETCH_TARGET_IA32) || defined(FLETCH_TARGET_ARM) || ...
@@ -12,7 +12,8 @@ namespace fletch {
 class Process;
 class TargetYieldResult;
 
-#if defined(FLETCH_TARGET_IA32) || defined(FLETCH_TARGET_ARM)
+#if defined(FLETCH_TARGET_IA32) || defined(FLETCH_TARGET_ARM) || \
+    (defined(FLETCH_TARGET_X64) && defined(FLETCH_TARGET_OS_POSIX))
 
 // For the platforms that have a native interpreter this function is
 // generated as the native interpreter entry point. The native
@@ -41,7 +42,7 @@ inline void SetBytecodeBreak(Opcode opcode) { }
 
 inline void ClearBytecodeBreak(Opcode opcode) { }
 
-#endif  // defined(FLETCH_TARGET_IA32) || defined(FLETCH_TARGET_ARM)
+#endif  // defined(FLETCH_TARGET_IA32) || defined(FLETCH_TARGET_ARM) || ...
 
 }  // namespace fletch
 
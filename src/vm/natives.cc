@@ -14,7 +14,10 @@
 #include "src/shared/selectors.h"
 #include "src/shared/platform.h"
 
+#include "src/vm/buffer_pool.h"
+#include "src/vm/clock.h"
 #include "src/vm/event_handler.h"
+#include "src/vm/histogram.h"
 #include "src/vm/interpreter.h"
 #include "src/vm/port.h"
 #include "src/vm/process.h"
@@ -795,6 +798,15 @@ NATIVE(DoublePow) {
   return process->NewDouble(pow(x_value, y_value));
 }
 
+// Natives that read all the elements of a fixed-length or constant list
+// take the array or byte array holding them, which the Dart code gets with
+// fixedListBackingStore, rather than the list itself. Returns [store] if it
+// is such an array, and NULL otherwise.
+static BaseArray* AsListBackingStore(Object* store) {
+  if (!store->IsArray() && !store->IsByteArray()) return NULL;
+  return BaseArray::cast(store);
+}
+
 NATIVE(ListNew) {
   Object* x = arguments[0];
   if (!x->IsSmi()) return Failure::wrong_argument_type();
@@ -916,6 +928,14 @@ NATIVE(ProcessSpawn) {
     }
     monitor_port = Port::FromDartObject(dart_monitor_port);
   }
+  Object* heap_size = arguments[6];
+  if (!heap_size->IsNull() && !heap_size->IsSmi()) {
+    return Failure::wrong_argument_type();
+  }
+
+  // The closure and argument may refer to objects in an open message arena,
+  // which must live in the shared heap before the child can see them.
+  process->CloseMessageArena(process->immutable_heap());
 
   if (!closure->IsImmutable()) {
     // TODO(kasperl): Return a proper failure.
@@ -957,6 +977,12 @@ NATIVE(ProcessSpawn) {
     child->links()->InsertPort(monitor_port);
   }
 
+  if (heap_size->IsSmi()) {
+    word size = Smi::cast(heap_size)->value();
+    size = Utils::Minimum<word>(size, HeapSizingPolicy::kMaximumBudget);
+    child->SetHeapSizeHint(static_cast<int>(size));
+  }
+
   program->scheduler()->EnqueueProcessOnSchedulerWorkerThread(process, child);
 
   return dart_process;
@@ -973,6 +999,17 @@ NATIVE(ProcessCurrent) {
   return dart_process;
 }
 
+NATIVE(ProcessNumberOfThreads) {
+  Scheduler* scheduler = process->program()->scheduler();
+  int threads = (scheduler != NULL) ? scheduler->max_threads() : 1;
+  return Smi::FromWord(threads);
+}
+
+NATIVE(ProcessHibernate) {
+  process->RequestHibernation();
+  return process->program()->null_object();
+}
+
 NATIVE(CoroutineCurrent) { return process->coroutine(); }
 
 NATIVE(CoroutineNewStack) {
@@ -1011,13 +1048,128 @@ NATIVE(CoroutineNewStack) {
   return stack;
 }
 
-NATIVE(StopwatchFrequency) { return Smi::FromWord(1000000); }
+NATIVE(StopwatchFrequency) {
+  return process->ToInteger(Clock::TicksPerSecond());
+}
+
+NATIVE(StopwatchNow) { return process->ToInteger(Clock::ElapsedTicks()); }
+
+NATIVE(LatencyHistogramNow) {
+  return process->ToInteger(Clock::TicksToMicroseconds(Clock::ElapsedTicks()));
+}
+
+NATIVE(LatencyHistogramBucketCount) {
+  return Smi::FromWord(LatencyBuckets::kNumberOfBuckets);
+}
+
+// The buckets of a LatencyHistogram are the array behind a fixed-length list
+// with a Smi count for each of the [LatencyBuckets].
+static Array* LatencyBucketCounts(Object* store) {
+  if (!store->IsArray()) return NULL;
+  Array* counts = Array::cast(store);
+  if (counts->length() != LatencyBuckets::kNumberOfBuckets) return NULL;
+  return counts;
+}
+
+NATIVE(LatencyHistogramRecord) {
+  Array* counts = LatencyBucketCounts(arguments[0]);
+  if (counts == NULL) return Failure::wrong_argument_type();
+  Object* x = arguments[1];
+  int64 value;
+  if (x->IsSmi()) {
+    value = Smi::cast(x)->value();
+  } else if (x->IsLargeInteger()) {
+    value = LargeInteger::cast(x)->value();
+  } else {
+    return Failure::wrong_argument_type();
+  }
+  if (value < 0) return Failure::wrong_argument_type();
+  int index = LatencyBuckets::BucketFor(value);
+  Object* count = counts->get(index);
+  if (!count->IsSmi()) return Failure::wrong_argument_type();
+  word incremented = Smi::cast(count)->value() + 1;
+  if (!Smi::IsValid(incremented)) return Failure::index_out_of_bounds();
+  counts->set(index, Smi::FromWord(incremented));
+  return process->program()->null_object();
+}
+
+NATIVE(LatencyHistogramPercentile) {
+  Array* counts = LatencyBucketCounts(arguments[0]);
+  if (counts == NULL) return Failure::wrong_argument_type();
+  Object* x = arguments[1];
+  double percentile;
+  if (x->IsSmi()) {
+    percentile = Smi::cast(x)->value();
+  } else if (x->IsDouble()) {
+    percentile = Double::cast(x)->value();
+  } else {
+    return Failure::wrong_argument_type();
+  }
+  if (percentile < 0 || percentile > 100) return Failure::index_out_of_bounds();
 
-NATIVE(StopwatchNow) {
-  static uint64 first = 0;
-  uint64 now = Platform::GetProcessMicroseconds();
-  if (first == 0) first = now;
-  return process->ToInteger(now - first);
+  uint64 total = 0;
+  for (int i = 0; i < LatencyBuckets::kNumberOfBuckets; i++) {
+    Object* count = counts->get(i);
+    if (!count->IsSmi()) return Failure::wrong_argument_type();
+    total += Smi::cast(count)->value();
+  }
+  if (total == 0) return Smi::FromWord(0);
+
+  // Same rounding as Histogram::Percentile.
+  uint64 target = static_cast<uint64>((total * percentile) / 100.0 + 0.5);
+  if (target == 0) target = 1;
+  uint64 seen = 0;
+  for (int i = 0; i < LatencyBuckets::kNumberOfBuckets; i++) {
+    seen += Smi::cast(counts->get(i))->value();
+    if (seen >= target) {
+      return process->ToInteger(
+          static_cast<int64>(LatencyBuckets::BucketLimit(i)));
+    }
+  }
+  UNREACHABLE();
+  return NULL;
+}
+
+NATIVE(BufferPoolRegister) {
+  Object* size = arguments[0];
+  Object* max_buffers = arguments[1];
+  if (!size->IsSmi() || !max_buffers->IsSmi()) {
+    return Failure::wrong_argument_type();
+  }
+  bool registered = BufferPool::Register(Smi::cast(size)->value(),
+                                         Smi::cast(max_buffers)->value());
+  return ToBool(process, registered);
+}
+
+NATIVE(BufferPoolPooledBuffers) {
+  Object* size = arguments[0];
+  if (!size->IsSmi()) return Failure::wrong_argument_type();
+  return Smi::FromWord(BufferPool::PooledBuffers(Smi::cast(size)->value()));
+}
+
+// Returns the index of the first [byte] in [start, end) of the foreign memory
+// at [address], or -1 if there is none. The Dart code has checked the range
+// against the length of the memory.
+NATIVE(IndexOfByte) {
+  Object* address = arguments[0];
+  Object* byte = arguments[1];
+  Object* start = arguments[2];
+  Object* end = arguments[3];
+  if (!address->IsSmi() && !address->IsLargeInteger()) {
+    return Failure::wrong_argument_type();
+  }
+  if (!byte->IsSmi() || !start->IsSmi() || !end->IsSmi()) {
+    return Failure::wrong_argument_type();
+  }
+  word value = Smi::cast(byte)->value();
+  if (value < 0 || value > 0xFF) return Failure::wrong_argument_type();
+  word from = Smi::cast(start)->value();
+  word to = Smi::cast(end)->value();
+  if (from < 0 || to < from) return Failure::index_out_of_bounds();
+  const uint8* memory = reinterpret_cast<const uint8*>(AsForeignWord(address));
+  const void* found = memchr(memory + from, static_cast<int>(value), to - from);
+  if (found == NULL) return Smi::FromWord(-1);
+  return Smi::FromWord(static_cast<const uint8*>(found) - memory);
 }
 
 NATIVE(IdentityHashCode) {
@@ -1051,6 +1203,64 @@ NATIVE(StringLength) {
   return Smi::FromWord(x->length());
 }
 
+// Creates a string from the code units at [start, end) of the array or byte
+// array behind a list, without going through the Dart code unit by code
+// unit. Code points that need surrogate pairs are left to the Dart code.
+NATIVE(StringFromCharCodes) {
+  BaseArray* store = AsListBackingStore(arguments[0]);
+  Object* x = arguments[1];
+  Object* y = arguments[2];
+  if (store == NULL || !x->IsSmi() || !y->IsSmi()) {
+    return Failure::wrong_argument_type();
+  }
+  word start = Smi::cast(x)->value();
+  word end = Smi::cast(y)->value();
+  if (start < 0 || start > end || end > store->length()) {
+    return Failure::index_out_of_bounds();
+  }
+  int length = end - start;
+
+  if (store->IsByteArray()) {
+    Object* raw_result = process->NewOneByteStringUninitialized(length);
+    if (raw_result->IsFailure()) return raw_result;
+    OneByteString* result = OneByteString::cast(raw_result);
+    if (length > 0) {
+      ByteArray* bytes = ByteArray::cast(store);
+      memcpy(result->byte_address_for(0), bytes->byte_address_for(start),
+             length);
+    }
+    return result;
+  }
+
+  Array* array = Array::cast(store);
+  word max_code_unit = 0;
+  for (int i = start; i < end; i++) {
+    Object* code = array->get(i);
+    if (!code->IsSmi()) return Failure::wrong_argument_type();
+    word value = Smi::cast(code)->value();
+    if (value < 0 || value > 0xFFFF) return Failure::wrong_argument_type();
+    if (value > max_code_unit) max_code_unit = value;
+  }
+
+  if (max_code_unit <= 0xFF) {
+    Object* raw_result = process->NewOneByteStringUninitialized(length);
+    if (raw_result->IsFailure()) return raw_result;
+    OneByteString* result = OneByteString::cast(raw_result);
+    for (int i = 0; i < length; i++) {
+      result->set_char_code(i, Smi::cast(array->get(start + i))->value());
+    }
+    return result;
+  }
+
+  Object* raw_result = process->NewTwoByteStringUninitialized(length);
+  if (raw_result->IsFailure()) return raw_result;
+  TwoByteString* result = TwoByteString::cast(raw_result);
+  for (int i = 0; i < length; i++) {
+    result->set_code_unit(i, Smi::cast(array->get(start + i))->value());
+  }
+  return result;
+}
+
 NATIVE(OneByteStringAdd) {
   OneByteString* x = OneByteString::cast(arguments[0]);
   Object* other = arguments[1];
@@ -1328,8 +1538,18 @@ NATIVE(DateTimeLocalTimeZoneOffset) {
   return process->ToInteger(offset);
 }
 
+NATIVE(SystemEventHandlerCount) {
+  return Smi::FromWord(process->program()->number_of_event_handlers());
+}
+
 NATIVE(SystemGetEventHandler) {
-  int fd = process->program()->event_handler()->GetEventHandler();
+  if (!arguments[0]->IsSmi()) return Failure::wrong_argument_type();
+  word index = Smi::cast(arguments[0])->value();
+  Program* program = process->program();
+  if (index < 0 || index >= program->number_of_event_handlers()) {
+    return Failure::index_out_of_bounds();
+  }
+  int fd = program->event_handler(index)->GetEventHandler();
   return process->ToInteger(fd);
 }
 
@@ -1338,6 +1558,137 @@ NATIVE(IsImmutable) {
   return ToBool(process, o->IsImmutable());
 }
 
+static void CopyArrayElements(Array* target, int target_index, Array* source,
+                              int source_index, int count) {
+  if (count == 0) return;
+  memcpy(target->element_address_for(target_index),
+         source->element_address_for(source_index), count * kPointerSize);
+}
+
+// Creates an unmodifiable list with the elements in the array behind a
+// fixed-length list where the [delete_count] elements starting at [index]
+// are removed and, if [insert] is true, [value] is inserted at [index]. If
+// all the elements are immutable, so is the result.
+NATIVE(ImmutableListSplice) {
+  Object* raw_array = arguments[0];
+  if (!raw_array->IsArray()) return Failure::wrong_argument_type();
+  Array* array = Array::cast(raw_array);
+  int length = array->length();
+
+  Object* x = arguments[1];
+  Object* y = arguments[2];
+  if (!x->IsSmi() || !y->IsSmi()) return Failure::wrong_argument_type();
+  int index = Smi::cast(x)->value();
+  int delete_count = Smi::cast(y)->value();
+  if (index < 0 || index > length) return Failure::index_out_of_bounds();
+  if (delete_count < 0 || delete_count > length - index) {
+    return Failure::index_out_of_bounds();
+  }
+  Object* value = arguments[3];
+  bool insert = arguments[4]->IsTrue();
+  int tail = index + delete_count;
+
+  // A mutable result pointing to immutable objects needs a single store
+  // buffer entry, however many of its elements do.
+  bool immutable = !insert || value->IsImmutable();
+  bool immutable_pointer =
+      insert && value->IsHeapObject() && value->IsImmutable();
+  for (int i = 0; i < length; i++) {
+    if (i == index) i = tail;
+    if (i == length) break;
+    Object* element = array->get(i);
+    if (!element->IsImmutable()) {
+      immutable = false;
+    } else if (element->IsHeapObject()) {
+      immutable_pointer = true;
+    }
+  }
+
+  int result_length = length - delete_count + (insert ? 1 : 0);
+  Object* raw_result = immutable ? process->NewImmutableArray(result_length)
+                                 : process->NewArray(result_length);
+  if (raw_result->IsFailure()) return raw_result;
+  Object* raw_list = process->NewInstance(
+      process->program()->constant_list_class(), immutable);
+  if (raw_list->IsFailure()) return raw_list;
+
+  Array* result = Array::cast(raw_result);
+  CopyArrayElements(result, 0, array, 0, index);
+  int target = index;
+  if (insert) result->set(target++, value);
+  CopyArrayElements(result, target, array, tail, length - tail);
+  ASSERT(target + length - tail == result_length);
+  if (!immutable && immutable_pointer) process->store_buffer()->Insert(result);
+
+  Instance* list = Instance::cast(raw_list);
+  list->SetInstanceField(0, result);
+  if (!immutable) process->RecordStore(list, result);
+  return list;
+}
+
+// Creates a constant byte list with the elements of a list, given with the
+// array of integers from 0 to 255 or the byte array holding them. A list
+// that already is a constant byte list is returned as is. The bytes live in
+// the immutable heap, so the result can be shared with other processes.
+NATIVE(ImmutableByteList) {
+  Program* program = process->program();
+  Object* source = arguments[0];
+  if (source->IsInstance() &&
+      Instance::cast(source)->get_class() ==
+          program->constant_byte_list_class()) {
+    return source;
+  }
+  BaseArray* store = AsListBackingStore(arguments[1]);
+  if (store == NULL) return Failure::wrong_argument_type();
+
+  int length = store->length();
+  if (store->IsArray()) {
+    Array* array = Array::cast(store);
+    for (int i = 0; i < length; i++) {
+      Object* element = array->get(i);
+      if (!element->IsSmi()) return Failure::wrong_argument_type();
+      word value = Smi::cast(element)->value();
+      if (value < 0 || value > 0xFF) return Failure::wrong_argument_type();
+    }
+  }
+
+  Object* raw_bytes = process->NewByteArray(length);
+  if (raw_bytes->IsFailure()) return raw_bytes;
+  Object* raw_list =
+      process->NewInstance(program->constant_byte_list_class(), true);
+  if (raw_list->IsFailure()) return raw_list;
+
+  ByteArray* bytes = ByteArray::cast(raw_bytes);
+  if (length > 0) {
+    if (store->IsByteArray()) {
+      memcpy(bytes->byte_address_for(0),
+             ByteArray::cast(store)->byte_address_for(0), length);
+    } else {
+      Array* array = Array::cast(store);
+      for (int i = 0; i < length; i++) {
+        bytes->set(i, Smi::cast(array->get(i))->value());
+      }
+    }
+  }
+
+  Instance* list = Instance::cast(raw_list);
+  list->SetInstanceField(0, bytes);
+  return list;
+}
+
+NATIVE(BitCount) {
+  Object* x = arguments[0];
+  uint64 value;
+  if (x->IsSmi()) {
+    value = static_cast<uint64>(Smi::cast(x)->value());
+  } else if (x->IsLargeInteger()) {
+    value = static_cast<uint64>(LargeInteger::cast(x)->value());
+  } else {
+    return Failure::wrong_argument_type();
+  }
+  return Smi::FromWord(Utils::BitCount(value));
+}
+
 NATIVE(Uint32DigitsAllocate) {
   Smi* length = Smi::cast(arguments[0]);
   word byte_size = length->value() * 4;
@@ -1366,6 +1717,11 @@ NATIVE(Uint32DigitsSet) {
   return process->program()->null_object();
 }
 
+NATIVE(TimerNow) {
+  uint64 us = Platform::GetMonotonicMicroseconds();
+  return process->ToInteger(us / 1000);
+}
+
 NATIVE(TimerScheduleTimeout) {
   int64 timeout = AsForeignInt64(arguments[0]);
   Port* port = Port::FromDartObject(arguments[1]);
@@ -28,6 +28,9 @@ class Arguments {
 
   Object* operator[](word index) const { return raw_[-index]; }
 
+  // The stack slot holding the argument at [index].
+  Object** address(word index) const { return raw_ - index; }
+
  private:
   Object** raw_;
 };
@@ -0,0 +1,179 @@
+// Copyright (c) 2015, the Fletch project authors. Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE.md file.
+
+#include "src/vm/numa.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "src/shared/platform.h"
+
+#if defined(FLETCH_TARGET_OS_LINUX) && !defined(__ANDROID__)
+#define FLETCH_HAS_NUMA
+#include <pthread.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace fletch {
+
+#if defined(FLETCH_HAS_NUMA)
+
+// Node ids at or above this are ignored.
+static const int kMaxNodes = 1024;
+
+// From <numaif.h>, which is only available with libnuma.
+static const int kMemoryPolicyPreferred = 1;
+static const int kMemoryPolicyMove = 1 << 1;
+
+#endif  // defined(FLETCH_HAS_NUMA)
+
+NumaTopology::NumaTopology() : node_count_(0) {}
+
+static bool IsAllowed(int cpu, const Vector<int>* allowed) {
+  for (size_t i = 0; i < allowed->size(); i++) {
+    if ((*allowed)[i] == cpu) return true;
+  }
+  return false;
+}
+
+NumaTopology* NumaTopology::Discover() {
+  NumaTopology* topology = new NumaTopology();
+#if defined(FLETCH_HAS_NUMA)
+  // Workers are only placed on the CPUs the process may run on, which may be
+  // restricted by taskset or cpusets.
+  Vector<int> allowed;
+  cpu_set_t set;
+  bool has_affinity = sched_getaffinity(0, sizeof(set), &set) == 0;
+  if (has_affinity) {
+    for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+      if (CPU_ISSET(cpu, &set)) allowed.PushBack(cpu);
+    }
+  }
+  for (int i = 0; i < kMaxNodes; i++) {
+    char path[64];
+    snprintf(path, sizeof(path), "/sys/devices/system/node/node%d/cpulist", i);
+    FILE* file = fopen(path, "r");
+    if (file == NULL) continue;
+    char buffer[4096];
+    if (fgets(buffer, sizeof(buffer), file) != NULL) {
+      // Nodes with memory but no allowed CPUs are skipped.
+      topology->AddNode(buffer, has_affinity ? &allowed : NULL);
+    }
+    fclose(file);
+  }
+  if (topology->node_count() == 0 && allowed.size() > 0) {
+    topology->AddNode(allowed);
+  }
+#endif  // defined(FLETCH_HAS_NUMA)
+  if (topology->node_count() == 0) {
+    topology->AddNode(Platform::GetNumberOfHardwareThreads());
+  }
+  return topology;
+}
+
+bool NumaTopology::AddNode(const char* cpu_list, const Vector<int>* allowed) {
+  Vector<int> listed;
+  if (!ParseCpuList(cpu_list, &listed)) return false;
+  Vector<int> cpus;
+  for (size_t i = 0; i < listed.size(); i++) {
+    if (allowed == NULL || IsAllowed(listed[i], allowed)) {
+      cpus.PushBack(listed[i]);
+    }
+  }
+  if (cpus.size() == 0) return false;
+  AddNode(cpus);
+  return true;
+}
+
+void NumaTopology::AddNode(const Vector<int>& cpus) {
+  for (size_t i = 0; i < cpus.size(); i++) {
+    cpus_.PushBack(cpus[i]);
+    nodes_.PushBack(node_count_);
+  }
+  node_count_++;
+}
+
+void NumaTopology::AddNode(int cpu_count) {
+  for (int i = 0; i < cpu_count; i++) {
+    cpus_.PushBack(i);
+    nodes_.PushBack(node_count_);
+  }
+  node_count_++;
+}
+
+int NumaTopology::CpuForWorker(int worker) const {
+  ASSERT(cpus_.size() > 0);
+  return cpus_[worker % cpus_.size()];
+}
+
+int NumaTopology::NodeForWorker(int worker) const {
+  ASSERT(nodes_.size() > 0);
+  return nodes_[worker % nodes_.size()];
+}
+
+static bool ParseNumber(const char** list, int* result) {
+  const char* start = *list;
+  char* end;
+  long value = strtol(start, &end, 10);  // NOLINT
+  if (end == start || value < 0) return false;
+  *list = end;
+  *result = static_cast<int>(value);
+  return true;
+}
+
+bool NumaTopology::ParseCpuList(const char* list, Vector<int>* cpus) {
+  const char* current = list;
+  while (*current != '\0' && *current != '\n') {
+    int first;
+    if (!ParseNumber(&current, &first)) return false;
+    int last = first;
+    if (*current == '-') {
+      current++;
+      if (!ParseNumber(&current, &last) || last < first) return false;
+    }
+    for (int cpu = first; cpu <= last; cpu++) cpus->PushBack(cpu);
+    if (*current == ',') {
+      current++;
+    } else if (*current != '\0' && *current != '\n') {
+      return false;
+    }
+  }
+  return true;
+}
+
+#if defined(FLETCH_HAS_NUMA)
+
+bool NumaTopology::PinCurrentThread(int cpu) {
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  CPU_SET(cpu, &set);
+  return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+}
+
+void NumaTopology::PlaceOnCurrentNode(uword base, uword size) {
+  unsigned cpu;
+  unsigned node;
+  if (syscall(SYS_getcpu, &cpu, &node, NULL) != 0) return;
+  if (node >= static_cast<unsigned>(kMaxNodes)) return;
+  static const int kBitsPerMaskWord = 8 * sizeof(unsigned long);  // NOLINT
+  unsigned long mask[kMaxNodes / kBitsPerMaskWord] = { 0 };  // NOLINT
+  mask[node / kBitsPerMaskWord] |= 1UL << (node % kBitsPerMaskWord);
+  // The chunk may reuse pages that malloc already faulted in elsewhere, so
+  // they are moved as well. Failing is fine, the pages are then placed by
+  // the default policy.
+  syscall(SYS_mbind, base, size, kMemoryPolicyPreferred, mask, kMaxNodes,
+          kMemoryPolicyMove);
+}
+
+#else  // defined(FLETCH_HAS_NUMA)
+
+bool NumaTopology::PinCurrentThread(int cpu) { return false; }
+
+void NumaTopology::PlaceOnCurrentNode(uword base, uword size) {}
+
+#endif  // defined(FLETCH_HAS_NUMA)
+
+}  // namespace fletch
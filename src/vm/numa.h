@@ -0,0 +1,73 @@
+// Copyright (c) 2015, the Fletch project authors. Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE.md file.
+
+#ifndef SRC_VM_NUMA_H_
+#define SRC_VM_NUMA_H_
+
+#include "src/shared/globals.h"
+
+#include "src/vm/vector.h"
+
+namespace fletch {
+
+// The NUMA nodes of the machine and the CPUs on each of them. The scheduler
+// places its worker threads node by node, so workers with adjacent ids share
+// a node, and prefers stealing processes from workers on the same node.
+//
+// With --numa the workers are pinned to their CPU, and the chunks of object
+// memory are placed on the node of the thread allocating them. Since a
+// process heap grows and is collected by the worker running the process, its
+// chunks end up on the node of that worker.
+class NumaTopology {
+ public:
+  NumaTopology();
+
+  // Reads the nodes from /sys/devices/system/node on Linux, keeping only the
+  // CPUs in the affinity mask of the process. Elsewhere, or if the nodes
+  // cannot be read, all CPUs are on a single node.
+  static NumaTopology* Discover();
+
+  int node_count() const { return node_count_; }
+  int cpu_count() const { return cpus_.size(); }
+
+  // Appends a node with the CPUs of [cpu_list] (see [ParseCpuList]) that
+  // are also in [allowed], unless that is NULL. Returns false if the list is
+  // malformed or no CPU is left.
+  bool AddNode(const char* cpu_list, const Vector<int>* allowed = NULL);
+
+  // Appends a node with the CPUs 0 to [cpu_count] - 1.
+  void AddNode(int cpu_count);
+
+  // The CPU and node of worker [worker]. Workers take up the CPUs of one
+  // node before moving on to the next node, and wrap around if there are
+  // more workers than CPUs. The topology must have at least one node.
+  int CpuForWorker(int worker) const;
+  int NodeForWorker(int worker) const;
+
+  // Parses a Linux CPU list like "0-3,8,10-11" into [cpus]. Returns false if
+  // the list is malformed.
+  static bool ParseCpuList(const char* list, Vector<int>* cpus);
+
+  // Pins the calling thread to [cpu]. Returns false if that is not
+  // supported or fails.
+  static bool PinCurrentThread(int cpu);
+
+  // Asks the OS to place the pages of [base, base + size) on the node the
+  // calling thread is running on, moving the pages that are already there.
+  // A hint, which may be ignored.
+  static void PlaceOnCurrentNode(uword base, uword size);
+
+ private:
+  void AddNode(const Vector<int>& cpus);
+
+  int node_count_;
+  Vector<int> cpus_;
+  Vector<int> nodes_;
+
+  DISALLOW_COPY_AND_ASSIGN(NumaTopology);
+};
+
+}  // namespace fletch
+
+#endif  // SRC_VM_NUMA_H_
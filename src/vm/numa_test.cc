@@ -0,0 +1,74 @@
+// Copyright (c) 2015, the Fletch project authors. Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE.md file.
+
+#include "src/shared/test_case.h"
+
+#include "src/vm/numa.h"
+
+namespace fletch {
+
+TEST_CASE(NumaTopology_ParseCpuList) {
+  Vector<int> cpus;
+  EXPECT(NumaTopology::ParseCpuList("0-3,8,10-11\n", &cpus));
+  EXPECT_EQ(7, static_cast<int>(cpus.size()));
+  EXPECT_EQ(0, cpus[0]);
+  EXPECT_EQ(3, cpus[3]);
+  EXPECT_EQ(8, cpus[4]);
+  EXPECT_EQ(11, cpus[6]);
+
+  Vector<int> empty;
+  EXPECT(NumaTopology::ParseCpuList("", &empty));
+  EXPECT_EQ(0, static_cast<int>(empty.size()));
+
+  Vector<int> invalid;
+  EXPECT(!NumaTopology::ParseCpuList("3-1", &invalid));
+  EXPECT(!NumaTopology::ParseCpuList("0,,1", &invalid));
+  EXPECT(!NumaTopology::ParseCpuList("a", &invalid));
+}
+
+TEST_CASE(NumaTopology_Workers) {
+  NumaTopology topology;
+  EXPECT(topology.AddNode("0-1,4-5"));
+  EXPECT(!topology.AddNode(""));
+  EXPECT(topology.AddNode("2-3,6-7"));
+  EXPECT_EQ(2, topology.node_count());
+  EXPECT_EQ(8, topology.cpu_count());
+
+  EXPECT_EQ(0, topology.CpuForWorker(0));
+  EXPECT_EQ(4, topology.CpuForWorker(2));
+  EXPECT_EQ(2, topology.CpuForWorker(4));
+  EXPECT_EQ(0, topology.CpuForWorker(8));
+
+  EXPECT_EQ(0, topology.NodeForWorker(3));
+  EXPECT_EQ(1, topology.NodeForWorker(4));
+  EXPECT_EQ(1, topology.NodeForWorker(7));
+  EXPECT_EQ(0, topology.NodeForWorker(9));
+
+  // Only the allowed CPUs of a node are used.
+  Vector<int> allowed;
+  allowed.PushBack(1);
+  allowed.PushBack(6);
+  NumaTopology restricted;
+  EXPECT(!restricted.AddNode("2-5", &allowed));
+  EXPECT(restricted.AddNode("0-3", &allowed));
+  EXPECT(restricted.AddNode("4-7", &allowed));
+  EXPECT_EQ(2, restricted.node_count());
+  EXPECT_EQ(2, restricted.cpu_count());
+  EXPECT_EQ(1, restricted.CpuForWorker(0));
+  EXPECT_EQ(6, restricted.CpuForWorker(1));
+  EXPECT_EQ(1, restricted.NodeForWorker(1));
+
+  NumaTopology single;
+  single.AddNode(4);
+  EXPECT_EQ(1, single.node_count());
+  EXPECT_EQ(3, single.CpuForWorker(7));
+  EXPECT_EQ(0, single.NodeForWorker(7));
+
+  NumaTopology* discovered = NumaTopology::Discover();
+  EXPECT(discovered->node_count() >= 1);
+  EXPECT(discovered->cpu_count() >= 1);
+  delete discovered;
+}
+
+}  // namespace fletch
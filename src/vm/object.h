@@ -234,6 +234,7 @@ class InstanceFormat {
   inline static const InstanceFormat one_byte_string_format();
   inline static const InstanceFormat two_byte_string_format();
   inline static const InstanceFormat array_format();
+  inline static const InstanceFormat immutable_array_format();
   inline static const InstanceFormat function_format();
   inline static const InstanceFormat heap_integer_format();
   inline static const InstanceFormat byte_array_format();
@@ -288,6 +289,7 @@ class InstanceFormat {
   // Exclusive access to Class contructing from Smi.
   explicit InstanceFormat(Smi* value) : value_(value) {}
   friend class Class;
+  friend class InterpreterGeneratorX64;
   friend class InterpreterGeneratorX86;
   friend class InterpreterGeneratorARM;
 
@@ -477,8 +479,16 @@ class Boxed : public HeapObject {
   void BoxedPrint();
   void BoxedShortPrint();
 
+  // Snapshotting.
+  void BoxedWriteTo(SnapshotWriter* writer, Class* klass);
+  void BoxedReadFrom(SnapshotReader* reader);
+
   static int AllocationSize() { return Utils::RoundUp(kSize, kPointerSize); }
 
+  PortableSize CalculatePortableSize() {
+    return PortableSize(kSize / kPointerSize, 0, 0);
+  }
+
   static const int kValueOffset = HeapObject::kSize;
   static const int kSize = kValueOffset + kPointerSize;
 
@@ -575,6 +585,9 @@ class Array : public BaseArray {
   inline Object* get(int index);
   inline void set(int index, Object* value);
 
+  // Access to element address.
+  inline Object** element_address_for(int index);
+
   // Sizing.
   int ArraySize() { return AllocationSize(length()); }
 
@@ -657,6 +670,8 @@ class Instance : public HeapObject {
   inline bool get_immutable();
   // NOTE: This method will also initialize the idendity hash code to 0.
   inline void set_immutable(bool immutable);
+  // Clears the immutability bit but keeps the identity hash code.
+  inline void ClearImmutable();
 
   inline Smi* LazyIdentityHashCode(RandomXorShift* random);
 
@@ -1139,6 +1154,9 @@ class Stack : public BaseArray {
   static int AllocationSize(int length) {
     return Utils::RoundUp(kSize + (length * kPointerSize), kPointerSize);
   }
+  PortableSize CalculatePortableSize() {
+    return PortableSize(kSize / kPointerSize + length(), 0, 0);
+  }
 
   // Casting.
   static inline Stack* cast(Object* obj);
@@ -1351,6 +1369,11 @@ const InstanceFormat InstanceFormat::array_format() {
   return InstanceFormat(ARRAY_TYPE, Array::kSize, true, false, NEVER_IMMUTABLE);
 }
 
+const InstanceFormat InstanceFormat::immutable_array_format() {
+  return InstanceFormat(ARRAY_TYPE, Array::kSize, true, false,
+                        ALWAYS_IMMUTABLE);
+}
+
 const InstanceFormat InstanceFormat::stack_format() {
   return InstanceFormat(STACK_TYPE, Stack::kSize, true, false, NEVER_IMMUTABLE);
 }
@@ -1577,6 +1600,12 @@ void Instance::set_immutable(bool immutable) {
   at_put(kFlagsOffset, reinterpret_cast<Smi*>(flags));
 }
 
+void Instance::ClearImmutable() {
+  word flags = reinterpret_cast<word>(at(kFlagsOffset));
+  flags = FlagsImmutabilityField::update(false, flags);
+  at_put(kFlagsOffset, reinterpret_cast<Smi*>(flags));
+}
+
 Smi* Instance::LazyIdentityHashCode(RandomXorShift* random) {
   Smi* hash_code = IdentityHashCode();
   if (hash_code->value() == 0) {
@@ -1680,6 +1709,11 @@ void Array::set(int index, Object* value) {
   at_put(Array::kSize + (index * kPointerSize), value);
 }
 
+Object** Array::element_address_for(int index) {
+  ASSERT(index >= 0 && index < length());
+  return reinterpret_cast<Object**>(address() + kSize + index * kPointerSize);
+}
+
 void Array::Initialize(int length, int size, Object* null) {
   set_length(length);
   // Initialize the body of the instance.
@@ -8,12 +8,14 @@
 #include <stdio.h>
 
 #include "src/shared/assert.h"
+#include "src/shared/flags.h"
 #include "src/shared/platform.h"
 #include "src/shared/utils.h"
 
 #include "src/vm/frame.h"
 #include "src/vm/heap.h"
 #include "src/vm/mark_sweep.h"
+#include "src/vm/numa.h"
 #include "src/vm/object.h"
 #include "src/vm/storebuffer.h"
 
@@ -51,6 +53,23 @@ void Space::FreeAllChunks() {
   }
 }
 
+void Space::QueueChunksForFreeing() {
+  if (is_empty()) return;
+  for (Chunk* chunk = first(); chunk != NULL; chunk = chunk->next()) {
+    ObjectMemory::SetSpaceForPages(chunk->base(), chunk->limit(), NULL);
+    chunk->owner_ = NULL;
+  }
+  Chunk* head = ObjectMemory::queued_chunks_;
+  do {
+    last_->set_next(head);
+  } while (!ObjectMemory::queued_chunks_.compare_exchange_weak(head, first_));
+  first_ = NULL;
+  last_ = NULL;
+  used_ = 0;
+  top_ = 0;
+  limit_ = 0;
+}
+
 int Space::Size() {
   int result = 0;
   Chunk* chunk = first();
@@ -223,10 +242,12 @@ PageDirectory ObjectMemory::page_directory_;
 PageDirectory* ObjectMemory::page_directories_[1 << 13];
 #endif
 Atomic<uword> ObjectMemory::allocated_;
+Atomic<Chunk*> ObjectMemory::queued_chunks_;
 
 void ObjectMemory::Setup() {
   mutex_ = Platform::CreateMutex();
   allocated_ = 0;
+  queued_chunks_ = NULL;
 #ifdef FLETCH32
   page_directory_.Clear();
 #else
@@ -235,6 +256,7 @@ void ObjectMemory::Setup() {
 }
 
 void ObjectMemory::TearDown() {
+  FreeQueuedChunks();
 #ifdef FLETCH32
   page_directory_.Delete();
 #else
@@ -284,6 +306,7 @@ Chunk* ObjectMemory::AllocateChunk(Space* owner, int size) {
 #else
   uword base = reinterpret_cast<uword>(memory);
   Chunk* chunk = new Chunk(owner, base, size);
+  if (Flags::numa) NumaTopology::PlaceOnCurrentNode(base, size);
 #endif
 
   ASSERT(base == Utils::RoundUp(base, kPageSize));
@@ -323,6 +346,23 @@ void ObjectMemory::FreeChunk(Chunk* chunk) {
   delete chunk;
 }
 
+uword ObjectMemory::FreeQueuedChunks() {
+  uword freed = 0;
+  Chunk* current = queued_chunks_.exchange(NULL);
+  while (current != NULL) {
+    Chunk* next = current->next();
+    ASSERT(current->owner() == NULL);
+#ifdef DEBUG
+    if (!current->is_external()) current->Scramble();
+#endif
+    freed += current->size();
+    delete current;
+    current = next;
+  }
+  allocated_ -= freed;
+  return freed;
+}
+
 bool ObjectMemory::IsAddressInSpace(uword address, const Space* space) {
   PageTable* table = GetPageTable(address);
   return (table != NULL) ? table->Get((address >> 12) & 0x3ff) == space : false;
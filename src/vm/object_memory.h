@@ -159,6 +159,8 @@ class Space {
 
   void SetAllocationBudget(int new_budget);
 
+  int allocation_budget() const { return allocation_budget_; }
+
   // Tells whether garbage collection is needed.
   bool needs_garbage_collection() { return allocation_budget_ <= 0; }
 
@@ -177,6 +179,10 @@ class Space {
 
   bool is_empty() const { return first_ == NULL; }
 
+  // Hand all chunks to the GC thread for freeing and leave this space
+  // empty. Used for the heaps of terminated processes.
+  void QueueChunksForFreeing();
+
   static int DefaultChunkSize(int heap_size) {
     // We return a value between kDefaultMinimumChunkSize and
     // kDefaultMaximumChunkSize - and try to keep the chunks smaller than 20% of
@@ -331,6 +337,13 @@ class ObjectMemory {
 
   static uword Allocated() { return allocated_; }
 
+  // Tells whether there are chunks of dead spaces waiting to be freed. The
+  // pages of queued chunks no longer belong to any space.
+  static bool HasQueuedChunks() { return queued_chunks_.load() != NULL; }
+
+  // Free all queued chunks in one go and return the number of bytes freed.
+  static uword FreeQueuedChunks();
+
  private:
   // Low-level access to the page table associated with a given
   // address.
@@ -349,6 +362,9 @@ class ObjectMemory {
 
   static Atomic<uword> allocated_;
 
+  // Singly-linked list of chunks waiting to be freed, pushed lock-free.
+  static Atomic<Chunk*> queued_chunks_;
+
   friend class Space;
 };
 
@@ -74,4 +74,23 @@ TEST_CASE(Space_PrependSpace) {
   }
 }
 
+TEST_CASE(Space_QueueChunksForFreeing) {
+  Space* space = new Space(32);
+  space->AdjustAllocationBudget(0);
+  uword object = space->Allocate(8);
+  EXPECT(space->Includes(object));
+  uword allocated = ObjectMemory::Allocated();
+
+  space->QueueChunksForFreeing();
+  EXPECT(space->is_empty());
+  EXPECT(!space->Includes(object));
+  EXPECT(ObjectMemory::HasQueuedChunks());
+  EXPECT_EQ(allocated, ObjectMemory::Allocated());
+  delete space;
+
+  EXPECT(ObjectMemory::FreeQueuedChunks() > 0);
+  EXPECT(!ObjectMemory::HasQueuedChunks());
+  EXPECT(ObjectMemory::Allocated() < allocated);
+}
+
 }  // namespace fletch
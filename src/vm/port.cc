@@ -6,10 +6,13 @@
 
 #include <stdlib.h>
 
+#include "src/vm/frame.h"
 #include "src/vm/interpreter.h"
 #include "src/vm/natives.h"
 #include "src/vm/object.h"
 #include "src/vm/process.h"
+#include "src/vm/scheduler.h"
+#include "src/vm/signal.h"
 
 namespace fletch {
 
@@ -18,13 +21,42 @@ Port::Port(Process* process, Instance* channel)
       channel_(channel),
       ref_count_(1),
       spinlock_(),
-      next_(process->ports()) {
+      next_(process->ports()),
+      gather_count_(0),
+      gather_remaining_(0),
+      gather_slots_(NULL),
+      death_signals_(NULL),
+      death_signals_taken_(0),
+      death_message_(NULL) {
   ASSERT(process != NULL);
   ASSERT(Thread::IsCurrent(process->thread_state()->thread()));
   process->set_ports(this);
 }
 
-Port::~Port() { ASSERT(ref_count_ == 0); }
+Port::Port(Process* process, Instance* channel, int gather_count)
+    : process_(process),
+      channel_(channel),
+      ref_count_(1),
+      spinlock_(),
+      next_(process->ports()),
+      gather_count_(gather_count),
+      gather_remaining_(gather_count),
+      gather_slots_(new Object*[gather_count]),
+      death_signals_(NULL),
+      death_signals_taken_(0),
+      death_message_(NULL) {
+  ASSERT(process != NULL);
+  ASSERT(gather_count > 0);
+  ASSERT(Thread::IsCurrent(process->thread_state()->thread()));
+  for (int i = 0; i < gather_count; i++) gather_slots_[i] = NULL;
+  process->set_ports(this);
+}
+
+Port::~Port() {
+  ASSERT(ref_count_ == 0);
+  delete[] gather_slots_;
+  ReleaseAllDeathSignals();
+}
 
 Port* Port::FromDartObject(Object* dart_port) {
   ASSERT(dart_port->IsPort());
@@ -60,6 +92,98 @@ void Port::OwnerProcessTerminating() {
     return;
   } else {
     set_process(NULL);
+    // Nobody visits the contributions once the owner is gone.
+    delete[] gather_slots_;
+    gather_slots_ = NULL;
+    ReleaseAllDeathSignals();
+  }
+  Unlock();
+}
+
+bool Port::Contribute(int index, Object* value) {
+  ASSERT(IsLocked());
+  ASSERT(index >= 0 && index < gather_count_);
+  if (gather_slots_ == NULL || gather_slots_[index] != NULL) return false;
+  gather_slots_[index] = value;
+  gather_remaining_--;
+  return true;
+}
+
+void Port::TakeContributions(Array* result) {
+  ASSERT(IsLocked());
+  ASSERT(IsGatherComplete());
+  ASSERT(gather_slots_ != NULL);
+  for (int i = 0; i < gather_count_; i++) result->set(i, gather_slots_[i]);
+  delete[] gather_slots_;
+  gather_slots_ = NULL;
+}
+
+Message* Port::AddDeathSignal(Signal* signal) {
+  ASSERT(IsLocked());
+  ASSERT(process_ != NULL);
+  if (death_signals_ == NULL) death_signals_ = new Vector<Signal*>();
+  death_signals_->PushBack(signal);
+  // The batch of a message ends at the index kept as its value. The owner
+  // takes the whole mailbox at once, so the newest message cannot be
+  // received while it is still the last one.
+  if (death_message_ != NULL && process_->mailbox()->IsLast(death_message_)) {
+    death_message_->set_value(death_signals_->size());
+    return NULL;
+  }
+  death_message_ = new Message(this, death_signals_->size(), 0,
+                               Message::PROCESS_DEATH_SIGNAL);
+  return death_message_;
+}
+
+Signal* Port::TakeDeathSignal(Message* message, bool* more) {
+  ASSERT(IsLocked());
+  ASSERT(death_signals_ != NULL);
+  size_t end = message->value();
+  ASSERT(death_signals_taken_ < end);
+  Signal* signal = (*death_signals_)[death_signals_taken_++];
+  *more = death_signals_taken_ < end;
+  if (!*more) FinishDeathBatch(message);
+  return signal;
+}
+
+void Port::ReleaseDeathSignals(Message* message) {
+  ASSERT(IsLocked());
+  if (death_signals_ == NULL) return;
+  size_t end = message->value();
+  while (death_signals_taken_ < end) {
+    Signal::DecrementRef((*death_signals_)[death_signals_taken_++]);
+  }
+  FinishDeathBatch(message);
+}
+
+void Port::FinishDeathBatch(Message* message) {
+  // A later signal must not join the batch of a message about to be
+  // deleted, even if a new message is allocated at the same address.
+  if (message == death_message_) death_message_ = NULL;
+  if (death_signals_taken_ == death_signals_->size()) {
+    delete death_signals_;
+    death_signals_ = NULL;
+    death_signals_taken_ = 0;
+  }
+}
+
+void Port::ReleaseAllDeathSignals() {
+  death_message_ = NULL;
+  if (death_signals_ == NULL) return;
+  for (size_t i = death_signals_taken_; i < death_signals_->size(); i++) {
+    Signal::DecrementRef((*death_signals_)[i]);
+  }
+  delete death_signals_;
+  death_signals_ = NULL;
+  death_signals_taken_ = 0;
+}
+
+void Port::VisitGatherPointers(PointerVisitor* visitor) {
+  Lock();
+  for (int i = 0; i < gather_count_; i++) {
+    if (gather_slots_ != NULL && gather_slots_[i] != NULL) {
+      visitor->Visit(&gather_slots_[i]);
+    }
   }
   Unlock();
 }
@@ -102,15 +226,15 @@ void Port::WeakCallback(HeapObject* object, Heap* heap) {
   port->DecrementRef();
 }
 
-NATIVE(PortCreate) {
-  Instance* channel = Instance::cast(arguments[0]);
-
+static Object* NewDartPort(Process* process, Instance* channel,
+                           int gather_count) {
   Object* dart_port =
       process->NewInstance(process->program()->port_class(), true);
   if (dart_port == Failure::retry_after_gc()) return dart_port;
   Instance* port_instance = Instance::cast(dart_port);
 
-  Port* port = new Port(process, channel);
+  Port* port = (gather_count == 0) ? new Port(process, channel)
+                                   : new Port(process, channel, gather_count);
   ASSERT((reinterpret_cast<uword>(port) & 3) == 0);  // Always aligned.
   Smi* p = Smi::FromWord(reinterpret_cast<uword>(port) >> 2);
   port_instance->SetInstanceField(0, p);
@@ -119,6 +243,42 @@ NATIVE(PortCreate) {
   return port_instance;
 }
 
+NATIVE(PortCreate) {
+  Instance* channel = Instance::cast(arguments[0]);
+  return NewDartPort(process, channel, 0);
+}
+
+NATIVE(PortCreateGather) {
+  Instance* channel = Instance::cast(arguments[0]);
+  Object* count = arguments[1];
+  if (!count->IsSmi()) return Failure::wrong_argument_type();
+  int gather_count = Smi::cast(count)->value();
+  if (gather_count <= 0) return Failure::index_out_of_bounds();
+  return NewDartPort(process, channel, gather_count);
+}
+
+// Enqueue [entry] in the mailbox of the process owning [port] and take over
+// ownership of [entry].
+static Object* SendMessage(Process* process, Port* port, Message* entry) {
+  port->Lock();
+  Process* port_process = port->process();
+  if (port_process != NULL) {
+    port_process->mailbox()->EnqueueEntry(entry);
+    entry = NULL;
+
+    if (port_process != process) {
+      // If sending to another process, return the locked port. This will
+      // allow the scheduler to schedule the owner of the port, while it's
+      // still alive.
+      return reinterpret_cast<Object*>(port);
+    }
+  }
+  port->Unlock();
+
+  if (entry != NULL) delete entry;
+  return process->program()->null_object();
+}
+
 NATIVE(PortSend) {
   Instance* instance = Instance::cast(arguments[0]);
 
@@ -128,38 +288,177 @@ NATIVE(PortSend) {
   Port* port = Port::FromDartObject(instance);
   if (port == NULL) return Failure::illegal_state();
 
+  // The message may refer to objects in an open message arena, which must
+  // live in the shared heap before other processes can see them.
+  process->CloseMessageArena(process->immutable_heap());
+
   // We want to avoid holding a spinlock while doing an allocation, so:
   //    * we do an early return if the destination process is not there
   //    * we allocate (and possibly free) the message outside of the spinlock
   //      region.
   if (port->process() != NULL) {
     Message* entry = Message::NewImmutableMessage(port, message);
+    return SendMessage(process, port, entry);
+  }
+  return process->program()->null_object();
+}
+
+NATIVE(PortSendClone) {
+  Instance* instance = Instance::cast(arguments[0]);
+  Object* message = arguments[1];
+  Port* port = Port::FromDartObject(instance);
+  if (port == NULL) return Failure::illegal_state();
+
+  process->CloseMessageArena(process->immutable_heap());
+  if (port->process() == NULL) return process->program()->null_object();
+
+  if (message->IsImmutable()) {
+    Message* entry = Message::NewImmutableMessage(port, message);
+    return SendMessage(process, port, entry);
+  }
+
+#ifdef FLETCH_ENABLE_MULTIPLE_PROCESS_HEAPS
+  // The copy is made outside the port lock, like the messages of [PortSend].
+  ExitReference* reference = ExitReference::CloneMessage(process, message);
+  if (reference == NULL) return Failure::wrong_argument_type();
+  uint64 address = reinterpret_cast<uint64>(reference);
+  return SendMessage(process, port,
+                     new Message(port, address, 0, Message::CLONE));
+#else
+  // All processes share one heap, so there is no heap to copy into.
+  return Failure::wrong_argument_type();
+#endif
+}
+
+NATIVE(PortContribute) {
+  Port* port = Port::FromDartObject(arguments[0]);
+  if (port == NULL || !port->IsGather()) return Failure::illegal_state();
+
+  Object* x = arguments[1];
+  if (!x->IsSmi()) return Failure::wrong_argument_type();
+  int index = Smi::cast(x)->value();
+  if (index < 0 || index >= port->gather_count()) {
+    return Failure::index_out_of_bounds();
+  }
+
+  Object* value = arguments[2];
+  if (!value->IsImmutable()) return Failure::wrong_argument_type();
 
+  process->CloseMessageArena(process->immutable_heap());
+
+  port->Lock();
+  Process* port_process = port->process();
+  if (port_process == NULL) {
+    port->Unlock();
+    return process->program()->null_object();
+  }
+  if (!port->Contribute(index, value)) {
+    port->Unlock();
+    return Failure::illegal_state();
+  }
+  if (!port->IsGatherComplete()) {
+    port->Unlock();
+    return process->program()->null_object();
+  }
+
+  // The last contribution delivers all of them in a single message.
+  Message* entry = new Message(port, 0, 0, Message::GATHER);
+  port_process->mailbox()->EnqueueEntry(entry);
+  if (port_process != process) return reinterpret_cast<Object*>(port);
+  port->Unlock();
+  return process->program()->null_object();
+}
+
+NATIVE(PortGroupBroadcast) {
+  Object* message = arguments[1];
+  if (!message->IsImmutable()) return Failure::wrong_argument_type();
+
+  Object* list = arguments[0];
+  if (!list->IsInstance() || !list->IsImmutable()) {
+    return Failure::wrong_argument_type();
+  }
+  Object* raw_ports = Instance::cast(list)->GetInstanceField(0);
+  if (!raw_ports->IsArray()) return Failure::wrong_argument_type();
+  Array* ports = Array::cast(raw_ports);
+  int length = ports->length();
+  for (int i = 0; i < length; i++) {
+    if (!ports->get(i)->IsPort()) return Failure::wrong_argument_type();
+  }
+
+  process->CloseMessageArena(process->immutable_heap());
+
+  // The message is immutable, so every receiver shares it. Each port still
+  // gets its own mailbox entry, but the owners are woken up right away
+  // instead of by yielding to the scheduler once per port.
+  Scheduler* scheduler = process->program()->scheduler();
+  for (int i = 0; i < length; i++) {
+    Port* port = Port::FromDartObject(ports->get(i));
+    if (port == NULL || port->process() == NULL) continue;
+    Message* entry = Message::NewImmutableMessage(port, message);
     port->Lock();
     Process* port_process = port->process();
     if (port_process != NULL) {
       port_process->mailbox()->EnqueueEntry(entry);
       entry = NULL;
-
-      if (port_process != process) {
-        // If sending to another process, return the locked port. This will
-        // allow the scheduler to schedule the owner of the port, while it's
-        // still alive.
-        return reinterpret_cast<Object*>(port);
-      }
+      if (port_process != process) scheduler->ResumeProcess(port_process);
     }
     port->Unlock();
-
     if (entry != NULL) delete entry;
   }
   return process->program()->null_object();
 }
 
+NATIVE(PortOpenMessageArena) {
+  if (process->message_arena() != NULL) return Failure::illegal_state();
+  process->OpenMessageArena();
+  return process->program()->null_object();
+}
+
+NATIVE(PortCloseMessageArena) {
+  process->CloseMessageArena(process->immutable_heap());
+  return process->program()->null_object();
+}
+
+NATIVE(PortSendMessageArena) {
+  Instance* instance = Instance::cast(arguments[0]);
+  Object* message = arguments[1];
+  Port* port = Port::FromDartObject(instance);
+
+  if (!message->IsImmutable() || port == NULL || port->process() == NULL) {
+    process->CloseMessageArena(process->immutable_heap());
+    if (!message->IsImmutable()) return Failure::wrong_argument_type();
+    if (port == NULL) return Failure::illegal_state();
+    return process->program()->null_object();
+  }
+
+  // Hand the objects of the arena over to the receiver if possible. Otherwise
+  // the arena has been merged into the shared heap and the message is sent
+  // like any other immutable message.
+  Message* entry = NULL;
+  if (process->message_arena() != NULL) {
+    // Only the frames of Port._sendMessageArena and Port.sendBuilt, the
+    // caller of its frame, may refer to the arena objects.
+    NativeFrame frame(arguments, 2);
+    Object** frames_start = frame.FirstSlot();
+    Object** frames_end = frame.PreviousFramePointer();
+    ExitReference* reference =
+        process->SealMessageArena(message, frames_start, frames_end);
+    if (reference != NULL) {
+      uint64 address = reinterpret_cast<uint64>(reference);
+      entry = new Message(port, address, 0, Message::EXIT);
+    }
+  }
+  if (entry == NULL) entry = Message::NewImmutableMessage(port, message);
+  return SendMessage(process, port, entry);
+}
+
 NATIVE(PortSendExit) {
   Instance* instance = Instance::cast(arguments[0]);
   Port* port = Port::FromDartObject(instance);
   if (port == NULL) return Failure::illegal_state();
 
+  process->CloseMessageArena(process->immutable_heap());
+
   port->Lock();
 
   Process* port_process = port->process();
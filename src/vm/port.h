@@ -10,19 +10,27 @@
 
 #include "src/vm/object_memory.h"
 #include "src/vm/spinlock.h"
+#include "src/vm/vector.h"
 
 namespace fletch {
 
+class Array;
 class HeapObject;
 class Instance;
+class Message;
 class Object;
 class PointerVisitor;
 class Process;
+class Signal;
 
 class Port {
  public:
   Port(Process* process, Instance* channel);
 
+  // A gather port collects [gather_count] contributions and delivers them
+  // to [channel] as a single array once all of them have arrived.
+  Port(Process* process, Instance* channel, int gather_count);
+
   static Port* FromDartObject(Object* dart_port);
 
   Process* process() { return process_; }
@@ -38,6 +46,44 @@ class Port {
 
   Spinlock* spinlock() { return &spinlock_; }
 
+  bool IsGather() const { return gather_count_ > 0; }
+  int gather_count() const { return gather_count_; }
+
+  // Store [value] as contribution [index] of a gather port. Returns false if
+  // the contribution has already been made. The port must be locked.
+  bool Contribute(int index, Object* value);
+
+  // Returns true when all contributions have arrived. The port must be
+  // locked.
+  bool IsGatherComplete() const { return gather_remaining_ == 0; }
+
+  // Move the contributions into [result], which must have room for
+  // [gather_count] elements. The port must be locked.
+  void TakeContributions(Array* result);
+
+  // Visit the contributions that have not been delivered yet. They live in
+  // the shared heap or the program heap.
+  void VisitGatherPointers(PointerVisitor* visitor);
+
+  // Death signals of monitored processes that have not been received yet.
+  // They are delivered in batches, each through a single
+  // PROCESS_DEATH_SIGNAL message. A signal only joins the newest batch while
+  // its message is still the last one in the mailbox of the owner, so it
+  // cannot overtake messages enqueued after that. Adding a signal takes over
+  // a reference to it. Returns the message to enqueue for a new batch, or
+  // NULL if [signal] joined the newest one. The port must be locked and have
+  // an owner.
+  Message* AddDeathSignal(Signal* signal);
+
+  // Removes the oldest signal of the batch delivered by [message] and hands
+  // over its reference. Sets [more] to whether the batch has other signals.
+  // The port must be locked.
+  Signal* TakeDeathSignal(Message* message, bool* more);
+
+  // Drops the signals of the batch delivered by [message]. The port must be
+  // locked.
+  void ReleaseDeathSignals(Message* message);
+
   // Increment the ref count. This function is thread safe.
   void IncrementRef();
 
@@ -57,6 +103,9 @@ class Port {
 
   void OwnerProcessTerminating();
 
+  void FinishDeathBatch(Message* message);
+  void ReleaseAllDeathSignals();
+
   void set_next(Port* next) { next_ = next; }
 
   virtual ~Port();
@@ -68,6 +117,17 @@ class Port {
   // The ports are in a list in the process so that we can GC the channel
   // pointer.
   Port* next_;
+
+  int gather_count_;
+  int gather_remaining_;
+  Object** gather_slots_;
+
+  // Allocated along with the first pending death signal.
+  Vector<Signal*>* death_signals_;
+  size_t death_signals_taken_;
+  // The message of the newest batch of death signals, until all of its
+  // signals have been received.
+  Message* death_message_;
 };
 
 }  // namespace fletch
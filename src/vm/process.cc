@@ -5,6 +5,7 @@
 #include "src/vm/process.h"
 
 #include <errno.h>
+#include <limits.h>
 #include <stdlib.h>
 
 #include "src/shared/assert.h"
@@ -13,6 +14,8 @@
 #include "src/shared/names.h"
 #include "src/shared/selectors.h"
 
+#include "src/vm/buffer_pool.h"
+#include "src/vm/clock.h"
 #include "src/vm/frame.h"
 #include "src/vm/heap_validator.h"
 #include "src/vm/mark_sweep.h"
@@ -22,6 +25,7 @@
 #include "src/vm/process_queue.h"
 #include "src/vm/session.h"
 #include "src/vm/storebuffer.h"
+#include "src/vm/threaded_code.h"
 
 namespace fletch {
 
@@ -32,10 +36,14 @@ static uword kMaxStackMarker = ~static_cast<uword>((1 << 3) - 1);
 
 ThreadState::ThreadState()
     : thread_id_(-1),
+      node_(0),
       queue_(new ProcessQueue()),
       cache_(NULL),
+      threaded_cache_(NULL),
       idle_monitor_(Platform::CreateMonitor()),
-      next_idle_thread_(NULL) {}
+      next_idle_thread_(NULL),
+      safepoint_program_(NULL),
+      cache_epoch_(0) {}
 
 void ThreadState::AttachToCurrentThread() { thread_ = ThreadIdentifier(); }
 
@@ -44,10 +52,16 @@ LookupCache* ThreadState::EnsureCache() {
   return cache_;
 }
 
+ThreadedCodeCache* ThreadState::EnsureThreadedCodeCache() {
+  if (threaded_cache_ == NULL) threaded_cache_ = new ThreadedCodeCache();
+  return threaded_cache_;
+}
+
 ThreadState::~ThreadState() {
   delete idle_monitor_;
   delete queue_;
   delete cache_;
+  delete threaded_cache_;
 }
 
 Process::Process(Program* program, Process* parent)
@@ -60,8 +74,12 @@ Process::Process(Program* program, Process* parent)
       random_(program->random()->NextUInt32() + 1),
 #ifdef FLETCH_ENABLE_MULTIPLE_PROCESS_HEAPS
       heap_(&random_, 4 * KB),
+      heap_policy_(HeapSizingPolicy::FromFlags()),
+      mutator_time_(0),
+      quantum_start_(0),
 #endif
       immutable_heap_(NULL),
+      message_arena_(NULL),
       state_(kSleeping),
       thread_state_(NULL),
       next_(NULL),
@@ -73,10 +91,14 @@ Process::Process(Program* program, Process* parent)
       ports_(NULL),
       process_list_next_(NULL),
       process_list_prev_(NULL),
+      process_list_index_(0),
       process_triangle_count_(1),
       parent_(parent),
       errno_cache_(0),
-      debug_info_(NULL) {
+      debug_info_(NULL),
+      hibernation_requested_(false),
+      sleep_start_(0),
+      last_sleep_(0) {
   process_handle_ = new ProcessHandle(this);
 
   // These asserts need to hold when running on the target, but they don't need
@@ -120,8 +142,20 @@ Process::~Process() {
 
 #ifdef FLETCH_ENABLE_MULTIPLE_PROCESS_HEAPS
   heap_.ProcessWeakPointers();
+
+  // Freeing the memory of the heap is left to the GC thread, so terminating
+  // processes do not pay for it.
+  Space* space = heap_.TakeSpace();
+  if (space != NULL) {
+    space->QueueChunksForFreeing();
+    delete space;
+  }
 #endif  // #ifdef FLETCH_ENABLE_MULTIPLE_PROCESS_HEAPS
 
+  // Objects in an open message arena cannot have escaped to other processes,
+  // because sending closes the arena.
+  delete message_arena_;
+
   delete debug_info_;
 
   ASSERT(next_ == NULL);
@@ -185,6 +219,7 @@ Process::StackCheckResult Process::HandleStackOverflow(int addition) {
     if ((current_limit & kProfileMarker) != 0) {
       ClearStackMarker(kProfileMarker);
       UpdateStackLimit();
+      RecordProfileSample();
       return kStackCheckContinue;
     }
   }
@@ -229,6 +264,13 @@ Object* Process::NewArray(int length) {
   return result;
 }
 
+Object* Process::NewImmutableArray(int length) {
+  Class* array_class = program()->immutable_array_class();
+  Object* null = program()->null_object();
+  Heap* heap = (message_arena_ != NULL) ? message_arena_ : immutable_heap_;
+  return heap->CreateArray(array_class, length, null);
+}
+
 Object* Process::NewDouble(fletch_double value) {
   Class* double_class = program()->double_class();
   Object* result = immutable_heap_->CreateDouble(double_class, value);
@@ -300,7 +342,8 @@ Object* Process::NewBoxed(Object* value) {
 Object* Process::NewInstance(Class* klass, bool immutable) {
   Object* null = program()->null_object();
   if (immutable) {
-    return immutable_heap_->CreateInstance(klass, null, immutable);
+    Heap* heap = (message_arena_ != NULL) ? message_arena_ : immutable_heap_;
+    return heap->CreateInstance(klass, null, immutable);
   } else {
     return heap()->CreateInstance(klass, null, immutable);
   }
@@ -335,7 +378,7 @@ struct HeapUsage {
 #ifdef FLETCH_ENABLE_MULTIPLE_PROCESS_HEAPS
 
 static void GetHeapUsage(Process* process, HeapUsage* heap_usage) {
-  heap_usage->timestamp = Platform::GetMicroseconds();
+  heap_usage->timestamp = Platform::GetMonotonicMicroseconds();
   heap_usage->process_used = process->heap()->space()->Used();
   heap_usage->process_size = process->heap()->space()->Size();
   heap_usage->immutable_used =
@@ -372,6 +415,51 @@ void PrintProcessGCInfo(Process* process, HeapUsage* before, HeapUsage* after) {
 #ifdef FLETCH_ENABLE_MULTIPLE_PROCESS_HEAPS
 
 void Process::CollectMutableGarbage() {
+  uint64 start = Platform::GetMonotonicMicroseconds();
+  int used_before = heap()->UsedTotal();
+  int old_budget = heap_policy_.budget();
+  Space* from = heap()->space();
+  ScavengeMutableHeap(new Space(heap_policy_.ToSpaceSize(from->Used())));
+  uint64 end = Platform::GetMonotonicMicroseconds();
+
+  uint64 gc_time = end - start;
+  uint64 mutator_time = mutator_time_;
+  if (quantum_start_ != 0) {
+    mutator_time += start - quantum_start_;
+    quantum_start_ = end;
+  }
+  mutator_time_ = 0;
+  int budget = heap_policy_.RecordCollection(used_before, heap()->UsedTotal(),
+                                             gc_time, mutator_time);
+  heap()->space()->SetAllocationBudget(budget);
+
+  if (Flags::print_heap_statistics) {
+    Print::Error(
+        "Process-Heap-Policy(%p): \t%s, \tsurvival %i%%, \tgc %llu us, "
+        "\tmutator %llu us, \tbudget %i -> %i\n",
+        this, heap_policy_.ModeName(), heap_policy_.survival_percent(),
+        gc_time, mutator_time, old_budget, budget);
+  }
+
+  UpdateStackLimit();
+}
+
+void Process::SetHeapSizeHint(int size) {
+  heap_policy_.set_size_hint(size);
+  int used = heap()->UsedTotal();
+  heap()->space()->SetAllocationBudget(heap_policy_.InitialBudget(used));
+}
+
+void Process::StartQuantum() {
+  quantum_start_ = Platform::GetMonotonicMicroseconds();
+}
+
+void Process::EndQuantum() {
+  mutator_time_ += Platform::GetMonotonicMicroseconds() - quantum_start_;
+  quantum_start_ = 0;
+}
+
+void Process::ScavengeMutableHeap(Space* to) {
   TakeChildHeaps();
 
   HeapUsage usage_before;
@@ -380,7 +468,6 @@ void Process::CollectMutableGarbage() {
   }
 
   Space* from = heap()->space();
-  Space* to = new Space(from->Used() / 10);
   StoreBuffer sb;
 
   // While garbage collecting, do not fail allocations. Instead grow
@@ -404,7 +491,33 @@ void Process::CollectMutableGarbage() {
     GetHeapUsage(this, &usage_after);
     PrintProcessGCInfo(this, &usage_before, &usage_after);
   }
+}
+
+void Process::ShrinkStack(int free) {
+  Stack* old_stack = stack();
+  word height = old_stack->length() - old_stack->top();
+  int new_size = height + free;
+  if (2 * new_size > old_stack->length()) return;
 
+  Object* new_stack_object = NewStack(new_size);
+  if (new_stack_object->IsFailure()) return;
+
+  Stack* new_stack = Stack::cast(new_stack_object);
+  new_stack->set_top(new_stack->length() - height);
+  memcpy(new_stack->Pointer(new_stack->top()),
+         old_stack->Pointer(old_stack->top()), height * kWordSize);
+  new_stack->UpdateFramePointers(old_stack);
+  coroutine_->set_stack(new_stack);
+  store_buffer_.Insert(coroutine_->stack());
+  UpdateStackLimit();
+}
+
+void Process::Hibernate() {
+  hibernation_requested_ = false;
+  ShrinkStack(kHibernatedStackSlack);
+  // Without an initial chunk the to-space starts at the minimum chunk size
+  // and only grows as far as the live objects need.
+  ScavengeMutableHeap(new Space());
   UpdateStackLimit();
 }
 
@@ -415,8 +528,39 @@ void Process::CollectMutableGarbage() {
   UpdateStackLimit();
 }
 
+void Process::SetHeapSizeHint(int size) {}
+
+void Process::StartQuantum() {}
+
+void Process::EndQuantum() {}
+
+void Process::Hibernate() {
+  // All objects, including the stacks, live in the shared heap, so there
+  // is nothing to release for a single process.
+  hibernation_requested_ = false;
+}
+
 #endif  // #ifdef FLETCH_ENABLE_MULTIPLE_PROCESS_HEAPS
 
+bool Process::ShouldHibernate() {
+  if (!mailbox_.IsEmpty() || signal() != NULL) return false;
+  if (hibernation_requested_) return true;
+  // A process that slept for the whole idle period the last time it went
+  // to sleep is likely to sleep for long again.
+  uint64 idle = static_cast<uint64>(Flags::hibernate_idle_ms) * 1000;
+  return idle > 0 && last_sleep_ >= idle;
+}
+
+void Process::RecordSleep() {
+  sleep_start_ = Clock::CoarseMicroseconds();
+}
+
+void Process::RecordWakeUp() {
+  if (sleep_start_ == 0) return;
+  last_sleep_ = Clock::CoarseMicroseconds() - sleep_start_;
+  sleep_start_ = 0;
+}
+
 // Helper class for copying HeapObjects and chaining stacks for a
 // process.
 class ScavengeAndChainStacksVisitor : public PointerVisitor {
@@ -542,16 +686,31 @@ void Process::IterateRoots(PointerVisitor* visitor) {
   if (debug_info_ != NULL) debug_info_->VisitPointers(visitor);
 
   mailbox_.IteratePointers(visitor);
+  for (Port* port = ports_; port != NULL; port = port->next()) {
+    port->VisitGatherPointers(visitor);
+  }
+
+  // Objects in the message arena can point into the shared heap.
+  if (message_arena_ != NULL) {
+    HeapObjectPointerVisitor arena_visitor(visitor);
+    message_arena_->IterateObjects(&arena_visitor);
+  }
 }
 
 void Process::IterateProgramPointers(PointerVisitor* visitor) {
   ASSERT(stacks_are_cooked());
   HeapObjectPointerVisitor program_pointer_visitor(visitor);
   heap()->IterateObjects(&program_pointer_visitor);
+  if (message_arena_ != NULL) {
+    message_arena_->IterateObjects(&program_pointer_visitor);
+  }
   store_buffer_.IteratePointersToImmutableSpace(visitor);
   if (debug_info_ != NULL) debug_info_->VisitProgramPointers(visitor);
   visitor->Visit(&exception_);
   mailbox_.IteratePointers(visitor);
+  for (Port* port = ports_; port != NULL; port = port->next()) {
+    port->VisitGatherPointers(visitor);
+  }
 }
 
 void Process::TakeLookupCache() {
@@ -588,6 +747,12 @@ void Process::DebugInterrupt() { SetStackMarker(kDebugInterruptMarker); }
 
 void Process::Profile() { SetStackMarker(kProfileMarker); }
 
+void Process::RecordProfileSample() {
+  Frame frame(stack());
+  if (!frame.MovePrevious()) return;
+  program()->profile()->Record(frame.FunctionFromByteCodePointer(), 1);
+}
+
 void Process::EnsureDebuggerAttached() {
   if (debug_info_ == NULL) debug_info_ = new DebugInfo();
 }
@@ -722,6 +887,9 @@ void Process::RegisterFinalizer(HeapObject* object,
   uword address = object->address();
   if (heap()->space()->Includes(address)) {
     heap()->AddWeakPointer(object, callback);
+  } else if (message_arena_ != NULL &&
+             message_arena_->space()->Includes(address)) {
+    message_arena_->AddWeakPointer(object, callback);
   } else {
     ASSERT(immutable_heap()->space()->Includes(address));
     immutable_heap()->AddWeakPointer(object, callback);
@@ -740,7 +908,7 @@ void Process::FinalizeForeign(HeapObject* foreign, Heap* heap) {
   Instance* instance = Instance::cast(foreign);
   uword value = instance->GetConsecutiveSmis(0);
   uword length = Smi::cast(instance->GetInstanceField(2))->value();
-  free(reinterpret_cast<void*>(value));
+  BufferPool::Free(reinterpret_cast<void*>(value), length);
   heap->FreedForeignMemory(length);
 }
 
@@ -773,6 +941,143 @@ void Process::SendSignal(Signal* signal) {
 
 void Process::TakeChildHeaps() { mailbox_.MergeAllChildHeaps(this); }
 
+#ifdef FLETCH_ENABLE_MULTIPLE_PROCESS_HEAPS
+
+// Finds out whether any of the visited pointers point into [space].
+class FindPointerIntoSpaceVisitor : public PointerVisitor {
+ public:
+  explicit FindPointerIntoSpaceVisitor(Space* space)
+      : space_(space), found_(false) {}
+
+  bool found() const { return found_; }
+
+  void VisitBlock(Object** start, Object** end) {
+    for (Object** p = start; p < end; p++) {
+      if (Includes(*p)) found_ = true;
+    }
+  }
+
+  bool Includes(Object* object) {
+    return object->IsHeapObject() &&
+           space_->Includes(HeapObject::cast(object)->address());
+  }
+
+ private:
+  Space* space_;
+  bool found_;
+};
+
+// Replaces all visited pointers into [space] with [null].
+class ClearPointerIntoSpaceVisitor : public PointerVisitor {
+ public:
+  ClearPointerIntoSpaceVisitor(Space* space, Object* null)
+      : space_(space), null_(null) {}
+
+  void VisitBlock(Object** start, Object** end) {
+    for (Object** p = start; p < end; p++) {
+      Object* object = *p;
+      if (object->IsHeapObject() &&
+          space_->Includes(HeapObject::cast(object)->address())) {
+        *p = null_;
+      }
+    }
+  }
+
+ private:
+  Space* space_;
+  Object* null_;
+};
+
+// Finds out whether any object in the store buffer, except for [stack],
+// points into [space].
+class FindReferenceIntoSpaceVisitor : public HeapObjectVisitor {
+ public:
+  FindReferenceIntoSpaceVisitor(Space* space, Stack* stack)
+      : pointer_visitor_(space), stack_(stack) {}
+
+  bool found() const { return pointer_visitor_.found(); }
+
+  virtual int Visit(HeapObject* object) {
+    if (object != stack_) object->IteratePointers(&pointer_visitor_);
+    return object->Size();
+  }
+
+ private:
+  FindPointerIntoSpaceVisitor pointer_visitor_;
+  Stack* stack_;
+};
+
+void Process::OpenMessageArena() {
+  ASSERT(message_arena_ == NULL);
+  message_arena_ = new Heap(random());
+  // The arena is only bounded by the size of the message being built, so
+  // allocating in it never asks for a garbage collection.
+  message_arena_->space()->SetAllocationBudget(INT_MAX);
+}
+
+void Process::CloseMessageArena(Heap* immutable_heap) {
+  if (message_arena_ == NULL) return;
+  immutable_heap->MergeInOtherHeap(message_arena_);
+  delete message_arena_;
+  message_arena_ = NULL;
+}
+
+ExitReference* Process::SealMessageArena(Object* message,
+                                         Object** frames_start,
+                                         Object** frames_end) {
+  ASSERT(message_arena_ != NULL);
+  Space* space = message_arena_->space();
+  Stack* stack = this->stack();
+  ASSERT(stack->Pointer(0) <= frames_start);
+  ASSERT(frames_start <= frames_end);
+  ASSERT(frames_end <= stack->Pointer(stack->length()));
+
+  // Mutable objects pointing to arena objects are in the store buffer, since
+  // the arena objects are immutable. Immutable objects outside the arena
+  // cannot point into it. That leaves the roots and the current stack. The
+  // stack is not in a saved state while a native runs, so the live slots
+  // below the sending frames are not known, but none of them are older than
+  // the message.
+  FindPointerIntoSpaceVisitor finder(space);
+  bool detachable = finder.Includes(message);
+  if (detachable) {
+    finder.Visit(&exception_);
+    finder.VisitBlock(frames_end, stack->Pointer(stack->length()));
+    FindReferenceIntoSpaceVisitor store_buffer_finder(space, stack);
+    store_buffer_.IterateObjects(&store_buffer_finder);
+    detachable = !finder.found() && !store_buffer_finder.found();
+  }
+
+  if (!detachable) {
+    CloseMessageArena(immutable_heap_);
+    return NULL;
+  }
+
+  ClearPointerIntoSpaceVisitor clearer(space, program()->null_object());
+  clearer.VisitBlock(frames_start, frames_end);
+
+  ExitReference* reference =
+      new ExitReference(message_arena_, program(), message);
+  delete message_arena_;
+  message_arena_ = NULL;
+  return reference;
+}
+
+#else  // #ifdef FLETCH_ENABLE_MULTIPLE_PROCESS_HEAPS
+
+void Process::OpenMessageArena() {}
+
+void Process::CloseMessageArena(Heap* immutable_heap) {}
+
+ExitReference* Process::SealMessageArena(Object* message,
+                                         Object** frames_start,
+                                         Object** frames_end) {
+  UNREACHABLE();
+  return NULL;
+}
+
+#endif  // #ifdef FLETCH_ENABLE_MULTIPLE_PROCESS_HEAPS
+
 void Process::UpdateStackLimit() {
   // By adding 2, we reserve a slot for a return address and an extra
   // temporary each bytecode can utilize internally.
@@ -856,18 +1161,31 @@ NATIVE(ProcessQueueGetMessage) {
       break;
     }
 
-    case Message::EXIT: {
+    case Message::EXIT:
+    case Message::CLONE: {
       queue->MergeChildHeaps(process);
       result = queue->ExitReferenceObject();
       break;
     }
 
+    case Message::GATHER: {
+      Port* port = queue->port();
+      Object* object = process->NewArray(port->gather_count());
+      if (object == Failure::retry_after_gc()) return object;
+      Array* array = Array::cast(object);
+      port->Lock();
+      port->TakeContributions(array);
+      port->Unlock();
+      for (int i = 0; i < array->length(); i++) {
+        process->RecordStore(array, array->get(i));
+      }
+      result = array;
+      break;
+    }
+
     case Message::PROCESS_DEATH_SIGNAL: {
       Program* program = process->program();
 
-      Signal* signal = queue->ProcessDeathSignal();
-      ProcessHandle* handle = signal->handle();
-
       Object* dart_process =
           process->NewInstance(program->process_class(), true);
       if (dart_process == Failure::retry_after_gc()) return dart_process;
@@ -876,6 +1194,14 @@ NATIVE(ProcessQueueGetMessage) {
           process->NewInstance(program->process_death_class(), true);
       if (process_death == Failure::retry_after_gc()) return process_death;
 
+      // Only take the signal once allocation can no longer fail.
+      Port* port = queue->port();
+      bool more;
+      port->Lock();
+      Signal* signal = port->TakeDeathSignal(queue, &more);
+      port->Unlock();
+      ProcessHandle* handle = signal->handle();
+
       handle->IncrementRef();
 
       handle->InitializeDartObject(dart_process);
@@ -885,7 +1211,10 @@ NATIVE(ProcessQueueGetMessage) {
 
       process->RegisterFinalizer(HeapObject::cast(dart_process),
                                  Process::FinalizeProcess);
+      Signal::DecrementRef(signal);
 
+      // The message delivers the remaining signals of its batch as well.
+      if (more) return process_death;
       result = process_death;
       break;
     }
@@ -906,8 +1235,15 @@ NATIVE(ProcessQueueGetChannel) {
   // messages sent to the port can never be received. In that case we drop the
   // message when processing the message queue.
   while (queue != NULL) {
-    Instance* channel = queue->port()->channel();
+    Port* port = queue->port();
+    Instance* channel = port->channel();
     if (channel != NULL) return channel;
+    if (queue->kind() == Message::PROCESS_DEATH_SIGNAL) {
+      // The message stands for a batch of death signals of the port.
+      port->Lock();
+      port->ReleaseDeathSignals(queue);
+      port->Unlock();
+    }
     mailbox->AdvanceCurrentMessage();
     queue = mailbox->CurrentMessage();
   }
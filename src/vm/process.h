@@ -10,6 +10,7 @@
 
 #include "src/vm/debug_info.h"
 #include "src/vm/heap.h"
+#include "src/vm/heap_policy.h"
 #include "src/vm/links.h"
 #include "src/vm/lookup_cache.h"
 #include "src/vm/message_mailbox.h"
@@ -21,12 +22,14 @@
 
 namespace fletch {
 
+template <bool kThreaded>
 class Engine;
 class Interpreter;
 class SharedHeap;
 class Port;
 class ProcessQueue;
 class ProcessVisitor;
+class ThreadedCodeCache;
 
 class ThreadState {
  public:
@@ -39,6 +42,10 @@ class ThreadState {
     thread_id_ = thread_id;
   }
 
+  // The NUMA node of the CPU this thread was placed on.
+  int node() const { return node_; }
+  void set_node(int node) { node_ = node; }
+
   const ThreadIdentifier* thread() const { return &thread_; }
 
   // Update the thread field to point to the current thread.
@@ -49,18 +56,39 @@ class ThreadState {
   LookupCache* cache() const { return cache_; }
   LookupCache* EnsureCache();
 
+  // The decoded bytecodes used by the threaded mode of the C++ interpreter.
+  // Cleared together with the lookup cache.
+  ThreadedCodeCache* threaded_cache() const { return threaded_cache_; }
+  ThreadedCodeCache* EnsureThreadedCodeCache();
+
   Monitor* idle_monitor() const { return idle_monitor_; }
 
   ThreadState* next_idle_thread() const { return next_idle_thread_; }
   void set_next_idle_thread(ThreadState* value) { next_idle_thread_ = value; }
 
+  // The program this thread is currently executing processes of (and, with
+  // multiple process heaps, holding a shared heap part of). The thread is at
+  // a safepoint with respect to all other programs. See
+  // [Scheduler::StopProgram].
+  Program* safepoint_program() const { return safepoint_program_; }
+  void set_safepoint_program(Program* program) { safepoint_program_ = program; }
+
+  // The scheduler's cache epoch at the time the lookup cache was last
+  // cleared. Only accessed by the thread owning this state.
+  int cache_epoch() const { return cache_epoch_; }
+  void set_cache_epoch(int value) { cache_epoch_ = value; }
+
  private:
   int thread_id_;
+  int node_;
   ThreadIdentifier thread_;
   ProcessQueue* const queue_;
   LookupCache* cache_;
+  ThreadedCodeCache* threaded_cache_;
   Monitor* idle_monitor_;
   Atomic<ThreadState*> next_idle_thread_;
+  Atomic<Program*> safepoint_program_;
+  int cache_epoch_;
 };
 
 class Process {
@@ -103,12 +131,34 @@ class Process {
   void set_exception(Object* object) { exception_ = object; }
 #ifdef FLETCH_ENABLE_MULTIPLE_PROCESS_HEAPS
   Heap* heap() { return &heap_; }
+  HeapSizingPolicy* heap_policy() { return &heap_policy_; }
 #else
   Heap* heap() { return program()->shared_heap()->heap(); }
 #endif
   Heap* immutable_heap() { return immutable_heap_; }
   void set_immutable_heap(Heap* heap) { immutable_heap_ = heap; }
 
+  // While a message arena is open, new immutable instances are allocated in
+  // it instead of in the immutable heap. The arena is private to this
+  // process, so building a message in it does not put pressure on the
+  // shared heap.
+  Heap* message_arena() const { return message_arena_; }
+  void OpenMessageArena();
+
+  // Move the objects of the open message arena, if any, into
+  // [immutable_heap]. Since the objects are immutable, this is always safe.
+  void CloseMessageArena(Heap* immutable_heap);
+
+  // Close the message arena and detach its objects, so they can be handed
+  // to another process in one step, if nothing but [message] refers to them.
+  // The stack slots from [frames_start] up to [frames_end] belong to the
+  // frames sending the message. Their references to the arena objects are
+  // cleared, references from the rest of the stack prevent detaching. If
+  // the objects cannot be detached, the arena is closed like with
+  // [CloseMessageArena] and NULL is returned.
+  ExitReference* SealMessageArena(Object* message, Object** frames_start,
+                                  Object** frames_end);
+
   Coroutine* coroutine() const { return coroutine_; }
   void UpdateCoroutine(Coroutine* coroutine);
 
@@ -134,6 +184,8 @@ class Process {
 
   Object* NewByteArray(int length);
   Object* NewArray(int length);
+  // Allocates an array for immutable elements in the immutable heap.
+  Object* NewImmutableArray(int length);
   Object* NewDouble(fletch_double value);
   Object* NewInteger(int64 value);
 
@@ -165,6 +217,35 @@ class Process {
 
   void CollectMutableGarbage();
 
+  // Let the heap grow to [size] bytes before collecting it, for processes
+  // that are known to allocate that much. Ignored with a shared heap.
+  void SetHeapSizeHint(int size);
+
+  // Called by the scheduler around each quantum the process is interpreted,
+  // so the heap sizing policy only sees the time the process itself ran
+  // between collections. Ignored with a shared heap.
+  void StartQuantum();
+  void EndQuantum();
+
+  // Ask for the process to hibernate the next time it goes to sleep.
+  void RequestHibernation() { hibernation_requested_ = true; }
+
+  // Returns true if the process should hibernate before going to sleep.
+  // Only processes with an empty mailbox do.
+  bool ShouldHibernate();
+
+  // Called by the scheduler when the process goes to sleep and when it runs
+  // again, to measure how long it slept.
+  void RecordSleep();
+  void RecordWakeUp();
+
+  // Release the memory kept for the peak usage of a process that waits for
+  // messages. The stack is shrunk to its live frames, the heap is compacted
+  // into a minimally sized space and the store buffer is rebuilt with the
+  // entries that are still needed. The process grows again as needed when
+  // it is resumed.
+  void Hibernate();
+
   // Perform garbage collection and chain all stack objects. Additionally,
   // locate all processes in ports in the heap that are not yet known
   // by the program GC and link them in the argument list. Returns the
@@ -190,6 +271,9 @@ class Process {
   void DebugInterrupt();
   void Profile();
 
+  // Records the function of the top frame in the profile of the program.
+  void RecordProfileSample();
+
   // Debugging support.
   void EnsureDebuggerAttached();
   int PrepareStepOver();
@@ -263,6 +347,10 @@ class Process {
 
   void SendSignal(Signal* signal);
 
+  // The unused stack slots kept when hibernating. The stack always grows by
+  // at least this much.
+  static const int kHibernatedStackSlack = 256;
+
   // If you add an offset here, remember to add the corresponding static_assert
   // in process.cc.
   static const uword kCoroutineOffset = 0;
@@ -274,9 +362,12 @@ class Process {
       kExceptionOffset + sizeof(void*);
 
  private:
+  friend class CheckpointReader;
   friend class Interpreter;
+  template <bool kThreaded>
   friend class Engine;
   friend class Program;
+  friend class ProcessList;
 
   // Creation and deletion of processes is managed by a [Program].
   Process(Program* program, Process* parent);
@@ -291,10 +382,20 @@ class Process {
 
   void UpdateStackLimit();
 
+#ifdef FLETCH_ENABLE_MULTIPLE_PROCESS_HEAPS
+  // Replace the stack by a copy with [free] unused slots.
+  void ShrinkStack(int free);
+
+  // Scavenge the heap into [to], which becomes the new space of the heap.
+  void ScavengeMutableHeap(Space* to);
+#endif
+
   void set_process_list_next(Process* process) { process_list_next_ = process; }
   Process* process_list_next() { return process_list_next_; }
   void set_process_list_prev(Process* process) { process_list_prev_ = process; }
   Process* process_list_prev() { return process_list_prev_; }
+  void set_process_list_index(int index) { process_list_index_ = index; }
+  int process_list_index() const { return process_list_index_; }
 
   // Put these first so they can be accessed from the interpreter without
   // issues around object layout.
@@ -313,9 +414,16 @@ class Process {
 
 #ifdef FLETCH_ENABLE_MULTIPLE_PROCESS_HEAPS
   Heap heap_;
+  HeapSizingPolicy heap_policy_;
+  // The time the process was interpreted since the last collection of
+  // [heap_], not counting the current quantum, and when the current quantum
+  // (or the part of it after a collection) started, or 0 outside one.
+  uint64 mutator_time_;
+  uint64 quantum_start_;
 #endif
 
   Heap* immutable_heap_;
+  Heap* message_arena_;
   StoreBuffer store_buffer_;
   Links links_;
 
@@ -345,10 +453,11 @@ class Process {
   // Linked list of ports owned by this process.
   Port* ports_;
 
-  // Used for chaining all processes of a program. It is protected by a lock
-  // in the program.
+  // Used for chaining all processes of a program. It is protected by the
+  // lock of the program's process list with the given index.
   Process* process_list_next_;
   Process* process_list_prev_;
+  int process_list_index_;
 
   // The number of direct child processes plus 1.
   Atomic<int> process_triangle_count_;
@@ -360,6 +469,12 @@ class Process {
 
   DebugInfo* debug_info_;
 
+  bool hibernation_requested_;
+  // When the process went to sleep, or 0 if it has run since, and how long
+  // it slept the last time. Used for idle hibernation.
+  uint64 sleep_start_;
+  uint64 last_sleep_;
+
 #ifdef DEBUG
   bool true_then_false_;
 #endif
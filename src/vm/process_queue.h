@@ -136,6 +136,48 @@ class ProcessQueue {
     return true;
   }
 
+  // Try to move all entries of [program] from the queue to the list of
+  // paused processes of the program. The entries stay ready.
+  // Returns false if it was not possible to modify the queue. The operation
+  // should be repeated.
+  bool TryMoveToPaused(Program* program) {
+    Process* head = head_.load(kRelaxed);
+    while (true) {
+      if (head == kSentinel) return false;
+      if (head == NULL) return true;
+      if (head_.compare_exchange_weak(head, kSentinel, kAcquire, kRelaxed)) {
+        break;
+      }
+    }
+    ASSERT(head != kSentinel);
+    ASSERT(head_ == kSentinel);
+    ProgramState* program_state = program->program_state();
+    Process* entry = head;
+    while (entry != NULL) {
+      Process* next = entry->queue_next_;
+      if (entry->program() == program) {
+        Process* previous = entry->queue_previous_;
+        if (previous == NULL) {
+          head = next;
+        } else {
+          previous->queue_next_ = next;
+        }
+        if (next == NULL) {
+          tail_ = previous;
+        } else {
+          next->queue_previous_ = previous;
+        }
+        entry->queue_.store(NULL, kRelaxed);
+        entry->queue_next_ = NULL;
+        entry->queue_previous_ = NULL;
+        program_state->AddPausedProcess(entry);
+      }
+      entry = next;
+    }
+    head_.store(head, kRelease);
+    return true;
+  }
+
   bool is_empty() const { return head_.load(kAcquire) == NULL; }
 
  private:
@@ -40,11 +40,11 @@ Program::Program(ProgramSource source)
 #define CONSTRUCTOR_NULL(type, name, CamelName) name##_(NULL),
       ROOTS_DO(CONSTRUCTOR_NULL)
 #undef CONSTRUCTOR_NULL
-          process_list_mutex_(Platform::CreateMutex()),
-      process_list_head_(NULL),
-      random_(0),
+          random_(0),
       heap_(&random_),
       scheduler_(NULL),
+      event_handlers_(NULL),
+      number_of_event_handlers_(0),
       session_(NULL),
       entry_(NULL),
       is_compact_(false),
@@ -58,11 +58,27 @@ Program::Program(ProgramSource source)
   static_assert(k##CamelName##Offset == offsetof(Program, name##_), #name);
   ROOTS_DO(ASSERT_OFFSET)
 #undef ASSERT_OFFSET
+
+  int count = Flags::event_handlers;
+  if (count <= 0) count = Platform::GetNumberOfHardwareThreads();
+  if (count <= 0) count = 1;
+  number_of_event_handlers_ = count;
+  event_handlers_ = new EventHandler*[count];
+  if (count == 1) {
+    event_handlers_[0] = new EventHandler();
+  } else {
+    // Event handler i prefers scheduler worker thread i for the processes it
+    // resumes.
+    for (int i = 0; i < count; i++) event_handlers_[i] = new EventHandler(i);
+  }
 }
 
 Program::~Program() {
-  delete process_list_mutex_;
-  ASSERT(process_list_head_ == NULL);
+  ASSERT(FirstProcess() == NULL);
+  for (int i = 0; i < number_of_event_handlers_; i++) {
+    delete event_handlers_[i];
+  }
+  delete[] event_handlers_;
 }
 
 Process* Program::SpawnProcess(Process* parent) {
@@ -73,7 +89,7 @@ Process* Program::SpawnProcess(Process* parent) {
     parent->process_triangle_count_++;
   }
 
-  AddToProcessList(process);
+  AddToProcessList(process, parent);
   return process;
 }
 
@@ -132,10 +148,10 @@ bool Program::ScheduleProcessForDeletion(Process* process, Signal::Kind kind) {
 }
 
 void Program::VisitProcesses(ProcessVisitor* visitor) {
-  Process* current = process_list_head_;
+  Process* current = FirstProcess();
   while (current != NULL) {
     visitor->VisitProcess(current);
-    current = current->process_list_next();
+    current = NextProcess(current);
   }
 }
 
@@ -239,7 +255,7 @@ void Program::PrepareProgramGC(bool disable_heap_validation_before_gc) {
   }
 
   // Loop over all processes and cook all stacks.
-  Process* current = process_list_head_;
+  Process* current = FirstProcess();
   while (current != NULL) {
     if (Flags::validate_heaps && !disable_heap_validation_before_gc) {
       current->ValidateHeaps(&shared_heap_);
@@ -247,7 +263,7 @@ void Program::PrepareProgramGC(bool disable_heap_validation_before_gc) {
 
     int number_of_stacks = current->CollectGarbageAndChainStacks();
     current->CookStacks(number_of_stacks);
-    current = current->process_list_next();
+    current = NextProcess(current);
   }
 }
 
@@ -255,6 +271,10 @@ void Program::PerformProgramGC(Space* to, PointerVisitor* visitor) {
   {
     NoAllocationFailureScope scope(to);
 
+    // Copy the profiled functions first, so the hot code of the program
+    // is next to each other at the start of the heap.
+    profile_.IteratePointers(visitor);
+
     // Iterate program roots.
     IterateRoots(visitor);
 
@@ -263,10 +283,10 @@ void Program::PerformProgramGC(Space* to, PointerVisitor* visitor) {
     shared_heap_.heap()->IterateObjects(&object_pointer_visitor);
 
     // Iterate over all process program pointers.
-    Process* current = process_list_head_;
+    Process* current = FirstProcess();
     while (current != NULL) {
       current->IterateProgramPointers(visitor);
-      current = current->process_list_next();
+      current = NextProcess(current);
     }
 
     // Finish collection.
@@ -277,7 +297,7 @@ void Program::PerformProgramGC(Space* to, PointerVisitor* visitor) {
 }
 
 void Program::FinishProgramGC() {
-  Process* current = process_list_head_;
+  Process* current = FirstProcess();
   while (current != NULL) {
     // Uncook process
     current->UncookAndUnchainStacks();
@@ -286,7 +306,7 @@ void Program::FinishProgramGC() {
     if (Flags::validate_heaps) {
       current->ValidateHeaps(&shared_heap_);
     }
-    current = current->process_list_next();
+    current = NextProcess(current);
   }
 
   if (Flags::validate_heaps) {
@@ -364,20 +384,27 @@ void Program::CollectGarbage() {
   }
 }
 
-void Program::AddToProcessList(Process* process) {
-  ScopedLock locker(process_list_mutex_);
+ProcessList::ProcessList() : mutex_(Platform::CreateMutex()), head_(NULL) {}
+
+ProcessList::~ProcessList() {
+  ASSERT(head_ == NULL);
+  delete mutex_;
+}
+
+void ProcessList::Add(Process* process) {
+  ScopedLock locker(mutex_);
 
   ASSERT(process->process_list_next() == NULL &&
          process->process_list_prev() == NULL);
-  process->set_process_list_next(process_list_head_);
-  if (process_list_head_ != NULL) {
-    process_list_head_->set_process_list_prev(process);
+  process->set_process_list_next(head_);
+  if (head_ != NULL) {
+    head_->set_process_list_prev(process);
   }
-  process_list_head_ = process;
+  head_ = process;
 }
 
-void Program::RemoveFromProcessList(Process* process) {
-  ScopedLock locker(process_list_mutex_);
+void ProcessList::Remove(Process* process) {
+  ScopedLock locker(mutex_);
 
   Process* next = process->process_list_next();
   Process* prev = process->process_list_prev();
@@ -387,12 +414,44 @@ void Program::RemoveFromProcessList(Process* process) {
   if (prev != NULL) {
     prev->set_process_list_next(next);
   } else {
-    process_list_head_ = next;
+    head_ = next;
   }
   process->set_process_list_next(NULL);
   process->set_process_list_prev(NULL);
 }
 
+void Program::AddToProcessList(Process* process, Process* parent) {
+  // Spread the processes over the lists by the thread spawning them, so
+  // threads spawning processes concurrently do not contend for a lock.
+  int index = 0;
+  ThreadState* thread_state = (parent != NULL) ? parent->thread_state() : NULL;
+  if (thread_state != NULL && thread_state->thread_id() >= 0) {
+    index = thread_state->thread_id() % kNumberOfProcessLists;
+  }
+  process->set_process_list_index(index);
+  process_lists_[index].Add(process);
+}
+
+void Program::RemoveFromProcessList(Process* process) {
+  process_lists_[process->process_list_index()].Remove(process);
+}
+
+Process* Program::FirstProcess() { return FirstProcessFrom(0); }
+
+Process* Program::NextProcess(Process* process) {
+  Process* next = process->process_list_next();
+  if (next != NULL) return next;
+  return FirstProcessFrom(process->process_list_index() + 1);
+}
+
+Process* Program::FirstProcessFrom(int index) {
+  for (int i = index; i < kNumberOfProcessLists; i++) {
+    Process* head = process_lists_[i].head();
+    if (head != NULL) return head;
+  }
+  return NULL;
+}
+
 struct SharedHeapUsage {
   uint64 timestamp = 0;
   uword shared_used = 0;
@@ -400,7 +459,7 @@ struct SharedHeapUsage {
 };
 
 static void GetSharedHeapUsage(Heap* heap, SharedHeapUsage* heap_usage) {
-  heap_usage->timestamp = Platform::GetMicroseconds();
+  heap_usage->timestamp = Platform::GetMonotonicMicroseconds();
   heap_usage->shared_used = heap->space()->Used();
   heap_usage->shared_size = heap->space()->Size();
 }
@@ -474,13 +533,13 @@ void Program::PerformSharedGarbageCollection() {
   ScavengeVisitor scavenger(from, to);
 
   int process_heap_sizes = 0;
-  Process* current = process_list_head_;
+  Process* current = FirstProcess();
   while (current != NULL) {
     current->TakeChildHeaps();
     current->IterateRoots(&scavenger);
     current->store_buffer()->IteratePointersToImmutableSpace(&scavenger);
     process_heap_sizes += current->heap()->space()->Used();
-    current = current->process_list_next();
+    current = NextProcess(current);
   }
 
   to->CompleteScavenge(&scavenger);
@@ -500,19 +559,19 @@ void Program::PerformSharedGarbageCollection() {
   Space* space = heap->space();
   MarkingStack stack;
   MarkingVisitor marking_visitor(space, &stack);
-  Process* current = process_list_head_;
+  Process* current = FirstProcess();
   while (current != NULL) {
     current->TakeChildHeaps();
     current->IterateRoots(&marking_visitor);
-    current = current->process_list_next();
+    current = NextProcess(current);
   }
   stack.Process(&marking_visitor);
   heap->ProcessWeakPointers();
 
-  current = process_list_head_;
+  current = FirstProcess();
   while (current != NULL) {
     current->set_ports(Port::CleanupPorts(space, current->ports()));
-    current = current->process_list_next();
+    current = NextProcess(current);
   }
 
   // Flush outstanding free_list chunks into the free list. Then sweep
@@ -521,10 +580,10 @@ void Program::PerformSharedGarbageCollection() {
   SweepingVisitor sweeping_visitor(space->free_list());
   space->IterateObjects(&sweeping_visitor);
 
-  current = process_list_head_;
+  current = FirstProcess();
   while (current != NULL) {
     current->UpdateStackLimit();
-    current = current->process_list_next();
+    current = NextProcess(current);
   }
 
   space->set_used(sweeping_visitor.used());
@@ -541,21 +600,21 @@ void Program::PerformSharedGarbageCollection() {
 
   ScavengeVisitor scavenger(from, to);
 
-  Process* current = process_list_head_;
+  Process* current = FirstProcess();
   while (current != NULL) {
     current->TakeChildHeaps();
     current->IterateRoots(&scavenger);
-    current = current->process_list_next();
+    current = NextProcess(current);
   }
 
   to->CompleteScavenge(&scavenger);
   heap->ProcessWeakPointers();
 
-  current = process_list_head_;
+  current = FirstProcess();
   while (current != NULL) {
     current->set_ports(Port::CleanupPorts(from, current->ports()));
     current->UpdateStackLimit();
-    current = current->process_list_next();
+    current = NextProcess(current);
   }
 
   heap->ReplaceSpace(to);
@@ -566,10 +625,10 @@ void Program::PerformSharedGarbageCollection() {
 #endif  // #ifdef FLETCH_ENABLE_MULTIPLE_PROCESS_HEAPS
 
 void Program::CompactStorebuffers() {
-  Process* current = process_list_head_;
+  Process* current = FirstProcess();
   while (current != NULL) {
     current->store_buffer()->Deduplicate();
-    current = current->process_list_next();
+    current = NextProcess(current);
   }
 }
 
@@ -678,6 +737,15 @@ void Program::PrintStatistics() {
   Print::Out("    - header size = %d bytes\n",
              statistics.function_header_size());
   Print::Out("    - bytecode size = %d bytes\n", statistics.bytecode_size());
+  if (!profile_.is_empty()) {
+    int span = 0;
+    int pages = 0;
+    profile_.ComputeLayout(4 * KB, &span, &pages);
+    Print::Out("  Profiled functions\n");
+    Print::Out("    - count = %d\n", profile_.length());
+    Print::Out("    - span = %d bytes\n", span);
+    Print::Out("    - pages = %d\n", pages);
+  }
 }
 
 void Program::Initialize() {
@@ -700,6 +768,14 @@ void Program::Initialize() {
         Class::cast(heap()->CreateClass(format, meta_class_, null_object_));
   }
 
+  // Arrays holding only immutable objects. They are created by natives and
+  // can be shared between processes.
+  {
+    InstanceFormat format = InstanceFormat::immutable_array_format();
+    immutable_array_class_ =
+        Class::cast(heap()->CreateClass(format, meta_class_, null_object_));
+  }
+
   empty_array_ = Array::cast(CreateArray(0));
 
   {
@@ -5,9 +5,11 @@
 #ifndef SRC_VM_PROGRAM_H_
 #define SRC_VM_PROGRAM_H_
 
+#include "src/shared/atomic.h"
 #include "src/shared/globals.h"
 #include "src/shared/random.h"
 #include "src/vm/event_handler.h"
+#include "src/vm/function_profile.h"
 #include "src/vm/heap.h"
 #include "src/vm/shared_heap.h"
 #include "src/vm/links.h"
@@ -24,6 +26,22 @@ class ProgramTableRewriter;
 class Scheduler;
 class Session;
 
+// A doubly linked list of processes protected by a lock.
+class ProcessList {
+ public:
+  ProcessList();
+  ~ProcessList();
+
+  void Add(Process* process);
+  void Remove(Process* process);
+
+  Process* head() const { return head_; }
+
+ private:
+  Mutex* mutex_;
+  Process* head_;
+};
+
 // Defines all the roots in the program heap.
 #define ROOTS_DO(V)                                             \
   V(Instance, null_object, NullObject)                          \
@@ -43,6 +61,7 @@ class Session;
   V(Class, two_byte_string_class, TwoByteStringClass)           \
   V(Class, object_class, ObjectClass)                           \
   V(Class, array_class, ArrayClass)                             \
+  V(Class, immutable_array_class, ImmutableArrayClass)          \
   V(Class, function_class, FunctionClass)                       \
   V(Class, closure_class, ClosureClass)                         \
   V(Class, byte_array_class, ByteArrayClass)                    \
@@ -79,6 +98,8 @@ class ProgramState {
   // The [Scheduler::pause_monitor_] must be locked when calling this method.
   void AddPausedProcess(Process* process);
 
+  // Read without holding the lock by scheduler threads entering the program,
+  // see [Scheduler::StopProgram].
   bool is_paused() const { return is_paused_; }
   void set_is_paused(bool value) { is_paused_ = value; }
 
@@ -89,7 +110,7 @@ class ProgramState {
 
  private:
   Process* paused_processes_head_;
-  bool is_paused_;
+  Atomic<bool> is_paused_;
 };
 
 class Program {
@@ -151,7 +172,10 @@ class Program {
 
   ProgramState* program_state() { return &program_state_; }
 
-  EventHandler* event_handler() { return &event_handler_; }
+  // The first event handler also handles timeouts.
+  EventHandler* event_handler() { return event_handlers_[0]; }
+  EventHandler* event_handler(int index) { return event_handlers_[index]; }
+  int number_of_event_handlers() const { return number_of_event_handlers_; }
 
   // TODO(ager): Support more than one active session at a time.
   void AddSession(Session* session) {
@@ -162,6 +186,7 @@ class Program {
   Session* session() { return session_; }
 
   Heap* heap() { return &heap_; }
+  FunctionProfile* profile() { return &profile_; }
   SharedHeap* shared_heap() { return &shared_heap_; }
 
   int program_heap_size() {
@@ -251,6 +276,8 @@ class Program {
   uword OffsetOf(HeapObject* object);
 
  private:
+  friend class CheckpointWriter;
+
   // Access to the address of the first and last root.
   Object** first_root_address() {
     return reinterpret_cast<Object**>(&null_object_);
@@ -263,26 +290,37 @@ class Program {
   void ValidateGlobalHeapsAreConsistent();
 
   // Chaining of all processes of this program.
-  void AddToProcessList(Process* process);
+  void AddToProcessList(Process* process, Process* parent);
   void RemoveFromProcessList(Process* process);
 
+  // Iteration over all processes of this program, list by list. Only safe
+  // once the program has been stopped.
+  Process* FirstProcess();
+  Process* NextProcess(Process* process);
+  Process* FirstProcessFrom(int index);
+
 #define ROOT_DECLARATION(type, name, CamelName) type* name##_;
   ROOTS_DO(ROOT_DECLARATION)
 #undef ROOT_DECLARATION
 
-  // Chained doubly linked list of all processes protected by a lock.
-  Mutex* process_list_mutex_;
-  Process* process_list_head_;
+  // The processes of this program, sharded over several lists keyed by the
+  // thread spawning them.
+  static const int kNumberOfProcessLists = 32;
+  ProcessList process_lists_[kNumberOfProcessLists];
 
   RandomXorShift random_;
 
   Heap heap_;
   SharedHeap shared_heap_;
+  FunctionProfile profile_;
 
   Scheduler* scheduler_;
   ProgramState program_state_;
 
-  EventHandler event_handler_;
+  // File descriptors are spread over the event handlers by hashing, see
+  // lib/os/event_handler.dart.
+  EventHandler** event_handlers_;
+  int number_of_event_handlers_;
 
   // Session operating on this program.
   Session* session_;
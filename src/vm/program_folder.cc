@@ -10,8 +10,10 @@
 #include "src/shared/flags.h"
 #include "src/shared/names.h"
 #include "src/shared/selectors.h"
+#include "src/shared/utils.h"
 
 #include "src/vm/hash_map.h"
+#include "src/vm/hash_set.h"
 #include "src/vm/heap.h"
 #include "src/vm/program.h"
 #include "src/vm/selector_row.h"
@@ -42,6 +44,22 @@ static Array* MapToArray(ObjectIndexMap* map, Program* program) {
   return result;
 }
 
+// Run through the dispatch table of a folded program and compute a map from
+// selector offsets to the original selectors.
+static void ComputeSelectorOffsetMap(Program* program, SelectorOffsetMap* map) {
+  Array* dispatch_table = program->dispatch_table();
+  if (dispatch_table == NULL) return;
+  for (int i = 0, length = dispatch_table->length(); i < length; i++) {
+    Object* element = dispatch_table->get(i);
+    if (element->IsNull()) continue;
+    Array* entry = Array::cast(element);
+    int offset = Smi::cast(entry->get(0))->value();
+    int selector = Smi::cast(entry->get(1))->value();
+    ASSERT(map->Find(offset) == map->End() || (*map)[offset] == selector);
+    (*map)[offset] = selector;
+  }
+}
+
 class ProgramTableRewriter {
  public:
   ~ProgramTableRewriter() {
@@ -635,22 +653,11 @@ void ProgramFolder::Unfold() {
   // the program is stopped?
   ASSERT(program_->is_compact());
 
-  // Run through the dispatch table and compute a map from selector offsets
-  // to the original selectors. This is used when rewriting the
-  // bytecodes back to the original invoke-method bytecodes.
+  // Compute a map from selector offsets to the original selectors. This is
+  // used when rewriting the bytecodes back to the original invoke-method
+  // bytecodes.
   SelectorOffsetMap map;
-  Array* dispatch_table = program_->dispatch_table();
-  if (dispatch_table != NULL) {
-    for (int i = 0, length = dispatch_table->length(); i < length; i++) {
-      Object* element = dispatch_table->get(i);
-      if (element->IsNull()) continue;
-      Array* entry = Array::cast(element);
-      int offset = Smi::cast(entry->get(0))->value();
-      int selector = Smi::cast(entry->get(1))->value();
-      ASSERT(map.Find(offset) == map.End() || map[offset] == selector);
-      map[offset] = selector;
-    }
-  }
+  ComputeSelectorOffsetMap(program_, &map);
 
   program_->PrepareProgramGC();
   Space* to = new Space();
@@ -666,6 +673,291 @@ void ProgramFolder::Unfold() {
   program_->FinishProgramGC();
 }
 
+typedef HashSet<intptr_t> IndexSet;
+typedef HashMap<intptr_t, Vector<Function*>*> SelectorMethodsMap;
+
+// Computes the part of a folded program that can be reached from its
+// entry. Static methods, constants and static fields are reachable when a
+// reachable function refers to their index. Methods are reachable when a
+// reachable function invokes their selector, since any class implementing
+// the selector could be the receiver.
+class TreeShaker {
+ public:
+  explicit TreeShaker(Program* program)
+      : program_(program), methods_retained_(0), methods_removed_(0) {
+    ComputeSelectorOffsetMap(program, &selectors_);
+  }
+
+  ~TreeShaker() {
+    SelectorMethodsMap::ConstIterator it = methods_.Begin();
+    SelectorMethodsMap::ConstIterator end = methods_.End();
+    for (; it != end; ++it) delete it->second;
+  }
+
+  void ComputeReachable() {
+    ComputeMethodsBySelector();
+
+    MarkFunction(program_->entry());
+    // The dispatch table refers to the noSuchMethod trampoline for all
+    // entries that do not match.
+    static const Names::Id name = Names::kNoSuchMethodTrampoline;
+    MarkSelector(Selector::Encode(name, Selector::METHOD, 0));
+
+    // Closures are called and coroutines are started by natives and by the
+    // noSuchMethod handling in the interpreter, without an invoke of the
+    // selector in the bytecodes.
+    SelectorMethodsMap::ConstIterator it = methods_.Begin();
+    SelectorMethodsMap::ConstIterator end = methods_.End();
+    for (; it != end; ++it) {
+      int id = Selector::IdField::decode(it->first);
+      if (id == Names::kCall || id == Names::kCoroutineStart) {
+        MarkSelector(it->first);
+      }
+    }
+
+    while (!worklist_.IsEmpty()) ScanFunction(worklist_.PopBack());
+  }
+
+  // Drops the unreachable methods from the classes, rebuilds the dispatch
+  // table for the remaining methods and clears the unreachable entries of
+  // the program tables. The tables are not compacted, so the indices in
+  // the bytecodes stay valid.
+  void RemoveUnreachable() {
+    ProgramTableRewriter rewriter;
+    Array* classes = program_->classes();
+    for (int i = classes->length() - 1; i >= 0; i--) {
+      Class* clazz = Class::cast(classes->get(i));
+      if (clazz->has_methods()) RetainMethods(clazz, &rewriter);
+    }
+    rewriter.ProcessSelectorRows(program_);
+
+    InvokeRewriter visitor(&rewriter, &selectors_);
+    program_->heap()->IterateObjects(&visitor);
+
+    int static_methods =
+        ClearUnreachable(program_->static_methods(), &static_methods_);
+    int constants = ClearUnreachable(program_->constants(), &constants_);
+    int static_fields =
+        ClearUnreachable(program_->static_fields(), &static_fields_);
+
+    program_->profile()->Retain(&functions_);
+
+    if (Flags::print_program_statistics) {
+      Print::Out("Tree shaking removed:\n");
+      Print::Out("  - %d of %d methods\n", methods_removed_,
+                 methods_removed_ + methods_retained_);
+      Print::Out("  - %d static methods\n", static_methods);
+      Print::Out("  - %d constants\n", constants);
+      Print::Out("  - %d static fields\n", static_fields);
+    }
+  }
+
+ private:
+  // Rewrites the invokes of all functions to use the offsets in the new
+  // dispatch table.
+  class InvokeRewriter : public HeapObjectVisitor {
+   public:
+    InvokeRewriter(ProgramTableRewriter* rewriter, SelectorOffsetMap* map)
+        : rewriter_(rewriter), map_(map) {}
+
+    virtual int Visit(HeapObject* object) {
+      int size = object->Size();
+      if (object->IsFunction()) Process(Function::cast(object));
+      return size;
+    }
+
+   private:
+    void Process(Function* function) {
+      uint8_t* bcp = function->bytecode_address_for(0);
+      while (*bcp != kMethodEnd) {
+        Opcode opcode = static_cast<Opcode>(*bcp);
+        if (IsDynamicInvoke(opcode)) {
+          int offset = Selector::IdField::decode(Utils::ReadInt32(bcp + 1));
+          int selector = map_->At(offset);
+          SelectorRow* row = rewriter_->LookupSelectorRow(selector);
+          if (row->IsMatched()) {
+            int updated = Selector::IdField::update(row->offset(), selector);
+            Utils::WriteInt32(bcp + 1, updated);
+          } else {
+            // Only unreachable functions invoke selectors that no longer
+            // have any methods.
+            *bcp = (opcode == kInvokeTest) ? kInvokeTestNoSuchMethod
+                                           : kInvokeNoSuchMethod;
+            Utils::WriteInt32(bcp + 1, selector);
+          }
+        }
+        bcp += Bytecode::Size(opcode);
+      }
+    }
+
+    ProgramTableRewriter* rewriter_;
+    SelectorOffsetMap* map_;
+  };
+
+  static bool IsDynamicInvoke(Opcode opcode) {
+    return Bytecode::IsInvoke(opcode) && opcode != kInvokeStatic &&
+           opcode != kInvokeFactory;
+  }
+
+  void ComputeMethodsBySelector() {
+    Array* classes = program_->classes();
+    for (int i = 0, length = classes->length(); i < length; i++) {
+      Class* clazz = Class::cast(classes->get(i));
+      if (!clazz->has_methods()) continue;
+      Array* methods = clazz->methods();
+      for (int j = 0, length = methods->length(); j < length; j += 2) {
+        int selector = Smi::cast(methods->get(j))->value();
+        Vector<Function*>*& entry = methods_[selector];
+        if (entry == NULL) entry = new Vector<Function*>();
+        entry->PushBack(Function::cast(methods->get(j + 1)));
+      }
+    }
+  }
+
+  void ScanFunction(Function* function) {
+    uint8_t* bcp = function->bytecode_address_for(0);
+    while (true) {
+      Opcode opcode = static_cast<Opcode>(*bcp);
+      switch (opcode) {
+        case kInvokeStatic:
+        case kInvokeFactory: {
+          int index = Utils::ReadInt32(bcp + 1);
+          static_methods_.Insert(index);
+          MarkObject(program_->static_methods()->get(index));
+          break;
+        }
+        case kLoadConst: {
+          int index = Utils::ReadInt32(bcp + 1);
+          constants_.Insert(index);
+          MarkObject(program_->constants()->get(index));
+          break;
+        }
+        case kLoadStatic:
+        case kLoadStaticInit:
+        case kStoreStatic: {
+          int index = Utils::ReadInt32(bcp + 1);
+          static_fields_.Insert(index);
+          MarkObject(program_->static_fields()->get(index));
+          break;
+        }
+        case kInvokeNoSuchMethod:
+        case kInvokeTestNoSuchMethod:
+          MarkSelector(Utils::ReadInt32(bcp + 1));
+          break;
+        case kMethodEnd:
+          return;
+        default:
+          if (IsDynamicInvoke(opcode)) {
+            int offset = Selector::IdField::decode(Utils::ReadInt32(bcp + 1));
+            MarkSelector(selectors_.At(offset));
+          }
+          break;
+      }
+      bcp += Bytecode::Size(opcode);
+    }
+  }
+
+  void MarkObject(Object* object) {
+    if (object->IsFunction()) {
+      MarkFunction(Function::cast(object));
+    } else if (object->IsInitializer()) {
+      MarkFunction(Initializer::cast(object)->function());
+    }
+  }
+
+  void MarkFunction(Function* function) {
+    if (functions_.Insert(function).second) worklist_.PushBack(function);
+  }
+
+  void MarkSelector(int selector) {
+    if (!selectors_live_.Insert(selector).second) return;
+    SelectorMethodsMap::ConstIterator it = methods_.Find(selector);
+    if (it != methods_.End()) {
+      Vector<Function*>* methods = it->second;
+      for (unsigned i = 0; i < methods->size(); i++) MarkFunction((*methods)[i]);
+    }
+    // Invoking a method that a class does not implement calls the getter of
+    // the same name instead (see HandleEnterNoSuchMethod).
+    if (Selector::KindField::decode(selector) == Selector::METHOD) {
+      MarkSelector(Selector::EncodeGetter(Selector::IdField::decode(selector)));
+    }
+  }
+
+  void RetainMethods(Class* clazz, ProgramTableRewriter* rewriter) {
+    Array* methods = clazz->methods();
+    int length = methods->length();
+    int retained = 0;
+    for (int i = 0; i < length; i += 2) {
+      int selector = Smi::cast(methods->get(i))->value();
+      if (IsLiveSelector(selector)) retained += 2;
+    }
+    methods_retained_ += retained / 2;
+    methods_removed_ += (length - retained) / 2;
+
+    if (retained != length) {
+      Array* result = Array::cast(program_->CreateArray(retained));
+      for (int i = 0, j = 0; i < length; i += 2) {
+        int selector = Smi::cast(methods->get(i))->value();
+        if (!IsLiveSelector(selector)) continue;
+        result->set(j++, methods->get(i));
+        result->set(j++, methods->get(i + 1));
+      }
+      clazz->set_methods(result);
+      methods = result;
+    }
+
+    for (int i = 0; i < retained; i += 2) {
+      int selector = Smi::cast(methods->get(i))->value();
+      Function* method = Function::cast(methods->get(i + 1));
+      rewriter->LookupSelectorRow(selector)->DefineMethod(clazz, method);
+    }
+  }
+
+  bool IsLiveSelector(int selector) {
+    return selectors_live_.Find(selector) != selectors_live_.End();
+  }
+
+  // Replaces the entries of [table] that are not in [live] with null and
+  // returns the number of entries replaced.
+  int ClearUnreachable(Array* table, IndexSet* live) {
+    Object* null = program_->null_object();
+    int cleared = 0;
+    for (int i = 0, length = table->length(); i < length; i++) {
+      if (live->Find(i) != live->End() || table->get(i) == null) continue;
+      table->set(i, null);
+      cleared++;
+    }
+    return cleared;
+  }
+
+  Program* const program_;
+
+  SelectorOffsetMap selectors_;
+  SelectorMethodsMap methods_;
+
+  HashSet<Function*> functions_;
+  Vector<Function*> worklist_;
+  IndexSet selectors_live_;
+  IndexSet static_methods_;
+  IndexSet constants_;
+  IndexSet static_fields_;
+
+  int methods_retained_;
+  int methods_removed_;
+};
+
+void ProgramFolder::Shake() {
+  ASSERT(program_->is_compact());
+
+  TreeShaker shaker(program_);
+  shaker.ComputeReachable();
+  {
+    NoAllocationFailureScope scope(program_->heap()->space());
+    shaker.RemoveUnreachable();
+  }
+  program_->SetupDispatchTableIntrinsics();
+}
+
 void ProgramFolder::FoldProgramByDefault(Program* program) {
   // For testing purposes, we support unfolding the program
   // before running it.
@@ -33,6 +33,14 @@ class ProgramFolder {
   // program before calling.
   void Unfold();
 
+  // Remove the parts of a folded program that cannot be reached from its
+  // entry: methods for selectors that are never invoked, and the static
+  // methods, constants and static fields that no reachable function refers
+  // to. The dispatch table is rebuilt for the remaining methods. Used
+  // before writing a snapshot, as the removed code cannot be added back by
+  // the session.
+  void Shake();
+
   Program* program() const { return program_; }
 
   // Will fold the program if not overridden by -Xunfold-program.
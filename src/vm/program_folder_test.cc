@@ -0,0 +1,77 @@
+// Copyright (c) 2015, the Fletch project authors. Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE.md file.
+
+#ifdef FLETCH_ENABLE_LIVE_CODING
+
+#include "src/shared/bytecodes.h"
+#include "src/shared/names.h"
+#include "src/shared/selectors.h"
+#include "src/shared/test_case.h"
+
+#include "src/vm/object.h"
+#include "src/vm/program.h"
+#include "src/vm/program_folder.h"
+#include "src/vm/test_program.h"
+
+namespace fletch {
+
+static uint8 kLeafBytecodes[] = {
+  kLoadLiteral0,                            // 0
+  kReturn, 1,                               // 1
+};
+
+static uint8 kEntryBytecodes[] = {
+  kLoadLiteral0,                            // 0
+  kInvokeMethodUnfold, 0, 0, 0, 0,          // 1: selector patched below
+  kReturn, 1,                               // 6
+};
+
+TEST_CASE(ProgramFolder_Shake) {
+  TestProgram test;
+  Program* program = test.program();
+
+  int used = Selector::EncodeMethod(Names::kCount, 0);
+  int unused = Selector::EncodeMethod(Names::kCount + 1, 0);
+  int trampoline =
+      Selector::Encode(Names::kNoSuchMethodTrampoline, Selector::METHOD, 0);
+  {
+    NoAllocationFailureScope scope(program->heap()->space());
+    Utils::WriteInt32(kEntryBytecodes + 2, used);
+    Array* methods = Array::cast(program->CreateArray(6));
+    methods->set(0, Smi::FromWord(used));
+    for (int i = 1; i < 6; i += 2) {
+      methods->set(i, test.CreateFunction(kLeafBytecodes,
+                                          sizeof(kLeafBytecodes)));
+    }
+    methods->set(2, Smi::FromWord(unused));
+    methods->set(4, Smi::FromWord(trampoline));
+    program->object_class()->set_methods(methods);
+    program->set_entry(test.CreateFunction(kEntryBytecodes,
+                                           sizeof(kEntryBytecodes)));
+  }
+
+  ProgramFolder folder(program);
+  folder.Fold();
+  int table_length = program->dispatch_table()->length();
+  folder.Shake();
+
+  // The method for the selector that is never invoked is gone.
+  Array* methods = program->object_class()->methods();
+  EXPECT_EQ(4, methods->length());
+  EXPECT_EQ(used, Smi::cast(methods->get(0))->value());
+  EXPECT_EQ(trampoline, Smi::cast(methods->get(2))->value());
+  EXPECT(program->dispatch_table()->length() < table_length);
+
+  // The invoke in the entry uses the offset in the new dispatch table.
+  uint8* bcp = program->entry()->bytecode_address_for(1);
+  EXPECT_EQ(kInvokeMethod, *bcp);
+  int offset = Selector::IdField::decode(Utils::ReadInt32(bcp + 1));
+  int id = program->smi_class()->id();
+  Array* entry = Array::cast(program->dispatch_table()->get(offset + id));
+  EXPECT_EQ(used, Smi::cast(entry->get(1))->value());
+}
+
+}  // namespace fletch
+
+#endif  // FLETCH_ENABLE_LIVE_CODING
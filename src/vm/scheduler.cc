@@ -6,15 +6,18 @@
 
 #include "src/shared/flags.h"
 
+#include "src/vm/clock.h"
 #include "src/vm/frame.h"
 #include "src/vm/gc_thread.h"
 #include "src/vm/interpreter.h"
 #include "src/vm/links.h"
+#include "src/vm/numa.h"
 #include "src/vm/port.h"
 #include "src/vm/process.h"
 #include "src/vm/process_queue.h"
 #include "src/vm/session.h"
 #include "src/vm/thread.h"
+#include "src/vm/threaded_code.h"
 
 #define HANDLE_BY_SESSION_OR_SELF(session_expression, self_expression) \
   do {                                                                 \
@@ -31,24 +34,35 @@ ThreadState* const kEmptyThreadState = reinterpret_cast<ThreadState*>(1);
 ThreadState* const kLockedThreadState = reinterpret_cast<ThreadState*>(2);
 Process* const kPreemptMarker = reinterpret_cast<Process*>(1);
 
+#if defined(FLETCH_ENABLE_MULTIPLE_PROCESS_HEAPS)
+static int MaxThreads() {
+  int count = Flags::max_threads;
+  if (count <= 0) count = Platform::GetNumberOfHardwareThreads();
+  if (count <= 0) count = 1;
+  return count;
+}
+#endif
+
 Scheduler::Scheduler()
 #if !defined(FLETCH_ENABLE_MULTIPLE_PROCESS_HEAPS)
     : max_threads_(1),
 #else
-    : max_threads_(Platform::GetNumberOfHardwareThreads()),
+    : max_threads_(MaxThreads()),
 #endif
       thread_pool_(max_threads_),
       preempt_monitor_(Platform::CreateMonitor()),
       processes_(0),
-      sleeping_threads_(0),
       thread_count_(0),
       idle_threads_(kEmptyThreadState),
       threads_(new Atomic<ThreadState*>[max_threads_]),
       temporary_thread_states_(NULL),
       startup_queue_(new ProcessQueue()),
+      topology_(NumaTopology::Discover()),
       pause_monitor_(Platform::CreateMonitor()),
       last_process_exit_(Signal::kTerminated),
-      pause_(false),
+      unlocked_resumes_(0),
+      cache_epoch_(0),
+      exit_statistics_mutex_(Platform::CreateMutex()),
       current_processes_(new Atomic<Process*>[max_threads_]),
       gc_thread_(new GCThread()) {
   for (int i = 0; i < max_threads_; i++) {
@@ -60,9 +74,11 @@ Scheduler::Scheduler()
 Scheduler::~Scheduler() {
   delete preempt_monitor_;
   delete pause_monitor_;
+  delete exit_statistics_mutex_;
   delete[] current_processes_;
   delete[] threads_;
   delete startup_queue_;
+  delete topology_;
   delete gc_thread_;
   ThreadState* current = temporary_thread_states_;
   while (current != NULL) {
@@ -87,6 +103,21 @@ void Scheduler::ScheduleProgram(Program* program, Process* main_process) {
   EnqueueProcessAndNotifyThreads(NULL, main_process);
 }
 
+void Scheduler::ScheduleRestoredProgram(Program* program, Process** processes,
+                                        int count) {
+  program->set_scheduler(this);
+
+  ScopedMonitorLock locker(pause_monitor_);
+
+  processes_ += count;
+  for (int i = 0; i < count; i++) {
+    Process* process = processes[i];
+    if (process->state() == Process::kReady) {
+      EnqueueProcessAndNotifyThreads(NULL, process);
+    }
+  }
+}
+
 void Scheduler::UnscheduleProgram(Program* program) {
   ScopedMonitorLock locker(pause_monitor_);
 
@@ -97,63 +128,55 @@ void Scheduler::UnscheduleProgram(Program* program) {
 void Scheduler::StopProgram(Program* program) {
   ASSERT(program->scheduler() == this);
 
-  {
-    ScopedMonitorLock pause_locker(pause_monitor_);
-
-    ProgramState* program_state = program->program_state();
-    while (program_state->is_paused()) {
-      pause_monitor_->Wait();
-    }
-    program_state->set_is_paused(true);
-
-    pause_ = true;
-
-    NotifyAllThreads();
+  ScopedMonitorLock pause_locker(pause_monitor_);
 
-    while (true) {
-      int count = 0;
-      // Preempt running processes, only if it was possibly to 'take' the
-      // current process. This makes sure we don't preempt while deleting.
-      // Loop to ensure we continue to preempt until all threads are sleeping.
-      for (int i = 0; i < max_threads_; i++) {
-        if (threads_[i].load() != NULL) count++;
-        PreemptThreadProcess(i);
-      }
-      if (count == sleeping_threads_) break;
-      pause_monitor_->Wait();
-    }
+  ProgramState* program_state = program->program_state();
+  while (program_state->is_paused()) {
+    pause_monitor_->Wait();
+  }
 
-    Process* to_enqueue = NULL;
+  uint64 start = Platform::GetMonotonicMicroseconds();
 
-    while (true) {
-      Process* process = NULL;
-      // All processes dequeued are marked as Running.
-      if (!TryDequeueFromAnyThread(&process)) continue;  // Retry.
-      if (process == NULL) break;
+  // From here on no thread will start running processes of [program]. A
+  // thread that has already entered the program will see the flag at its next
+  // process switch, park the process and leave the program.
+  program_state->set_is_paused(true);
+  ++cache_epoch_;
 
-      if (process->program() == program) {
-        process->ChangeState(Process::kRunning, Process::kReady);
-        program_state->AddPausedProcess(process);
-      } else {
-        process->set_next(to_enqueue);
-        to_enqueue = process;
-      }
+  while (true) {
+    // Preempt the processes of all threads that are still inside the program.
+    // The preemption is noticed at the next call or backward branch through
+    // the stack limit marker. If a thread is between two processes, the marker
+    // makes sure the next process it picks up is interrupted right away.
+    bool at_safepoint = true;
+    for (int i = 0; i < max_threads_; i++) {
+      ThreadState* thread_state = threads_[i];
+      if (thread_state == NULL) continue;
+      if (thread_state->safepoint_program() != program) continue;
+      at_safepoint = false;
+      PreemptThreadProcess(i);
     }
+    if (at_safepoint) break;
+    pause_monitor_->Wait();
+  }
 
-    while (to_enqueue != NULL) {
-      to_enqueue->ChangeState(Process::kRunning, Process::kReady);
-      EnqueueOnAnyThread(to_enqueue);
-      Process* next = to_enqueue->next();
-      to_enqueue->set_next(NULL);
-      to_enqueue = next;
+  // No thread is inside the program anymore, and processes of a paused
+  // program are only enqueued on its paused list, once the resumes that
+  // did not see the flag are done. Take the ones that are still in the
+  // ready queues out, so no thread picks them up while the program is
+  // stopped.
+  while (unlocked_resumes_ != 0) {
+  }
+  for (int i = 0; i < max_threads_; i++) {
+    ThreadState* thread_state = threads_[i];
+    if (thread_state == NULL) continue;
+    while (!thread_state->queue()->TryMoveToPaused(program)) {
     }
-
-    FlushCacheInThreadStates();
-
-    pause_ = false;
+  }
+  while (!startup_queue_->TryMoveToPaused(program)) {
   }
 
-  NotifyAllThreads();
+  safepoint_histogram_.Record(Platform::GetMonotonicMicroseconds() - start);
 }
 
 void Scheduler::ResumeProgram(Program* program) {
@@ -203,6 +226,21 @@ void Scheduler::ResumeProcess(Process* process) {
   EnqueueOnAnyThreadSafe(process);
 }
 
+void Scheduler::ResumeProcessOn(Process* process, int thread_id) {
+  if (!process->ChangeState(Process::kSleeping, Process::kReady)) return;
+  // Every event resumes a process, so the common case does not take
+  // [pause_monitor_]. The resume is announced before the paused flag is
+  // read: a [StopProgram] that sets the flag afterwards waits for the
+  // process to reach the ready queue before emptying the queues.
+  ++unlocked_resumes_;
+  ProgramState* state = process->program()->program_state();
+  int thread_count = thread_count_;
+  bool enqueued = !state->is_paused() && thread_count > 0 &&
+                  TryEnqueueOnThread(process, thread_id % thread_count);
+  --unlocked_resumes_;
+  if (!enqueued) EnqueueOnAnyThreadSafe(process, thread_id);
+}
+
 void Scheduler::SignalProcess(Process* process) {
   while (true) {
     switch (process->state()) {
@@ -272,14 +310,16 @@ int Scheduler::Run() {
   static const uint64 kProfileIntervalUs = Flags::profile_interval;
 
   int thread_index = 0;
+  Clock::UpdateCoarseMicroseconds();
   uint64 next_preempt = GetNextPreemptTime();
   // If profile is disabled, next_preempt will always be less than next_profile.
   uint64 next_profile =
-      kProfile ? Platform::GetMicroseconds() + kProfileIntervalUs : UINT64_MAX;
+      kProfile ? Clock::CoarseMicroseconds() + kProfileIntervalUs : UINT64_MAX;
   uint64 next_timeout = Utils::Minimum(next_preempt, next_profile);
   while (processes_ > 0) {
     // If we didn't time out, we were interrupted. In that case, continue.
     if (!preempt_monitor_->WaitUntil(next_timeout)) continue;
+    Clock::UpdateCoarseMicroseconds();
 
     bool is_preempt = next_preempt <= next_profile;
     bool is_profile = next_profile <= next_preempt;
@@ -306,6 +346,18 @@ int Scheduler::Run() {
 
   gc_thread_->StopThread();
 
+  if (Flags::print_safepoint_statistics) {
+    ScopedMonitorLock locker(pause_monitor_);
+    safepoint_histogram_.PrintStatistics("Time-to-safepoint", "us");
+  }
+
+  if (Flags::print_exit_statistics) {
+    ScopedLock locker(exit_statistics_mutex_);
+    exit_heap_histogram_.PrintStatistics("Exit heap size", "bytes");
+    exit_copied_histogram_.PrintStatistics("Exit message size", "bytes");
+    exit_time_histogram_.PrintStatistics("Exit message copy time", "us");
+  }
+
   switch (last_process_exit_.load()) {
     case Signal::kTerminated:
       return 0;
@@ -337,6 +389,16 @@ void Scheduler::DeleteTerminatedProcess(Process* process, Signal::Kind kind) {
     ASSERT(gc_thread_ != NULL);
     gc_thread_->TriggerGC(program);
   }
+
+  if (ObjectMemory::HasQueuedChunks()) gc_thread_->TriggerChunkFreeing();
+}
+
+void Scheduler::RecordExit(int heap_size, int copied_size,
+                           uint64 microseconds) {
+  ScopedLock locker(exit_statistics_mutex_);
+  exit_heap_histogram_.Record(heap_size);
+  exit_copied_histogram_.Record(copied_size);
+  exit_time_histogram_.Record(microseconds);
 }
 
 void Scheduler::ExitAtTermination(Process* process, Signal::Kind kind) {
@@ -477,7 +539,7 @@ void Scheduler::ProfileThreadProcess(int thread_id) {
 uint64 Scheduler::GetNextPreemptTime() {
   // Wait between 1 and 100 ms.
   int current_threads = Utils::Maximum<int>(1, thread_count_);
-  uint64 now = Platform::GetMicroseconds();
+  uint64 now = Clock::CoarseMicroseconds();
   return now + Utils::Maximum(1, 100 / current_threads) * 1000L;
 }
 
@@ -556,33 +618,15 @@ void Scheduler::RunInThread() {
       preempt_monitor_->Notify();
       preempt_monitor_->Unlock();
       break;
-    } else if (pause_) {
-      LookupCache* cache = thread_state->cache();
-      if (cache != NULL) cache->Clear();
-
-      // Take lock to be sure StopProgram is waiting.
-      {
-        ScopedMonitorLock locker(pause_monitor_);
-        sleeping_threads_++;
-        pause_monitor_->NotifyAll();
-      }
-      {
-        ScopedMonitorLock idle_locker(thread_state->idle_monitor());
-        while (pause_) thread_state->idle_monitor()->Wait();
-      }
-      {
-        ScopedMonitorLock locker(pause_monitor_);
-        sleeping_threads_--;
-        pause_monitor_->NotifyAll();
-      }
-    } else {
-      RunInterpreterLoop(thread_state);
     }
 
+    RunInterpreterLoop(thread_state);
+    ASSERT(thread_state->safepoint_program() == NULL);
+
     // Sleep until there is something new to execute.
     ScopedMonitorLock scoped_lock(thread_state->idle_monitor());
     while (thread_state->queue()->is_empty() && startup_queue_->is_empty() &&
-           !pause_ && processes_ > 0) {
+           processes_ > 0) {
       PushIdleThread(thread_state);
       // The thread is becoming idle.
       thread_state->idle_monitor()->Wait();
@@ -593,6 +637,42 @@ void Scheduler::RunInThread() {
   ThreadExit(thread_state);
 }
 
+void Scheduler::EnterProgram(ThreadState* thread_state, Program* program) {
+  ASSERT(thread_state->safepoint_program() == NULL);
+  thread_state->set_safepoint_program(program);
+}
+
+void Scheduler::LeaveProgram(ThreadState* thread_state) {
+  Program* program = thread_state->safepoint_program();
+  if (program == NULL) return;
+  thread_state->set_safepoint_program(NULL);
+  // If the program is being stopped, [StopProgram] may be waiting for this
+  // thread to reach the safepoint.
+  if (program->program_state()->is_paused()) {
+    ScopedMonitorLock locker(pause_monitor_);
+    pause_monitor_->NotifyAll();
+  }
+}
+
+bool Scheduler::TryParkProcess(Process* process) {
+  ScopedMonitorLock locker(pause_monitor_);
+  ProgramState* program_state = process->program()->program_state();
+  if (!program_state->is_paused()) return false;
+  process->ChangeState(Process::kRunning, Process::kReady);
+  program_state->AddPausedProcess(process);
+  return true;
+}
+
+void Scheduler::UpdateLookupCache(ThreadState* thread_state) {
+  int epoch = cache_epoch_;
+  if (thread_state->cache_epoch() == epoch) return;
+  LookupCache* cache = thread_state->cache();
+  if (cache != NULL) cache->Clear();
+  ThreadedCodeCache* threaded_cache = thread_state->threaded_cache();
+  if (threaded_cache != NULL) threaded_cache->Clear();
+  thread_state->set_cache_epoch(epoch);
+}
+
 #ifdef FLETCH_ENABLE_MULTIPLE_PROCESS_HEAPS
 
 void Scheduler::RunInterpreterLoop(ThreadState* thread_state) {
@@ -601,7 +681,7 @@ void Scheduler::RunInterpreterLoop(ThreadState* thread_state) {
   SharedHeap* shared_heap = NULL;
   SharedHeap::Part* shared_heap_part = NULL;
 
-  while (!pause_) {
+  while (true) {
     Process* process = NULL;
     DequeueFromThread(thread_state, &process);
     // No more processes for this state, break.
@@ -609,28 +689,44 @@ void Scheduler::RunInterpreterLoop(ThreadState* thread_state) {
 
     while (process != NULL) {
       // If we changed programs, merge the current part back to it's heap
-      // and get a new part from the new program.
+      // and enter the new program.
       if (process->program() != program) {
         if (shared_heap_part != NULL) {
-          if (shared_heap->ReleasePart(shared_heap_part)) {
-            gc_thread_->TriggerImmutableGC(program);
-          }
+          shared_heap->ReleasePart(shared_heap_part);
         }
+        shared_heap_part = NULL;
+        LeaveProgram(thread_state);
         program = process->program();
         shared_heap = program->shared_heap();
+        EnterProgram(thread_state, program);
+      }
+
+      // If the program is being stopped, give the part back and leave the
+      // program, so the stopping thread can reach its safepoint.
+      if (program->program_state()->is_paused() && TryParkProcess(process)) {
+        if (shared_heap_part != NULL) {
+          shared_heap->ReleasePart(shared_heap_part);
+        }
+        shared_heap_part = NULL;
+        LeaveProgram(thread_state);
+        program = NULL;
+        break;
+      }
+
+      // Only take a part once we know the program is not stopped.
+      if (shared_heap_part == NULL) {
         shared_heap_part = shared_heap->AcquirePart();
       }
 
-      // Interpret and trigger GC if interpretation resulted in immutable
-      // allocation failure.
+      UpdateLookupCache(thread_state);
+
+      // Interpret and refill the part if interpretation resulted in immutable
+      // allocation failure. The refill tells us when a GC is due.
       bool allocation_failure = false;
       Process* new_process = InterpretProcess(
           process, shared_heap_part->heap(), thread_state, &allocation_failure);
-      if (allocation_failure) {
-        if (shared_heap->ReleasePart(shared_heap_part)) {
-          gc_thread_->TriggerImmutableGC(program);
-        }
-        shared_heap_part = shared_heap->AcquirePart();
+      if (allocation_failure && shared_heap->RefillPart(shared_heap_part)) {
+        gc_thread_->TriggerImmutableGC(program);
       }
 
       // Possibly switch to a new process.
@@ -640,24 +736,38 @@ void Scheduler::RunInterpreterLoop(ThreadState* thread_state) {
 
   // Always merge remaining immutable heap part back before (possibly) going
   // to sleep.
-  if (shared_heap != NULL && shared_heap->ReleasePart(shared_heap_part)) {
-    gc_thread_->TriggerImmutableGC(program);
-  }
+  if (shared_heap_part != NULL) shared_heap->ReleasePart(shared_heap_part);
+  LeaveProgram(thread_state);
 }
 
 #else  // FLETCH_ENABLE_MULTIPLE_PROCESS_HEAPS
 
 void Scheduler::RunInterpreterLoop(ThreadState* thread_state) {
-  // We use this heap for allocating new immutable objects.
-  while (!pause_) {
+  Program* program = NULL;
+
+  while (true) {
     Process* process = NULL;
     DequeueFromThread(thread_state, &process);
     // No more processes for this state, break.
     if (process == NULL) break;
 
     while (process != NULL) {
+      if (process->program() != program) {
+        LeaveProgram(thread_state);
+        program = process->program();
+        EnterProgram(thread_state, program);
+      }
+
+      if (program->program_state()->is_paused() && TryParkProcess(process)) {
+        LeaveProgram(thread_state);
+        program = NULL;
+        break;
+      }
+
+      UpdateLookupCache(thread_state);
+
       bool allocation_failure = false;
-      Heap* shared_heap = process->program()->shared_heap()->heap();
+      Heap* shared_heap = program->shared_heap()->heap();
 
       Process* new_process = InterpretProcess(
           process, shared_heap, thread_state, &allocation_failure);
@@ -671,6 +781,8 @@ void Scheduler::RunInterpreterLoop(ThreadState* thread_state) {
       process = new_process;
     }
   }
+
+  LeaveProgram(thread_state);
 }
 
 #endif  // FLETCH_ENABLE_MULTIPLE_PROCESS_HEAPS
@@ -728,6 +840,7 @@ Process* Scheduler::InterpretProcess(Process* process, Heap* shared_heap,
 
   // Mark the process as owned by the current thread while interpreting.
   process->set_thread_state(thread_state);
+  process->RecordWakeUp();
   Interpreter interpreter(process);
 
   // Warning: These two lines should not be moved, since the code further down
@@ -735,7 +848,9 @@ Process* Scheduler::InterpretProcess(Process* process, Heap* shared_heap,
   // threads, which would create a race.
   shared_heap->set_random(process->random());
   process->set_immutable_heap(shared_heap);
+  process->StartQuantum();
   interpreter.Run();
+  process->EndQuantum();
   process->set_immutable_heap(NULL);
   shared_heap->set_random(NULL);
 
@@ -751,8 +866,12 @@ Process* Scheduler::InterpretProcess(Process* process, Heap* shared_heap,
   }
 
   if (interpreter.IsYielded()) {
+    // Hibernate while the process is still kRunning. Messages arriving in
+    // the meantime are seen by the mailbox check below.
+    if (process->ShouldHibernate()) process->Hibernate();
     process->ChangeState(Process::kRunning, Process::kYielding);
     if (process->mailbox()->IsEmpty() && process->signal() == NULL) {
+      process->RecordSleep();
       process->ChangeState(Process::kYielding, Process::kSleeping);
     } else {
       process->ChangeState(Process::kYielding, Process::kReady);
@@ -844,6 +963,10 @@ void Scheduler::ThreadEnter(ThreadState* thread_state) {
   int thread_id = thread_count_++;
   ASSERT(thread_id < max_threads_);
   thread_state->set_thread_id(thread_id);
+  thread_state->set_node(topology_->NodeForWorker(thread_id));
+  if (Flags::numa) {
+    NumaTopology::PinCurrentThread(topology_->CpuForWorker(thread_id));
+  }
   threads_[thread_id] = thread_state;
   // Notify pause_monitor_ when changing threads_.
   pause_monitor_->Lock();
@@ -901,15 +1024,6 @@ void Scheduler::ReturnThreadState(ThreadState* thread_state) {
   }
 }
 
-void Scheduler::FlushCacheInThreadStates() {
-  ThreadState* temp = temporary_thread_states_;
-  while (temp != NULL) {
-    LookupCache* cache = temp->cache();
-    if (cache != NULL) cache->Clear();
-    temp = temp->next_idle_thread();
-  }
-}
-
 void Scheduler::DequeueFromThread(ThreadState* thread_state,
                                   Process** process) {
   ASSERT(*process == NULL);
@@ -933,15 +1047,24 @@ bool Scheduler::TryDequeueFromAnyThread(Process** process, int start_id) {
   ASSERT(*process == NULL);
   int count = thread_count_;
   bool should_retry = false;
-  for (int i = start_id; i < count; i++) {
-    ThreadState* thread_state = threads_[i];
+  int node = topology_->NodeForWorker(start_id);
+  bool single_node = topology_->node_count() == 1;
+  // Steal from threads on the same node first, as the heaps of their
+  // processes are likely in memory close to this thread.
+  for (int j = 0; j < count; j++) {
+    ThreadState* thread_state = threads_[(start_id + j) % count];
     if (thread_state == NULL) continue;
+    if (!single_node && thread_state->node() != node) continue;
     if (TryDequeue(thread_state->queue(), process, &should_retry)) return true;
   }
-  for (int i = 0; i < start_id; i++) {
-    ThreadState* thread_state = threads_[i];
-    if (thread_state == NULL) continue;
-    if (TryDequeue(thread_state->queue(), process, &should_retry)) return true;
+  if (!single_node) {
+    for (int j = 0; j < count; j++) {
+      ThreadState* thread_state = threads_[(start_id + j) % count];
+      if (thread_state == NULL || thread_state->node() == node) continue;
+      if (TryDequeue(thread_state->queue(), process, &should_retry)) {
+        return true;
+      }
+    }
   }
   // TODO(ajohnsen): Merge startup_queue_ into the first thread we start, or
   // use it for queing other proceses as well?
@@ -981,6 +1104,17 @@ bool Scheduler::TryEnqueueOnIdleThread(Process* process) {
   return false;
 }
 
+bool Scheduler::TryEnqueueOnThread(Process* process, int thread_id) {
+  ThreadState* thread_state = threads_[thread_id];
+  if (thread_state == NULL) return false;
+  bool was_empty = false;
+  if (!thread_state->queue()->TryEnqueue(process, &was_empty)) return false;
+  if (was_empty && current_processes_[thread_id].load() == NULL) {
+    NotifyThread(thread_state);
+  }
+  return true;
+}
+
 bool Scheduler::EnqueueOnAnyThread(Process* process, int start_id) {
   ASSERT(process->state() == Process::kReady);
   // First try to resume an idle thread.
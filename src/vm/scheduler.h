@@ -7,6 +7,7 @@
 
 #include "src/shared/atomic.h"
 
+#include "src/vm/histogram.h"
 #include "src/vm/signal.h"
 #include "src/vm/thread_pool.h"
 
@@ -14,6 +15,7 @@ namespace fletch {
 
 class GCThread;
 class Heap;
+class NumaTopology;
 class Object;
 class Port;
 class ProcessQueue;
@@ -38,8 +40,17 @@ class Scheduler {
   ~Scheduler();
 
   void ScheduleProgram(Program* program, Process* main_process);
+
+  // Schedule [program] with the [count] processes restored from a checkpoint
+  // (see [CheckpointReader]). The processes in state kReady are enqueued, the
+  // others sleep until they receive a message.
+  void ScheduleRestoredProgram(Program* program, Process** processes,
+                               int count);
   void UnscheduleProgram(Program* program);
 
+  // Bring all threads executing processes of [program] to a safepoint and
+  // keep the program's processes from running until [ResumeProgram] is
+  // called. Threads running other programs are not stopped.
   void StopProgram(Program* program);
   void ResumeProgram(Program* program);
 
@@ -63,6 +74,11 @@ class Scheduler {
   // nothing. This function is thread safe.
   void ResumeProcess(Process* process);
 
+  // Resume a process like [ResumeProcess], but prefer running it on the worker
+  // thread [thread_id] (modulo the number of threads) if that thread accepts
+  // it without waiting.
+  void ResumeProcessOn(Process* process, int thread_id);
+
   // Continue a process that is stopped at a break point.
   void ContinueProcess(Process* process);
 
@@ -88,21 +104,49 @@ class Scheduler {
 
   size_t process_count() const { return processes_; }
 
+  int max_threads() const { return max_threads_; }
+
+  // Time it took for StopProgram to bring all threads of the program to a
+  // safepoint, in microseconds. Guarded by [pause_monitor_].
+  const Histogram* safepoint_histogram() const { return &safepoint_histogram_; }
+
+  // Record the cost of sending the exit message of a process whose heap
+  // held [heap_size] bytes, of which [copied_size] were copied.
+  void RecordExit(int heap_size, int copied_size, uint64 microseconds);
+
  private:
   const int max_threads_;
   ThreadPool thread_pool_;
   Monitor* preempt_monitor_;
   Atomic<int> processes_;
-  Atomic<int> sleeping_threads_;
   Atomic<int> thread_count_;
   Atomic<ThreadState*> idle_threads_;
   Atomic<ThreadState*>* threads_;
   Atomic<ThreadState*> temporary_thread_states_;
   ProcessQueue* startup_queue_;
+  NumaTopology* topology_;
 
   Monitor* pause_monitor_;
   Atomic<Signal::Kind> last_process_exit_;
-  Atomic<bool> pause_;
+
+  // The number of [ResumeProcessOn] calls that may be enqueuing a process on
+  // a ready queue without holding [pause_monitor_]. [StopProgram] waits for
+  // them before it takes the processes out of the ready queues.
+  Atomic<int> unlocked_resumes_;
+
+  // Bumped every time a program is stopped. Threads clear their lookup and
+  // threaded code caches before interpreting a process if they have seen an
+  // older epoch, as the stopped program may have moved or changed its classes
+  // and methods. The caches of a thread state, also of a pooled one, are only
+  // ever cleared by the thread using it.
+  Atomic<int> cache_epoch_;
+  Histogram safepoint_histogram_;
+
+  // Exit message statistics, guarded by [exit_statistics_mutex_].
+  Mutex* exit_statistics_mutex_;
+  Histogram exit_heap_histogram_;
+  Histogram exit_copied_histogram_;
+  Histogram exit_time_histogram_;
 
   // A list of currently executed processes, indexable by thread id. Upon
   // preemption, the value may be set to kPreemptMarker if it's NULL (which is
@@ -129,6 +173,17 @@ class Scheduler {
   void EnqueueProcessAndNotifyThreads(ThreadState* thread_state,
                                       Process* process);
 
+  // Safepoint protocol. A thread announces the program it is about to run
+  // processes of through [ThreadState::safepoint_program] before it checks
+  // whether the program is paused, and clears it again when it is done.
+  void EnterProgram(ThreadState* thread_state, Program* program);
+  void LeaveProgram(ThreadState* thread_state);
+  // Move the [process] (which must be kRunning) to the list of paused
+  // processes if its program is paused. Returns false if the program was
+  // resumed in the meantime.
+  bool TryParkProcess(Process* process);
+  void UpdateLookupCache(ThreadState* thread_state);
+
   void PushIdleThread(ThreadState* thread_state);
   ThreadState* PopIdleThread();
   void RunInThread();
@@ -147,20 +202,23 @@ class Scheduler {
 
   ThreadState* TakeThreadState();
   void ReturnThreadState(ThreadState* thread_state);
-  void FlushCacheInThreadStates();
 
   // Dequeue from [thread_state]. If [process] is [NULL] after a call to
   // DequeueFromThread, the [thread_state] is empty. Note that DequeueFromThread
   // may dequeue a process from another ThreadState.
   void DequeueFromThread(ThreadState* thread_state, Process** process);
   // Returns true if it was able to dequeue a process, or all thread_states were
-  // empty. Returns false if the operation should be retried.
+  // empty. Returns false if the operation should be retried. The threads on
+  // the NUMA node of [start_id] are tried before the others.
   bool TryDequeueFromAnyThread(Process** process, int start_id = 0);
   void EnqueueOnThread(ThreadState* thread_state, Process* process);
   // Returns true if it was able to enqueue the process on an idle thread.
   bool TryEnqueueOnIdleThread(Process* process);
   // Returns true if it was able to enqueue the process on an idle thread.
   bool EnqueueOnAnyThread(Process* process, int start_id = 0);
+  // Returns true if it was able to enqueue the process on the thread
+  // [thread_id] without waiting.
+  bool TryEnqueueOnThread(Process* process, int thread_id);
 
   // The [process] will be enqueued on any thread. In case the program is paused
   // the process will be enqueued once the program is resumed.
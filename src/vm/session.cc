@@ -865,10 +865,9 @@ bool Session::WriteSnapshot(const char* path,
   program()->set_main_arity(Smi::cast(Pop())->value());
   // Make sure that the program is in the compact form before
   // snapshotting.
-  if (!program()->is_compact()) {
-    ProgramFolder program_folder(program());
-    program_folder.Fold();
-  }
+  ProgramFolder program_folder(program());
+  if (!program()->is_compact()) program_folder.Fold();
+  if (Flags::tree_shake) program_folder.Shake();
 
   SnapshotWriter writer(function_offsets, class_offsets);
   List<uint8> snapshot = writer.WriteProgram(program());
@@ -1198,6 +1197,9 @@ void Session::ChangeMethodTable(int length) {
 void Session::CommitChangeMethodTable(PostponedChange* change) {
   Class* clazz = Class::cast(change->get(1));
   Array* methods = Array::cast(change->get(2));
+  if (clazz->has_methods()) {
+    program()->profile()->RemoveReplaced(clazz->methods(), methods);
+  }
   clazz->set_methods(methods);
 }
 
@@ -1210,6 +1212,11 @@ void Session::CommitChangeMethodLiteral(PostponedChange* change) {
   Function* function = Function::cast(change->get(1));
   Object* literal = change->get(2);
   int index = Smi::cast(change->get(3))->value();
+  // A replaced static method is only referenced from the literals.
+  Object* old_literal = function->literal_at(index);
+  if (old_literal->IsFunction() && old_literal != literal) {
+    program()->profile()->Remove(Function::cast(old_literal));
+  }
   function->set_literal_at(index, literal);
 }
 
@@ -1506,6 +1513,10 @@ class TransformInstancesProcessVisitor : public ProcessVisitor {
     // the program space / to the process heap objects which were transformed.
     process->TakeChildHeaps();
 
+    // Instances in an open message arena are transformed as part of the
+    // shared heap.
+    process->CloseMessageArena(shared_heap_->heap());
+
     Heap* heap = process->heap();
 
     Space* space = heap->space();
@@ -12,37 +12,35 @@ namespace fletch {
 
 SharedHeap::SharedHeap()
     : number_of_hw_threads_(Platform::GetNumberOfHardwareThreads()),
-      heap_mutex_(Platform::CreateMutex()),
       heap_(new Space(), reinterpret_cast<WeakPointer*>(NULL)),
       outstanding_parts_(0),
       unmerged_parts_(NULL),
       allocation_limit_(0),
-      unmerged_allocated_(0),
-      outstanding_parts_allocated_(0),
-      outstanding_parts_budget_(0) {
+      initial_part_budget_(0),
+      reserved_(0),
+      gc_requested_(false) {
   UpdateLimitAfterGC(0);
 }
 
 SharedHeap::~SharedHeap() {
-  delete heap_mutex_;
-
-  while (HasUnmergedParts()) {
-    delete RemoveUnmergedPart();
+  Part* current = TakeUnmergedParts();
+  while (current != NULL) {
+    Part* next = current->next();
+    delete current;
+    current = next;
   }
 }
 
-void SharedHeap::AddUnmergedPart(Part* part) {
-  part->set_next(unmerged_parts_);
-  unmerged_parts_ = part;
+void SharedHeap::PushUnmergedParts(Part* first, Part* last) {
+  Part* head = unmerged_parts_;
+  do {
+    last->set_next(head);
+  } while (!unmerged_parts_.compare_exchange_weak(head, first));
 }
 
-SharedHeap::Part* SharedHeap::RemoveUnmergedPart() {
-  Part* part = unmerged_parts_;
-  if (part == NULL) return NULL;
-
-  unmerged_parts_ = part->next();
-  part->set_next(NULL);
-  return part;
+int SharedHeap::MaximumPartBudget() {
+  return Utils::Maximum(MinimumPartBudget(),
+                        allocation_limit_ / number_of_hw_threads_);
 }
 
 void SharedHeap::UpdateLimitAfterGC(int mutable_size_at_last_gc) {
@@ -70,58 +68,34 @@ void SharedHeap::UpdateLimitAfterGC(int mutable_size_at_last_gc) {
   // heap size (preferable the number of pointers to immutable space - the
   // size of the root set).
   allocation_limit_ = Utils::Maximum(limit, mutable_size_at_last_gc / 10);
+
+  reserved_ = 0;
+  gc_requested_ = false;
 }
 
 int SharedHeap::EstimatedUsed() {
-  ScopedLock locker(heap_mutex_);
-
-  int merged_used = heap_.UsedTotal();
-
-  int unmerged_used = 0;
-  Part* current = unmerged_parts_;
-  while (current != NULL) {
-    unmerged_used += current->heap()->UsedTotal();
-    current = current->next();
-  }
-
-  // This overapproximates used memory of outstanding parts.
-  int outstanding_used =
-      outstanding_parts_allocated_ + outstanding_parts_budget_;
-
-  return merged_used + unmerged_used + outstanding_used;
+  // Parts cannot be merged while processes of the program are running, so
+  // the merged heap is stable here.
+  return heap_.UsedTotal() + reserved_;
 }
 
 int SharedHeap::EstimatedSize() {
-  ScopedLock locker(heap_mutex_);
-
-  int merged_size = heap_.space()->Size();
-
-  int unmerged_size = 0;
-  Part* current = unmerged_parts_;
-  while (current != NULL) {
-    unmerged_size += current->heap()->space()->Size();
-    current = current->next();
-  }
-
-  // This overapproximates used memory of outstanding parts.
-  int outstanding_size =
-      outstanding_parts_allocated_ + outstanding_parts_budget_;
-
-  return merged_size + unmerged_size + outstanding_size;
+  return heap_.space()->Size() + reserved_;
 }
 
 void SharedHeap::MergeParts() {
-  ScopedLock locker(heap_mutex_);
-
   ASSERT(outstanding_parts_ == 0);
-  ASSERT(outstanding_parts_allocated_ == 0);
-  ASSERT(outstanding_parts_budget_ == 0);
-  while (HasUnmergedParts()) {
-    Part* part = RemoveUnmergedPart();
-    heap_.MergeInOtherHeap(part->heap());
-    delete part;
+
+  int largest_budget = 0;
+  Part* current = TakeUnmergedParts();
+  while (current != NULL) {
+    Part* next = current->next();
+    largest_budget = Utils::Maximum(largest_budget, current->budget());
+    heap_.MergeInOtherHeap(current->heap());
+    delete current;
+    current = next;
   }
-  unmerged_allocated_ = 0;
+  if (largest_budget > 0) initial_part_budget_ = largest_budget;
 }
 
 void SharedHeap::IterateProgramPointers(PointerVisitor* visitor) {
@@ -132,46 +106,67 @@ void SharedHeap::IterateProgramPointers(PointerVisitor* visitor) {
 }
 
 SharedHeap::Part* SharedHeap::AcquirePart() {
-  ScopedLock locker(heap_mutex_);
-
-  int budget = allocation_limit_ / number_of_hw_threads_;
-
-  Part* part;
-  if (HasUnmergedParts()) {
-    part = RemoveUnmergedPart();
-    part->heap()->space()->SetAllocationBudget(budget);
-    part->set_budget(budget);
-    part->ResetUsed();
+  Part* part = TakeUnmergedParts();
+  if (part != NULL) {
+    // Keep the first part and give the rest back.
+    Part* rest = part->next();
+    part->set_next(NULL);
+    if (rest != NULL) {
+      Part* last = rest;
+      while (last->next() != NULL) last = last->next();
+      PushUnmergedParts(rest, last);
+    }
   } else {
-    part = new Part(NULL, budget);
+    int budget = initial_part_budget_;
+    if (budget == 0) budget = MaximumPartBudget() / 4;
+    budget = Utils::Maximum(MinimumPartBudget(),
+                            Utils::Minimum(budget, MaximumPartBudget()));
+    part = new Part(budget);
   }
 
-  outstanding_parts_allocated_ += part->used();
-  outstanding_parts_budget_ += part->budget();
+  int budget = part->budget();
+  part->heap()->space()->SetAllocationBudget(budget);
+  part->last_refill_ = Platform::GetMonotonicMicroseconds();
+  reserved_ += budget;
 
   outstanding_parts_++;
   return part;
 }
 
-bool SharedHeap::ReleasePart(Part* part) {
-  ScopedLock locker(heap_mutex_);
+bool SharedHeap::RefillPart(Part* part) {
+  // Adapt the budget to how fast the owning thread used up the last one, so
+  // threads that allocate a lot come back here less often and threads that
+  // allocate little do not hold on to memory they do not need.
+  uint64 now = Platform::GetMonotonicMicroseconds();
+  uint64 elapsed = now - part->last_refill_;
+  int budget = part->budget();
+  if (elapsed < static_cast<uint64>(kFastRefillMicroseconds)) {
+    budget *= 2;
+  } else if (elapsed > static_cast<uint64>(kSlowRefillMicroseconds)) {
+    budget /= 2;
+  }
+  budget = Utils::Maximum(MinimumPartBudget(),
+                          Utils::Minimum(budget, MaximumPartBudget()));
+
+  part->set_budget(budget);
+  part->last_refill_ = now;
+  part->heap()->space()->SetAllocationBudget(budget);
+
+  int reserved = (reserved_ += budget);
+  return reserved >= allocation_limit_ && !gc_requested_.exchange(true);
+}
+
+void SharedHeap::ReleasePart(Part* part) {
   ASSERT(outstanding_parts_ > 0);
-  outstanding_parts_--;
 
   part->heap()->Flush();
 
-  int limit = allocation_limit_;
-  int diff = part->NewlyAllocated();
-  ASSERT(diff >= 0);
-  int new_allocated_memory = unmerged_allocated_ + diff;
-  bool gc = unmerged_allocated_ < limit && limit <= new_allocated_memory;
-  unmerged_allocated_ = new_allocated_memory;
-
-  outstanding_parts_allocated_ -= part->used();
-  outstanding_parts_budget_ -= part->budget();
-  AddUnmergedPart(part);
+  // Give back the budget the part did not use.
+  int unused = part->heap()->space()->allocation_budget();
+  if (unused > 0) reserved_ -= unused;
 
-  return gc;
+  outstanding_parts_--;
+  PushUnmergedParts(part, part);
 }
 
 #else  // #ifdef FLETCH_ENABLE_MULTIPLE_PROCESS_HEAPS
@@ -5,6 +5,7 @@
 #ifndef SRC_VM_SHARED_HEAP_H_
 #define SRC_VM_SHARED_HEAP_H_
 
+#include "src/shared/atomic.h"
 #include "src/shared/globals.h"
 #include "src/vm/heap.h"
 
@@ -14,50 +15,64 @@ namespace fletch {
 
 class SharedHeap {
  public:
+  // A part is a thread-local allocation buffer in the shared heap. A scheduler
+  // thread owns at most one part of a given program at a time and allocates
+  // immutable objects into it without any synchronization. When the budget
+  // of a part is used up, the thread refills it through [RefillPart], which
+  // only touches atomic counters.
   class Part {
    public:
-    Part(Part* next, int budget)
+    explicit Part(int budget)
         : heap_(NULL, budget),
           budget_(budget),
-          used_original_(0),
-          next_(next) {}
+          last_refill_(0),
+          next_(NULL) {}
 
     Heap* heap() { return &heap_; }
 
+    // The budget handed out with the last refill. It adapts to the
+    // allocation rate of the thread owning the part.
     int budget() { return budget_; }
     void set_budget(int new_budget) { budget_ = new_budget; }
 
-    int used() { return used_original_; }
-
-    void ResetUsed() { used_original_ = heap_.UsedTotal(); }
-
-    int NewlyAllocated() { return heap_.UsedTotal() - used_original_; }
-
     Part* next() { return next_; }
     void set_next(Part* next) { next_ = next; }
 
    private:
+    friend class SharedHeap;
+
     Heap heap_;
     int budget_;
-    int used_original_;
+    uint64 last_refill_;
     Part* next_;
   };
 
+  // Refilling a part faster than this doubles its budget, refilling it slower
+  // than [kSlowRefillMicroseconds] halves it.
+  static const int kFastRefillMicroseconds = 1000;
+  static const int kSlowRefillMicroseconds = 10000;
+
   SharedHeap();
   ~SharedHeap();
 
-  // Will return a [Heap] which will have an allocation budget which is
-  // `known_live_memory / number_of_hw_threads_`. This is an approximation of a
-  // 2x growth strategy.
+  // Will return a part that is not used by any other thread. Parts that were
+  // released earlier are reused, keeping the budget they had adapted to.
   //
-  // TODO(kustermann): instead of `number_of_hw_threads_` we could make this
-  // better by keeping track of the current number of used scheduler threads.
+  // This function is lock-free.
   Part* AcquirePart();
 
-  // Will return `true` if the caller should trigger a GC.
+  // Hand out a new allocation budget to a part whose budget has been used up.
+  // Will return `true` if the caller should trigger a GC, which happens once
+  // the budgets handed out since the last GC exceed the allocation limit.
   //
-  // It is assumed that this function is only called on allocation failures.
-  bool ReleasePart(Part* part);
+  // This function is lock-free.
+  bool RefillPart(Part* part);
+
+  // Give a part back to the shared heap. It will be merged into the
+  // accumulated shared heap by the next [MergeParts].
+  //
+  // This function is lock-free.
+  void ReleasePart(Part* part);
 
   // Merges all parts which have been acquired and subsequently released into
   // the accumulated shared heap.
@@ -83,38 +98,46 @@ class SharedHeap {
   //   * all cached parts were merged via [MergeParts]
   void UpdateLimitAfterGC(int mutable_size_at_last_gc);
 
-  // The number of used bytes at the moment. Note that this is an over
-  // approximation.
+  // The number of used bytes at the moment. Note that this is an
+  // approximation based on the budgets handed out to parts.
   int EstimatedUsed();
 
   // The total size of the shared heap at the moment. Note that this is an
-  // over approximation.
+  // approximation based on the budgets handed out to parts.
   int EstimatedSize();
 
  private:
-  bool HasUnmergedParts() { return unmerged_parts_ != NULL; }
-  void AddUnmergedPart(Part* part);
-  Part* RemoveUnmergedPart();
+  // Lock-free stack of released parts. Parts are only ever pushed, or the
+  // whole stack is taken at once, so there is no ABA problem.
+  void PushUnmergedParts(Part* first, Part* last);
+  Part* TakeUnmergedParts() { return unmerged_parts_.exchange(NULL); }
+
+  // The budget range for a single part.
+  int MinimumPartBudget() { return Space::kDefaultMinimumChunkSize; }
+  int MaximumPartBudget();
 
   int number_of_hw_threads_;
 
-  Mutex* heap_mutex_;
   Heap heap_;
-  int outstanding_parts_;
-  Part* unmerged_parts_;
+  Atomic<int> outstanding_parts_;
+  Atomic<Part*> unmerged_parts_;
 
-  // The limit of bytes we give out before a GC should happen.
+  // The limit of bytes we give out before a GC should happen. Only changed
+  // while the program is stopped.
   int allocation_limit_;
 
-  // The amount of memory consumed by unmerged parts.
-  int unmerged_allocated_;
+  // The budget new parts start out with. It is the largest budget any part
+  // had adapted to when the parts were last merged.
+  int initial_part_budget_;
 
-  // The allocated memory and budget of all outstanding parts.
-  //
-  // Adding these two number gives an overapproximation of used memory by
-  // oustanding parts.
-  int outstanding_parts_allocated_;
-  int outstanding_parts_budget_;
+  // The sum of all budgets handed out to parts since the last GC, minus the
+  // budget given back when releasing parts. This approximates the memory
+  // allocated in parts.
+  Atomic<int> reserved_;
+
+  // Set once a GC has been requested, so only one caller of [RefillPart] is
+  // told to trigger it.
+  Atomic<bool> gc_requested_;
 };
 
 #else  // #ifdef FLETCH_ENABLE_MULTIPLE_PROCESS_HEAPS
@@ -0,0 +1,52 @@
+// Copyright (c) 2015, the Fletch project authors. Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE.md file.
+
+#include "src/shared/assert.h"
+#include "src/shared/test_case.h"
+
+#include "src/vm/shared_heap.h"
+
+namespace fletch {
+
+#ifdef FLETCH_ENABLE_MULTIPLE_PROCESS_HEAPS
+
+TEST_CASE(SharedHeap_RefillPart) {
+  SharedHeap shared_heap;
+
+  SharedHeap::Part* part = shared_heap.AcquirePart();
+  int budget = part->budget();
+  EXPECT(budget >= Space::kDefaultMinimumChunkSize);
+  EXPECT(!part->heap()->space()->needs_garbage_collection());
+
+  // Refilling never shrinks the budget of a part that is refilled quickly.
+  bool gc = shared_heap.RefillPart(part);
+  EXPECT(part->budget() >= budget);
+
+  // Keep refilling until the limit is crossed. Only one refill asks for a GC.
+  for (int i = 0; i < 1000 && !gc; i++) gc = shared_heap.RefillPart(part);
+  EXPECT(gc);
+  EXPECT(!shared_heap.RefillPart(part));
+
+  shared_heap.ReleasePart(part);
+
+  // Released parts are reused before they are merged.
+  SharedHeap::Part* reused = shared_heap.AcquirePart();
+  EXPECT_EQ(part, reused);
+  shared_heap.ReleasePart(reused);
+
+  shared_heap.MergeParts();
+  shared_heap.UpdateLimitAfterGC(0);
+
+  // After a GC, a new GC is requested once the limit is crossed again.
+  part = shared_heap.AcquirePart();
+  gc = false;
+  for (int i = 0; i < 1000 && !gc; i++) gc = shared_heap.RefillPart(part);
+  EXPECT(gc);
+  shared_heap.ReleasePart(part);
+  shared_heap.MergeParts();
+}
+
+#endif  // FLETCH_ENABLE_MULTIPLE_PROCESS_HEAPS
+
+}  // namespace fletch
@@ -72,8 +72,12 @@ class Header {
             Function::BytecodeAllocationSize(elements()));
       case InstanceFormat::DOUBLE_TYPE:
         return Double::AllocationSize();
+      case InstanceFormat::BOXED_TYPE:
+        return Boxed::AllocationSize();
       case InstanceFormat::INITIALIZER_TYPE:
         return Initializer::AllocationSize();
+      case InstanceFormat::STACK_TYPE:
+        return Stack::AllocationSize(elements());
       default:
         UNREACHABLE();
         return 0;
@@ -298,33 +302,24 @@ Program* SnapshotReader::ReadProgram() {
   }
   delete[] snapshot_version;
 
-  // Read the required backward reference table size.
-  int references = 0;
-  for (int i = 0; i < kReferenceTableSizeBytes; i++) {
-    references = (references << 8) | ReadByte();
-  }
+  // Read the required backward reference table size and allocate space for
+  // the backward references.
+  ReadReferenceCount();
 
   Program* program = new Program(Program::kLoadedFromSnapshot);
 
   // Read the heap size and allocate an area for it.
-  int size_position;
-  if (kPointerSize == 8 && sizeof(fletch_double) == 8) {
-    size_position = position_ + 0 * kHeapSizeBytes;
-  } else if (kPointerSize == 8 && sizeof(fletch_double) == 4) {
-    size_position = position_ + 1 * kHeapSizeBytes;
-  } else if (kPointerSize == 4 && sizeof(fletch_double) == 8) {
-    size_position = position_ + 2 * kHeapSizeBytes;
-  } else {
-    ASSERT(kPointerSize == 4 && sizeof(fletch_double) == 4);
-    size_position = position_ + 3 * kHeapSizeBytes;
-  }
-  position_ += 4 * kHeapSizeBytes;
-  int heap_size = ReadHeapSizeFrom(size_position);
+  int heap_size = ReadHeapSize();
   memory_ = ObjectMemory::AllocateChunk(program->heap()->space(), heap_size);
   top_ = memory_->base();
 
-  // Allocate space for the backward references.
-  backward_references_ = List<HeapObject*>::New(references);
+  // Read the profiled functions, hottest first. They keep their order in
+  // the profile of the new program.
+  int profiled = ReadInt64();
+  for (int i = 0; i < profiled; i++) {
+    Function* function = Function::cast(ReadObject());
+    program->profile()->Record(function, profiled - i);
+  }
 
   // Read all the program state (except roots).
   program->set_entry(Function::cast(ReadObject()));
@@ -370,15 +365,16 @@ List<uint8> SnapshotWriter::WriteProgram(Program* program) {
   WriteBytes(version_length, reinterpret_cast<const uint8*>(version));
 
   // Reserve space for the backward reference table size.
-  int reference_count_position = position_;
-  for (int i = 0; i < kReferenceTableSizeBytes; i++) WriteByte(0);
+  int reference_count_position = ReserveReferenceCount();
 
   // Reserve space for the size of the heap.
-  int size64_double_position = position_ + 0 * kHeapSizeBytes;
-  int size64_float_position = position_ + 1 * kHeapSizeBytes;
-  int size32_double_position = position_ + 2 * kHeapSizeBytes;
-  int size32_float_position = position_ + 3 * kHeapSizeBytes;
-  for (int i = 0; i < 4 * kHeapSizeBytes; i++) WriteByte(0);
+  int heap_size_position = ReserveHeapSizes();
+
+  // Write the profiled functions first, so they are allocated next to each
+  // other when the snapshot is read.
+  WriteInt64(program->profile()->length());
+  WriterVisitor profile_visitor(this);
+  program->profile()->IteratePointers(&profile_visitor);
 
   // Write all the program state (except roots).
   WriteObject(program->entry());
@@ -397,21 +393,14 @@ List<uint8> SnapshotWriter::WriteProgram(Program* program) {
   // only unmark the roots.
   UnmarkVisitor unmarker;
   program->IterateRoots(&unmarker);
+  program->profile()->IteratePointers(&unmarker);
 
   // Write out the required size of the backward reference table
   // at the beginning of the snapshot.
-  int references = index_ - 1;
-  for (int i = kReferenceTableSizeBytes - 1; i >= 0; i--) {
-    snapshot_[reference_count_position + i] = references & 0xFF;
-    references >>= 8;
-  }
-  ASSERT(references == 0);
+  WriteReferenceCount(reference_count_position);
 
   // Write the size of the heap.
-  WriteHeapSizeTo(size64_double_position, heap_size_.offset_64bits_double);
-  WriteHeapSizeTo(size64_float_position, heap_size_.offset_64bits_float);
-  WriteHeapSizeTo(size32_double_position, heap_size_.offset_32bits_double);
-  WriteHeapSizeTo(size32_float_position, heap_size_.offset_32bits_float);
+  WriteHeapSizes(heap_size_position, PortableOffset());
 
   return snapshot_.Sublist(0, position_);
 }
@@ -432,8 +421,10 @@ Object* SnapshotReader::ReadObject() {
     integer->set_value(header.as_large_integer_value());
     return object;
   } else if (header.is_index()) {
-    // The header word indicates that this is a backreference.
+    // The header word indicates that this is a backreference, or a reference
+    // to an object the snapshot does not contain.
     word index = header.as_index();
+    if (index > 0) return ReferenceAt(index - 1);
     ASSERT(index < 0);
     return Dereference(-index);
   }
@@ -482,11 +473,17 @@ Object* SnapshotReader::ReadObject() {
     case InstanceFormat::INSTANCE_TYPE:
       reinterpret_cast<Instance*>(object)->InstanceReadFrom(this, elements);
       break;
+    case InstanceFormat::BOXED_TYPE:
+      reinterpret_cast<Boxed*>(object)->BoxedReadFrom(this);
+      break;
     case InstanceFormat::INITIALIZER_TYPE: {
       Initializer* initializer = reinterpret_cast<Initializer*>(object);
       initializer->InitializerReadFrom(this);
       break;
     }
+    case InstanceFormat::STACK_TYPE:
+      reinterpret_cast<Stack*>(object)->StackReadFrom(this, elements);
+      break;
     default:
       UNIMPLEMENTED();
   }
@@ -509,6 +506,13 @@ void SnapshotWriter::WriteObject(Object* object) {
   }
 
   HeapObject* heap_object = HeapObject::cast(object);
+  // Then check if the object is referred to rather than written.
+  int reference = ReferenceIndexFor(heap_object);
+  if (reference >= 0) {
+    WriteInt64(Header::FromIndex(reference + 1).as_word());
+    return;
+  }
+
   // Then check possible backward reference.
   word f = heap_object->forwarding_word();
   if (f != 0) {
@@ -578,18 +582,54 @@ void SnapshotWriter::WriteObject(Object* object) {
       d->DoubleWriteTo(this, klass);
       break;
     }
+    case InstanceFormat::BOXED_TYPE: {
+      Boxed* boxed = Boxed::cast(object);
+      heap_size_ += boxed->CalculatePortableSize();
+      boxed->BoxedWriteTo(this, klass);
+      break;
+    }
     case InstanceFormat::INITIALIZER_TYPE: {
       Initializer* initializer = Initializer::cast(object);
       heap_size_ += initializer->CalculatePortableSize();
       initializer->InitializerWriteTo(this, klass);
       break;
     }
+    case InstanceFormat::STACK_TYPE: {
+      Stack* stack = Stack::cast(object);
+      heap_size_ += stack->CalculatePortableSize();
+      stack->StackWriteTo(this, klass);
+      break;
+    }
     default:
       // Unable to handle this type of object.
       UNREACHABLE();
   }
 }
 
+void SnapshotReader::ReadReferenceCount() {
+  int references = 0;
+  for (int i = 0; i < kReferenceTableSizeBytes; i++) {
+    references = (references << 8) | ReadByte();
+  }
+  backward_references_ = List<HeapObject*>::New(references);
+}
+
+int SnapshotReader::ReadHeapSize() {
+  int size_position;
+  if (kPointerSize == 8 && sizeof(fletch_double) == 8) {
+    size_position = position_ + 0 * kHeapSizeBytes;
+  } else if (kPointerSize == 8 && sizeof(fletch_double) == 4) {
+    size_position = position_ + 1 * kHeapSizeBytes;
+  } else if (kPointerSize == 4 && sizeof(fletch_double) == 8) {
+    size_position = position_ + 2 * kHeapSizeBytes;
+  } else {
+    ASSERT(kPointerSize == 4 && sizeof(fletch_double) == 4);
+    size_position = position_ + 3 * kHeapSizeBytes;
+  }
+  position_ += 4 * kHeapSizeBytes;
+  return ReadHeapSizeFrom(size_position);
+}
+
 int SnapshotReader::ReadHeapSizeFrom(int position) {
   int size = 0;
   for (int i = 0; i < kHeapSizeBytes; i++) {
@@ -598,6 +638,38 @@ int SnapshotReader::ReadHeapSizeFrom(int position) {
   return size;
 }
 
+int SnapshotWriter::ReserveReferenceCount() {
+  int position = position_;
+  for (int i = 0; i < kReferenceTableSizeBytes; i++) WriteByte(0);
+  return position;
+}
+
+void SnapshotWriter::WriteReferenceCount(int position) {
+  int references = index_ - 1;
+  for (int i = kReferenceTableSizeBytes - 1; i >= 0; i--) {
+    snapshot_[position + i] = references & 0xFF;
+    references >>= 8;
+  }
+  ASSERT(references == 0);
+}
+
+int SnapshotWriter::ReserveHeapSizes() {
+  int position = position_;
+  for (int i = 0; i < 4 * kHeapSizeBytes; i++) WriteByte(0);
+  return position;
+}
+
+void SnapshotWriter::WriteHeapSizes(int position, const PortableOffset& start) {
+  WriteHeapSizeTo(position + 0 * kHeapSizeBytes,
+                  heap_size_.offset_64bits_double - start.offset_64bits_double);
+  WriteHeapSizeTo(position + 1 * kHeapSizeBytes,
+                  heap_size_.offset_64bits_float - start.offset_64bits_float);
+  WriteHeapSizeTo(position + 2 * kHeapSizeBytes,
+                  heap_size_.offset_32bits_double - start.offset_32bits_double);
+  WriteHeapSizeTo(position + 3 * kHeapSizeBytes,
+                  heap_size_.offset_32bits_float - start.offset_32bits_float);
+}
+
 void SnapshotWriter::WriteHeapSizeTo(int position, int size) {
   for (int i = kHeapSizeBytes - 1; i >= 0; i--) {
     snapshot_[position + i] = size & 0xFF;
@@ -610,6 +682,14 @@ Class* SnapshotWriter::ClassFor(HeapObject* object) {
   return object->raw_class();
 }
 
+void SnapshotWriter::Unforward(HeapObject* object) {
+  word f = object->forwarding_word();
+  if (f == 0) return;
+  ObjectInfo* info = reinterpret_cast<ObjectInfo*>(f);
+  object->set_class(info->the_class());
+  delete info;
+}
+
 void SnapshotWriter::Forward(HeapObject* object) {
   Class* klass = ClassFor(object);
   ObjectInfo* info = new ObjectInfo(object->raw_class(), index_++);
@@ -767,6 +847,18 @@ void Double::DoubleReadFrom(SnapshotReader* reader) {
   set_value(reader->ReadDouble());
 }
 
+void Boxed::BoxedWriteTo(SnapshotWriter* writer, Class* klass) {
+  // Header.
+  writer->WriteHeader(InstanceFormat::BOXED_TYPE);
+  writer->Forward(this);
+  // Body.
+  writer->WriteObject(value());
+}
+
+void Boxed::BoxedReadFrom(SnapshotReader* reader) {
+  set_value(reader->ReadObject());
+}
+
 void Initializer::InitializerWriteTo(SnapshotWriter* writer, Class* klass) {
   // Header.
   writer->WriteHeader(InstanceFormat::INITIALIZER_TYPE);
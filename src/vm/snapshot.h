@@ -61,7 +61,7 @@ class SnapshotReader {
         memory_(NULL),
         top_(0),
         index_(0) {}
-  ~SnapshotReader() {}
+  virtual ~SnapshotReader() {}
 
   // Reads an entire program.
   Program* ReadProgram();
@@ -70,6 +70,13 @@ class SnapshotReader {
   // Read the next object from the snapshot.
   Object* ReadObject();
 
+  // Checkpoints refer to the objects of the program instead of containing
+  // them (see CheckpointReader). Returns the object referred to by [index].
+  virtual HeapObject* ReferenceAt(int index) {
+    UNREACHABLE();
+    return NULL;
+  }
+
   // Helpers for reading primitives. Only accessible from the
   // objects that need to read themselves from a snapshot.
   uint8 ReadByte() { return snapshot_[position_++]; }
@@ -81,6 +88,14 @@ class SnapshotReader {
   void AddReference(HeapObject* object);
   HeapObject* Dereference(int index);
 
+  // Reads the table size written by [SnapshotWriter::WriteReferenceCount]
+  // and allocates the backward reference table.
+  void ReadReferenceCount();
+
+  // Reads the heap sizes written by [SnapshotWriter::WriteHeapSizes] and
+  // returns the one for this configuration.
+  int ReadHeapSize();
+
   friend class ByteArray;
   friend class Class;
   friend class Function;
@@ -91,10 +106,11 @@ class SnapshotReader {
   friend class TwoByteString;
   friend class LargeInteger;
   friend class Double;
+  friend class Boxed;
   friend class Initializer;
   friend class ReaderVisitor;
+  friend class Stack;
 
- private:
   List<uint8> snapshot_;
   int position_;
 
@@ -114,6 +130,7 @@ class SnapshotReader {
     return result;
   }
 
+ private:
   int ReadHeapSizeFrom(int position);
 };
 
@@ -126,12 +143,33 @@ class SnapshotWriter {
         index_(1),
         function_offsets_(function_offsets),
         class_offsets_(class_offsets) {}
-  ~SnapshotWriter() {}
+  virtual ~SnapshotWriter() {}
 
   // Create a snapshot of a program. The program must be folded.
   List<uint8> WriteProgram(Program* program);
 
  protected:
+  // Checkpoints refer to the objects of the program instead of containing
+  // them (see CheckpointWriter). Returns the index to refer to [object] by,
+  // or -1 if the object is written.
+  virtual int ReferenceIndexFor(HeapObject* object) { return -1; }
+
+  // Reserves space for the size of the backward reference table and returns
+  // its position. [WriteReferenceCount] fills it in once all objects are
+  // written.
+  int ReserveReferenceCount();
+  void WriteReferenceCount(int position);
+
+  // Reserves space for the heap sizes of all configurations and returns its
+  // position. [WriteHeapSizes] fills in the size of the objects written
+  // since [start].
+  int ReserveHeapSizes();
+  void WriteHeapSizes(int position, const PortableOffset& start);
+
+  // Restores the class of a written object. Does not visit the objects it
+  // points to.
+  void Unforward(HeapObject* object);
+
   void WriteByte(uint8 value);
   void WriteBytes(int length, const uint8* values);
   void WriteInt64(int64 value);
@@ -154,11 +192,12 @@ class SnapshotWriter {
   friend class TwoByteString;
   friend class LargeInteger;
   friend class Double;
+  friend class Boxed;
   friend class Initializer;
   friend class UnmarkSnapshotVisitor;
   friend class WriterVisitor;
+  friend class Stack;
 
- private:
   List<uint8> snapshot_;
   int position_;
   int index_;
@@ -174,6 +213,7 @@ class SnapshotWriter {
   FunctionOffsetsType* function_offsets_;
   ClassOffsetsType* class_offsets_;
 
+ private:
   void WriteHeapSizeTo(int position, int size);
 
   void EnsureCapacity(int extra) {
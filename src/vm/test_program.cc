@@ -0,0 +1,58 @@
+// Copyright (c) 2015, the Fletch project authors. Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE.md file.
+
+#include "src/vm/test_program.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "src/shared/bytecodes.h"
+#include "src/shared/utils.h"
+
+#include "src/vm/object.h"
+#include "src/vm/process.h"
+#include "src/vm/program.h"
+
+namespace fletch {
+
+TestProgram::TestProgram(int static_fields)
+    : program_(new Program(Program::kBuiltViaSession)) {
+  program_->Initialize();
+  NoAllocationFailureScope scope(program_->heap()->space());
+  program_->set_static_fields(
+      Array::cast(program_->CreateArray(static_fields)));
+}
+
+TestProgram::~TestProgram() { delete program_; }
+
+Function* TestProgram::CreateFunction(const uint8* bytecodes, int length,
+                                      int arity) {
+  int size = length + kMethodEndLength;
+  uint8* data = static_cast<uint8*>(malloc(size));
+  memcpy(data, bytecodes, length);
+  data[length] = kMethodEnd;
+  // The delta back to the first bytecode, without catch ranges.
+  Utils::WriteInt32(data + length + 1, length << 1);
+  Function* function;
+  {
+    NoAllocationFailureScope scope(program_->heap()->space());
+    List<uint8> bytes(data, size);
+    function = Function::cast(program_->CreateFunction(arity, bytes, 0));
+  }
+  free(data);
+  return function;
+}
+
+Process* TestProgram::SpawnProcess() {
+  Process* process = program_->SpawnProcess(NULL);
+  process->SetupExecutionStack();
+  return process;
+}
+
+void TestProgram::DeleteProcess(Process* process) {
+  process->ChangeState(process->state(), Process::kWaitingForChildren);
+  program_->ScheduleProcessForDeletion(process, Signal::kTerminated);
+}
+
+}  // namespace fletch
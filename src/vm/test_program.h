@@ -0,0 +1,44 @@
+// Copyright (c) 2015, the Fletch project authors. Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE.md file.
+
+#ifndef SRC_VM_TEST_PROGRAM_H_
+#define SRC_VM_TEST_PROGRAM_H_
+
+#include "src/shared/globals.h"
+
+namespace fletch {
+
+class Function;
+class Process;
+class Program;
+
+// An initialized program, built via a session, for unit tests of the VM
+// that assemble their bytecodes by hand.
+class TestProgram {
+ public:
+  explicit TestProgram(int static_fields = 0);
+  ~TestProgram();
+
+  Program* program() const { return program_; }
+
+  // Creates a function taking [arity] arguments from [bytecodes], which
+  // must not include the terminating kMethodEnd. It is appended here.
+  Function* CreateFunction(const uint8* bytecodes, int length,
+                           int arity = 0);
+
+  // Spawns a process with an empty execution stack.
+  Process* SpawnProcess();
+
+  // Deletes a process that is not running.
+  void DeleteProcess(Process* process);
+
+ private:
+  Program* const program_;
+
+  DISALLOW_COPY_AND_ASSIGN(TestProgram);
+};
+
+}  // namespace fletch
+
+#endif  // SRC_VM_TEST_PROGRAM_H_
@@ -0,0 +1,155 @@
+// Copyright (c) 2015, the Fletch project authors. Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE.md file.
+
+#include "src/vm/threaded_code.h"
+
+#include "src/shared/bytecodes.h"
+
+#include "src/vm/object.h"
+
+namespace fletch {
+
+static int CountBytecodes(uint8* bcp) {
+  int count = 1;
+  while (*bcp != kMethodEnd) {
+    bcp += Bytecode::Size(static_cast<Opcode>(*bcp));
+    count++;
+  }
+  return count;
+}
+
+// Reads the operands of the bytecode at [bcp] into [instruction] and returns
+// the bytecode delta if it is a branch.
+static int DecodeOperands(uint8* bcp, ThreadedInstruction* instruction) {
+  const char* format = Bytecode::BytecodeFormat(static_cast<Opcode>(*bcp));
+  int offset = 1;
+  for (int i = 0; format[i] != '\0'; i++) {
+    ASSERT(i < 2);
+    if (format[i] == 'B') {
+      instruction->operands[i] = bcp[offset];
+      offset += 1;
+    } else {
+      ASSERT(format[i] == 'I');
+      instruction->operands[i] = Utils::ReadInt32(bcp + offset);
+      offset += 4;
+    }
+  }
+
+  switch (*bcp) {
+    case kBranchWide:
+    case kBranchIfTrueWide:
+    case kBranchIfFalseWide:
+    case kSubroutineCall:
+      return instruction->operands[0];
+    case kBranchBack:
+    case kBranchBackIfTrue:
+    case kBranchBackIfFalse:
+    case kBranchBackWide:
+    case kBranchBackIfTrueWide:
+    case kBranchBackIfFalseWide:
+      return -instruction->operands[0];
+    case kPopAndBranchWide:
+      return instruction->operands[1];
+    case kPopAndBranchBackWide:
+      return -instruction->operands[1];
+    default:
+      return 0;
+  }
+}
+
+static bool IsUnfoldedConstant(uint8 opcode) {
+  return opcode == kLoadConstUnfold || opcode == kInvokeStaticUnfold ||
+         opcode == kInvokeFactoryUnfold || opcode == kAllocateUnfold ||
+         opcode == kAllocateImmutableUnfold;
+}
+
+ThreadedCode::ThreadedCode(Function* function, void** handlers)
+    : function_(function), length_(0), instructions_(NULL) {
+  uint8* start = function->bytecode_address_for(0);
+  length_ = CountBytecodes(start);
+  instructions_ = new ThreadedInstruction[length_];
+
+  uint8* bcp = start;
+  for (int i = 0; i < length_; i++) {
+    ThreadedInstruction* instruction = &instructions_[i];
+    instruction->handler = handlers[*bcp];
+    instruction->bcp = bcp;
+    instruction->operands[0] = 0;
+    instruction->operands[1] = 0;
+    instruction->branch_delta = DecodeOperands(bcp, instruction);
+    instruction->target = NULL;
+    if (IsUnfoldedConstant(*bcp)) {
+      instruction->constant = Function::ConstantForBytecode(bcp);
+    }
+    bcp += Bytecode::Size(static_cast<Opcode>(*bcp));
+  }
+
+  // Resolve the branch targets now that all instructions are known.
+  for (int i = 0; i < length_; i++) {
+    ThreadedInstruction* instruction = &instructions_[i];
+    if (instruction->branch_delta == 0) continue;
+    uint8* target = instruction->bcp + instruction->branch_delta;
+    instruction->target = FromBytecodePointer(target);
+  }
+}
+
+ThreadedCode::~ThreadedCode() { delete[] instructions_; }
+
+ThreadedInstruction* ThreadedCode::FromBytecodePointer(uint8* bcp) const {
+  int low = 0;
+  int high = length_ - 1;
+  while (low <= high) {
+    int middle = (low + high) / 2;
+    uint8* current = instructions_[middle].bcp;
+    if (current == bcp) return &instructions_[middle];
+    if (current < bcp) {
+      low = middle + 1;
+    } else {
+      high = middle - 1;
+    }
+  }
+  FATAL("Bytecode pointer is not the start of a bytecode");
+  return NULL;
+}
+
+ThreadedCodeCache::ThreadedCodeCache()
+    : primary_(new Entry[kPrimarySize]), instructions_(0) {
+  memset(primary_, 0, sizeof(Entry) * kPrimarySize);
+}
+
+ThreadedCodeCache::~ThreadedCodeCache() {
+  Clear();
+  delete[] primary_;
+}
+
+ThreadedCode* ThreadedCodeCache::LookupFunction(Function* function,
+                                                void** handlers) {
+  ThreadedCode*& code = functions_[function];
+  if (code == NULL) {
+    code = new ThreadedCode(function, handlers);
+    instructions_ += code->length();
+  }
+  return code;
+}
+
+ThreadedInstruction* ThreadedCodeCache::LookupSlow(Entry* entry, uint8* bcp,
+                                                   void** handlers) {
+  Function* function = Function::FromBytecodePointer(bcp);
+  ThreadedInstruction* instruction =
+      LookupFunction(function, handlers)->FromBytecodePointer(bcp);
+  entry->bcp = bcp;
+  entry->instruction = instruction;
+  return instruction;
+}
+
+void ThreadedCodeCache::Clear() {
+  memset(primary_, 0, sizeof(Entry) * kPrimarySize);
+  for (auto it = functions_.Begin(); it != functions_.End(); ++it) {
+    delete it->second;
+  }
+  functions_.Clear();
+  instructions_ = 0;
+}
+
+}  // namespace fletch
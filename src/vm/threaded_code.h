@@ -0,0 +1,115 @@
+// Copyright (c) 2015, the Fletch project authors. Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE.md file.
+
+#ifndef SRC_VM_THREADED_CODE_H_
+#define SRC_VM_THREADED_CODE_H_
+
+#include "src/shared/globals.h"
+#include "src/shared/utils.h"
+
+#include "src/vm/hash_map.h"
+
+namespace fletch {
+
+class Function;
+class Object;
+
+// A bytecode decoded for direct threading. The operands are read once when
+// the function is decoded, so interpreting the instruction does not touch
+// the (unaligned) bytecodes again.
+struct ThreadedInstruction {
+  // The address of the interpreter code for the opcode.
+  void* handler;
+  // The bytecode this instruction was decoded from. Frames on the stack
+  // always hold bytecode pointers, never instructions.
+  uint8* bcp;
+  // The first and second operand of the bytecode, if any.
+  int32 operands[2];
+  // The bytecode delta of a branch, 0 for other bytecodes.
+  int32 branch_delta;
+  union {
+    // The instruction a branch jumps to.
+    ThreadedInstruction* target;
+    // The constant of an unfolded bytecode.
+    Object* constant;
+  };
+};
+
+// The decoded bytecodes of a function, including the method end.
+class ThreadedCode {
+ public:
+  // Decode [function] using [handlers], indexed by opcode, as the
+  // instruction handlers.
+  ThreadedCode(Function* function, void** handlers);
+  ~ThreadedCode();
+
+  Function* function() const { return function_; }
+  int length() const { return length_; }
+  ThreadedInstruction* instruction_at(int index) const {
+    ASSERT(index >= 0 && index < length_);
+    return &instructions_[index];
+  }
+
+  // The instruction decoded from [bcp], which must be the start of a
+  // bytecode in the function.
+  ThreadedInstruction* FromBytecodePointer(uint8* bcp) const;
+
+ private:
+  Function* const function_;
+  int length_;
+  ThreadedInstruction* instructions_;
+};
+
+// Maps bytecode pointers to threaded instructions, decoding functions the
+// first time they are entered. Each thread has its own cache, so it is only
+// used by the thread interpreting the process. The cache holds pointers into
+// the program, so it is cleared whenever the program is stopped (see
+// [Scheduler::StopProgram]).
+class ThreadedCodeCache {
+ public:
+  static const int kPrimarySize = 4096;
+
+  // The cache is cleared before an interpreter quantum when the decoded
+  // functions hold more instructions than this.
+  static const int kMaximumInstructions = 256 * KB;
+
+  ThreadedCodeCache();
+  ~ThreadedCodeCache();
+
+  ThreadedInstruction* Lookup(uint8* bcp, void** handlers) {
+    Entry* entry = &primary_[ComputePrimaryIndex(bcp)];
+    if (entry->bcp == bcp) return entry->instruction;
+    return LookupSlow(entry, bcp, handlers);
+  }
+
+  ThreadedCode* LookupFunction(Function* function, void** handlers);
+
+  int functions() const { return functions_.size(); }
+  int instructions() const { return instructions_; }
+  bool IsFull() const { return instructions_ > kMaximumInstructions; }
+
+  void Clear();
+
+ private:
+  struct Entry {
+    uint8* bcp;
+    ThreadedInstruction* instruction;
+  };
+
+  static uword ComputePrimaryIndex(uint8* bcp) {
+    ASSERT(Utils::IsPowerOfTwo(kPrimarySize));
+    uword address = reinterpret_cast<uword>(bcp);
+    return (address ^ (address >> 12)) & (kPrimarySize - 1);
+  }
+
+  ThreadedInstruction* LookupSlow(Entry* entry, uint8* bcp, void** handlers);
+
+  Entry* const primary_;
+  HashMap<Function*, ThreadedCode*> functions_;
+  int instructions_;
+};
+
+}  // namespace fletch
+
+#endif  // SRC_VM_THREADED_CODE_H_
@@ -0,0 +1,69 @@
+// Copyright (c) 2015, the Fletch project authors. Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE.md file.
+
+#include "src/shared/bytecodes.h"
+#include "src/shared/test_case.h"
+
+#include "src/vm/object.h"
+#include "src/vm/test_program.h"
+#include "src/vm/threaded_code.h"
+
+namespace fletch {
+
+static uint8 kLoopBytecodes[] = {
+  kLoadLiteral0,                            // 0
+  kLoadLiteral, 7,                          // 1
+  kPopAndBranchWide, 1, 6, 0, 0, 0,         // 3: pop 1 and branch +6
+  kLoadLocal0,                              // 9
+  kBranchBack, 10,                          // 10: branch -10
+  kReturn, 1,                               // 12
+};
+
+TEST_CASE(ThreadedCode_Decode) {
+  TestProgram test;
+  Function* function =
+      test.CreateFunction(kLoopBytecodes, sizeof(kLoopBytecodes));
+  void* handlers[Bytecode::kNumBytecodes];
+  for (int i = 0; i < Bytecode::kNumBytecodes; i++) {
+    handlers[i] = &handlers[i];
+  }
+
+  ThreadedCode code(function, handlers);
+  EXPECT_EQ(7, code.length());
+  uint8* start = function->bytecode_address_for(0);
+
+  ThreadedInstruction* literal = code.instruction_at(1);
+  EXPECT(literal->handler == handlers[kLoadLiteral]);
+  EXPECT(literal->bcp == start + 1);
+  EXPECT_EQ(7, literal->operands[0]);
+  EXPECT_EQ(0, literal->branch_delta);
+
+  ThreadedInstruction* forward = code.instruction_at(2);
+  EXPECT_EQ(1, forward->operands[0]);
+  EXPECT_EQ(6, forward->operands[1]);
+  EXPECT_EQ(6, forward->branch_delta);
+  EXPECT(forward->target == code.instruction_at(3));
+
+  ThreadedInstruction* backward = code.instruction_at(4);
+  EXPECT_EQ(-10, backward->branch_delta);
+  EXPECT(backward->target == code.instruction_at(0));
+
+  EXPECT(code.instruction_at(6)->handler == handlers[kMethodEnd]);
+  EXPECT(code.FromBytecodePointer(start + 12) == code.instruction_at(5));
+
+  ThreadedCodeCache cache;
+  ThreadedInstruction* instruction = cache.Lookup(start + 10, handlers);
+  EXPECT(instruction->bcp == start + 10);
+  EXPECT(cache.Lookup(start + 10, handlers) == instruction);
+  EXPECT(cache.Lookup(start + 3, handlers)->target == instruction - 1);
+  EXPECT_EQ(1, cache.functions());
+  EXPECT_EQ(7, cache.instructions());
+
+  cache.Clear();
+  EXPECT_EQ(0, cache.functions());
+  EXPECT_EQ(0, cache.instructions());
+  EXPECT(cache.Lookup(start, handlers)->bcp == start);
+}
+
+}  // namespace fletch
@@ -66,6 +66,12 @@
       ],
       'sources': [
         '<(INTERMEDIATE_DIR)/generated<(asm_file_extension)',
+        'buffer_pool.cc',
+        'buffer_pool.h',
+        'checkpoint.cc',
+        'checkpoint.h',
+        'clock.cc',
+        'clock.h',
         'debug_info.cc',
         'debug_info.h',
         'debug_info_no_live_coding.h',
@@ -86,6 +92,8 @@
         'fletch_api_impl.cc',
         'fletch_api_impl.h',
         'fletch.cc',
+        'function_profile.cc',
+        'function_profile.h',
         'gc_thread.cc',
         'gc_thread.h',
         'hash_map.h',
@@ -93,8 +101,12 @@
         'hash_table.h',
         'heap.cc',
         'heap.h',
+        'heap_policy.cc',
+        'heap_policy.h',
         'heap_validator.cc',
         'heap_validator.h',
+        'histogram.cc',
+        'histogram.h',
         'shared_heap.cc',
         'shared_heap.h',
         'interpreter.cc',
@@ -120,6 +132,8 @@
         'natives_lk.cc',
         'natives_cmsis.cc',
         'natives.h',
+        'numa.cc',
+        'numa.h',
         'object.cc',
         'object.h',
         'object_list.cc',
@@ -172,6 +186,8 @@
         'thread_cmsis.h',
         'thread_windows.cc',
         'thread_windows.h',
+        'threaded_code.cc',
+        'threaded_code.h',
         'unicode.cc',
         'unicode.h',
         'vector.cc',
@@ -269,6 +285,7 @@
         'generator.h',
         'generator.cc',
         'interpreter_arm.cc',
+        'interpreter_x64.cc',
         'interpreter_x86.cc',
       ],
     },
@@ -297,12 +314,25 @@
       ],
       'sources': [
         # TODO(ahe): Add header (.h) files.
+        'buffer_pool_test.cc',
+        'checkpoint_test.cc',
+        'clock_test.cc',
+        'function_profile_test.cc',
         'hash_table_test.cc',
+        'heap_policy_test.cc',
+        'histogram_test.cc',
+        'interpreter_test.cc',
+        'message_mailbox_test.cc',
+        'numa_test.cc',
         'object_map_test.cc',
         'object_memory_test.cc',
         'object_test.cc',
         'platform_test.cc',
         'priority_heap_test.cc',
+        'program_folder_test.cc',
+        'shared_heap_test.cc',
+        'test_program.cc',
+        'threaded_code_test.cc',
         'vector_test.cc',
       ],
     },
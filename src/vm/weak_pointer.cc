@@ -48,6 +48,30 @@ void WeakPointer::Process(Space* space, WeakPointer** pointers, Heap* heap) {
   *pointers = new_list;
 }
 
+void WeakPointer::MoveForwarded(Space* space, WeakPointer** pointers,
+                                WeakPointer** forwarded) {
+  WeakPointer* remaining = NULL;
+  WeakPointer* current = *pointers;
+  while (current != NULL) {
+    WeakPointer* next = current->next_;
+    HeapObject* forward = NULL;
+    if (space->Includes(current->object_->address())) {
+      forward = current->object_->forwarding_address();
+    }
+    WeakPointer** list = &remaining;
+    if (forward != NULL) {
+      current->object_ = forward;
+      list = forwarded;
+    }
+    current->prev_ = NULL;
+    current->next_ = *list;
+    if (*list != NULL) (*list)->prev_ = current;
+    *list = current;
+    current = next;
+  }
+  *pointers = remaining;
+}
+
 void WeakPointer::ForceCallbacks(WeakPointer** pointers, Heap* heap) {
   WeakPointer* current = *pointers;
   while (current != NULL) {
@@ -20,6 +20,10 @@ class WeakPointer {
               WeakPointer* next);
 
   static void Process(Space* garbage_space, WeakPointer** pointers, Heap* heap);
+  // Move the weak pointers to objects in [space] that have been copied by a
+  // scavenge from [pointers] to [forwarded], updating them to the copies.
+  static void MoveForwarded(Space* space, WeakPointer** pointers,
+                            WeakPointer** forwarded);
   static void ForceCallbacks(WeakPointer** pointers, Heap* heap);
   static void Remove(WeakPointer** pointers, HeapObject* object);
   static void PrependWeakPointers(WeakPointer** pointers,
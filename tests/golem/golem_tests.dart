@@ -71,37 +71,88 @@ Future<Null> main() async {
                   'stdout:\n${untarResult.stdout}\n'
                   'stderr:\n${untarResult.stderr}');
 
-    // Build the snapshot in the temporary directory. Use the dart
-    // binary in the archive to test that everything needed is in
-    // there.
-    ProcessResult snapshotResult = Process.runSync(
-        '$buildDir/dart',
-        ['-Dsnapshot=out.snapshot',
-         'tests/fletchc/run.dart',
-         'benchmarks/DeltaBlue.dart'],
-        workingDirectory: tempDir.path,
-        runInShell: true);
-    Expect.equals(0,
-                  snapshotResult.exitCode,
-                  'snapshot creation failed:\n\n'
-                  'stdout:\n${snapshotResult.stdout}\n'
-                  'stderr:\n${snapshotResult.stderr}');
-
-    // Run the snapshot in the temporary directory.Use the fletch-vm
-    // binary in the archive to test that everything needed is in
-    // there.
-    ProcessResult runResult = Process.runSync(
-        '$buildDir/fletch-vm',
-        ['out.snapshot'],
-        workingDirectory: tempDir.path,
-        runInShell: true);
-    Expect.equals(0,
-                  runResult.exitCode,
-                  'benchmark run failed:\n\n'
-                  'stdout:\n${runResult.stdout}\n'
-                  'stderr:\n${runResult.stderr}');
-    Expect.isTrue(runResult.stdout.contains('DeltaBlue(RunTime):'));
+    String deltaBlue = runBenchmark(buildDir, tempDir, 'DeltaBlue.dart');
+    Expect.isTrue(deltaBlue.contains('DeltaBlue(RunTime):'));
+
+    // Latency benchmarks print a line per statistic and configuration.
+    String latency =
+        runBenchmark(buildDir, tempDir, 'messaging/PortLatency.dart');
+    RegExp latencyLine =
+        new RegExp(r'^PortLatency_\d+p_\d+rps\(P99\): \d+ us\.$',
+                   multiLine: true);
+    Expect.isTrue(latencyLine.hasMatch(latency), latency);
+
+    // The generated interpreter is compared with the C++ interpreter by
+    // tools/compare_interpreters.py, which prints a line per benchmark.
+    String comparison = compareInterpreters(
+        buildDir, tempDir, 'DeltaBlue.dart',
+        executable.resolve('../../tools/compare_interpreters.py'));
+    RegExp comparisonLine =
+        new RegExp(r'^DeltaBlue +[0-9.]+ +[0-9.]+ +[0-9.]+x$',
+                   multiLine: true);
+    Expect.isTrue(comparisonLine.hasMatch(comparison), comparison);
   } finally {
     tempDir.deleteSync(recursive: true);
   }
-}
\ No newline at end of file
+}
+
+/// Builds a snapshot of [benchmark] and runs it, like Golem does, and
+/// returns the output.
+String runBenchmark(String buildDir, Directory tempDir, String benchmark) {
+  buildSnapshot(buildDir, tempDir, benchmark);
+
+  // Run the snapshot in the temporary directory.Use the fletch-vm
+  // binary in the archive to test that everything needed is in
+  // there.
+  ProcessResult runResult = Process.runSync(
+      '$buildDir/fletch-vm',
+      ['out.snapshot'],
+      workingDirectory: tempDir.path,
+      runInShell: true);
+  Expect.equals(0,
+                runResult.exitCode,
+                'benchmark run failed:\n\n'
+                'stdout:\n${runResult.stdout}\n'
+                'stderr:\n${runResult.stderr}');
+  return runResult.stdout;
+}
+
+/// Builds a snapshot of [benchmark], runs it once with each interpreter
+/// using [script], and returns the output.
+String compareInterpreters(String buildDir, Directory tempDir,
+                           String benchmark, Uri script) {
+  buildSnapshot(buildDir, tempDir, benchmark);
+  ProcessResult compareResult = Process.runSync(
+      'python',
+      [script.toFilePath(),
+       '--vm=$buildDir/fletch-vm',
+       '--runs=1',
+       'out.snapshot'],
+      workingDirectory: tempDir.path,
+      runInShell: true);
+  Expect.equals(0,
+                compareResult.exitCode,
+                'interpreter comparison failed:\n\n'
+                'stdout:\n${compareResult.stdout}\n'
+                'stderr:\n${compareResult.stderr}');
+  return compareResult.stdout;
+}
+
+/// Builds a snapshot of [benchmark] in [tempDir] as out.snapshot.
+void buildSnapshot(String buildDir, Directory tempDir, String benchmark) {
+  // Build the snapshot in the temporary directory. Use the dart
+  // binary in the archive to test that everything needed is in
+  // there.
+  ProcessResult snapshotResult = Process.runSync(
+      '$buildDir/dart',
+      ['-Dsnapshot=out.snapshot',
+       'tests/fletchc/run.dart',
+       'benchmarks/$benchmark'],
+      workingDirectory: tempDir.path,
+      runInShell: true);
+  Expect.equals(0,
+                snapshotResult.exitCode,
+                'snapshot creation failed:\n\n'
+                'stdout:\n${snapshotResult.stdout}\n'
+                'stderr:\n${snapshotResult.stderr}');
+}
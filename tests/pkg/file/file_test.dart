@@ -2,15 +2,19 @@
 // for details. All rights reserved. Use of this source code is governed by a
 // BSD-style license that can be found in the LICENSE.md file.
 
+import 'dart:fletch';
 import 'dart:typed_data';
 
 import 'package:expect/expect.dart';
 import 'package:file/file.dart';
+import 'package:socket/socket.dart';
 
 void main() {
   testOpen();
   testReadWrite();
   testSeek();
+  testSendTo();
+  testCopyTo();
 }
 
 bool isFileException(e) => e is FileException;
@@ -66,3 +70,59 @@ void testSeek() {
   file.close();
   File.delete(file.path);
 }
+
+File createFile(String template, int length) {
+  var file = new File.temporary(template);
+  var data = new Uint8List(length);
+  for (int i = 0; i < length; i++) data[i] = i & 0xFF;
+  file.write(data.buffer);
+  return file;
+}
+
+void expectBytes(ByteBuffer buffer, int offset, int length) {
+  var list = new Uint8List.view(buffer);
+  Expect.equals(length, list.length);
+  for (int i = 0; i < length; i++) Expect.equals((offset + i) & 0xFF, list[i]);
+}
+
+void testSendTo() {
+  const int LENGTH = 256 * 1024;
+  var file = createFile("/tmp/file_send_test", LENGTH);
+  var server = new ServerSocket("127.0.0.1", 0);
+  var socket = new Socket.connect("127.0.0.1", server.port);
+  var client = server.accept();
+
+  file.sendTo(socket, 0, 10);
+  expectBytes(client.read(10), 0, 10);
+
+  // Larger than the socket buffers, so the transfer is resumed once the
+  // socket is writable again.
+  Fiber.fork(() => file.sendTo(socket, 100, LENGTH - 100));
+  expectBytes(client.read(LENGTH - 100), 100, LENGTH - 100);
+  Expect.equals(LENGTH, file.position);
+
+  Expect.throws(() => file.sendTo(socket, LENGTH, 1),
+                (e) => e is SocketException);
+
+  client.close();
+  server.close();
+  file.close();
+  File.delete(file.path);
+}
+
+void testCopyTo() {
+  const int LENGTH = 100 * 1024;
+  var source = createFile("/tmp/file_copy_source_test", LENGTH);
+  var destination = new File.temporary("/tmp/file_copy_destination_test");
+
+  source.copyTo(destination, 10, LENGTH - 10);
+  Expect.equals(LENGTH - 10, destination.length);
+  Expect.equals(LENGTH, source.position);
+  destination.position = 0;
+  expectBytes(destination.read(LENGTH), 10, LENGTH - 10);
+
+  source.close();
+  destination.close();
+  File.delete(source.path);
+  File.delete(destination.path);
+}
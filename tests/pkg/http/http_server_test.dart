@@ -0,0 +1,291 @@
+// Copyright (c) 2015, the Fletch project authors. Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE.md file.
+
+import 'dart:convert' show UTF8;
+import 'dart:fletch';
+import 'dart:typed_data';
+
+import 'package:expect/expect.dart';
+import 'package:http/http.dart';
+import 'package:socket/socket.dart';
+
+void main() {
+  HttpServer server = new HttpServer("127.0.0.1", 0);
+  Fiber.fork(() => server.serve(handle, workers: 2));
+
+  testGet(server.port);
+  testKeepAlive(server.port);
+  testPipelining(server.port);
+  testPost(server.port);
+  testConnectionClose(server.port);
+  testHttp10(server.port);
+  testBadRequest(server.port);
+  testBareLineFeeds(server.port);
+  testHeaderNames(server.port);
+  testIdentityEncoding(server.port);
+  testNonAsciiHeader(server.port);
+  testHandlerThrows(server.port);
+  testWriteBuffer(server.port);
+
+  server.close();
+
+  testSharedServer();
+  testLimits();
+}
+
+void handle(HttpServerRequest request, HttpServerResponse response) {
+  switch (request.path) {
+    case "/hello":
+      response.write("hello");
+      break;
+    case "/header":
+      response.headers["X-Echo"] = request.header("x-value");
+      response.write(request.method);
+      break;
+    case "/echo":
+      response.writeBytes(request.body);
+      break;
+    case "/buffer":
+      response.write("<");
+      response.writeBuffer(stringToByteBuffer("hello world"), 5);
+      response.write(">");
+      response.writeBuffer(stringToByteBuffer("!"));
+      break;
+    case "/name":
+      response.headers["X-Name"] = "J\u00f8rgen \u2603";
+      break;
+    case "/throw":
+      response.write("lost");
+      throw "error";
+    default:
+      response.statusCode = 404;
+  }
+}
+
+String response(String body, {String status: "200 OK", String headers: ""}) {
+  return "HTTP/1.1 $status\r\n${headers}"
+         "Content-Length: ${body.length}\r\n\r\n$body";
+}
+
+void send(Socket socket, String data) {
+  socket.write(stringToByteBuffer(data));
+}
+
+void expectResponse(Socket socket, String expected) {
+  var data = new Uint8List.view(socket.read(expected.length));
+  Expect.equals(expected, new String.fromCharCodes(data));
+}
+
+void expectClosed(Socket socket) {
+  Expect.isNull(socket.readNext());
+}
+
+void testGet(int port) {
+  var socket = new Socket.connect("127.0.0.1", port);
+  send(socket, "GET /header HTTP/1.1\r\nHost: myhost\r\nX-VALUE:  42 \r\n\r\n");
+  expectResponse(socket, response("GET", headers: "X-Echo: 42\r\n"));
+  socket.close();
+}
+
+void testKeepAlive(int port) {
+  var socket = new Socket.connect("127.0.0.1", port);
+  for (int i = 0; i < 10; i++) {
+    send(socket, "GET /hello HTTP/1.1\r\n\r\n");
+    expectResponse(socket, response("hello"));
+  }
+  send(socket, "GET /missing HTTP/1.1\r\n\r\n");
+  expectResponse(socket, response("", status: "404 Not Found"));
+  socket.close();
+}
+
+void testPipelining(int port) {
+  var socket = new Socket.connect("127.0.0.1", port);
+  StringBuffer requests = new StringBuffer();
+  StringBuffer responses = new StringBuffer();
+  for (int i = 0; i < 100; i++) {
+    requests.write("GET /hello HTTP/1.1\r\nHost: myhost\r\n\r\n");
+    responses.write(response("hello"));
+  }
+  send(socket, requests.toString());
+  expectResponse(socket, responses.toString());
+  socket.close();
+}
+
+void testPost(int port) {
+  var socket = new Socket.connect("127.0.0.1", port);
+  send(socket, "POST /echo HTTP/1.1\r\nContent-Length: 11\r\n\r\nhello");
+  send(socket, " world");
+  expectResponse(socket, response("hello world"));
+
+  // A body larger than the connection buffer.
+  String body = "x" * (64 * 1024);
+  send(socket, "POST /echo HTTP/1.1\r\nContent-Length: ${body.length}\r\n\r\n");
+  send(socket, body);
+  expectResponse(socket, response(body));
+  socket.close();
+}
+
+void testConnectionClose(int port) {
+  var socket = new Socket.connect("127.0.0.1", port);
+  send(socket, "GET /hello HTTP/1.1\r\nConnection: close\r\n\r\n");
+  expectResponse(socket, response("hello", headers: "Connection: close\r\n"));
+  expectClosed(socket);
+  socket.close();
+}
+
+void testHttp10(int port) {
+  var socket = new Socket.connect("127.0.0.1", port);
+  send(socket, "GET /hello HTTP/1.0\r\nConnection: Keep-Alive\r\n\r\n");
+  expectResponse(socket,
+                 response("hello", headers: "Connection: keep-alive\r\n"));
+  send(socket, "GET /hello HTTP/1.0\r\n\r\n");
+  expectResponse(socket, response("hello", headers: "Connection: close\r\n"));
+  expectClosed(socket);
+  socket.close();
+}
+
+void testBadRequest(int port) {
+  var socket = new Socket.connect("127.0.0.1", port);
+  send(socket, "GET /hello\r\n\r\n");
+  expectResponse(socket, response("",
+                                  status: "400 Bad Request",
+                                  headers: "Connection: close\r\n"));
+  expectClosed(socket);
+  socket.close();
+
+  socket = new Socket.connect("127.0.0.1", port);
+  send(socket, "POST /echo HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n");
+  expectResponse(socket, response("",
+                                  status: "501 Not Implemented",
+                                  headers: "Connection: close\r\n"));
+  expectClosed(socket);
+  socket.close();
+}
+
+void testBareLineFeeds(int port) {
+  var socket = new Socket.connect("127.0.0.1", port);
+  send(socket, "GET /header HTTP/1.1\nX-Value: 42\n\n");
+  expectResponse(socket, response("GET", headers: "X-Echo: 42\r\n"));
+  send(socket, "POST /echo HTTP/1.1\r\nContent-Length: 2\n\nhi");
+  expectResponse(socket, response("hi"));
+  socket.close();
+}
+
+void testHeaderNames(int port) {
+  var socket = new Socket.connect("127.0.0.1", port);
+  // Only letters are compared ignoring case, so this is not Content-Length.
+  send(socket, "GET /hello HTTP/1.1\r\nContent\rLength: 5\r\n\r\n");
+  expectResponse(socket, response("hello"));
+  socket.close();
+}
+
+void testIdentityEncoding(int port) {
+  var socket = new Socket.connect("127.0.0.1", port);
+  send(socket, "POST /echo HTTP/1.1\r\nTransfer-Encoding: Identity\r\n"
+               "Content-Length: 5\r\n\r\nhello");
+  expectResponse(socket, response("hello"));
+  socket.close();
+}
+
+void testNonAsciiHeader(int port) {
+  var socket = new Socket.connect("127.0.0.1", port);
+  send(socket, "GET /name HTTP/1.1\r\n\r\n");
+  String expected =
+      response("", headers: "X-Name: J\u00f8rgen \u2603\r\n");
+  List<int> encoded = UTF8.encode(expected);
+  var data = new Uint8List.view(socket.read(encoded.length));
+  Expect.listEquals(encoded, data);
+  socket.close();
+}
+
+void testSharedServer() {
+  HttpServer server = new HttpServer("127.0.0.1", 0, shared: true);
+  Fiber.fork(() => server.serve(handle, workers: 4));
+  List<Socket> sockets = [];
+  for (int i = 0; i < 16; i++) {
+    sockets.add(new Socket.connect("127.0.0.1", server.port));
+  }
+  for (Socket socket in sockets) {
+    send(socket, "GET /hello HTTP/1.1\r\n\r\n");
+  }
+  for (Socket socket in sockets) {
+    expectResponse(socket, response("hello"));
+    socket.close();
+  }
+  server.close();
+}
+
+void expectError(int port, String request, String status) {
+  var socket = new Socket.connect("127.0.0.1", port);
+  send(socket, request);
+  expectResponse(socket, response("",
+                                  status: status,
+                                  headers: "Connection: close\r\n"));
+  expectClosed(socket);
+  socket.close();
+}
+
+void testLimits() {
+  HttpServer server =
+      new HttpServer("127.0.0.1", 0, maxHeadSize: 256, maxBodySize: 1024);
+  Fiber.fork(() => server.serve(handle, workers: 1));
+  int port = server.port;
+
+  // Heads and bodies up to the limits are served.
+  var socket = new Socket.connect("127.0.0.1", port);
+  String request = "GET /hello HTTP/1.1\r\nX-Pad: ";
+  String padding = "x" * (256 - request.length - 4);
+  send(socket, "$request$padding\r\n\r\n");
+  expectResponse(socket, response("hello"));
+  String body = "x" * 1024;
+  send(socket, "POST /echo HTTP/1.1\r\nContent-Length: 1024\r\n\r\n$body");
+  expectResponse(socket, response(body));
+  socket.close();
+
+  // A complete head that is too large, and one that is not complete yet.
+  expectError(port,
+              "$request${padding}x\r\n\r\n",
+              "431 Request Header Fields Too Large");
+  expectError(port,
+              "$request${'x' * 300}",
+              "431 Request Header Fields Too Large");
+
+  // The Content-Length is checked before the body is received.
+  expectError(port,
+              "POST /echo HTTP/1.1\r\nContent-Length: 1025\r\n\r\n",
+              "413 Payload Too Large");
+
+  // Lengths that are malformed or too long to be parsed.
+  for (String length in ["", "-1", "12a", "0x10", "9" * 40]) {
+    expectError(port,
+                "POST /echo HTTP/1.1\r\nContent-Length: $length\r\n\r\n",
+                "400 Bad Request");
+  }
+
+  server.close();
+}
+
+void testHandlerThrows(int port) {
+  var socket = new Socket.connect("127.0.0.1", port);
+  send(socket, "GET /throw HTTP/1.1\r\n\r\n");
+  expectResponse(socket, response("", status: "500 Internal Server Error"));
+  send(socket, "GET /hello HTTP/1.1\r\n\r\n");
+  expectResponse(socket, response("hello"));
+  socket.close();
+}
+
+void testWriteBuffer(int port) {
+  var socket = new Socket.connect("127.0.0.1", port);
+  StringBuffer requests = new StringBuffer();
+  StringBuffer responses = new StringBuffer();
+  for (int i = 0; i < 20; i++) {
+    requests.write("GET /buffer HTTP/1.1\r\n\r\n");
+    requests.write("GET /hello HTTP/1.1\r\n\r\n");
+    responses.write(response("<hello>!"));
+    responses.write(response("hello"));
+  }
+  send(socket, requests.toString());
+  expectResponse(socket, responses.toString());
+  socket.close();
+}
@@ -15,6 +15,7 @@ void main() {
   testReadWrite();
   testSpawnAccept();
   testLargeChunk();
+  testWriteBuffers();
   testShutdown();
   testFailingBind();
 }
@@ -130,6 +131,33 @@ void testLargeChunk() {
   server.close();
 }
 
+const GATHER_COUNT = 40;
+
+void gatherClient(Socket client) {
+  int length = GATHER_COUNT * CHUNK_SIZE;
+  validateBuffer(client.read(length), length);
+  client.close();
+}
+
+void testWriteBuffers() {
+  var server = new ServerSocket("127.0.0.1", 0);
+  var socket = new Socket.connect("127.0.0.1", server.port);
+  server.spawnAccept(gatherClient);
+
+  // More buffers than fit in one system call, each only partially written.
+  var buffers = [];
+  var lengths = [];
+  for (int i = 0; i < GATHER_COUNT; i++) {
+    buffers.add(createBuffer(2 * CHUNK_SIZE));
+    lengths.add(CHUNK_SIZE);
+  }
+  socket.writeBuffers(buffers, lengths);
+  Expect.isNull(socket.readNext());
+
+  socket.close();
+  server.close();
+}
+
 bool isSocketException(e) => e is SocketException;
 
 void testShutdown() {
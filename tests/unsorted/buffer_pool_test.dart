@@ -0,0 +1,97 @@
+// Copyright (c) 2015, the Fletch project authors. Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE.md file.
+
+import 'dart:fletch';
+import 'dart:typed_data';
+
+import 'package:expect/expect.dart';
+
+// No other buffers of these sizes are allocated, so the counts are exact.
+const int SIZE = 3 * 1024 + 8;
+const int OTHER_SIZE = 5 * 1024 + 8;
+
+void main() {
+  testRecycle();
+  testGrow();
+  testOtherSizes();
+  testIndexOfByte();
+}
+
+int addressOf(ByteBuffer buffer) {
+  var foreign = buffer;
+  return foreign.getForeign().address;
+}
+
+void testRecycle() {
+  BufferPool pool = new BufferPool(SIZE, maxPooledBuffers: 1);
+  ByteBuffer first = pool.acquire();
+  ByteBuffer second = pool.acquire();
+  Expect.equals(SIZE, first.lengthInBytes);
+  Expect.isFalse(identical(first, second));
+  int address = addressOf(first);
+  new Uint8List.view(first)[0] = 42;
+
+  // Released buffers are emptied. Only one is kept.
+  pool.release(first);
+  pool.release(second);
+  Expect.equals(0, first.lengthInBytes);
+  Expect.equals(0, second.lengthInBytes);
+  Expect.equals(1, pool.pooledBuffers);
+
+  // Releasing a buffer twice has no effect.
+  pool.release(first);
+  Expect.equals(1, pool.pooledBuffers);
+
+  // The memory is reused and cleared.
+  ByteBuffer reused = pool.acquire();
+  Expect.equals(address, addressOf(reused));
+  Expect.equals(0, new Uint8List.view(reused)[0]);
+  Expect.equals(0, pool.pooledBuffers);
+  pool.release(reused);
+}
+
+void testGrow() {
+  BufferPool pool = new BufferPool(SIZE, maxPooledBuffers: 4);
+  ByteBuffer buffer = pool.acquire(SIZE + 1);
+  Expect.equals(2 * SIZE, buffer.lengthInBytes);
+  Expect.equals(SIZE, pool.acquire(SIZE - 1).lengthInBytes);
+  Expect.equals(8 * SIZE, pool.acquire(5 * SIZE).lengthInBytes);
+  pool.release(buffer);
+  Expect.equals(0, buffer.lengthInBytes);
+
+  // Buffers larger than 64 times the size are not pooled.
+  buffer = pool.acquire(64 * SIZE + 1);
+  Expect.equals(64 * SIZE + 1, buffer.lengthInBytes);
+  pool.release(buffer);
+  Expect.equals(64 * SIZE + 1, buffer.lengthInBytes);
+}
+
+void testOtherSizes() {
+  BufferPool pool = new BufferPool(SIZE);
+  ByteBuffer buffer = new Uint8List(OTHER_SIZE).buffer;
+  pool.release(buffer);
+  Expect.equals(OTHER_SIZE, buffer.lengthInBytes);
+}
+
+void testIndexOfByte() {
+  Uint8List bytes = new Uint8List(8);
+  bytes[2] = 10;
+  bytes[6] = 10;
+  ByteBuffer buffer = bytes.buffer;
+  Expect.equals(2, indexOfByte(buffer, 10, 0, 8));
+  Expect.equals(6, indexOfByte(buffer, 10, 3, 8));
+  Expect.equals(-1, indexOfByte(buffer, 10, 3, 6));
+  Expect.equals(-1, indexOfByte(buffer, 10, 4, 4));
+  Expect.equals(0, indexOfByte(buffer, 0, 0, 8));
+  Expect.throws(() => indexOfByte(buffer, 10, 0, 9), (e) => e is RangeError);
+  Expect.throws(() => indexOfByte(buffer, 10, -1, 8), (e) => e is RangeError);
+  Expect.throws(() => indexOfByte(buffer, 256, 0, 8),
+                (e) => e is ArgumentError);
+
+  // A released buffer has no bytes left to search.
+  BufferPool pool = new BufferPool(SIZE);
+  ByteBuffer released = pool.acquire();
+  pool.release(released);
+  Expect.throws(() => indexOfByte(released, 0, 0, 1), (e) => e is RangeError);
+}
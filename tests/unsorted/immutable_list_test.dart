@@ -0,0 +1,130 @@
+// Copyright (c) 2015, the Fletch project authors. Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE.md file.
+
+import 'dart:collection';
+import 'dart:fletch';
+
+import 'package:expect/expect.dart';
+
+class Mutable {
+  int value;
+  Mutable(this.value);
+}
+
+// A list that is not built on an array. Its elements must be read through
+// the List interface, not from its first field.
+class Doubled extends ListBase<int> {
+  final List<int> _elements;
+  Doubled(this._elements);
+
+  int get length => _elements.length;
+  void set length(int value) => throw new UnsupportedError("length");
+  int operator[](int index) => 2 * _elements[index];
+  void operator[]=(int index, int value) {
+    _elements[index] = value ~/ 2;
+  }
+}
+
+void main() {
+  testCopy();
+  testUpdates();
+  testMutableElements();
+  testSend();
+  testByteList();
+  testStringFromCharCodes();
+  testOtherLists();
+  testBitCount();
+}
+
+void testCopy() {
+  List list = immutableList([1, 'two', 3.0]);
+  Expect.listEquals([1, 'two', 3.0], list);
+  Expect.isTrue(isImmutable(list));
+  Expect.throws(() => list[0] = 2, (e) => e is UnsupportedError);
+
+  Expect.isTrue(isImmutable(immutableList([])));
+  Expect.isTrue(isImmutable(immutableList(new List(3))));
+  Expect.isTrue(isImmutable(immutableList(const [1, 2])));
+  Expect.isTrue(isImmutable(immutableList([list, list])));
+}
+
+void testUpdates() {
+  List list = immutableList([1, 2, 3]);
+  Expect.listEquals([1, 4, 3], immutableListReplace(list, 1, 4));
+  Expect.listEquals([0, 1, 2, 3], immutableListInsert(list, 0, 0));
+  Expect.listEquals([1, 2, 3, 4], immutableListInsert(list, 3, 4));
+  Expect.listEquals([1, 3], immutableListRemove(list, 1));
+  Expect.listEquals([1, 2, 3], list);
+
+  Expect.throws(() => immutableListReplace(list, 3, 0),
+                (e) => e is RangeError);
+  Expect.throws(() => immutableListInsert(list, 4, 0),
+                (e) => e is RangeError);
+  Expect.throws(() => immutableListRemove(list, -1),
+                (e) => e is RangeError);
+}
+
+void testMutableElements() {
+  Mutable element = new Mutable(1);
+  List list = immutableList([1, element]);
+  Expect.isFalse(isImmutable(list));
+  Expect.identical(element, list[1]);
+  Expect.throws(() => list[0] = 2, (e) => e is UnsupportedError);
+
+  List replaced = immutableListReplace(list, 1, 2);
+  Expect.isTrue(isImmutable(replaced));
+  Expect.isFalse(isImmutable(immutableListInsert(replaced, 0, element)));
+}
+
+void testSend() {
+  List list = immutableList(['a', immutableList([1, 2])]);
+  Channel channel = new Channel();
+  Port port = new Port(channel);
+  Process.spawnDetached(() => port.send(list));
+  Expect.identical(list, channel.receive());
+
+  port.sendBuilt(() => immutableListInsert(list, 0, 'b'));
+  Expect.listEquals(['b', 'a', list[1]], channel.receive());
+}
+
+void testByteList() {
+  List<int> bytes = immutableByteList([1, 2, 255]);
+  Expect.isTrue(isImmutable(bytes));
+  Expect.listEquals([1, 2, 255], bytes);
+  Expect.identical(bytes, immutableByteList(bytes));
+  Expect.throws(() => bytes[0] = 2, (e) => e is UnsupportedError);
+
+  List<int> growable = [3, 4];
+  Expect.listEquals([3, 4], immutableByteList(growable));
+  Expect.throws(() => immutableByteList([256]), (e) => e is ArgumentError);
+}
+
+void testStringFromCharCodes() {
+  Expect.equals('abc', new String.fromCharCodes([97, 98, 99]));
+  Expect.equals('bc', new String.fromCharCodes([97, 98, 99], 1));
+  Expect.equals('\u1234a', new String.fromCharCodes([0x1234, 97]));
+  Expect.equals('\u{10000}', new String.fromCharCodes([0x10000]));
+  Expect.equals('ab', new String.fromCharCodes(immutableByteList([97, 98])));
+}
+
+void testOtherLists() {
+  Doubled doubled = new Doubled(new List<int>.from([1, 2], growable: false));
+  Expect.listEquals([2, 4], immutableList(doubled));
+  Expect.listEquals([2, 6], immutableListReplace(doubled, 1, 6));
+  Expect.listEquals([2, 4], immutableByteList(doubled));
+  Expect.equals('\x02\x04', new String.fromCharCodes(doubled));
+  Expect.throws(() => immutableListInsert(doubled, 3, 0),
+                (e) => e is RangeError);
+  Expect.throws(() => immutableListRemove(immutableByteList([1]), 1),
+                (e) => e is RangeError);
+  Expect.listEquals([], immutableListRemove(immutableByteList([1]), 0));
+}
+
+void testBitCount() {
+  Expect.equals(0, bitCount(0));
+  Expect.equals(1, bitCount(1 << 31));
+  Expect.equals(32, bitCount(0xFFFFFFFF));
+  Expect.equals(64, bitCount(-1));
+  Expect.throws(() => bitCount(1.0), (e) => e is ArgumentError);
+}
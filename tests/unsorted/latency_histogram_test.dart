@@ -0,0 +1,69 @@
+// Copyright (c) 2015, the Fletch project authors. Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE.md file.
+
+import 'dart:fletch';
+
+import 'package:expect/expect.dart';
+
+void main() {
+  testRecord();
+  testPercentiles();
+  testRecordSince();
+  testErrors();
+}
+
+void testRecord() {
+  LatencyHistogram histogram = new LatencyHistogram();
+  Expect.equals(0, histogram.count);
+  Expect.equals(0, histogram.mean);
+  Expect.equals(0, histogram.percentile(99));
+
+  for (int i = 1; i <= 100; i++) histogram.record(i);
+  Expect.equals(100, histogram.count);
+  Expect.equals(5050, histogram.sum);
+  Expect.equals(1, histogram.minimum);
+  Expect.equals(100, histogram.maximum);
+  Expect.equals(50, histogram.mean);
+
+  histogram.reset();
+  Expect.equals(0, histogram.count);
+  Expect.equals(0, histogram.maximum);
+  Expect.equals(0, histogram.percentile(50));
+}
+
+void testPercentiles() {
+  LatencyHistogram histogram = new LatencyHistogram();
+  // Small values have a bucket each.
+  for (int i = 1; i <= 100; i++) histogram.record(i);
+  Expect.equals(50, histogram.percentile(50));
+  Expect.equals(99, histogram.percentile(99));
+  Expect.equals(100, histogram.percentile(100));
+
+  // Large values are within 1/64th.
+  histogram.reset();
+  for (int i = 0; i < 99; i++) histogram.record(1000);
+  histogram.record(1000000);
+  int p50 = histogram.percentile(50);
+  Expect.isTrue(p50 >= 1000 && p50 <= 1000 + 1000 ~/ 64);
+  Expect.isTrue(histogram.percentile(99.9) > 1000000 - 1000000 ~/ 64);
+  Expect.equals(1000000, histogram.percentile(100));
+}
+
+void testRecordSince() {
+  LatencyHistogram histogram = new LatencyHistogram();
+  int start = LatencyHistogram.now;
+  histogram.recordSince(start);
+  histogram.recordSince(LatencyHistogram.now + 1000000);
+  Expect.equals(2, histogram.count);
+  Expect.equals(0, histogram.minimum);
+  Expect.isTrue(LatencyHistogram.now >= start);
+}
+
+void testErrors() {
+  LatencyHistogram histogram = new LatencyHistogram();
+  Expect.throws(() => histogram.record(-1), (e) => e is ArgumentError);
+  Expect.throws(() => histogram.record(null), (e) => e is ArgumentError);
+  Expect.throws(() => histogram.percentile(101), (e) => e is RangeError);
+  Expect.equals(0, histogram.count);
+}
@@ -0,0 +1,98 @@
+// Copyright (c) 2015, the Fletch project authors. Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE.md file.
+
+import 'dart:fletch';
+
+import 'package:expect/expect.dart';
+
+class Node {
+  final int value;
+  final Node next;
+  Node(this.value, this.next);
+}
+
+Node buildList(int length) {
+  Node head = null;
+  for (int i = length - 1; i >= 0; i--) head = new Node(i, head);
+  return head;
+}
+
+void expectList(int length, Node head) {
+  for (int i = 0; i < length; i++) {
+    Expect.equals(i, head.value);
+    head = head.next;
+  }
+  Expect.isNull(head);
+}
+
+void testSendBuilt() {
+  Channel channel = new Channel();
+  Port port = new Port(channel);
+  port.sendBuilt(() => buildList(100));
+  expectList(100, channel.receive());
+}
+
+void testSendBuiltReceivedMutable() {
+  // Detached arena objects become objects of the receiver, so they cannot be
+  // sent on as immutable objects.
+  Channel channel = new Channel();
+  Port port = new Port(channel);
+  port.sendBuilt(() => buildList(10));
+  Node received = channel.receive();
+  Expect.isFalse(isImmutable(received));
+  Expect.throws(() => port.send(received), (e) => e is ArgumentError);
+  port.sendClone(received);
+  expectList(10, channel.receive());
+
+  // Messages sent with send stay immutable.
+  port.send(buildList(10));
+  Expect.isTrue(isImmutable(channel.receive()));
+}
+
+void testSendBuiltToOtherProcess() {
+  Channel channel = new Channel();
+  Port port = new Port(channel);
+  Process.spawnDetached(() {
+    port.sendBuilt(() => buildList(1000));
+  });
+  expectList(1000, channel.receive());
+}
+
+void testSendBuiltKeptReference() {
+  // Keeping a reference to the message makes it go through the shared heap.
+  Channel channel = new Channel();
+  Port port = new Port(channel);
+  List kept = [];
+  port.sendBuilt(() {
+    Node list = buildList(10);
+    kept.add(list);
+    return list;
+  });
+  Node received = channel.receive();
+  expectList(10, received);
+  Expect.identical(kept[0], received);
+}
+
+void testSendBuiltThrows() {
+  Channel channel = new Channel();
+  Port port = new Port(channel);
+  Node list;
+  Expect.throws(() => port.sendBuilt(() {
+    list = buildList(10);
+    throw 42;
+  }), (e) => e == 42);
+  expectList(10, list);
+
+  // The arena was closed, so sending works again.
+  port.sendBuilt(() => buildList(5));
+  expectList(5, channel.receive());
+}
+
+main() {
+  testSendBuilt();
+  testSendBuiltReceivedMutable();
+  testSendBuiltToOtherProcess();
+  testSendBuiltKeptReference();
+  testSendBuiltThrows();
+}
@@ -0,0 +1,69 @@
+// Copyright (c) 2015, the Fletch project authors. Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE.md file.
+
+import 'dart:fletch';
+
+import 'package:expect/expect.dart';
+
+class Node {
+  int value;
+  Node next;
+  Node(this.value, this.next);
+}
+
+void testSendClone() {
+  Channel channel = new Channel();
+  Port port = new Port(channel);
+  Map document = {'name': 'doc', 'items': [1, 2, 3]};
+  port.sendClone(document);
+  Map received = channel.receive();
+  Expect.isFalse(identical(document, received));
+  Expect.equals('doc', received['name']);
+  Expect.listEquals([1, 2, 3], received['items']);
+
+  // The sender's objects are untouched by the copy.
+  document['items'].add(4);
+  Expect.equals(3, received['items'].length);
+}
+
+void testSendCloneKeepsCyclesAndSharing() {
+  Channel channel = new Channel();
+  Port port = new Port(channel);
+  Node first = new Node(1, null);
+  Node second = new Node(2, first);
+  first.next = second;
+  port.sendClone([first, second, first]);
+  List received = channel.receive();
+  Expect.identical(received[0], received[2]);
+  Expect.identical(received[1], received[0].next);
+  Expect.identical(received[0], received[1].next);
+  Expect.equals(2, received[0].next.value);
+}
+
+void testSendCloneToOtherProcess() {
+  Channel channel = new Channel();
+  Port port = new Port(channel);
+  Process.spawnDetached(() {
+    List list = new List.generate(1000, (i) => new Node(i, null));
+    port.sendClone(list);
+  });
+  List received = channel.receive();
+  for (int i = 0; i < 1000; i++) Expect.equals(i, received[i].value);
+}
+
+void testSendCloneImmutable() {
+  Channel channel = new Channel();
+  Port port = new Port(channel);
+  port.sendClone(42);
+  Expect.equals(42, channel.receive());
+  port.sendClone('string');
+  Expect.equals('string', channel.receive());
+}
+
+main() {
+  testSendClone();
+  testSendCloneKeepsCyclesAndSharing();
+  testSendCloneToOtherProcess();
+  testSendCloneImmutable();
+}
@@ -0,0 +1,170 @@
+// Copyright (c) 2015, the Fletch project authors. Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE.md file.
+
+import 'dart:fletch';
+
+import 'package:expect/expect.dart';
+import 'package:immutable/persistent.dart';
+
+const int COUNT = 10000;
+
+// Keys with few distinct hash codes end up in collision nodes.
+class Colliding {
+  final int value;
+  const Colliding(this.value);
+  int get hashCode => value % 3;
+  bool operator ==(other) => other is Colliding && other.value == value;
+}
+
+void main() {
+  testMap();
+  testMapBuilder();
+  testMapCollisions();
+  testSet();
+  testVector();
+  testVectorBuilder();
+  testShare();
+}
+
+void testMap() {
+  PersistentMap map = new PersistentMap();
+  Expect.isTrue(map.isEmpty);
+  for (int i = 0; i < COUNT; i++) map = map.put(i, 'v$i');
+  Expect.equals(COUNT, map.length);
+  Expect.isTrue(isImmutable(map));
+
+  PersistentMap old = map;
+  map = map.put(7, 'seven');
+  Expect.equals('seven', map[7]);
+  Expect.equals('v7', old[7]);
+  Expect.equals(COUNT, map.length);
+  Expect.identical(map, map.put(7, 'seven'));
+
+  for (int i = 0; i < COUNT; i += 2) map = map.remove(i);
+  Expect.equals(COUNT ~/ 2, map.length);
+  for (int i = 0; i < COUNT; i++) {
+    Expect.equals(i.isOdd, map.containsKey(i));
+    if (i.isOdd && i != 7) Expect.equals('v$i', map[i]);
+  }
+  Expect.identical(map, map.remove(COUNT));
+  Expect.equals(COUNT, old.length);
+
+  int sum = 0;
+  map.forEach((key, value) => sum += key);
+  Expect.equals(COUNT * COUNT ~/ 4, sum);
+
+  for (int i = 1; i < COUNT; i += 2) map = map.remove(i);
+  Expect.isTrue(map.isEmpty);
+  Expect.isNull(map[1]);
+}
+
+void testMapBuilder() {
+  PersistentMapBuilder builder = new PersistentMapBuilder();
+  for (int i = 0; i < COUNT; i++) builder[i] = i;
+  builder.remove(0);
+  builder.remove(COUNT);
+  PersistentMap map = builder.build();
+  Expect.equals(COUNT - 1, map.length);
+  Expect.isTrue(isImmutable(map));
+  Expect.isNull(map[0]);
+  Expect.equals(42, map[42]);
+
+  // Updating the builder afterwards does not change the built map.
+  builder[42] = -1;
+  builder.remove(43);
+  Expect.equals(42, map[42]);
+  Expect.equals(43, map[43]);
+  PersistentMap updated = builder.build();
+  Expect.equals(-1, updated[42]);
+  Expect.isFalse(updated.containsKey(43));
+  Expect.equals(COUNT - 2, updated.length);
+
+  PersistentMap copy = new PersistentMap.fromMap({'a': 1, 'b': 2});
+  Expect.equals(2, copy.length);
+  Expect.equals(2, copy['b']);
+}
+
+void testMapCollisions() {
+  PersistentMap map = new PersistentMap();
+  for (int i = 0; i < 30; i++) map = map.put(new Colliding(i), i);
+  map = map.put(100, 100);
+  Expect.equals(31, map.length);
+  for (int i = 0; i < 30; i++) Expect.equals(i, map[new Colliding(i)]);
+  for (int i = 0; i < 30; i++) map = map.remove(new Colliding(i));
+  Expect.equals(1, map.length);
+  Expect.equals(100, map[100]);
+}
+
+void testSet() {
+  PersistentSet set = new PersistentSet.from(['a', 'b', 'c']);
+  Expect.equals(3, set.length);
+  Expect.isTrue(set.contains('b'));
+  Expect.identical(set, set.add('a'));
+  PersistentSet smaller = set.remove('b');
+  Expect.isFalse(smaller.contains('b'));
+  Expect.isTrue(set.contains('b'));
+  Expect.isTrue(isImmutable(smaller));
+
+  PersistentSetBuilder builder = smaller.toBuilder();
+  builder.add('d');
+  builder.remove('a');
+  Expect.equals(2, builder.length);
+  List elements = [];
+  builder.build().forEach(elements.add);
+  elements.sort();
+  Expect.listEquals(['c', 'd'], elements);
+}
+
+void testVector() {
+  PersistentVector vector = new PersistentVector();
+  for (int i = 0; i < COUNT; i++) vector = vector.add(i);
+  Expect.equals(COUNT, vector.length);
+  Expect.isTrue(isImmutable(vector));
+  for (int i = 0; i < COUNT; i++) Expect.equals(i, vector[i]);
+  Expect.throws(() => vector[COUNT], (e) => e is RangeError);
+
+  PersistentVector updated = vector.set(1000, -1).set(COUNT - 1, -2);
+  Expect.equals(-1, updated[1000]);
+  Expect.equals(-2, updated[COUNT - 1]);
+  Expect.equals(1000, vector[1000]);
+
+  for (int i = COUNT - 1; i >= 0; i--) {
+    Expect.equals(i, vector[i]);
+    vector = vector.removeLast();
+    Expect.equals(i, vector.length);
+  }
+  Expect.isTrue(vector.isEmpty);
+  Expect.throws(() => vector.removeLast(), (e) => e is StateError);
+}
+
+void testVectorBuilder() {
+  PersistentVector prefix = new PersistentVector.from([-3, -2, -1]);
+  PersistentVectorBuilder builder = prefix.toBuilder();
+  for (int i = 0; i < COUNT; i++) builder.add(i);
+  builder[0] = 'first';
+  builder[COUNT + 2] = 'last';
+  PersistentVector vector = builder.build();
+  Expect.equals(COUNT + 3, vector.length);
+  Expect.equals('first', vector[0]);
+  Expect.equals(500, vector[503]);
+  Expect.equals('last', vector[COUNT + 2]);
+  Expect.equals(-3, prefix[0]);
+
+  List list = vector.toList();
+  Expect.equals(COUNT + 3, list.length);
+  Expect.equals(list[1000], vector[1000]);
+}
+
+void testShare() {
+  PersistentMap map = new PersistentMap();
+  for (int i = 0; i < 1000; i++) map = map.put('key$i', i);
+  Channel channel = new Channel();
+  Port port = new Port(channel);
+  Process.spawnDetached(() => port.send(map.put('extra', -1)));
+  PersistentMap received = channel.receive();
+  Expect.equals(1001, received.length);
+  Expect.equals(500, received['key500']);
+  Expect.equals(-1, received['extra']);
+  Expect.isNull(map['extra']);
+}
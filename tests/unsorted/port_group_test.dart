@@ -0,0 +1,99 @@
+// Copyright (c) 2015, the Fletch project authors. Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE.md file.
+
+import 'dart:fletch';
+
+import 'package:expect/expect.dart';
+
+const int WORKERS = 8;
+const int ROUNDS = 20;
+
+class Mutable {
+  int x;
+}
+
+class Query {
+  final Port reply;
+  final int round;
+  const Query(this.reply, this.round);
+}
+
+bool isArgumentError(o) => o is ArgumentError;
+bool isRangeError(o) => o is RangeError;
+bool isStateError(o) => o is StateError;
+
+void worker(int index, Port ready) {
+  Channel channel = new Channel();
+  ready.send(new Port(channel));
+  while (true) {
+    Query query = channel.receive();
+    if (query == null) return;
+    query.reply.contribute(index, query.round * WORKERS + index);
+  }
+}
+
+PortGroup spawnWorkers() {
+  Channel channel = new Channel();
+  Port ready = new Port(channel);
+  for (int i = 0; i < WORKERS; i++) {
+    Process.spawnDetached(() => worker(i, ready));
+  }
+  List<Port> ports = new List<Port>();
+  for (int i = 0; i < WORKERS; i++) ports.add(channel.receive());
+  return new PortGroup(ports);
+}
+
+void testBroadcastAndGather() {
+  PortGroup group = spawnWorkers();
+  Expect.equals(WORKERS, group.length);
+  Expect.isTrue(isImmutable(group));
+  Channel results = new Channel();
+  for (int round = 0; round < ROUNDS; round++) {
+    Port gather = new Port.gather(results, WORKERS);
+    group.broadcast(new Query(gather, round));
+    List values = results.receive();
+    Expect.equals(WORKERS, values.length);
+    for (int i = 0; i < WORKERS; i++) {
+      Expect.equals(round * WORKERS + i, values[i]);
+    }
+  }
+  group.broadcast(null);
+}
+
+void testGatherInProcess() {
+  Channel channel = new Channel();
+  Port gather = new Port.gather(channel, 3);
+  gather.contribute(2, "c");
+  gather.contribute(0, const Query(null, 0));
+  Expect.throws(() => gather.contribute(2, "d"), isStateError);
+  gather.contribute(1, 400000000000);
+  List values = channel.receive();
+  Expect.equals("c", values[2]);
+  Expect.equals(0, values[0].round);
+  Expect.equals(400000000000, values[1]);
+}
+
+void testInvalidArguments() {
+  Channel channel = new Channel();
+  Port port = new Port(channel);
+  Port gather = new Port.gather(channel, 2);
+  Expect.throws(() => new Port.gather(channel, 0), isRangeError);
+  Expect.throws(() => gather.contribute(2, 0), isRangeError);
+  Expect.throws(() => gather.contribute(-1, 0), isRangeError);
+  Expect.throws(() => gather.contribute(0, new Mutable()), isArgumentError);
+  Expect.throws(() => port.contribute(0, 0), isStateError);
+  Expect.throws(() => new PortGroup([port, 42]), isArgumentError);
+
+  PortGroup group = new PortGroup([port, port]);
+  Expect.throws(() => group.broadcast(new Mutable()), isArgumentError);
+  group.broadcast(42);
+  Expect.equals(42, channel.receive());
+  Expect.equals(42, channel.receive());
+}
+
+main() {
+  testBroadcastAndGather();
+  testGatherInProcess();
+  testInvalidArguments();
+}
@@ -31,9 +31,52 @@ void testFib() {
   Expect.equals(55, fib(10));
 }
 
+identity(x) => x;
+square(x) => x * x;
+add(a, b) => a + b;
+wrap(x) => [x];
+throwOnOdd(x) => x.isOdd ? throw x : x;
+throwOnLarge(a, b) => (b > 50) ? throw "too large" : a + b;
+throwMutable(a, b) => throw new Mutable();
+
+void testManyElements() {
+  List arguments = new List.generate(10000, (i) => i);
+  List results = Process.divide(square, arguments);
+  Expect.equals(10000, results.length);
+  for (int i = 0; i < 10000; i++) Expect.equals(i * i, results[i]);
+
+  Expect.equals(49995000, Process.divideReduce(identity, add, arguments));
+  Expect.isNull(Process.divideReduce(square, add, []));
+  Expect.listEquals([], Process.divide(square, []));
+  Process.divideForEach(square, arguments);
+}
+
+void testMutableResults() {
+  List results = Process.divide(wrap, new List.generate(100, (i) => i));
+  for (int i = 0; i < 100; i++) Expect.listEquals([i], results[i]);
+}
+
+void testThrowingElements() {
+  List results = Process.divide(throwOnOdd, [0, 1, 2, 3]);
+  Expect.listEquals([0, null, 2, null], results);
+}
+
+void testThrowingCombine() {
+  // Large enough for every chunk to be combined in a worker.
+  List arguments = new List.generate(10000, (i) => i);
+  Expect.throws(() => Process.divideReduce(identity, throwOnLarge, arguments),
+                (e) => e == "too large");
+  Expect.throws(() => Process.divideReduce(identity, throwMutable, arguments),
+                (e) => e is String);
+}
+
 main() {
   testInvalidArguments();
   testFib();
+  testManyElements();
+  testMutableResults();
+  testThrowingElements();
+  testThrowingCombine();
 }
 
 const Parallel parallel = const Parallel();
@@ -0,0 +1,42 @@
+// Copyright (c) 2015, the Fletch project authors. Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE.md file.
+
+import 'dart:fletch';
+
+import 'package:expect/expect.dart';
+
+// Grow the stack and the heap, so hibernation has something to release.
+int deep(int n) {
+  if (n == 0) {
+    List garbage = new List.generate(10000, (i) => [i]);
+    return garbage.length;
+  }
+  return deep(n - 1) + 1;
+}
+
+void echo(Port reply) {
+  Channel channel = new Channel();
+  reply.send(new Port(channel));
+  List kept = new List.generate(100, (i) => "$i");
+  while (true) {
+    var message = channel.receive();
+    if (message == null) break;
+    Expect.equals(10000 + 1000, deep(1000));
+    Process.hibernate();
+    reply.send(message + kept.length);
+  }
+  reply.send(kept.last);
+}
+
+main() {
+  Channel channel = new Channel();
+  Process.spawnDetached(() => echo(new Port(channel)));
+  Port port = channel.receive();
+  for (int i = 0; i < 10; i++) {
+    port.send(i);
+    Expect.equals(i + 100, channel.receive());
+  }
+  port.send(null);
+  Expect.equals("99", channel.receive());
+}
@@ -52,6 +52,9 @@ main() {
 
   print('killProcessTest');
   killProcessTest();
+
+  print('monitorManyProcessesTest');
+  monitorManyProcessesTest();
 }
 
 simpleMonitorTest(DeathReason reason) {
@@ -326,6 +329,32 @@ killProcessTest() {
   Expect.equals(DeathReason.Killed, death.reason);
 }
 
+monitorManyProcessesTest() {
+  const int count = 100;
+  var monitor = new Channel();
+  var monitorPort = new Port(monitor);
+
+  List processes = [];
+  for (int i = 0; i < count; i++) {
+    processes.add(Process.spawnDetached(() {
+      blockInfinitly();
+    }, monitor: monitorPort));
+  }
+  for (var process in processes) process.kill();
+
+  // The deaths arrive in batches, but each of them is received on its own.
+  for (int i = 0; i < count; i++) {
+    ProcessDeath death = monitor.receive();
+    Expect.equals(DeathReason.Killed, death.reason);
+    Expect.isTrue(processes.remove(death.process));
+  }
+  Expect.isTrue(processes.isEmpty);
+
+  // Messages sent after the deaths are received after them.
+  monitorPort.send('done');
+  Expect.equals('done', monitor.receive());
+}
+
 failWithDeathReason(DeathReason reason) {
   if (reason == DeathReason.UncaughtException) throw 'failing';
   if (reason == DeathReason.CompileTimeError) failWithCompileTimeError();
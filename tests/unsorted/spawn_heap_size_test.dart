@@ -0,0 +1,23 @@
+// Copyright (c) 2015, the Fletch project authors. Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE.md file.
+
+import 'dart:fletch';
+
+import 'package:expect/expect.dart';
+
+void allocate(Port reply) {
+  List lists = new List.generate(10000, (i) => [i]);
+  reply.send(lists.last.first);
+}
+
+main() {
+  Channel channel = new Channel();
+  Port port = new Port(channel);
+  Process.spawnDetached(() => allocate(port), heapSize: 1024 * 1024);
+  Expect.equals(9999, channel.receive());
+  Process.spawnDetached(() => allocate(port), heapSize: 0);
+  Expect.equals(9999, channel.receive());
+  Expect.throws(() => Process.spawnDetached(() => allocate(port),
+                                            heapSize: "big"));
+}
@@ -28,6 +28,9 @@ LOCAL_SRC_FILES := \
 	../../../src/shared/platform_linux.cc \
 	../../../src/shared/platform_posix.cc \
 	../../../src/shared/utils.cc \
+	../../../src/vm/buffer_pool.cc \
+	../../../src/vm/checkpoint.cc \
+	../../../src/vm/clock.cc \
 	../../../src/vm/debug_info.cc \
 	../../../src/vm/event_handler.cc \
 	../../../src/vm/event_handler_linux.cc \
@@ -37,9 +40,12 @@ LOCAL_SRC_FILES := \
 	../../../src/vm/ffi_posix.cc \
 	../../../src/vm/fletch.cc \
 	../../../src/vm/fletch_api_impl.cc \
+	../../../src/vm/function_profile.cc \
 	../../../src/vm/gc_thread.cc \
 	../../../src/vm/heap.cc \
+	../../../src/vm/heap_policy.cc \
 	../../../src/vm/heap_validator.cc \
+	../../../src/vm/histogram.cc \
 	../../../src/vm/shared_heap.cc \
 	../../../src/vm/interpreter.cc \
 	../../../src/vm/intrinsics.cc \
@@ -51,6 +57,7 @@ LOCAL_SRC_FILES := \
 	../../../src/vm/native_process_disabled.cc \
 	../../../src/vm/natives.cc \
 	../../../src/vm/natives_posix.cc \
+	../../../src/vm/numa.cc \
 	../../../src/vm/object.cc \
 	../../../src/vm/object_list.cc \
 	../../../src/vm/object_map.cc \
@@ -70,6 +77,7 @@ LOCAL_SRC_FILES := \
 	../../../src/vm/storebuffer.cc \
 	../../../src/vm/thread_pool.cc \
 	../../../src/vm/thread_posix.cc \
+	../../../src/vm/threaded_code.cc \
 	../../../src/vm/unicode.cc \
 	../../../src/vm/vector.cc \
 	../../../src/vm/void_hash_table.cc \
@@ -0,0 +1,73 @@
+#!/usr/bin/env python
+#
+# Copyright (c) 2015, the Fletch project authors.  Please see the AUTHORS file
+# for details. All rights reserved. Use of this source code is governed by a
+# BSD-style license that can be found in the LICENSE file.
+
+# Runs benchmark snapshots with the generated interpreter and with the C++
+# interpreter (-Xnative_interpreter=false) and prints the speedup.
+#
+# Build the snapshots first, for example:
+#
+#   dart -c -Dsnapshot=DeltaBlue.snapshot tests/fletchc/run.dart \
+#       benchmarks/DeltaBlue.dart
+#
+# and then run:
+#
+#   tools/compare_interpreters.py --vm=out/ReleaseX64/fletch-vm \
+#       DeltaBlue.snapshot Richards.snapshot
+#
+# tests/golem/golem_tests.dart runs this on DeltaBlue, so the script keeps
+# working with the benchmark output and the interpreter flags.
+
+import optparse
+import re
+import subprocess
+import sys
+
+SCORE_PATTERN = re.compile(r'^(\w+)\(RunTime\): ([0-9.]+) us\.$')
+
+def ParseOptions():
+  parser = optparse.OptionParser(usage='%prog [options] snapshot...')
+  parser.add_option('--vm', default='out/ReleaseX64/fletch-vm')
+  parser.add_option('--runs', type='int', default=5,
+                    help='Runs per interpreter, the best score is used.')
+  (options, args) = parser.parse_args()
+  if not args:
+    parser.error('No snapshots given')
+  return (options, args)
+
+def RunSnapshot(vm, snapshot, flags):
+  output = subprocess.check_output([vm] + flags + [snapshot],
+                                   universal_newlines=True)
+  scores = {}
+  for line in output.splitlines():
+    match = SCORE_PATTERN.match(line.strip())
+    if match:
+      scores[match.group(1)] = float(match.group(2))
+  return scores
+
+def BestScores(vm, snapshot, flags, runs):
+  best = {}
+  for _ in range(runs):
+    for name, score in RunSnapshot(vm, snapshot, flags).items():
+      best[name] = min(score, best.get(name, score))
+  return best
+
+def Main():
+  (options, snapshots) = ParseOptions()
+  print('%-20s %14s %14s %8s' % ('Benchmark', 'C++ (us)', 'Native (us)',
+                                  'Speedup'))
+  for snapshot in snapshots:
+    engine = BestScores(options.vm, snapshot,
+                        ['-Xnative_interpreter=false'], options.runs)
+    native = BestScores(options.vm, snapshot, [], options.runs)
+    for name in sorted(native):
+      if name not in engine:
+        continue
+      print('%-20s %14.1f %14.1f %7.2fx' % (
+          name, engine[name], native[name], engine[name] / native[name]))
+  return 0
+
+if __name__ == '__main__':
+  sys.exit(Main())
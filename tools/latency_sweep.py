@@ -0,0 +1,76 @@
+#!/usr/bin/env python
+#
+# Copyright (c) 2015, the Fletch project authors.  Please see the AUTHORS file
+# for details. All rights reserved. Use of this source code is governed by a
+# BSD-style license that can be found in the LICENSE file.
+
+# Runs latency benchmark snapshots (see benchmarks/LatencyBase.dart) with a
+# range of scheduler thread counts (-Xmax_threads) and prints the latencies
+# of every configuration, as a table or as JSON.
+#
+# Build the snapshots first, for example:
+#
+#   dart -c -Dsnapshot=PortLatency.snapshot tests/fletchc/run.dart \
+#       benchmarks/messaging/PortLatency.dart
+#
+# and then run:
+#
+#   tools/latency_sweep.py --vm=out/ReleaseX64/fletch-vm --threads=1,2,4,8 \
+#       PortLatency.snapshot
+
+import json
+import optparse
+import re
+import subprocess
+import sys
+
+LINE_PATTERN = re.compile(r'^(\w+)\((\w+)\): ([0-9.]+) us\.$')
+STATISTICS = ['P50', 'P90', 'P99', 'P999', 'Max', 'Mean']
+
+def ParseOptions():
+  parser = optparse.OptionParser(usage='%prog [options] snapshot...')
+  parser.add_option('--vm', default='out/ReleaseX64/fletch-vm')
+  parser.add_option('--threads', default='1,2,4',
+                    help='Comma separated scheduler thread counts.')
+  parser.add_option('--json', action='store_true', default=False,
+                    help='Print the results as JSON.')
+  (options, args) = parser.parse_args()
+  if not args:
+    parser.error('No snapshots given')
+  options.threads = [int(count) for count in options.threads.split(',')]
+  return (options, args)
+
+def RunSnapshot(vm, snapshot, threads):
+  output = subprocess.check_output(
+      [vm, '-Xmax_threads=%d' % threads, snapshot], universal_newlines=True)
+  results = {}
+  for line in output.splitlines():
+    match = LINE_PATTERN.match(line.strip())
+    if match:
+      point = results.setdefault(match.group(1), {})
+      point[match.group(2)] = float(match.group(3))
+  return results
+
+def Main():
+  (options, snapshots) = ParseOptions()
+  results = []
+  for snapshot in snapshots:
+    for threads in options.threads:
+      for name, point in sorted(RunSnapshot(options.vm, snapshot,
+                                            threads).items()):
+        point['name'] = name
+        point['threads'] = threads
+        results.append(point)
+  if options.json:
+    print(json.dumps(results, indent=2, sort_keys=True))
+    return 0
+  print('%-36s %7s' % ('Benchmark', 'Threads') +
+        ''.join('%10s' % statistic for statistic in STATISTICS))
+  for point in results:
+    print('%-36s %7d' % (point['name'], point['threads']) +
+          ''.join('%10.0f' % point.get(statistic, 0)
+                  for statistic in STATISTICS))
+  return 0
+
+if __name__ == '__main__':
+  sys.exit(Main())